@@ -0,0 +1,54 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+# pragma once
+#include <list>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "face.hpp"
+#include "detection_record.hpp"
+
+// -------------------------Audience in front of the screen-----------------------------------------------------
+
+// The faces found on a frame are matched with the faces of the previous frame, get their attributes and are
+// counted into the demographics. The live analysis passes the results of the networks as a RecordedFace, the
+// replay the recorded one, so that a recording replays to the demographics it was recorded with.
+
+struct AudienceOptions {
+    bool smooth;                      // faces are tracked from frame to frame, -no_smooth disables it
+    AttributeCachePolicy ageGender;   // when the age and gender of a tracked face are estimated again
+    bool emotions;                    // Emotions Recognition is loaded
+    bool landmarks;                   // Facial Landmarks Estimation is loaded
+};
+
+void setAudienceOptions(const AudienceOptions &options);
+const AudienceOptions &getAudienceOptions();
+
+// Forgets the tracked faces and the demographics, the next frame is the first one
+void resetAudience();
+
+// A person looking at the screen is interested in the ad
+bool isLookingAtScreen(const HeadPoseDetection::Results &headPose);
+
+// The demographics of every 5th frame are stored in the circular array of 5 frames
+void beginDemographics();
+void endDemographics(size_t peopleCount);
+
+// Matches the detected faces with the faces of the previous frame, so that the results cached for a face
+// can be reused. A face whose mean brightness changes markedly is taken for a new one.
+std::vector<Face::Ptr> trackFaces(const std::vector<cv::Rect> &rects, const std::vector<float> &intensities);
+
+// Sets the attributes of a tracked face from its results, the landmarks themselves are left to the caller
+void updateFace(const Face::Ptr &face, const RecordedFace &results);
+
+// Adds a face with its attributes updated to the demographics, it is tracked on the next frame
+void addFace(const Face::Ptr &face);
+
+// The faces of the latest frame
+const std::list<Face::Ptr> &trackedFaces();
+
+// Frame flags of the recording telling which networks are loaded
+uint16_t recordedNetworks();
@@ -0,0 +1,178 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __CAPTURE_SOURCE_H__
+#define __CAPTURE_SOURCE_H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sample_defs.h"
+#include "mfx_buffering.h"
+#include "vm/thread_defs.h"
+
+struct sCaptureParams
+{
+    std::string device;    // V4L2 device node or raw file
+    mfxU32      fourcc;    // MFX_FOURCC_NV12 or MFX_FOURCC_YUY2
+    mfxU16      width;
+    mfxU16      height;
+    mfxU32      numBuffers;
+    mfxF64      frameRate; // file source only, 0 - as fast as frames are returned
+    bool        loop;      // file source only, restart at the end of file
+
+    sCaptureParams()
+        : fourcc(MFX_FOURCC_NV12), width(0), height(0), numBuffers(4), frameRate(0), loop(false)
+    {}
+};
+
+/** \brief One captured picture, owned by the caller until it is passed to ReleaseFrame().
+ */
+struct sCaptureFrame
+{
+    mfxU32 index;     // buffer index inside the source
+    mfxU32 fourcc;
+    mfxU16 width;
+    mfxU16 height;
+    mfxU32 pitch;     // bytes per luma (NV12) or packed (YUY2) row
+    mfxU8* data;      // the luma plane is followed by the chroma plane at data + pitch * height for NV12
+    int    dmabufFd;  // exported DMABUF of the buffer, -1 if not available
+    msdk_tick timestamp;
+};
+
+/** \brief Base class for capture sources.
+ *
+ * A capture thread fills the buffers and passes their indices to the consumer over a
+ * lock-free single producer single consumer queue. The consumer works on the buffer
+ * in place and returns it explicitly, no picture is copied on the way.
+ */
+class CCaptureSource
+{
+public:
+    CCaptureSource();
+    virtual ~CCaptureSource();
+
+    virtual mfxStatus Open(const sCaptureParams& params) = 0;
+    virtual void Close();
+
+    /** \brief Waits for the next captured picture.
+     *
+     * @return MFX_ERR_NONE The picture is returned in frame.
+     * @return MFX_ERR_MORE_DATA The source is exhausted.
+     * @return Any other status is a capture error.
+     */
+    mfxStatus GetFrame(sCaptureFrame& frame);
+    void ReleaseFrame(const sCaptureFrame& frame);
+
+    /** \brief Number of frames captured and waiting for the consumer, called by the consumer. */
+    mfxU32 GetQueuedFrames() const { return m_pThread.get() ? m_ready.GetSize() : 0; }
+    /** \brief Number of frames the device dropped as no buffer was free. */
+    mfxU64 GetDroppedFrames() const { return m_dropped; }
+
+protected:
+    /** \brief Called on the capture thread, blocks until a buffer is filled.
+     *
+     * Should give up and return MFX_ERR_ABORTED once m_bStop is set.
+     */
+    virtual mfxStatus CaptureBuffer(mfxU32& index) = 0;
+    /** \brief Called on the consumer thread to give a buffer back to the source. */
+    virtual void ReturnBuffer(mfxU32 index) = 0;
+    /** \brief Wakes the capture thread if it waits inside CaptureBuffer(). */
+    virtual void Interrupt() {}
+
+    mfxStatus Start();
+    void Stop();
+
+    std::vector<sCaptureFrame> m_frames;
+
+    std::atomic<bool> m_bStop;
+    std::atomic<mfxU64> m_dropped; // updated by the capture thread
+
+private:
+    static unsigned int MFX_STDCALL CaptureThreadFunc(void* ctx);
+    void CaptureLoop();
+
+    enum { END_OF_STREAM = 0xFFFFFFFF };
+
+    msdkSPSCQueue<mfxU32>          m_ready;      // indices of filled buffers, END_OF_STREAM at the end
+    std::unique_ptr<MSDKSemaphore> m_pReady;     // counts the items in m_ready
+    std::unique_ptr<MSDKThread>    m_pThread;
+    mfxStatus                      m_status;     // written by the capture thread before END_OF_STREAM
+    bool                           m_bFinished;  // consumer side
+
+    CCaptureSource(const CCaptureSource&);
+    void operator=(const CCaptureSource&);
+};
+
+/** \brief V4L2 capture device using driver allocated buffers.
+ *
+ * The buffers are mapped into the process and exported as DMABUF where the driver
+ * supports it, so they can be imported by other devices without a copy.
+ */
+class CV4L2CaptureSource : public CCaptureSource
+{
+public:
+    CV4L2CaptureSource();
+    virtual ~CV4L2CaptureSource();
+
+    virtual mfxStatus Open(const sCaptureParams& params);
+    virtual void Close();
+
+protected:
+    virtual mfxStatus CaptureBuffer(mfxU32& index);
+    virtual void ReturnBuffer(mfxU32 index);
+
+    mfxStatus QueueBuffer(mfxU32 index);
+
+    int                 m_fd;
+    std::vector<size_t> m_lengths; // mapped size of every buffer
+    bool                m_bStreaming;
+    bool                m_bSequenceValid;
+    mfxU32              m_lastSequence; // sequence number of the last buffer dequeued
+};
+
+/** \brief Fake capture device reading raw NV12 or YUY2 frames from a file.
+ */
+class CFileCaptureSource : public CCaptureSource
+{
+public:
+    CFileCaptureSource();
+    virtual ~CFileCaptureSource();
+
+    virtual mfxStatus Open(const sCaptureParams& params);
+    virtual void Close();
+
+protected:
+    virtual mfxStatus CaptureBuffer(mfxU32& index);
+    virtual void ReturnBuffer(mfxU32 index);
+    virtual void Interrupt();
+
+    FILE*                          m_file;
+    bool                           m_bLoop;
+    size_t                         m_frameSize;
+    msdk_tick                      m_frameInterval; // 0 - no pacing
+    msdk_tick                      m_nextFrameTick;
+    std::vector<mfxU8*>            m_buffers;
+    msdkSPSCQueue<mfxU32>          m_free;  // buffers returned by the consumer
+    std::unique_ptr<MSDKSemaphore> m_pFree; // counts the items in m_free
+};
+
+#endif // __CAPTURE_SOURCE_H__
@@ -0,0 +1,76 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __DECODE_FRAME_SOURCE_H__
+#define __DECODE_FRAME_SOURCE_H__
+
+#include <memory>
+
+#include "pipeline_decode.h"
+#include "vm/thread_defs.h"
+
+/** \brief Pull interface on top of CDecodingPipeline.
+ *
+ * The stream is decoded on a separate thread into system memory NV12 surfaces.
+ * Every decoded surface is handed to the caller of GetFrame() as is, and the
+ * decoder is held until ReleaseFrame() is called, so no copy is ever made.
+ */
+class CDecodeFrameSource : public IDecodedFrameSink
+{
+public:
+    CDecodeFrameSource();
+    virtual ~CDecodeFrameSource();
+
+    mfxStatus Open(const char* fileName, const char* codec);
+    void Close();
+
+    /** \brief Waits for the next decoded surface.
+     *
+     * A frame still held from the previous call is released first.
+     *
+     * @return MFX_ERR_NONE The surface is returned in frame and stays valid until ReleaseFrame().
+     * @return MFX_ERR_MORE_DATA The stream is over.
+     * @return Any other status is a decoding error.
+     */
+    mfxStatus GetFrame(mfxFrameSurface1** frame);
+    void ReleaseFrame();
+
+    virtual mfxStatus OnFrame(mfxFrameSurface1* frame);
+
+protected:
+    mfxStatus DecodeLoop();
+    static unsigned int MFX_STDCALL DecodeThreadFunc(void* ctx);
+
+    sInputParams                       m_params;
+    std::unique_ptr<CDecodingPipeline> m_pPipeline;
+    std::unique_ptr<MSDKThread>        m_pThread;
+    std::unique_ptr<MSDKSemaphore>     m_pFrameReady;    // posted by the decoder thread for every frame and at the end
+    std::unique_ptr<MSDKSemaphore>     m_pFrameReleased; // posted by the consumer when it is done with the frame
+    mfxFrameSurface1*                  m_pFrame;         // NULL after the end of stream
+    mfxStatus                          m_status;         // result of the decoding loop, valid once m_pFrame is NULL
+    volatile bool                      m_bStop;
+    bool                               m_bFrameHeld;     // consumer side: GetFrame() result not released yet
+    bool                               m_bFinished;      // consumer side: end of stream or error was returned
+
+private:
+    CDecodeFrameSource(const CDecodeFrameSource&);
+    void operator=(const CDecodeFrameSource&);
+};
+
+#endif // __DECODE_FRAME_SOURCE_H__
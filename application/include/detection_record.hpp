@@ -0,0 +1,86 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+# pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CAsyncFileWriter;
+
+// -------------------------Recording of the inference results for an offline replay----------------------------
+
+// A recording starts with RECORDING_MAGIC and RECORDING_VERSION as two 32-bit words, followed by a record
+// per analysed frame: a RecordedFrame and as many RecordedFace entries as it has faces.
+#pragma pack(push, 1)
+struct RecordedFrame {
+    uint64_t timestamp;   // microseconds since the epoch when the frame was analysed
+    uint16_t width;
+    uint16_t height;
+    uint16_t faces;
+    uint16_t flags;       // RecordedFrameFlags
+};
+
+struct RecordedFace {
+    int16_t x;            // detected box clipped to the frame
+    int16_t y;
+    int16_t width;
+    int16_t height;
+    float confidence;
+    float intensity;      // mean brightness of the box, the tracking treats a marked change as a new face
+    float age;            // valid with RECORDED_AGE_GENDER
+    float maleProb;
+    float yaw;            // valid with RECORDED_HEAD_POSE
+    float pitch;
+    float roll;
+    float emotions[5];    // valid with RECORDED_EMOTIONS, in the order of EmotionsDetection::emotionsVec
+    uint8_t flags;        // RecordedFaceFlags
+};
+#pragma pack(pop)
+
+enum RecordedFrameFlags {
+    RECORDED_DETECTED = 1,     // faces were detected on the frame rather than skipped by the motion gate
+    RECORDED_AD_FINISHED = 2,  // an ad finished playing before the frame was analysed
+    RECORDED_EMOTIONS_ENABLED = 4,   // Emotions Recognition was loaded
+    RECORDED_LANDMARKS_ENABLED = 8,  // Facial Landmarks Estimation was loaded
+};
+
+enum RecordedFaceFlags {
+    RECORDED_AGE_GENDER = 1,   // Age/Gender ran on the face, rather than its cached results being used
+    RECORDED_HEAD_POSE = 2,
+    RECORDED_EMOTIONS = 4,     // Emotions Recognition ran on the face
+    RECORDED_LANDMARKS = 8,    // the landmarks of the face were estimated, they are not recorded
+};
+
+static const uint32_t RECORDING_MAGIC = 0x43455244;  // "DREC"
+static const uint32_t RECORDING_VERSION = 2;
+
+// Appends the records from the analysis thread, the file is written by a background thread
+class DetectionRecorder {
+public:
+    DetectionRecorder();
+    ~DetectionRecorder();
+
+    bool open(const std::string &path);
+    void write(const RecordedFrame &frame, const std::vector<RecordedFace> &faces);
+    void close();
+
+private:
+    std::unique_ptr<CAsyncFileWriter> _writer;
+};
+
+// Reads the records of a recording back, the whole file is loaded at once
+class DetectionReplay {
+public:
+    DetectionReplay();
+
+    bool open(const std::string &path);
+    // Returns false at the end of the recording or if it is truncated
+    bool next(RecordedFrame &frame, std::vector<RecordedFace> &faces);
+
+private:
+    std::vector<char> _data;
+    size_t _offset;
+};
@@ -0,0 +1,77 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+# pragma once
+#include <cstdint>
+#include <vector>
+#ifdef __SSE2__
+#include <xmmintrin.h>
+#endif
+
+// -------------------------Decoding of the face detection outputs----------------------------------------------
+
+// Row layouts of the face detection outputs, the decoder is specialised on them at compile time
+
+// DetectionOutput [1, 1, N, 7]: image_id, label, confidence, x_min, y_min, x_max, y_max in fractions
+// of the input size. The detections end at the first negative image_id.
+struct DetectionOutputRows {
+    static const int size = 7;
+    static const int confidence = 2;
+    static const int box = 3;
+    static const bool normalized = true;
+    static bool isEnd(const float *row) { return row[0] < 0; }
+    static int label(const float *row, const int32_t *, int) { return static_cast<int>(row[1]); }
+};
+
+// Boxes [N, 5]: x_min, y_min, x_max, y_max in input pixels and confidence, with the labels [N] in an output of their own
+struct BoxesRows {
+    static const int size = 5;
+    static const int confidence = 4;
+    static const int box = 0;
+    static const bool normalized = false;
+    static bool isEnd(const float *) { return false; }
+    static int label(const float *, const int32_t *labels, int i) { return labels[i]; }
+};
+
+// Writes the indices of the rows from first to count whose confidence is above threshold and returns how many
+// there are. The index is stored unconditionally and kept by advancing the count, so there is no branch per row.
+template <typename Rows>
+size_t filterRowsByConfidence(const float *detections, int first, int count, float threshold, int *survivors) {
+    size_t n = 0;
+    for (int i = first; i < count; ++i) {
+        survivors[n] = i;
+        n += detections[i * Rows::size + Rows::confidence] > threshold;
+    }
+    return n;
+}
+
+// Collects the indices of the rows whose confidence is above threshold, four rows are compared at once
+// and only the few survivors take a branch. micro_benchmark detection_filter compares it with the scalar loop.
+template <typename Rows>
+void filterByConfidence(const float *detections, int count, float threshold, std::vector<int> &survivors) {
+    survivors.resize(static_cast<size_t>(count));
+    size_t n = 0;
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 t = _mm_set1_ps(threshold);
+    for (; i + 4 <= count; i += 4) {
+        const float *c = detections + i * Rows::size + Rows::confidence;
+        int mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_setr_ps(c[0], c[Rows::size], c[2 * Rows::size],
+                                                            c[3 * Rows::size]), t));
+        while (mask) {
+            survivors[n++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+#endif
+    n += filterRowsByConfidence<Rows>(detections, i, count, threshold, survivors.data() + n);
+    survivors.resize(n);
+}
+
+// The scalar loop alone, the reference of filterByConfidence
+template <typename Rows>
+void filterByConfidenceScalar(const float *detections, int count, float threshold, std::vector<int> &survivors) {
+    survivors.resize(static_cast<size_t>(count));
+    survivors.resize(filterRowsByConfidence<Rows>(detections, 0, count, threshold, survivors.data()));
+}
@@ -28,6 +28,10 @@
 
 #include <opencv2/opencv.hpp>
 
+#include "latency_histogram.h"
+#include "trace_events.h"
+#include "preprocess.hpp"
+
 // -------------------------Generic routines for detection networks-------------------------------------------------
 
 struct BaseDetection {
@@ -44,6 +48,13 @@ struct BaseDetection {
     mutable bool enablingChecked;
     mutable bool _enabled;
     const bool doRawOutputMessages;
+    size_t inferredItems;   // images enqueued for inference
+    size_t skippedItems;    // images the application decided not to infer, e.g. with cached results
+    CLatencyHistogram latency;  // ms the analysis thread was blocked in submitRequest() and wait() per request
+    double blockedMs;
+    bool submitted;
+    const char *submitSpan;     // names of the trace spans
+    const char *waitSpan;
 
     BaseDetection(std::string topoName,
                   const std::string &pathToModel,
@@ -84,9 +95,21 @@ struct FaceDetection : BaseDetection {
     float bb_dx_coefficient;
     float bb_dy_coefficient;
     bool resultsFetched;
+    bool nv12Input;
     std::vector<std::string> labels;
     std::vector<Result> results;
 
+    // Far faces are also searched on overlapping tiles of the frame, each tile is inferred by a request of
+    // its own next to the request for the whole frame and the results are merged by NMS
+    cv::Size tileGrid;           // columns and rows of tiles, empty to detect on the whole frame only
+    float tileOverlap;           // fraction of a tile shared with its neighbour
+    cv::Rect2f tileRegion;       // part of the frame the tiles cover, in fractions of the frame size
+    float tileNmsThreshold;      // IoU above which the weaker of two detections is dropped
+    std::vector<cv::Rect> tiles; // tiles of the enqueued frame in pixels, row by row
+    std::vector<InferenceEngine::InferRequest::Ptr> tileRequests;
+    std::vector<InferenceEngine::InferRequest::Ptr> nxttileRequests;
+    float nmsThreshold;          // IoU threshold of the NMS for the detections of a request, 0 for outputs already suppressed
+
     FaceDetection(const std::string &pathToModel,
                   const std::string &deviceForInference,
                   int maxBatch, bool isBatchDynamic, bool isAsync,
@@ -96,9 +119,23 @@ struct FaceDetection : BaseDetection {
 
     InferenceEngine::CNNNetwork read(const InferenceEngine::Core& ie) override;
     void submitRequest() override;
+    void wait() override;
 
     void enqueue(const cv::Mat &frame);
+    void enqueue(const cv::Mat &y, const cv::Mat &uv);
+    void swapRequests();
     void fetchResults();
+
+private:
+    void prepareRequests();
+    std::vector<InferenceEngine::InferRequest::Ptr> &prepareTiles(int frameWidth, int frameHeight);
+    void fetchResults(const InferenceEngine::InferRequest::Ptr &req, const cv::Rect &area, int tile,
+                      std::vector<Result> &found);
+    template <typename Rows>
+    void decode(const float *detections, const int32_t *labels, const cv::Rect &area, int tile,
+                std::vector<Result> &found);
+
+    std::vector<int> survivors;  // rows passing the confidence filter, kept to reuse its memory
 };
 
 struct AgeGenderDetection : BaseDetection {
@@ -120,7 +157,7 @@ struct AgeGenderDetection : BaseDetection {
     InferenceEngine::CNNNetwork read(const InferenceEngine::Core& ie) override;
     void submitRequest() override;
 
-    void enqueue(const cv::Mat &face);
+    void enqueue(FaceCrop &face);
     Result operator[] (int idx) const;
 };
 
@@ -146,7 +183,7 @@ struct HeadPoseDetection : BaseDetection {
     InferenceEngine::CNNNetwork read(const InferenceEngine::Core& ie) override;
     void submitRequest() override;
 
-    void enqueue(const cv::Mat &face);
+    void enqueue(FaceCrop &face);
     Results operator[] (int idx) const;
 };
 
@@ -163,10 +200,11 @@ struct EmotionsDetection : BaseDetection {
     InferenceEngine::CNNNetwork read(const InferenceEngine::Core& ie) override;
     void submitRequest() override;
 
-    void enqueue(const cv::Mat &face);
+    void enqueue(FaceCrop &face);
     std::map<std::string, float> operator[] (int idx) const;
 
-    const std::vector<std::string> emotionsVec = {"neutral", "happy", "sad", "surprise", "anger"};
+    // The outputs in order, also the order of the recorded emotions
+    static const std::vector<std::string> emotionsVec;
 };
 
 struct FacialLandmarksDetection : BaseDetection {
@@ -184,7 +222,7 @@ struct FacialLandmarksDetection : BaseDetection {
     InferenceEngine::CNNNetwork read(const InferenceEngine::Core& ie) override;
     void submitRequest() override;
 
-    void enqueue(const cv::Mat &face);
+    void enqueue(FaceCrop &face);
     std::vector<float> operator[] (int idx) const;
 };
 
@@ -193,7 +231,10 @@ struct Load {
 
     explicit Load(BaseDetection& detector);
 
-    void into(InferenceEngine::Core & ie, const std::string & deviceName, bool enable_dynamic_batch = false) const;
+    void into(InferenceEngine::Core & ie, const std::string & deviceName, bool enable_dynamic_batch = false,
+              const std::map<std::string, std::string> & deviceConfig = {}) const;
+    // Loads the network on a single CPU thread and returns the average duration of its request in ms
+    double cost(InferenceEngine::Core & ie, const std::string & deviceName, bool enable_dynamic_batch, int runs) const;
 };
 
 class CallStat {
@@ -15,6 +15,14 @@
 
 // -------------------------Describe detected face on a frame-------------------------------------------------
 
+// When the age and gender of a tracked face are estimated again, see Face::isAgeGenderStale()
+struct AttributeCachePolicy {
+    size_t minSamples;       // estimates needed before the result may be considered converged
+    float maxAgeStdDev;      // age has converged once its estimates deviate less than this, in years
+    float minGenderMargin;   // gender has converged once the male and female scores are this far apart
+    size_t refreshInterval;  // frames between estimates of a converged face, 0 to estimate on every frame
+};
+
 struct Face {
 public:
     using Ptr = std::shared_ptr<Face>;
@@ -45,6 +53,12 @@ public:
     bool isHeadPoseEnabled();
     bool isLandmarksEnabled();
 
+    // Age/Gender results are cached per tracked face: they are estimated on every frame until they
+    // converge, then once per refresh interval. A face whose appearance changes is a new face.
+    bool isAgeGenderStale(const AttributeCachePolicy& policy) const;
+    bool hasAgeGender() const;
+    void skipAgeGender();
+
 public:
     cv::Rect _location;
     float _intensity_mean;
@@ -52,6 +66,10 @@ public:
 private:
     size_t _id;
     float _age;
+    size_t _ageGenderSamples;
+    float _ageSamplesMean;
+    float _ageSamplesM2;
+    size_t _framesSinceAgeGender;
     float _maleScore;
     float _femaleScore;
     std::map<std::string, float> _emotions;
@@ -0,0 +1,53 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+# pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+// -------------------------Output of the annotated frames------------------------------------------------------
+
+// Receives the frames with the results drawn on them. Sinks open lazily on the first frame, so a sink
+// created before the ad playback process is forked stays unused there.
+class FrameSink {
+public:
+    virtual ~FrameSink() {}
+    virtual void write(const cv::Mat &frame) = 0;
+    // True once the viewer asked to quit, ESC in the window
+    virtual bool closed() const { return false; }
+};
+
+// Creates the sink for a -sink value:
+//   window        - HighGUI window, the only sink calling HighGUI
+//   <path>.avi    - Motion JPEG file at fps frames per second
+//   shm:<name>    - shared memory frame ring, see SharedFrameRing
+// Returns nullptr for an unknown value.
+std::unique_ptr<FrameSink> createFrameSink(const std::string &spec, double fps);
+
+// Layout of the shared memory object written by the shm: sink, for a viewer process mapping it read-only.
+// The 64 byte header is followed by slots of slotSize bytes, a multiple of 64, each a SharedFrameSlot followed
+// by the width*height*3 bytes of a BGR frame with unpadded rows. Frame n goes to slot n % slots. Its sequence
+// is 2n+1 while the pixels are written and 2n+2 once they are complete, so a viewer copying frame written-1
+// keeps the copy if the sequence is 2n+2 both before and after it.
+struct SharedFrameRing {
+    uint32_t magic;                  // SHARED_FRAME_RING_MAGIC once the header is valid
+    uint32_t slots;
+    uint32_t width;
+    uint32_t height;
+    uint32_t slotSize;
+    uint32_t reserved;
+    std::atomic<uint64_t> written;   // number of frames completed
+    uint8_t padding[32];             // the slots start on a cache line
+};
+static_assert(sizeof(SharedFrameRing) == 64, "the slots must start on a cache line");
+
+struct SharedFrameSlot {
+    std::atomic<uint64_t> sequence;
+    uint64_t timestamp;              // microseconds since the epoch when the frame was written
+};
+
+static const uint32_t SHARED_FRAME_RING_MAGIC = 0x474e5246;  // "FRNG"
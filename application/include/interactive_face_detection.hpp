@@ -26,6 +26,8 @@ static const char input_video_message[] = "Required. Path to a video file (speci
 static const char face_detection_model_message[] = "Required. Path to an .xml file with a trained Face Detection model.";
 static const char age_gender_model_message[] = "Optional. Path to an .xml file with a trained Age/Gender Recognition model.";
 static const char head_pose_model_message[] = "Optional. Path to an .xml file with a trained Head Pose Estimation model.";
+static const char emotions_model_message[] = "Optional. Path to an .xml file with a trained Emotions Recognition model.";
+static const char facial_landmarks_model_message[] = "Optional. Path to an .xml file with a trained Facial Landmarks Estimation model.";
 
 /// @brief Message for plugin argument
 static const char plugin_message[] = "Plugin name. For example, CPU. If this parameter is specified, " \
@@ -43,6 +45,14 @@ static const char target_device_message_ag[] = "Optional. Target device for Age/
 static const char target_device_message_hp[] = "Optional. Target device for Head Pose Estimation network (CPU, GPU, HDDL, FPGA or MYRIAD). " \
 "The demo will look for a suitable plugin for a specified device.";
 
+/// @brief Message for assigning emotions calculation to device
+static const char target_device_message_em[] = "Optional. Target device for Emotions Recognition network (CPU, GPU, HDDL, FPGA or MYRIAD). " \
+"The demo will look for a suitable plugin for a specified device.";
+
+/// @brief Message for assigning facial landmarks calculation to device
+static const char target_device_message_lm[] = "Optional. Target device for Facial Landmarks Estimation network (CPU, GPU, HDDL, FPGA or MYRIAD). " \
+"The demo will look for a suitable plugin for a specified device.";
+
 /// @brief Message for the maximum number of simultaneously processed faces for Age Gender network
 static const char num_batch_ag_message[] = "Optional. Number of maximum simultaneously processed faces for Age/Gender Recognition network " \
 "(by default, it is 16)";
@@ -51,12 +61,101 @@ static const char num_batch_ag_message[] = "Optional. Number of maximum simultan
 static const char num_batch_hp_message[] = "Optional. Number of maximum simultaneously processed faces for Head Pose Estimation network " \
 "(by default, it is 16)";
 
+/// @brief Message for the maximum number of simultaneously processed faces for Emotions network
+static const char num_batch_em_message[] = "Optional. Number of maximum simultaneously processed faces for Emotions Recognition network " \
+"(by default, it is 16)";
+
+/// @brief Message for the maximum number of simultaneously processed faces for Facial Landmarks network
+static const char num_batch_lm_message[] = "Optional. Number of maximum simultaneously processed faces for Facial Landmarks Estimation network " \
+"(by default, it is 16)";
+
 /// @brief Message for dynamic batching support for AgeGender net
 static const char dyn_batch_ag_message[] = "Optional. Enable dynamic batch size for Age/Gender Recognition network";
 
 /// @brief Message for dynamic batching support for HeadPose net
 static const char dyn_batch_hp_message[] = "Optional. Enable dynamic batch size for Head Pose Estimation network";
 
+/// @brief Messages for the CPU throughput streams of the networks
+static const char cpu_streams_message[] = "Optional. Number of CPU throughput streams for Face Detection network " \
+"(by default, the plugin decides)";
+static const char cpu_streams_ag_message[] = "Optional. Number of CPU throughput streams for Age/Gender Recognition network " \
+"(by default, the plugin decides)";
+static const char cpu_streams_hp_message[] = "Optional. Number of CPU throughput streams for Head Pose Estimation network " \
+"(by default, the plugin decides)";
+static const char cpu_streams_em_message[] = "Optional. Number of CPU throughput streams for Emotions Recognition network " \
+"(by default, the plugin decides)";
+static const char cpu_streams_lm_message[] = "Optional. Number of CPU throughput streams for Facial Landmarks Estimation network " \
+"(by default, the plugin decides)";
+
+/// @brief Messages for the CPU threads per stream of the networks
+static const char cpu_threads_message[] = "Optional. Number of CPU threads per stream for Face Detection network " \
+"(by default, the plugin decides)";
+static const char cpu_threads_ag_message[] = "Optional. Number of CPU threads per stream for Age/Gender Recognition network " \
+"(by default, the plugin decides)";
+static const char cpu_threads_hp_message[] = "Optional. Number of CPU threads per stream for Head Pose Estimation network " \
+"(by default, the plugin decides)";
+static const char cpu_threads_em_message[] = "Optional. Number of CPU threads per stream for Emotions Recognition network " \
+"(by default, the plugin decides)";
+static const char cpu_threads_lm_message[] = "Optional. Number of CPU threads per stream for Facial Landmarks Estimation network " \
+"(by default, the plugin decides)";
+
+/// @brief Messages for the CPU thread binding of the networks
+static const char cpu_bind_message[] = "Optional. CPU thread binding for Face Detection network: YES, NO or NUMA " \
+"(by default, the plugin decides)";
+static const char cpu_bind_ag_message[] = "Optional. CPU thread binding for Age/Gender Recognition network: YES, NO or NUMA " \
+"(by default, the plugin decides)";
+static const char cpu_bind_hp_message[] = "Optional. CPU thread binding for Head Pose Estimation network: YES, NO or NUMA " \
+"(by default, the plugin decides)";
+static const char cpu_bind_em_message[] = "Optional. CPU thread binding for Emotions Recognition network: YES, NO or NUMA " \
+"(by default, the plugin decides)";
+static const char cpu_bind_lm_message[] = "Optional. CPU thread binding for Facial Landmarks Estimation network: YES, NO or NUMA " \
+"(by default, the plugin decides)";
+
+/// @brief Message for splitting the CPU cores between the networks
+static const char cpu_auto_message[] = "Optional. Split the available CPU cores between the networks running on the CPU " \
+"in proportion to their measured cost. Overrides the other CPU options";
+
+/// @brief Message for the refresh interval of cached Age/Gender results
+static const char ag_refresh_message[] = "Optional. Number of frames between Age/Gender estimates of a tracked face " \
+"once they converged, 0 to estimate on every frame (by default, it is 30)";
+
+/// @brief Message for the Age/Gender convergence threshold
+static const char ag_age_stddev_message[] = "Optional. Standard deviation of the age estimates of a tracked face, in years, " \
+"below which its Age/Gender results are cached (by default, it is 3)";
+
+/// @brief Messages for the motion gating of face detection
+static const char motion_message[] = "Optional. Detect faces at full rate only while the scene changes or faces are tracked";
+static const char motion_idle_message[] = "Optional. Number of frames between face detections on a static scene " \
+"(by default, it is 15)";
+static const char motion_threshold_message[] = "Optional. Fraction of the pixels that must change for a frame to show motion " \
+"(by default, it is 0.01)";
+
+/// @brief Message for the NMS of the face detections
+static const char nms_message[] = "Optional. IoU above which the less confident of two face detections is dropped, " \
+"for detection models whose output is not suppressed (by default, it is 0, disabled)";
+
+/// @brief Messages for the tiled face detection
+static const char tiles_message[] = "Optional. Also detect faces on a grid of overlapping tiles of the frame, given as " \
+"<columns>x<rows>, to find faces too small for the network on the whole frame";
+static const char tile_overlap_message[] = "Optional. Fraction of a tile shared with its neighbour (by default, it is 0.2)";
+static const char tile_region_message[] = "Optional. Part of the frame covered by the tiles, given as <x>,<y>,<width>,<height> " \
+"in fractions of the frame size (by default, the whole frame)";
+
+/// @brief Messages for the recording and the replay of the inference results
+static const char record_message[] = "Optional. Record the faces found and their attributes to a file for a later replay";
+static const char replay_message[] = "Optional. Replay a recording through the tracking, demographics, ad selection and " \
+"InfluxDB output as fast as possible, with no input and no network";
+
+/// @brief Message for dynamic batching support for Emotions net
+static const char dyn_batch_em_message[] = "Optional. Enable dynamic batch size for Emotions Recognition network";
+
+/// @brief Message for dynamic batching support for Facial Landmarks net
+static const char dyn_batch_lm_message[] = "Optional. Enable dynamic batch size for Facial Landmarks Estimation network";
+
+/// @brief Message for disabling the gating of the emotions and landmarks stage
+static const char no_gate_message[] = "Optional. Run Emotions Recognition and Facial Landmarks Estimation on every face, " \
+"not only on the faces looking at the screen";
+
 /// @brief Message for performance counters
 static const char performance_counter_message[] = "Optional. Enable per-layer performance report";
 
@@ -83,6 +182,10 @@ static const char no_wait_for_keypress_message[] = "Optional. Do not wait for ke
 /// @brief Message do not show processed video
 static const char no_show_processed_video[] = "Optional. Do not show processed video.";
 
+/// @brief Message for the output of the processed video
+static const char sink_message[] = "Optional. Send the processed video to \"window\", a Motion JPEG file \"<path>.avi\" " \
+"or a shared memory frame ring \"shm:<name>\" instead of the window shown by default";
+
 /// @brief Message for asynchronous mode
 static const char async_message[] = "Optional. Enable asynchronous mode";
 
@@ -117,6 +220,14 @@ DEFINE_string(m_ag, "", age_gender_model_message);
 /// It is a optional parameter
 DEFINE_string(m_hp, "", head_pose_model_message);
 
+/// \brief Define parameter for Emotions Recognition model file<br>
+/// It is a optional parameter
+DEFINE_string(m_em, "", emotions_model_message);
+
+/// \brief Define parameter for Facial Landmarks Estimation model file<br>
+/// It is a optional parameter
+DEFINE_string(m_lm, "", facial_landmarks_model_message);
+
 /// \brief target device for Face Detection network<br>
 DEFINE_string(d, "CPU", target_device_message);
 
@@ -126,6 +237,12 @@ DEFINE_string(d_ag, "CPU", target_device_message_ag);
 /// \brief Define parameter for target device for Head Pose Estimation network<br>
 DEFINE_string(d_hp, "CPU", target_device_message_hp);
 
+/// \brief Define parameter for target device for Emotions Recognition network<br>
+DEFINE_string(d_em, "CPU", target_device_message_em);
+
+/// \brief Define parameter for target device for Facial Landmarks Estimation network<br>
+DEFINE_string(d_lm, "CPU", target_device_message_lm);
+
 /// \brief Define parameter for maximum batch size for Age/Gender Recognition network<br>
 DEFINE_uint32(n_ag, 16, num_batch_ag_message);
 
@@ -138,6 +255,69 @@ DEFINE_uint32(n_hp, 16, num_batch_hp_message);
 /// \brief Define parameter to enable dynamic batch size for Head Pose Estimation network<br>
 DEFINE_bool(dyn_hp, false, dyn_batch_hp_message);
 
+/// \brief Define parameter for the refresh interval of cached Age/Gender results<br>
+DEFINE_uint32(ag_refresh, 30, ag_refresh_message);
+
+/// \brief Define parameter for the Age/Gender convergence threshold<br>
+DEFINE_double(ag_age_stddev, 3.0, ag_age_stddev_message);
+
+/// \brief Define parameters for the motion gating of face detection<br>
+DEFINE_bool(motion, false, motion_message);
+DEFINE_uint32(motion_idle, 15, motion_idle_message);
+DEFINE_double(motion_threshold, 0.01, motion_threshold_message);
+
+/// \brief Define parameter for the NMS of the face detections<br>
+DEFINE_double(nms, 0.0, nms_message);
+
+/// \brief Define parameters for the tiled face detection<br>
+DEFINE_string(tiles, "", tiles_message);
+DEFINE_double(tile_overlap, 0.2, tile_overlap_message);
+DEFINE_string(tile_region, "", tile_region_message);
+
+/// \brief Define parameters for the recording and the replay of the inference results<br>
+DEFINE_string(record, "", record_message);
+DEFINE_string(replay, "", replay_message);
+
+/// \brief Define parameter for maximum batch size for Emotions Recognition network<br>
+DEFINE_uint32(n_em, 16, num_batch_em_message);
+
+/// \brief Define parameter to enable dynamic batch size for Emotions Recognition network<br>
+DEFINE_bool(dyn_em, false, dyn_batch_em_message);
+
+/// \brief Define parameter for maximum batch size for Facial Landmarks Estimation network<br>
+DEFINE_uint32(n_lm, 16, num_batch_lm_message);
+
+/// \brief Define parameter to enable dynamic batch size for Facial Landmarks Estimation network<br>
+DEFINE_bool(dyn_lm, false, dyn_batch_lm_message);
+
+/// \brief Define a flag to run emotions and landmarks on every face<br>
+/// It is an optional parameter
+DEFINE_bool(no_gate, false, no_gate_message);
+
+/// \brief Define parameters for the number of CPU throughput streams of the networks<br>
+DEFINE_uint32(nstreams, 0, cpu_streams_message);
+DEFINE_uint32(nstreams_ag, 0, cpu_streams_ag_message);
+DEFINE_uint32(nstreams_hp, 0, cpu_streams_hp_message);
+DEFINE_uint32(nstreams_em, 0, cpu_streams_em_message);
+DEFINE_uint32(nstreams_lm, 0, cpu_streams_lm_message);
+
+/// \brief Define parameters for the number of CPU threads per stream of the networks<br>
+DEFINE_uint32(nthreads, 0, cpu_threads_message);
+DEFINE_uint32(nthreads_ag, 0, cpu_threads_ag_message);
+DEFINE_uint32(nthreads_hp, 0, cpu_threads_hp_message);
+DEFINE_uint32(nthreads_em, 0, cpu_threads_em_message);
+DEFINE_uint32(nthreads_lm, 0, cpu_threads_lm_message);
+
+/// \brief Define parameters for the CPU thread binding of the networks<br>
+DEFINE_string(pin, "", cpu_bind_message);
+DEFINE_string(pin_ag, "", cpu_bind_ag_message);
+DEFINE_string(pin_hp, "", cpu_bind_hp_message);
+DEFINE_string(pin_em, "", cpu_bind_em_message);
+DEFINE_string(pin_lm, "", cpu_bind_lm_message);
+
+/// \brief Define a flag to split the CPU cores between the networks by their measured cost<br>
+DEFINE_bool(cpu_auto, false, cpu_auto_message);
+
 /// \brief Define parameter to enable per-layer performance report<br>
 DEFINE_bool(pc, false, performance_counter_message);
 
@@ -169,6 +349,10 @@ DEFINE_bool(no_wait, false, no_wait_for_keypress_message);
 /// It is an optional parameter
 DEFINE_bool(no_show, false, no_show_processed_video);
 
+/// \brief Define a parameter for the output of the processed video<br>
+/// It is an optional parameter
+DEFINE_string(sink, "", sink_message);
+
 /// \brief Define a flag to enable asynchronous execution<br>
 /// It is an optional parameter
 DEFINE_uint32(async, true, async_message);
@@ -204,19 +388,56 @@ static void showUsage() {
     std::cout << "    -m \"<path>\"                " << face_detection_model_message<< std::endl;
     std::cout << "    -m_ag \"<path>\"             " << age_gender_model_message << std::endl;
     std::cout << "    -m_hp \"<path>\"             " << head_pose_model_message << std::endl;
+    std::cout << "    -m_em \"<path>\"             " << emotions_model_message << std::endl;
+    std::cout << "    -m_lm \"<path>\"             " << facial_landmarks_model_message << std::endl;
     std::cout << "      -l \"<absolute_path>\"     " << custom_cpu_library_message << std::endl;
     std::cout << "          Or" << std::endl;
     std::cout << "      -c \"<absolute_path>\"     " << custom_cldnn_message << std::endl;
     std::cout << "    -d \"<device>\"              " << target_device_message << std::endl;
     std::cout << "    -d_ag \"<device>\"           " << target_device_message_ag << std::endl;
     std::cout << "    -d_hp \"<device>\"           " << target_device_message_hp << std::endl;
+    std::cout << "    -d_em \"<device>\"           " << target_device_message_em << std::endl;
+    std::cout << "    -d_lm \"<device>\"           " << target_device_message_lm << std::endl;
     std::cout << "    -n_ag \"<num>\"              " << num_batch_ag_message << std::endl;
     std::cout << "    -n_hp \"<num>\"              " << num_batch_hp_message << std::endl;
+    std::cout << "    -n_em \"<num>\"              " << num_batch_em_message << std::endl;
+    std::cout << "    -n_lm \"<num>\"              " << num_batch_lm_message << std::endl;
     std::cout << "    -dyn_ag                    " << dyn_batch_ag_message << std::endl;
     std::cout << "    -dyn_hp                    " << dyn_batch_hp_message << std::endl;
+    std::cout << "    -ag_refresh \"<num>\"        " << ag_refresh_message << std::endl;
+    std::cout << "    -ag_age_stddev \"<num>\"     " << ag_age_stddev_message << std::endl;
+    std::cout << "    -dyn_em                    " << dyn_batch_em_message << std::endl;
+    std::cout << "    -dyn_lm                    " << dyn_batch_lm_message << std::endl;
+    std::cout << "    -no_gate                   " << no_gate_message << std::endl;
+    std::cout << "    -motion                    " << motion_message << std::endl;
+    std::cout << "    -motion_idle \"<num>\"       " << motion_idle_message << std::endl;
+    std::cout << "    -motion_threshold \"<num>\"  " << motion_threshold_message << std::endl;
+    std::cout << "    -nms \"<num>\"               " << nms_message << std::endl;
+    std::cout << "    -tiles \"<cols>x<rows>\"     " << tiles_message << std::endl;
+    std::cout << "    -tile_overlap \"<num>\"      " << tile_overlap_message << std::endl;
+    std::cout << "    -tile_region \"<x,y,w,h>\"   " << tile_region_message << std::endl;
+    std::cout << "    -record \"<path>\"           " << record_message << std::endl;
+    std::cout << "    -replay \"<path>\"           " << replay_message << std::endl;
+    std::cout << "    -nstreams \"<num>\"          " << cpu_streams_message << std::endl;
+    std::cout << "    -nstreams_ag \"<num>\"       " << cpu_streams_ag_message << std::endl;
+    std::cout << "    -nstreams_hp \"<num>\"       " << cpu_streams_hp_message << std::endl;
+    std::cout << "    -nstreams_em \"<num>\"       " << cpu_streams_em_message << std::endl;
+    std::cout << "    -nstreams_lm \"<num>\"       " << cpu_streams_lm_message << std::endl;
+    std::cout << "    -nthreads \"<num>\"          " << cpu_threads_message << std::endl;
+    std::cout << "    -nthreads_ag \"<num>\"       " << cpu_threads_ag_message << std::endl;
+    std::cout << "    -nthreads_hp \"<num>\"       " << cpu_threads_hp_message << std::endl;
+    std::cout << "    -nthreads_em \"<num>\"       " << cpu_threads_em_message << std::endl;
+    std::cout << "    -nthreads_lm \"<num>\"       " << cpu_threads_lm_message << std::endl;
+    std::cout << "    -pin \"<mode>\"              " << cpu_bind_message << std::endl;
+    std::cout << "    -pin_ag \"<mode>\"           " << cpu_bind_ag_message << std::endl;
+    std::cout << "    -pin_hp \"<mode>\"           " << cpu_bind_hp_message << std::endl;
+    std::cout << "    -pin_em \"<mode>\"           " << cpu_bind_em_message << std::endl;
+    std::cout << "    -pin_lm \"<mode>\"           " << cpu_bind_lm_message << std::endl;
+    std::cout << "    -cpu_auto                  " << cpu_auto_message << std::endl;
     std::cout << "    -async                     " << async_message << std::endl;
     std::cout << "    -no_wait                   " << no_wait_for_keypress_message << std::endl;
     std::cout << "    -no_show                   " << no_show_processed_video << std::endl;
+    std::cout << "    -sink \"<sink>\"             " << sink_message << std::endl;
     std::cout << "    -pc                        " << performance_counter_message << std::endl;
     std::cout << "    -r                         " << raw_output_message << std::endl;
     std::cout << "    -t                         " << thresh_output_message << std::endl;
@@ -0,0 +1,70 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+# pragma once
+#include <cstdint>
+#include "vm/time_defs.h"
+#include "latency_histogram.h"
+
+// -------------------------Latency from a captured frame to the ad it influenced--------------------------------
+
+// All times are msdk_time_get_tick() ticks. The monotonic clock is shared with the ad playback process.
+struct FrameTrace {
+    uint64_t frameId;      // number of the frame in the input, starting at 1, 0 for none
+    msdk_tick captured;    // frame read from the camera, the capture device or the decoder
+    msdk_tick analysed;    // faces detected and their attributes inferred
+};
+
+// Sent to the playback process after the name of the ad
+struct AdTrace {
+    FrameTrace frame;      // latest frame analysed before the decision
+    msdk_tick aggregated;  // demographics averaged
+    msdk_tick decided;     // ad selected by getAd()
+    msdk_tick sent;        // request written to the pipe
+};
+
+// Frames of an ad rendered by the playback process
+struct AdPlayback {
+    msdk_tick firstRendered;  // 0 if no frame was rendered
+    msdk_tick lastRendered;
+    uint32_t frames;
+
+    // Rate the frames were rendered at, 0 with less than two frames
+    double fps() const;
+};
+
+// Returned by the playback process once the ad finished
+struct AdAck {
+    int status;            // 0 when the ad was played, 1 on error
+    AdTrace trace;
+    AdPlayback playback;
+};
+
+// Distributions of the end-to-end latency, from the capture of a frame to the first rendered frame of the ad it
+// influenced, and of every hop on the way
+class LatencyReport {
+public:
+    struct Hops {
+        double analysis;     // capture to analysed, inference
+        double aggregation;  // analysed to averaged into the demographics, mostly the wait for the playing ad
+        double decision;     // averaged to ad selected
+        double request;      // selected to written to the pipe
+        double playback;     // written to the first frame rendered, 0 if none was
+        double total;        // capture to the first frame rendered, or to the request if none was rendered
+    };
+
+    // Returns the latencies of the ad in milliseconds
+    Hops add(const AdAck &ack);
+    void print() const;
+    uint64_t count() const { return _total.GetCount(); }
+    const CLatencyHistogram &total() const { return _total; }
+
+private:
+    CLatencyHistogram _analysis;
+    CLatencyHistogram _aggregation;
+    CLatencyHistogram _decision;
+    CLatencyHistogram _request;
+    CLatencyHistogram _playback;
+    CLatencyHistogram _total;
+};
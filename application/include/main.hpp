@@ -23,8 +23,13 @@
 
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <vector>
 #include <opencv2/opencv.hpp>
 #include <signal.h>
+#include "motion_gate.hpp"
+#include "detection_record.hpp"
+#include "latency_trace.hpp"
 
 
 // Number of instances in json file. 
@@ -49,6 +54,11 @@
 #define ADULT 3
 #define SENIOR 4
 
+/*
+* Number of emotions told apart by Emotions Recognition: neutral, happy, sad, surprise and anger
+*/
+#define NO_OF_EMOTIONS 5
+
 /*
 * Structure to store demographics
 */
@@ -63,8 +73,26 @@ struct DemographicsStructure {
         int count;             /* Number of female in the frame */     
         int ageGroup[5];       /* array containing count of female falling in age range 1 to 4 stored in address from 1 to 4 */
     } female;
+    int emotions[NO_OF_EMOTIONS]; /* Number of people showing each emotion as the main one, in the order of getEmotionNames() */
+    int landmarksCount;        /* Number of people whose facial landmarks were estimated */
+};
+
+/*
+* Store the gender and age group based on which the ad will play
+*/
+struct playAdForData
+{
+    char gender;
+    unsigned int ageGroup;
 };
 
+// Macros defining which address in "pCount" variable contains what data
+// pCount variable contains the demographics data
+#define NO_OF_PEOPLE 0
+#define NO_OF_MALE 1
+#define NO_OF_FEMALE 2
+#define NO_OF_PEOPLE_INTERESTED 3
+
 /* 
 * Structure to store values from json file containing the list of ad 
 */
@@ -94,13 +122,22 @@ extern struct adsDataStructure adsData[TOTAL_JSON_INSTANCES];
 */
 bool parseJsonFile(std::string );
 
+/*
+* Ad selection from the demographics, defined in ad_selection.cpp. The replay runs them on the recorded frames
+*/
+std::string getAd(struct playAdForData genderAgeData);
+void getPeopleCount(float pCount[]);
+int getUniqueVisitorCount(int peopleCount);
+struct playAdForData getGenderAgeGroup(float pCount[]);
+
 /*
 * Load the model, which is in the form of Intermediate Representation, in the memory
 *
 * @param All command line arguments which contains path to IR model for face detection, age-gender detection, head pose estimation
+* @param true if frames will be passed to analysePeople() as NV12 planes, the face detector then takes NV12 input directly
 * @return 0 on success, 1 on failure
 */
-int loadModel(int argc, char* argv[]);
+int loadModel(int argc, char* argv[], bool nv12Input = false);
 
 /*
 * Detects faces, age, gender and head pose for each face and store the data in demographics variable every 5th frame
@@ -110,10 +147,96 @@ int loadModel(int argc, char* argv[]);
 */
 int analysePeople(cv::Mat frame);
 
+/*
+* Same as above for a decoded NV12 picture. The planes are used in place, only face crops and,
+* if the results are shown, the displayed frame are converted to BGR
+*
+* @param luma plane of type CV_8UC1
+* @param interleaved chroma plane of type CV_8UC2 with half the width and height of the luma plane and the same row step
+* @return 0 on success, 1 on failure
+*/
+int analysePeople(const cv::Mat& y, const cv::Mat& uv);
+
+/*
+* Same as above for a frame of a recording made with -record. The recorded faces and attributes
+* go through the tracking and demographics instead of the networks
+*
+* @param recorded frame
+* @param recorded faces of the frame
+* @return 0 on success, 1 on failure
+*/
+int replayPeople(const RecordedFrame& frame, const std::vector<RecordedFace>& faces);
+
+/*
+* Check whether the viewer asked to quit, with ESC in the window
+*
+* @return true if the analysis should stop
+*/
+bool quitRequested();
+
+/*
+* Wait for the inference in flight and close the recording and the output of the processed video
+*/
+void finishAnalysis();
+
+/*
+* Note in the recording that an ad finished playing, so that the replay selects the next ad at the same frame
+*/
+void markAdFinished();
+
+/*
+* Path of the recording given with -replay
+*
+* @return empty string if the inference results are not replayed
+*/
+std::string getReplayFile();
+
+/*
+* Number of frames (face detection) or faces each network was run on and skipped for, as the scene
+* was static, results were cached or the face was not looking at the screen
+*/
+struct InferenceCounters {
+    std::string network;
+    unsigned long inferred;
+    unsigned long skipped;
+    CLatencyHistogram latency;  // ms the analysis was blocked on the network per request
+};
+
+/*
+* Read the counters of the enabled networks since the models were loaded
+*
+* @return Counters of every enabled network
+*/
+std::vector<InferenceCounters> getInferenceCounters();
+
+/*
+* Read the statistics of the motion gating of face detection
+*
+* @param Statistics to fill
+* @return false if face detection is not gated by motion
+*/
+bool getMotionGateStats(MotionGate::Stats &stats);
+
+/*
+* Names of the emotions counted in DemographicsStructure::emotions
+*
+* @return empty if Emotions Recognition is not enabled
+*/
+std::vector<std::string> getEmotionNames();
+
+/*
+* Check whether Facial Landmarks Estimation is enabled
+*
+* @return true if DemographicsStructure::landmarksCount is counted
+*/
+bool isLandmarksEstimated();
+
 /*
 * Takes the h265 input video, decodes it using hevc plugin and renders it
 *
 * @param h265 video file name
+* @param set to the frames rendered and their times if not NULL
+* @param seconds between the periodic reports of the decoding latency, 0 - no latency reports
 * @return 0 on success, 1 on failure
 */
-int media_sdk(const char*);
+int media_sdk(const char*, AdPlayback* playback = NULL, mfxU32 latencyPeriod = 0);
@@ -0,0 +1,59 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+# pragma once
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include "latency_histogram.h"
+
+class MSDKThread;
+
+// -------------------------Metrics for a Prometheus scraper----------------------------------------------------
+
+// Builds a page in the Prometheus text exposition format. Every family is declared once with family(),
+// before its samples.
+class PrometheusText {
+public:
+    typedef std::map<std::string, std::string> Labels;
+
+    // type - counter, gauge or summary
+    void family(const std::string &name, const std::string &type, const std::string &help);
+    void sample(const std::string &name, double value, const Labels &labels = Labels());
+    // The 0.5, 0.9 and 0.99 quantiles, sum and count of a histogram of milliseconds, in seconds
+    void summary(const std::string &name, const CLatencyHistogram &histogram, const Labels &labels = Labels());
+
+    std::string str() const { return _text.str(); }
+
+private:
+    void write(const std::string &name, const Labels &labels, double value);
+
+    std::ostringstream _text;
+};
+
+// Serves the latest published page at GET /metrics on 127.0.0.1. A thread of its own answers the requests,
+// the page is replaced by the thread collecting the metrics, so a scrape never waits for the pipeline.
+class MetricsServer {
+public:
+    MetricsServer();
+    ~MetricsServer();
+
+    bool start(int port);
+    void stop();
+    void publish(const std::string &page);
+
+private:
+    static unsigned int MFX_STDCALL serveThreadFunc(void *ctx);
+    void serve();
+    void answer(int client);
+
+    int _socket;
+    std::atomic<bool> _stop;
+    std::unique_ptr<MSDKThread> _thread;
+    std::mutex _mutex;
+    std::string _page;
+};
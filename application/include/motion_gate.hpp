@@ -0,0 +1,54 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+# pragma once
+#include <chrono>
+#include <opencv2/opencv.hpp>
+
+// -------------------------Decide on which frames faces are detected----------------------------------------
+
+// Compares a downscaled luma frame with a running average of the scene. Face detection runs on every frame
+// while the scene changes or faces are tracked, and only once per idle interval while it is static.
+// Motion on a frame lets detection run on that same frame.
+class MotionGate {
+public:
+    struct Stats {
+        size_t frames;            // frames seen
+        size_t skipped;           // frames face detection was skipped on
+        size_t wakeups;           // changes from a static scene to motion
+        double totalWakeLatency;  // ms from the arrival of a waking frame to the end of detection on it
+        double maxWakeLatency;
+    };
+
+    // idleInterval - frames between detections on a static scene, 1 to detect on every frame
+    // changedFraction - fraction of the pixels that must change for the frame to show motion
+    // pixelThreshold - luma difference from the background above which a pixel has changed
+    // holdFrames - frames detection stays at full rate after the last motion
+    MotionGate(size_t idleInterval, float changedFraction, int pixelThreshold = 12, size_t holdFrames = 30);
+
+    // Returns true if faces should be detected on the frame
+    bool update(const cv::Mat& luma, bool hasTracks);
+    // Called when the detection let through by update() has finished
+    void detectionDone();
+
+    const Stats& stats() const;
+
+    // Size of the luma frame passed to update() for a frame of the given size
+    static cv::Size lumaSize(int cols, int rows);
+
+private:
+    typedef std::chrono::high_resolution_clock Clock;
+
+    cv::Mat _background;
+    size_t _idleInterval;
+    float _changedFraction;
+    int _pixelThreshold;
+    size_t _holdFrames;
+    size_t _framesSinceMotion;
+    size_t _framesSinceDetection;
+    bool _wasActive;
+    bool _wakePending;
+    Clock::time_point _frameArrival;
+    Stats _stats;
+};
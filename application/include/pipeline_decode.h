@@ -32,6 +32,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include "hw_device.h"
 #include "decode_render.h"
 #include "mfx_buffering.h"
+#include "presentation_scheduler.h"
+#include "latency_histogram.h"
 #include <memory>
 
 #include "sample_utils.h"
@@ -71,17 +73,33 @@ enum eDecoderPostProc {
 };
 #endif //MFX_VERSION >= 1022
 
+/** \brief Consumer of decoded surfaces.
+ *
+ * In MODE_PERFORMANCE the pipeline hands every synced surface to the sink
+ * instead of dropping it. The surface is locked for the duration of the call
+ * and goes back to the decoder as soon as the call returns, so the sink must
+ * not keep pointers to the frame data.
+ */
+class IDecodedFrameSink
+{
+public:
+    virtual ~IDecodedFrameSink() {}
+    virtual mfxStatus OnFrame(mfxFrameSurface1* frame) = 0;
+};
+
 struct sInputParams
 {
     mfxU32 videoType;
     eWorkMode mode;
     MemType memType;
     bool    bUseHWLib; // true if application wants to use HW mfx library
+    bool    bUseSurfaceArena; // system memory surfaces are kept mapped and reused by the next pipeline
     bool    bIsMVC; // true if Multi-View Codec is in use
     bool    bLowLat; // low latency mode
     bool    bCalLat; // latency calculation
+    mfxU32  nLatencyPeriod; // seconds between periodic latency reports, 0 - report at the end only
     bool    bUseFullColorRange; //whether to use full color range
-    mfxU16  nMaxFPS; //rendering limited by certain fps
+    mfxU16  nMaxFPS; //rendering paced at certain fps, 0 - at the stream frame rate, stream timestamps are followed if present
     mfxU32  nWallCell;
     mfxU32  nWallW; //number of windows located in each row
     mfxU32  nWallH; //number of windows located in each column
@@ -126,6 +144,8 @@ struct sInputParams
     msdk_char     strDstFile[MSDK_MAX_FILENAME_LEN];
     sPluginParams pluginParams;
 
+    IDecodedFrameSink* pFrameSink; // receives decoded surfaces in performance mode, optional
+
     sInputParams()
     {
         MSDK_ZERO_MEMORY(*this);
@@ -183,6 +203,13 @@ public:
     void SetExtBuffersFlag()       { m_bIsExtBuffers = true; }
     virtual void PrintInfo();
     mfxU64 GetTotalBytesProcessed() { return totalBytesProcessed + m_mfxBS.DataOffset; }
+    const CLatencyHistogram& GetLatencyHistogram() const { return m_latencyHistogram; }
+    /** \brief Returns the time the first frame was rendered, 0 if none was. */
+    msdk_tick GetFirstRenderTick() const { return m_firstRenderTick; }
+    /** \brief Returns the time the last frame was rendered, 0 if none was. */
+    msdk_tick GetLastRenderTick() const { return m_lastRenderTick; }
+    /** \brief Returns the number of frames rendered. */
+    mfxU32 GetRenderedFrames() const { return m_renderedFrames; }
 
 #if (MFX_VERSION >= 1025)
     inline void PrintDecodeErrorReport(mfxExtDecodeErrorReport *pDecodeErrorReport)
@@ -208,6 +235,8 @@ public:
 protected: // functions
     virtual mfxStatus CreateRenderingWindow(sInputParams *pParams);
     virtual mfxStatus InitMfxParams(sInputParams *pParams);
+    // paces rendering at the fps limit, or at the frame rate of the stream if there is no limit
+    virtual void InitPresentationScheduler();
 
     // function for allocating a specific external buffer
     template <typename Buffer>
@@ -294,6 +323,8 @@ protected: // variables
     mfxU32                  m_fourcc; // color format of vpp out, i420 by default
     bool                    m_bPrintLatency;
     bool                    m_bOutI420;
+    bool                    m_bUseSurfaceArena;
+    IDecodedFrameSink*      m_pFrameSink;
 
     mfxU16                  m_vppOutWidth;
     mfxU16                  m_vppOutHeight;
@@ -305,10 +336,15 @@ protected: // variables
     mfxU16                  m_diMode;
     bool                    m_bVppIsUsed;
     bool                    m_bVppFullColorRange;
-    std::vector<msdk_tick>  m_vLatency;
-
-    msdk_tick               m_startTick;
-    msdk_tick               m_delayTicks;
+    CLatencyHistogram       m_latencyHistogram; // whole run
+    CLatencyHistogram       m_latencyPeriodHistogram; // since the last periodic report
+    msdk_tick               m_latencyPeriod;
+    msdk_tick               m_latencyReportTick;
+
+    CPresentationScheduler  m_presentationScheduler; // paces rendering
+    msdk_tick               m_firstRenderTick;       // time the first frame was rendered, 0 before
+    msdk_tick               m_lastRenderTick;
+    mfxU32                  m_renderedFrames;
 
     mfxExtVPPDoNotUse       m_VppDoNotUse;      // for disabling VPP algorithms
     mfxExtVPPDeinterlacing  m_VppDeinterlacing;
@@ -0,0 +1,32 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+# pragma once
+#include <utility>
+#include <vector>
+#include <inference_engine.hpp>
+#include <opencv2/opencv.hpp>
+
+// -------------------------Preparing the network inputs--------------------------------------------------------
+
+// Resizes a BGR image to the spatial size of an U8 NCHW blob, bilinearly as cv::resize with INTER_LINEAR does,
+// and writes the planes straight into the blob memory of the image at batchIndex. It replaces matU8ToBlob,
+// which resizes into a temporary image and copies it pixel by pixel. With parallel the rows are split over
+// the OpenCV threads, which pays off for the whole frame but not for a face.
+void resizeToBlob(const cv::Mat &image, const InferenceEngine::Blob::Ptr &blob, size_t batchIndex = 0,
+                  bool parallel = false);
+
+// A face prepared once for the face analytics networks. It is extracted into a scratch tile no larger than the
+// largest of their inputs, and every input is filled from the tile. An input of the same size as one filled
+// before is copied from it rather than resized again, so the blobs filled must stay untouched meanwhile.
+class FaceCrop {
+public:
+    bool empty() const { return _tile.empty(); }
+    void extract(const cv::Mat &face, const cv::Size &tileSize);
+    void fill(const InferenceEngine::Blob::Ptr &blob, size_t batchIndex);
+
+private:
+    cv::Mat _tile;
+    std::vector<std::pair<cv::Size, const uint8_t *>> _filled;  // images written to the blobs, by size
+};
@@ -0,0 +1,33 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+# pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// -------------------------Bilinear resize of BGR images into planes-------------------------------------------
+
+// The two source taps and the weight of the second one for every output coordinate, with the pixel
+// centres aligned and the taps clamped to the image like cv::resize does
+struct ResizeTaps {
+    std::vector<int> first;
+    std::vector<int> second;
+    std::vector<float> weight;
+
+    // stride - distance between neighbouring source taps, 3 for the columns of a BGR row and 1 for rows
+    ResizeTaps(int srcSize, int dstSize, int stride);
+};
+
+// Blends two interpolated rows vertically and stores the result as bytes, eight pixels at a time with SSE2.
+// The values are rounded half up, by the vector and the scalar loop alike.
+void blendRow(const float *top, const float *bottom, float weight, uint8_t *dst, int width);
+
+// The scalar loop alone, the reference of blendRow
+void blendRowScalar(const float *top, const float *bottom, float weight, uint8_t *dst, int width);
+
+// Writes the output rows [begin, end) of the three planes of width x height bytes, resized from
+// a BGR image whose rows are srcStep bytes apart. The rows may be split over threads.
+void resizeBgrRows(const uint8_t *src, size_t srcStep, const ResizeTaps &columns, const ResizeTaps &rows,
+                   uint8_t *planes, int width, int height, int begin, int end);
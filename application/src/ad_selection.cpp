@@ -0,0 +1,190 @@
+/*
+* Copyright (c) 2018 Intel Corporation.
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+* LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+* OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+* WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cmath>
+
+#include "main.hpp"
+
+/*
+* Select the Advertisement to be played
+*
+* @param Structure containing gender and age group based on which ad has to be selected
+* @return Advertisement name on success, "NULL" in case of failure
+*/
+std::string getAd(struct playAdForData genderAgeData)
+{ 
+    // To avoid Advertisement repetition
+    static unsigned int AdIndex[TOTAL_JSON_INSTANCES] = {0};
+
+    // Iterate through the data in variable adsData
+    for (int instance = 0; instance < TOTAL_JSON_INSTANCES; instance++)
+    {
+        if ((adsData[instance].ageGroup == genderAgeData.ageGroup) && (adsData[instance].gender == genderAgeData.gender))
+        {
+            if (AdIndex[instance] >= adsData[instance].Ads.size())
+                AdIndex[instance] = 1;
+            else
+                AdIndex[instance]++;
+            return adsData[instance].Ads[AdIndex[instance] - 1];
+        }
+    }
+    return "NULL";
+}
+
+
+
+/*
+* Find the total number of people, number of male, number of female.
+* It gets the data from  circular array "demographics" defined in main.hpp and find the mean of the respective data to get the demographics
+*
+* @param Float array of size 4, which will be updated with the demographics data
+*/
+void getPeopleCount(float pCount[])
+{
+    pCount[NO_OF_PEOPLE] = 0.0f;
+    pCount[NO_OF_MALE] = 0.0f;
+    pCount[NO_OF_FEMALE] = 0.0f;
+    pCount[NO_OF_PEOPLE_INTERESTED] = 0.0f;
+    float femaleCount =0.0f;
+    float maleCount = 0.0f;
+    float totalCount = 0.0f;
+
+    // Find the sum of the total people, number of the male, female and people interested in the ad count 
+    for (int i = 0; i < 5; i++)
+    {
+        pCount[NO_OF_PEOPLE] = pCount[NO_OF_PEOPLE] + demographics[i].peopleCount;
+        pCount[NO_OF_MALE] = pCount[NO_OF_MALE] + demographics[i].male.count;
+        pCount[NO_OF_FEMALE] = pCount[NO_OF_FEMALE] + demographics[i].female.count;
+        pCount[NO_OF_PEOPLE_INTERESTED] = pCount[NO_OF_PEOPLE_INTERESTED] + demographics[i].interestedCount;
+    }
+
+    // Find the mean to remove to the inconsistency in the data if any
+    totalCount = pCount[NO_OF_PEOPLE]/5;
+    maleCount = pCount[NO_OF_MALE]/5;
+    femaleCount = pCount[NO_OF_FEMALE]/5;
+
+    pCount[NO_OF_PEOPLE] = floor(totalCount + 0.5);
+    pCount[NO_OF_MALE] = floor(maleCount + 0.5);
+    pCount[NO_OF_FEMALE] = floor(femaleCount  + 0.5);
+    pCount[NO_OF_PEOPLE_INTERESTED] = floor(pCount[NO_OF_PEOPLE_INTERESTED]/5 + 0.5);
+
+    // Remove the error in the mismatch of total number of people and sum of male and female, if any
+    if(pCount[NO_OF_PEOPLE] < pCount[NO_OF_MALE] + pCount[NO_OF_FEMALE])
+    {
+        pCount[NO_OF_PEOPLE] = ceil(totalCount);
+    }
+    else
+    if(pCount[NO_OF_PEOPLE] > pCount[NO_OF_MALE] + pCount[NO_OF_FEMALE])
+    {
+        if( femaleCount > maleCount)
+            pCount[NO_OF_FEMALE] = ceil(femaleCount);
+        else
+            pCount[NO_OF_MALE] = ceil(maleCount);
+    }
+   
+}
+
+
+
+/*
+* Find the unique count of people who visited kiosk
+*
+* @param Number of people currently in front of digital signage
+* @return Count of unique visitors
+*/
+int getUniqueVisitorCount(int peopleCount)
+{
+    static int previousPeopleCount = 0;
+    static int uniqueCount = 0;
+    if(previousPeopleCount == 0 )
+    {
+        uniqueCount = peopleCount + uniqueCount; 
+    }
+    else if(previousPeopleCount < peopleCount)
+    {
+        uniqueCount = uniqueCount + peopleCount - previousPeopleCount;
+    }
+    previousPeopleCount = peopleCount;
+    return uniqueCount;
+}
+
+
+
+/*
+* Find the dominant age among the dominant gender
+*
+* @param Array of type float containing the demographics data
+* @return Structure containing age and gender for which the ad has to be played
+*/
+struct playAdForData getGenderAgeGroup(float pCount[])
+{
+    struct playAdForData data;
+    char gender;
+    int ageGroup, maxAgeGroup, max;
+    float meanAge[5] = {0};
+
+    // Check people of which gender is more in number
+    if (pCount[NO_OF_MALE] > pCount[NO_OF_FEMALE])
+    {
+        gender = 'M';
+        for (int i = 0; i < 5; i++)
+        {
+            for (int ageGroup = 1; ageGroup < 5; ageGroup++)
+            {
+               meanAge[ageGroup] = meanAge[ageGroup] + demographics[i].male.ageGroup[ageGroup];
+            }
+        }
+    }
+    else
+    {
+        gender = 'F';
+        for (int i = 0; i < 5; i++)
+        {
+            for (int ageGroup = 1; ageGroup < 5; ageGroup++)
+            {
+                meanAge[ageGroup] = meanAge[ageGroup] + demographics[i].female.ageGroup[ageGroup];
+            }
+        }
+    }
+
+    // Find the mean of the number of people on different ageGroup of the dominant gender
+    for (int ageGroup = 1; ageGroup < 5; ageGroup++)
+    {
+        meanAge[ageGroup] = meanAge[ageGroup] / 5;
+    }
+
+    max = meanAge[1], maxAgeGroup = 1;
+
+    // Find the dominant age group (Age group having maximum number of people)
+    for (int ageGroup = 1; ageGroup < 5; ageGroup++)
+    {
+        if (max < meanAge[ageGroup])
+        {
+            maxAgeGroup = ageGroup;
+            max = meanAge[ageGroup];
+        }
+    }    
+    data.gender = gender;
+    data.ageGroup = maxAgeGroup;
+    return data;
+}
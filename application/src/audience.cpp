@@ -0,0 +1,224 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "main.hpp"
+#include "audience.hpp"
+
+struct DemographicsStructure demographics[5];
+
+static AudienceOptions options = {true, {5, 3.f, 1.f, 30}, false, false};
+static int frameCount = 0, dataCount = 0;
+static std::list<Face::Ptr> faces;
+
+// Function to find the age Group in which the age of the person lies
+static int GetAgeGroup(int age)
+{
+    int ageGrp = 0;
+    if(age > 0 && age < 14)
+        ageGrp = CHILD;
+    else
+    if(age >= 14 && age < 29)
+        ageGrp = YOUNG_ADULT;
+    else
+    if(age >=29 && age < 50)
+        ageGrp = ADULT;
+    else
+    if(age >= 50 )
+        ageGrp = SENIOR;
+
+    return ageGrp;
+}
+
+void setAudienceOptions(const AudienceOptions &value) {
+    options = value;
+}
+
+const AudienceOptions &getAudienceOptions() {
+    return options;
+}
+
+void resetAudience() {
+    frameCount = 0;
+    dataCount = 0;
+    faces.clear();
+    for (auto &frame : demographics) {
+        frame = {0};
+    }
+}
+
+bool isLookingAtScreen(const HeadPoseDetection::Results &headPose) {
+    return headPose.angle_y > -30 && headPose.angle_y < 30;
+}
+
+void beginDemographics() {
+    if(dataCount == 5 && frameCount % 5 == 0)
+        dataCount = 0;
+
+    if(frameCount % 5 == 0)
+    {
+        demographics[dataCount] = {0};
+    }
+}
+
+void endDemographics(size_t peopleCount) {
+    if(frameCount % 5 == 0)
+    {
+        demographics[dataCount].peopleCount = peopleCount;
+        dataCount++;
+    }
+    frameCount++;
+}
+
+std::vector<Face::Ptr> trackFaces(const std::vector<cv::Rect> &rects, const std::vector<float> &intensities) {
+    std::list<Face::Ptr> prev_faces;
+
+    if (options.smooth) {
+        prev_faces.insert(prev_faces.begin(), faces.begin(), faces.end());
+    }
+
+    faces.clear();
+
+    size_t id = 0;
+    std::vector<Face::Ptr> tracked_faces;
+    for (size_t i = 0; i < rects.size(); i++) {
+        cv::Rect rect = rects[i];
+
+        Face::Ptr face;
+        if (options.smooth) {
+            face = matchFace(rect, prev_faces);
+            float intensity_mean = intensities[i];
+
+            if ((face == nullptr) ||
+                ((face != nullptr) && ((std::abs(intensity_mean - face->_intensity_mean) / face->_intensity_mean)
+                 > 0.07f))) {
+                face = std::make_shared<Face>(id++, rect);
+            } else {
+                prev_faces.remove(face);
+            }
+
+            face->_intensity_mean = intensity_mean;
+            face->_location = rect;
+        } else {
+            face = std::make_shared<Face>(id++, rect);
+        }
+        tracked_faces.push_back(face);
+    }
+    return tracked_faces;
+}
+
+void updateFace(const Face::Ptr &face, const RecordedFace &results) {
+    if (results.flags & RECORDED_AGE_GENDER) {
+        face->updateGender(results.maleProb);
+        face->updateAge(results.age);
+    }
+    face->ageGenderEnable(face->hasAgeGender());
+
+    face->headPoseEnable((results.flags & RECORDED_HEAD_POSE) != 0);
+    if (face->isHeadPoseEnabled()) {
+        face->updateHeadPose({results.roll, results.pitch, results.yaw});
+    }
+
+    // A face without results keeps the emotions smoothed over the frames it was looking at the screen
+    if (results.flags & RECORDED_EMOTIONS) {
+        std::map<std::string, float> emotions;
+        for (size_t i = 0; i < EmotionsDetection::emotionsVec.size(); ++i) {
+            emotions[EmotionsDetection::emotionsVec[i]] = results.emotions[i];
+        }
+        face->updateEmotions(emotions);
+    }
+    face->emotionsEnable(options.emotions && !face->getEmotions().empty());
+
+    face->landmarksEnable((results.flags & RECORDED_LANDMARKS) != 0);
+}
+
+void addFace(const Face::Ptr &face) {
+    if (face->isAgeGenderEnabled()) {
+        if(frameCount % 5 == 0) {
+            int ageRange = GetAgeGroup(face->getAge());
+            if (face->isMale()) {
+                demographics[dataCount].male.count++;
+                demographics[dataCount].male.ageGroup[ageRange]++;
+            } else {
+                demographics[dataCount].female.count++;
+                demographics[dataCount].female.ageGroup[ageRange]++;
+            }
+        }
+    }
+
+    if (frameCount % 5 == 0) {
+        if (face->isEmotionsEnabled()) {
+            const std::vector<std::string> &emotions = EmotionsDetection::emotionsVec;
+            size_t emotion = std::find(emotions.begin(), emotions.end(), face->getMainEmotion().first) - emotions.begin();
+            if (emotion < NO_OF_EMOTIONS) {
+                demographics[dataCount].emotions[emotion]++;
+            }
+        }
+        if (face->isLandmarksEnabled()) {
+            demographics[dataCount].landmarksCount++;
+        }
+        // Counted on the sampled frames only, the others would count into the slot the next sample clears
+        if (face->isHeadPoseEnabled() && isLookingAtScreen(face->getHeadPose())) {
+            demographics[dataCount].interestedCount++;
+        }
+    }
+    faces.push_back(face);
+}
+
+const std::list<Face::Ptr> &trackedFaces() {
+    return faces;
+}
+
+uint16_t recordedNetworks() {
+    return static_cast<uint16_t>((options.emotions ? RECORDED_EMOTIONS_ENABLED : 0) |
+                                 (options.landmarks ? RECORDED_LANDMARKS_ENABLED : 0));
+}
+
+std::vector<std::string> getEmotionNames() {
+    if (!options.emotions) {
+        return {};
+    }
+    return EmotionsDetection::emotionsVec;
+}
+
+bool isLandmarksEstimated() {
+    return options.landmarks;
+}
+
+// The recorded faces go through the same tracking, attribute caching and demographics as the detected ones.
+// The cache policy decides again which recorded Age/Gender estimates are used, so a recording made with
+// -ag_refresh 0 can be replayed with any policy.
+int replayPeople(const RecordedFrame &frame, const std::vector<RecordedFace> &recorded) {
+    options.emotions = (frame.flags & RECORDED_EMOTIONS_ENABLED) != 0;
+    options.landmarks = (frame.flags & RECORDED_LANDMARKS_ENABLED) != 0;
+    beginDemographics();
+
+    std::vector<cv::Rect> rects;
+    std::vector<float> intensities;
+    for (auto &&face : recorded) {
+        // The record is packed, its fields are copied rather than bound to the references of emplace_back
+        // and push_back, which could be misaligned
+        rects.emplace_back(int(face.x), int(face.y), int(face.width), int(face.height));
+        const float intensity = face.intensity;
+        intensities.push_back(intensity);
+    }
+    std::vector<Face::Ptr> tracked_faces = trackFaces(rects, intensities);
+
+    for (size_t i = 0; i < recorded.size(); i++) {
+        Face::Ptr face = tracked_faces[i];
+        RecordedFace results = recorded[i];
+        if (!face->isAgeGenderStale(options.ageGender)) {
+            face->skipAgeGender();
+            results.flags &= ~RECORDED_AGE_GENDER;
+        }
+        updateFace(face, results);
+        addFace(face);
+    }
+
+    endDemographics(recorded.size());
+    return 0;
+}
@@ -0,0 +1,521 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "capture_source.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+#define CAPTURE_POLL_TIMEOUT 100 // ms, how often the capture thread checks for stop
+
+CCaptureSource::CCaptureSource()
+    : m_bStop(false)
+    , m_dropped(0)
+    , m_status(MFX_ERR_NONE)
+    , m_bFinished(false)
+{
+}
+
+CCaptureSource::~CCaptureSource()
+{
+    Stop();
+}
+
+void CCaptureSource::Close()
+{
+    Stop();
+    m_frames.clear();
+}
+
+mfxStatus CCaptureSource::Start()
+{
+    mfxStatus sts = MFX_ERR_NONE;
+
+    // one slot per buffer plus the end of stream marker, so Push() never fails
+    sts = m_ready.Init((mfxU32)m_frames.size() + 1);
+    MSDK_CHECK_STATUS(sts, "m_ready.Init failed");
+    m_pReady.reset(new MSDKSemaphore(sts, 0));
+    MSDK_CHECK_STATUS(sts, "MSDKSemaphore creation failed");
+
+    m_bStop = false;
+    m_bFinished = false;
+    m_status = MFX_ERR_NONE;
+    m_dropped = 0;
+    m_pThread.reset(new MSDKThread(sts, CaptureThreadFunc, this, "capture"));
+    MSDK_CHECK_STATUS(sts, "MSDKThread creation failed");
+
+    return MFX_ERR_NONE;
+}
+
+void CCaptureSource::Stop()
+{
+    if (m_pThread.get())
+    {
+        m_bStop = true;
+        Interrupt();
+        m_pThread->Wait();
+        m_pThread.reset();
+    }
+    m_pReady.reset();
+}
+
+mfxStatus CCaptureSource::GetFrame(sCaptureFrame& frame)
+{
+    if (m_bFinished)
+        return m_status;
+    if (!m_pThread.get())
+        return MFX_ERR_NOT_INITIALIZED;
+
+    mfxU32 index = END_OF_STREAM;
+    {
+        MFX_ITT_TASK("WaitCapturedFrame");
+        m_pReady->Wait();
+    }
+    m_ready.Pop(index);
+
+    if (END_OF_STREAM == index)
+    {
+        m_bFinished = true;
+        return m_status;
+    }
+
+    frame = m_frames[index];
+    return MFX_ERR_NONE;
+}
+
+void CCaptureSource::ReleaseFrame(const sCaptureFrame& frame)
+{
+    if (frame.index < m_frames.size())
+        ReturnBuffer(frame.index);
+}
+
+void CCaptureSource::CaptureLoop()
+{
+    mfxStatus sts = MFX_ERR_NONE;
+
+    while (!m_bStop)
+    {
+        mfxU32 index = 0;
+        {
+            MFX_ITT_TASK("CaptureBuffer");
+            sts = CaptureBuffer(index);
+        }
+        if (MFX_ERR_NONE != sts)
+            break;
+
+        m_frames[index].timestamp = msdk_time_get_tick();
+        m_ready.Push(index);
+        m_pReady->Post();
+    }
+
+    // a requested stop looks like the end of stream to the consumer
+    m_status = (m_bStop || MFX_ERR_ABORTED == sts) ? MFX_ERR_MORE_DATA : sts;
+    m_ready.Push(END_OF_STREAM);
+    m_pReady->Post();
+}
+
+unsigned int MFX_STDCALL CCaptureSource::CaptureThreadFunc(void* ctx)
+{
+    CCaptureSource* source = (CCaptureSource*)ctx;
+
+    source->CaptureLoop();
+
+    return 0;
+}
+
+static int xioctl(int fd, unsigned long request, void* arg)
+{
+    int ret;
+    do
+    {
+        ret = ioctl(fd, request, arg);
+    } while (-1 == ret && EINTR == errno);
+    return ret;
+}
+
+CV4L2CaptureSource::CV4L2CaptureSource()
+    : m_fd(-1)
+    , m_bStreaming(false)
+    , m_bSequenceValid(false)
+    , m_lastSequence(0)
+{
+}
+
+CV4L2CaptureSource::~CV4L2CaptureSource()
+{
+    Close();
+}
+
+mfxStatus CV4L2CaptureSource::Open(const sCaptureParams& params)
+{
+    Close();
+
+    mfxU32 pixelformat = 0;
+    switch (params.fourcc)
+    {
+    case MFX_FOURCC_NV12: pixelformat = V4L2_PIX_FMT_NV12; break;
+    case MFX_FOURCC_YUY2: pixelformat = V4L2_PIX_FMT_YUYV; break;
+    default:
+        msdk_printf(MSDK_STRING("error: unsupported capture format\n"));
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    m_fd = open(params.device.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        msdk_printf(MSDK_STRING("error: failed to open %s: %s\n"), params.device.c_str(), strerror(errno));
+        return MFX_ERR_NOT_FOUND;
+    }
+
+    struct v4l2_capability caps;
+    MSDK_ZERO_MEMORY(caps);
+    if (xioctl(m_fd, VIDIOC_QUERYCAP, &caps) < 0 ||
+        !(caps.capabilities & V4L2_CAP_VIDEO_CAPTURE) || !(caps.capabilities & V4L2_CAP_STREAMING))
+    {
+        msdk_printf(MSDK_STRING("error: %s is not a streaming capture device\n"), params.device.c_str());
+        Close();
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    struct v4l2_format fmt;
+    MSDK_ZERO_MEMORY(fmt);
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = params.width;
+    fmt.fmt.pix.height = params.height;
+    fmt.fmt.pix.pixelformat = pixelformat;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (xioctl(m_fd, VIDIOC_S_FMT, &fmt) < 0 || fmt.fmt.pix.pixelformat != pixelformat)
+    {
+        msdk_printf(MSDK_STRING("error: %s does not support the requested format\n"), params.device.c_str());
+        Close();
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    struct v4l2_requestbuffers rqbufs;
+    MSDK_ZERO_MEMORY(rqbufs);
+    rqbufs.count = params.numBuffers;
+    rqbufs.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    rqbufs.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(m_fd, VIDIOC_REQBUFS, &rqbufs) < 0 || rqbufs.count < 2)
+    {
+        msdk_printf(MSDK_STRING("error: VIDIOC_REQBUFS failed: %s\n"), strerror(errno));
+        Close();
+        return MFX_ERR_MEMORY_ALLOC;
+    }
+
+    sCaptureFrame unmapped;
+    MSDK_ZERO_MEMORY(unmapped);
+    unmapped.dmabufFd = -1;
+    m_frames.assign(rqbufs.count, unmapped);
+    m_lengths.assign(rqbufs.count, 0);
+    for (mfxU32 i = 0; i < rqbufs.count; i++)
+    {
+        struct v4l2_buffer buf;
+        MSDK_ZERO_MEMORY(buf);
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (xioctl(m_fd, VIDIOC_QUERYBUF, &buf) < 0)
+        {
+            Close();
+            return MFX_ERR_MEMORY_ALLOC;
+        }
+
+        sCaptureFrame& frame = m_frames[i];
+        MSDK_ZERO_MEMORY(frame);
+        frame.index = i;
+        frame.fourcc = params.fourcc;
+        frame.width = (mfxU16)fmt.fmt.pix.width;
+        frame.height = (mfxU16)fmt.fmt.pix.height;
+        frame.pitch = fmt.fmt.pix.bytesperline;
+        frame.dmabufFd = -1;
+
+        void* data = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, buf.m.offset);
+        if (MAP_FAILED == data)
+        {
+            Close();
+            return MFX_ERR_MEMORY_ALLOC;
+        }
+        frame.data = (mfxU8*)data;
+        m_lengths[i] = buf.length;
+
+        // optional, lets other devices import the buffer without a copy
+        struct v4l2_exportbuffer expbuf;
+        MSDK_ZERO_MEMORY(expbuf);
+        expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        expbuf.index = i;
+        expbuf.flags = O_RDONLY | O_CLOEXEC;
+        if (0 == xioctl(m_fd, VIDIOC_EXPBUF, &expbuf))
+            frame.dmabufFd = expbuf.fd;
+
+        mfxStatus sts = QueueBuffer(i);
+        if (MFX_ERR_NONE != sts)
+        {
+            Close();
+            return sts;
+        }
+    }
+
+    int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(m_fd, VIDIOC_STREAMON, &type) < 0)
+    {
+        msdk_printf(MSDK_STRING("error: VIDIOC_STREAMON failed: %s\n"), strerror(errno));
+        Close();
+        return MFX_ERR_DEVICE_FAILED;
+    }
+    m_bStreaming = true;
+    m_bSequenceValid = false;
+
+    return Start();
+}
+
+void CV4L2CaptureSource::Close()
+{
+    Stop();
+
+    if (m_bStreaming)
+    {
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(m_fd, VIDIOC_STREAMOFF, &type);
+        m_bStreaming = false;
+    }
+    for (size_t i = 0; i < m_frames.size(); i++)
+    {
+        if (m_frames[i].dmabufFd >= 0)
+            close(m_frames[i].dmabufFd);
+        if (m_frames[i].data)
+            munmap(m_frames[i].data, m_lengths[i]);
+    }
+    m_lengths.clear();
+    if (m_fd >= 0)
+    {
+        // releasing the driver buffers is optional, closing the node frees them anyway
+        struct v4l2_requestbuffers rqbufs;
+        MSDK_ZERO_MEMORY(rqbufs);
+        rqbufs.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        rqbufs.memory = V4L2_MEMORY_MMAP;
+        xioctl(m_fd, VIDIOC_REQBUFS, &rqbufs);
+        close(m_fd);
+        m_fd = -1;
+    }
+
+    CCaptureSource::Close();
+}
+
+mfxStatus CV4L2CaptureSource::QueueBuffer(mfxU32 index)
+{
+    struct v4l2_buffer buf;
+    MSDK_ZERO_MEMORY(buf);
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+    if (xioctl(m_fd, VIDIOC_QBUF, &buf) < 0)
+    {
+        msdk_printf(MSDK_STRING("error: VIDIOC_QBUF failed: %s\n"), strerror(errno));
+        return MFX_ERR_DEVICE_FAILED;
+    }
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CV4L2CaptureSource::CaptureBuffer(mfxU32& index)
+{
+    while (!m_bStop)
+    {
+        struct pollfd pfd;
+        pfd.fd = m_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ret = poll(&pfd, 1, CAPTURE_POLL_TIMEOUT);
+        if (ret < 0 && EINTR != errno)
+            return MFX_ERR_DEVICE_FAILED;
+        if (ret <= 0)
+            continue;
+        if (pfd.revents & (POLLERR | POLLHUP))
+            return MFX_ERR_DEVICE_LOST;
+
+        struct v4l2_buffer buf;
+        MSDK_ZERO_MEMORY(buf);
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(m_fd, VIDIOC_DQBUF, &buf) < 0)
+        {
+            if (EAGAIN == errno)
+                continue;
+            msdk_printf(MSDK_STRING("error: VIDIOC_DQBUF failed: %s\n"), strerror(errno));
+            return MFX_ERR_DEVICE_FAILED;
+        }
+        index = buf.index;
+
+        // a gap in the sequence is frames the driver dropped while all buffers were held
+        if (m_bSequenceValid && buf.sequence - m_lastSequence > 1)
+            m_dropped += buf.sequence - m_lastSequence - 1;
+        m_lastSequence = buf.sequence;
+        m_bSequenceValid = true;
+        return MFX_ERR_NONE;
+    }
+    return MFX_ERR_ABORTED;
+}
+
+void CV4L2CaptureSource::ReturnBuffer(mfxU32 index)
+{
+    // the driver serializes the queue ioctls, so the buffer goes back from the consumer thread directly
+    QueueBuffer(index);
+}
+
+CFileCaptureSource::CFileCaptureSource()
+    : m_file(NULL)
+    , m_bLoop(false)
+    , m_frameSize(0)
+    , m_frameInterval(0)
+    , m_nextFrameTick(0)
+{
+}
+
+CFileCaptureSource::~CFileCaptureSource()
+{
+    Close();
+}
+
+mfxStatus CFileCaptureSource::Open(const sCaptureParams& params)
+{
+    Close();
+
+    mfxU32 pitch = 0;
+    switch (params.fourcc)
+    {
+    case MFX_FOURCC_NV12:
+        pitch = params.width;
+        m_frameSize = (size_t)params.width * params.height * 3 / 2;
+        break;
+    case MFX_FOURCC_YUY2:
+        pitch = params.width * 2;
+        m_frameSize = (size_t)pitch * params.height;
+        break;
+    default:
+        msdk_printf(MSDK_STRING("error: unsupported capture format\n"));
+        return MFX_ERR_UNSUPPORTED;
+    }
+    if (!params.width || !params.height || (params.width & 1) || (params.height & 1) || !params.numBuffers)
+        return MFX_ERR_INVALID_VIDEO_PARAM;
+
+    m_file = fopen(params.device.c_str(), "rb");
+    if (!m_file)
+    {
+        msdk_printf(MSDK_STRING("error: failed to open %s\n"), params.device.c_str());
+        return MFX_ERR_NOT_FOUND;
+    }
+    m_bLoop = params.loop;
+    m_frameInterval = (params.frameRate > 0) ? (msdk_tick)(msdk_time_get_frequency() / params.frameRate) : 0;
+    m_nextFrameTick = 0;
+
+    mfxStatus sts = m_free.Init(params.numBuffers);
+    MSDK_CHECK_STATUS(sts, "m_free.Init failed");
+    m_pFree.reset(new MSDKSemaphore(sts, 0));
+    MSDK_CHECK_STATUS(sts, "MSDKSemaphore creation failed");
+
+    m_frames.resize(params.numBuffers);
+    m_buffers.resize(params.numBuffers, NULL);
+    for (mfxU32 i = 0; i < params.numBuffers; i++)
+    {
+        void* data = NULL;
+        if (posix_memalign(&data, 64, m_frameSize))
+        {
+            Close();
+            return MFX_ERR_MEMORY_ALLOC;
+        }
+        m_buffers[i] = (mfxU8*)data;
+
+        sCaptureFrame& frame = m_frames[i];
+        MSDK_ZERO_MEMORY(frame);
+        frame.index = i;
+        frame.fourcc = params.fourcc;
+        frame.width = params.width;
+        frame.height = params.height;
+        frame.pitch = pitch;
+        frame.data = m_buffers[i];
+        frame.dmabufFd = -1;
+
+        m_free.Push(i);
+        m_pFree->Post();
+    }
+
+    return Start();
+}
+
+void CFileCaptureSource::Close()
+{
+    Stop();
+
+    for (size_t i = 0; i < m_buffers.size(); i++)
+        free(m_buffers[i]);
+    m_buffers.clear();
+    m_pFree.reset();
+    if (m_file)
+    {
+        fclose(m_file);
+        m_file = NULL;
+    }
+
+    CCaptureSource::Close();
+}
+
+mfxStatus CFileCaptureSource::CaptureBuffer(mfxU32& index)
+{
+    m_pFree->Wait();
+    if (m_bStop || !m_free.Pop(index))
+        return MFX_ERR_ABORTED;
+
+    if (m_frameInterval)
+    {
+        msdk_tick now = msdk_time_get_tick();
+        if (!m_nextFrameTick || m_nextFrameTick < now - m_frameInterval)
+            m_nextFrameTick = now; // first frame or the consumer is late, don't try to catch up
+        msdk_time_sleep_until(m_nextFrameTick);
+        m_nextFrameTick += m_frameInterval;
+    }
+
+    if (fread(m_buffers[index], 1, m_frameSize, m_file) != m_frameSize)
+    {
+        if (!m_bLoop || fseek(m_file, 0, SEEK_SET) ||
+            fread(m_buffers[index], 1, m_frameSize, m_file) != m_frameSize)
+        {
+            return MFX_ERR_MORE_DATA;
+        }
+    }
+    return MFX_ERR_NONE;
+}
+
+void CFileCaptureSource::ReturnBuffer(mfxU32 index)
+{
+    m_free.Push(index);
+    m_pFree->Post();
+}
+
+void CFileCaptureSource::Interrupt()
+{
+    m_pFree->Post();
+}
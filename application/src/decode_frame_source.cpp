@@ -0,0 +1,198 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "decode_frame_source.h"
+
+CDecodeFrameSource::CDecodeFrameSource()
+    : m_pFrame(NULL)
+    , m_status(MFX_ERR_NONE)
+    , m_bStop(false)
+    , m_bFrameHeld(false)
+    , m_bFinished(false)
+{
+}
+
+CDecodeFrameSource::~CDecodeFrameSource()
+{
+    Close();
+}
+
+mfxStatus CDecodeFrameSource::Open(const char* fileName, const char* codec)
+{
+    MSDK_CHECK_POINTER(fileName, MFX_ERR_NULL_PTR);
+    MSDK_CHECK_POINTER(codec, MFX_ERR_NULL_PTR);
+
+    Close();
+
+    msdk_char strCodec[MSDK_MAX_FILENAME_LEN];
+    mfxStatus sts = msdk_opt_read(codec, strCodec);
+    MSDK_CHECK_STATUS(sts, "msdk_opt_read failed");
+    sts = msdk_opt_read(fileName, m_params.strSrcFile);
+    MSDK_CHECK_STATUS(sts, "msdk_opt_read failed");
+
+    sts = StrFormatToCodecFormatFourCC(strCodec, m_params.videoType);
+    MSDK_CHECK_STATUS(sts, "Unknown codec");
+    // multi-view streams do not map to a single NV12 picture
+    if (CODEC_MVC == m_params.videoType || !IsDecodeCodecSupported(m_params.videoType))
+    {
+        msdk_printf(MSDK_STRING("error: unsupported codec\n"));
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    // decoder writes straight into system memory NV12 surfaces, nothing is rendered or dumped
+    m_params.mode = MODE_PERFORMANCE;
+    m_params.memType = SYSTEM_MEMORY;
+    m_params.bUseHWLib = true;
+    m_params.nAsyncDepth = 4;
+    m_params.pFrameSink = this;
+    // hugepage-backed, pre-faulted surfaces, kept mapped when the source is opened again
+    m_params.bUseSurfaceArena = true;
+
+    m_pPipeline.reset(new CDecodingPipeline);
+    sts = m_pPipeline->Init(&m_params);
+    MSDK_CHECK_STATUS(sts, "Pipeline.Init failed");
+
+    m_pFrameReady.reset(new MSDKSemaphore(sts, 0));
+    MSDK_CHECK_STATUS(sts, "MSDKSemaphore creation failed");
+    m_pFrameReleased.reset(new MSDKSemaphore(sts, 0));
+    MSDK_CHECK_STATUS(sts, "MSDKSemaphore creation failed");
+
+    m_bStop = false;
+    m_bFrameHeld = false;
+    m_bFinished = false;
+    m_status = MFX_ERR_NONE;
+    m_pThread.reset(new MSDKThread(sts, DecodeThreadFunc, this, "decode"));
+    MSDK_CHECK_STATUS(sts, "MSDKThread creation failed");
+
+    return MFX_ERR_NONE;
+}
+
+void CDecodeFrameSource::Close()
+{
+    if (m_pThread.get())
+    {
+        m_bStop = true;
+        // unblocks the decoder if it still waits for the consumer
+        m_pFrameReleased->Post();
+        m_pThread->Wait();
+        m_pThread.reset();
+    }
+    m_pPipeline.reset();
+    m_pFrameReady.reset();
+    m_pFrameReleased.reset();
+    m_pFrame = NULL;
+}
+
+mfxStatus CDecodeFrameSource::GetFrame(mfxFrameSurface1** frame)
+{
+    MSDK_CHECK_POINTER(frame, MFX_ERR_NULL_PTR);
+    *frame = NULL;
+
+    if (!m_pThread.get())
+        return MFX_ERR_NOT_INITIALIZED;
+    if (m_bFinished)
+        return m_status; // reported once already, the decoder thread is gone
+
+    ReleaseFrame();
+    {
+        MFX_ITT_TASK("WaitDecodedFrame");
+        m_pFrameReady->Wait();
+    }
+    if (!m_pFrame)
+    {
+        m_bFinished = true;
+        if (MFX_ERR_NONE == m_status)
+            m_status = MFX_ERR_MORE_DATA;
+        return m_status;
+    }
+
+    m_bFrameHeld = true;
+    *frame = m_pFrame;
+    return MFX_ERR_NONE;
+}
+
+void CDecodeFrameSource::ReleaseFrame()
+{
+    if (m_bFrameHeld)
+    {
+        m_bFrameHeld = false;
+        m_pFrameReleased->Post();
+    }
+}
+
+mfxStatus CDecodeFrameSource::OnFrame(mfxFrameSurface1* frame)
+{
+    if (m_bStop)
+        return MFX_ERR_ABORTED;
+    if (MFX_FOURCC_NV12 != frame->Info.FourCC)
+    {
+        msdk_printf(MSDK_STRING("error: only NV12 output is supported by the frame source\n"));
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    m_pFrame = frame;
+    m_pFrameReady->Post();
+    MFX_ITT_TASK("WaitFrameReleased");
+    m_pFrameReleased->Wait();
+
+    return m_bStop ? MFX_ERR_ABORTED : MFX_ERR_NONE;
+}
+
+mfxStatus CDecodeFrameSource::DecodeLoop()
+{
+    mfxStatus sts = MFX_ERR_NONE;
+    mfxU64 prevResetBytesCount = 0xFFFFFFFFFFFFFFFF;
+
+    for (;;)
+    {
+        sts = m_pPipeline->RunDecoding();
+        if (MFX_ERR_INCOMPATIBLE_VIDEO_PARAM == sts || MFX_ERR_DEVICE_LOST == sts || MFX_ERR_DEVICE_FAILED == sts)
+        {
+            if (m_bStop || prevResetBytesCount == m_pPipeline->GetTotalBytesProcessed())
+                break;
+            prevResetBytesCount = m_pPipeline->GetTotalBytesProcessed();
+
+            if (MFX_ERR_INCOMPATIBLE_VIDEO_PARAM != sts)
+            {
+                sts = m_pPipeline->ResetDevice();
+                MSDK_CHECK_STATUS(sts, "Pipeline.ResetDevice failed");
+            }
+            sts = m_pPipeline->ResetDecoder(&m_params);
+            MSDK_CHECK_STATUS(sts, "Pipeline.ResetDecoder failed");
+            continue;
+        }
+        break;
+    }
+
+    // a stop requested by the consumer is not an error
+    return m_bStop ? MFX_ERR_NONE : sts;
+}
+
+unsigned int MFX_STDCALL CDecodeFrameSource::DecodeThreadFunc(void* ctx)
+{
+    CDecodeFrameSource* source = (CDecodeFrameSource*)ctx;
+
+    mfxStatus sts = source->DecodeLoop();
+
+    source->m_status = (sts < MFX_ERR_NONE) ? sts : MFX_ERR_NONE;
+    source->m_pFrame = NULL;
+    source->m_pFrameReady->Post();
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "async_file_writer.h"
+#include "detection_record.hpp"
+
+// A second of records takes a few kilobytes, so the staging buffers are handed to the writer thread rarely
+static const mfxU32 RECORDER_BUFFER_SIZE = 1024 * 1024;
+
+DetectionRecorder::DetectionRecorder() {}
+
+DetectionRecorder::~DetectionRecorder() {
+    close();
+}
+
+bool DetectionRecorder::open(const std::string &path) {
+    close();
+    _writer.reset(new CAsyncFileWriter);
+    mfxU8 *data = nullptr;
+    const uint32_t header[2] = {RECORDING_MAGIC, RECORDING_VERSION};
+    if (_writer->Open(path.c_str(), RECORDER_BUFFER_SIZE) != MFX_ERR_NONE ||
+        _writer->Reserve(sizeof(header), &data) != MFX_ERR_NONE) {
+        _writer.reset();
+        return false;
+    }
+    std::memcpy(data, header, sizeof(header));
+    _writer->Commit(sizeof(header));
+    return true;
+}
+
+// The record is built in place in the staging buffer, no lock is taken unless the buffer is full
+void DetectionRecorder::write(const RecordedFrame &frame, const std::vector<RecordedFace> &faces) {
+    if (!_writer) {
+        return;
+    }
+    const size_t facesSize = faces.size() * sizeof(RecordedFace);
+    mfxU8 *data = nullptr;
+    if (_writer->Reserve(static_cast<mfxU32>(sizeof(frame) + facesSize), &data) != MFX_ERR_NONE) {
+        return;
+    }
+    std::memcpy(data, &frame, sizeof(frame));
+    if (facesSize) {
+        std::memcpy(data + sizeof(frame), faces.data(), facesSize);
+    }
+    _writer->Commit(static_cast<mfxU32>(sizeof(frame) + facesSize));
+}
+
+void DetectionRecorder::close() {
+    if (_writer) {
+        _writer->Close();
+        _writer.reset();
+    }
+}
+
+DetectionReplay::DetectionReplay() : _offset(0) {}
+
+bool DetectionReplay::open(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    _data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    uint32_t header[2] = {0, 0};
+    if (_data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(header, _data.data(), sizeof(header));
+    _offset = sizeof(header);
+    return header[0] == RECORDING_MAGIC && header[1] == RECORDING_VERSION;
+}
+
+bool DetectionReplay::next(RecordedFrame &frame, std::vector<RecordedFace> &faces) {
+    if (_data.size() - _offset < sizeof(frame)) {
+        return false;
+    }
+    std::memcpy(&frame, _data.data() + _offset, sizeof(frame));
+    const size_t facesSize = frame.faces * sizeof(RecordedFace);
+    if (_data.size() - _offset - sizeof(frame) < facesSize) {
+        return false;
+    }
+    faces.resize(frame.faces);
+    if (facesSize) {
+        std::memcpy(faces.data(), _data.data() + _offset + sizeof(frame), facesSize);
+    }
+    _offset += sizeof(frame) + facesSize;
+    return true;
+}
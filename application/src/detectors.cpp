@@ -15,6 +15,8 @@
 #include <algorithm>
 #include <iterator>
 #include <map>
+#include <limits>
+#include <cmath>
 
 #include <inference_engine.hpp>
 
@@ -25,6 +27,8 @@
 //#include <ext_list.hpp>
 
 #include "detectors.hpp"
+#include "detection_rows.hpp"
+#include "preprocess.hpp"
 
 using namespace InferenceEngine;
 
@@ -35,7 +39,10 @@ BaseDetection::BaseDetection(std::string topoName,
                              bool doRawOutputMessages)
     : topoName(topoName), pathToModel(pathToModel), deviceForInference(deviceForInference),
       maxBatch(maxBatch), isBatchDynamic(isBatchDynamic), isAsync(isAsync),
-      enablingChecked(false), _enabled(false), doRawOutputMessages(doRawOutputMessages) {
+      enablingChecked(false), _enabled(false), doRawOutputMessages(doRawOutputMessages),
+      inferredItems(0), skippedItems(0), blockedMs(0), submitted(false),
+      submitSpan(msdk_trace_name((topoName + " submit").c_str())),
+      waitSpan(msdk_trace_name((topoName + " wait").c_str())) {
     if (isAsync) {
         slog::info << "Use async mode for " << topoName << slog::endl;
     }
@@ -47,19 +54,38 @@ ExecutableNetwork* BaseDetection::operator ->() {
     return &net;
 }
 
+static double elapsedMs(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 void BaseDetection::submitRequest() {
     if (!enabled() || request == nullptr) return;
+    CTraceSpan span(submitSpan);
+    auto start = std::chrono::steady_clock::now();
     if (isAsync) {
         nxtrequest->StartAsync();
     } else {
         request->Infer();
     }
+    blockedMs += elapsedMs(start);
+    submitted = true;
 }
 
+// The sample covers the submission of the next request and the wait for the current one in async mode
 void BaseDetection::wait() {
-    if (!enabled()|| !request || !isAsync)
+    if (!enabled()|| !request)
         return;
-    request->Wait(IInferRequest::WaitMode::RESULT_READY);
+    if (isAsync) {
+        CTraceSpan span(waitSpan);
+        auto start = std::chrono::steady_clock::now();
+        request->Wait(IInferRequest::WaitMode::RESULT_READY);
+        blockedMs += elapsedMs(start);
+    }
+    if (submitted) {
+        latency.AddValue(blockedMs);
+        blockedMs = 0;
+        submitted = false;
+    }
 }
 
 bool BaseDetection::enabled() const  {
@@ -92,23 +118,92 @@ FaceDetection::FaceDetection(const std::string &pathToModel,
       maxProposalCount(0), objectSize(0), enquedFrames(0), width(0), height(0),
       network_input_width(0), network_input_height(0),
       bb_enlarge_coefficient(bb_enlarge_coefficient), bb_dx_coefficient(bb_dx_coefficient),
-      bb_dy_coefficient(bb_dy_coefficient), resultsFetched(false) {}
+      bb_dy_coefficient(bb_dy_coefficient), resultsFetched(false), nv12Input(false),
+      tileOverlap(0.2f), tileRegion(0.f, 0.f, 1.f, 1.f), tileNmsThreshold(0.4f), nmsThreshold(0.f) {}
 
 void FaceDetection::submitRequest() {
     if (!enquedFrames) return;
     enquedFrames = 0;
     resultsFetched = false;
     results.clear();
+    // Tiles are always started asynchronously, so that they run next to the whole frame also in sync mode
+    for (auto &tileRequest : isAsync ? nxttileRequests : tileRequests) {
+        tileRequest->StartAsync();
+    }
     BaseDetection::submitRequest();
 }
 
-void FaceDetection::enqueue(const cv::Mat &frame) {
+void FaceDetection::wait() {
     if (!enabled()) return;
+    if (!tileRequests.empty()) {
+        CTraceSpan span("Face Detection tiles wait");
+        auto start = std::chrono::steady_clock::now();
+        for (auto &tileRequest : tileRequests) {
+            tileRequest->Wait(IInferRequest::WaitMode::RESULT_READY);
+        }
+        blockedMs += elapsedMs(start);
+    }
+    BaseDetection::wait();
+}
+
+void FaceDetection::swapRequests() {
+    request.swap(nxtrequest);
+    tileRequests.swap(nxttileRequests);
+}
 
+// The requests are created once and swapped between frames in asynchronous mode. The requests being
+// filled may still run a frame submitted again without being waited for, as the BGR path does, so they
+// are waited for first. Dropping them for new requests waited for them as well.
+void FaceDetection::prepareRequests() {
     if (!request) {
         request = net.CreateInferRequestPtr();
     }
-    nxtrequest = net.CreateInferRequestPtr();
+    if (!isAsync) return;
+    if (!nxtrequest) {
+        nxtrequest = net.CreateInferRequestPtr();
+    }
+    nxtrequest->Wait(IInferRequest::WaitMode::RESULT_READY);
+    for (auto &tileRequest : nxttileRequests) {
+        tileRequest->Wait(IInferRequest::WaitMode::RESULT_READY);
+    }
+}
+
+// Tiles of equal size overlapping by tileOverlap cover tileRegion. Their corners are kept even,
+// as NV12 chroma is subsampled 2x2.
+std::vector<InferRequest::Ptr> &FaceDetection::prepareTiles(int frameWidth, int frameHeight) {
+    auto &tileSet = isAsync ? nxttileRequests : tileRequests;
+    tiles.clear();
+    if (tileGrid.area() > 0) {
+        const float regionX = tileRegion.x * frameWidth;
+        const float regionY = tileRegion.y * frameHeight;
+        const float tileWidth = tileRegion.width * frameWidth / (tileGrid.width - (tileGrid.width - 1) * tileOverlap);
+        const float tileHeight = tileRegion.height * frameHeight / (tileGrid.height - (tileGrid.height - 1) * tileOverlap);
+        const cv::Rect frameRect(0, 0, frameWidth & ~1, frameHeight & ~1);
+        for (int row = 0; row < tileGrid.height; ++row) {
+            for (int col = 0; col < tileGrid.width; ++col) {
+                const float x = regionX + col * tileWidth * (1.f - tileOverlap);
+                const float y = regionY + row * tileHeight * (1.f - tileOverlap);
+                const int x0 = static_cast<int>(x) & ~1;
+                const int y0 = static_cast<int>(y) & ~1;
+                const int x1 = static_cast<int>(x + tileWidth + 1.f) & ~1;
+                const int y1 = static_cast<int>(y + tileHeight + 1.f) & ~1;
+                tiles.push_back(cv::Rect(x0, y0, x1 - x0, y1 - y0) & frameRect);
+            }
+        }
+    }
+    tileSet.resize(tiles.size());
+    for (auto &tileRequest : tileSet) {
+        if (!tileRequest) {
+            tileRequest = net.CreateInferRequestPtr();
+        }
+    }
+    return tileSet;
+}
+
+void FaceDetection::enqueue(const cv::Mat &frame) {
+    if (!enabled()) return;
+
+    prepareRequests();
     width = static_cast<float>(frame.cols);
     height = static_cast<float>(frame.rows);
     Blob::Ptr  inputBlob;
@@ -117,7 +212,52 @@ void FaceDetection::enqueue(const cv::Mat &frame) {
     else {
        inputBlob = request->GetBlob(input);
     }
-    matU8ToBlob<uint8_t>(frame, inputBlob);
+    resizeToBlob(frame, inputBlob, 0, true);
+
+    auto &tileSet = prepareTiles(frame.cols, frame.rows);
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        resizeToBlob(frame(tiles[i]), tileSet[i]->GetBlob(input), 0, true);
+    }
+
+    enquedFrames = 1;
+}
+
+void FaceDetection::enqueue(const cv::Mat &y, const cv::Mat &uv) {
+    if (!enabled()) return;
+
+    prepareRequests();
+    width = static_cast<float>(y.cols);
+    height = static_cast<float>(y.rows);
+
+    // Planes are wrapped in place with the surface pitch as the row length, the ROI drops the padding.
+    // Color conversion and resize to the network input are left to the Inference Engine preprocessing.
+    const size_t pitch = y.step[0];
+    Blob::Ptr yBlob = make_shared_blob<uint8_t>(
+        TensorDesc(Precision::U8, {1, 1, static_cast<size_t>(y.rows), pitch}, Layout::NHWC), y.data);
+    Blob::Ptr uvBlob = make_shared_blob<uint8_t>(
+        TensorDesc(Precision::U8, {1, 2, static_cast<size_t>(uv.rows), pitch / 2}, Layout::NHWC), uv.data);
+    Blob::Ptr nv12Blob = make_shared_blob<NV12Blob>(yBlob, uvBlob);
+    ROI roi;
+    roi.id = 0;
+    roi.posX = 0;
+    roi.posY = 0;
+    roi.sizeX = static_cast<size_t>(y.cols);
+    roi.sizeY = static_cast<size_t>(y.rows);
+
+    if(isAsync)
+       nxtrequest->SetBlob(input, make_shared_blob(nv12Blob, roi));
+    else {
+       request->SetBlob(input, make_shared_blob(nv12Blob, roi));
+    }
+
+    auto &tileSet = prepareTiles(y.cols, y.rows);
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        roi.posX = static_cast<size_t>(tiles[i].x);
+        roi.posY = static_cast<size_t>(tiles[i].y);
+        roi.sizeX = static_cast<size_t>(tiles[i].width);
+        roi.sizeY = static_cast<size_t>(tiles[i].height);
+        tileSet[i]->SetBlob(input, make_shared_blob(nv12Blob, roi));
+    }
 
     enquedFrames = 1;
 }
@@ -155,10 +295,15 @@ CNNNetwork FaceDetection::read(const InferenceEngine::Core& ie)  {
     }
     InputInfo::Ptr inputInfoFirst = inputInfo.begin()->second;
     inputInfoFirst->setPrecision(Precision::U8);
+    if (nv12Input) {
+        inputInfoFirst->getPreProcess().setColorFormat(ColorFormat::NV12);
+        inputInfoFirst->getPreProcess().setResizeAlgorithm(RESIZE_BILINEAR);
+    }
     
+    // Boxes [N, 5] are given in pixels of the network input
     const SizeVector inputDims = inputInfoFirst->getTensorDesc().getDims();
-    //network_input_height = inputDims[2];
-    //network_input_width = inputDims[3];
+    network_input_height = static_cast<float>(inputDims[2]);
+    network_input_width = static_cast<float>(inputDims[3]);
     // -----------------------------------------------------------------------------------------------------
 
     // ---------------------------Check outputs ------------------------------------------------------------
@@ -223,78 +368,102 @@ CNNNetwork FaceDetection::read(const InferenceEngine::Core& ie)  {
 }
 
 void FaceDetection::fetchResults() {
+    CTraceSpan span("Face Detection results");
     if (!enabled()) return;
     results.clear();
     if (resultsFetched) return;
     resultsFetched = true;
-    const float *detections = request->GetBlob(output)->buffer().as<float *>();
-    const int32_t *labels = !labels_output.empty() ? request->GetBlob(labels_output)->buffer().as<int32_t *>() : nullptr;
-
-    for (int i = 0; i < maxProposalCount && objectSize == 5; i++) {
-//        float image_id = detections[i * objectSize + 0];
-//        if (image_id < 0) {
-//            break;
-//        }
-        Result r;
-        r.label = labels[i];
-        r.confidence = detections[i * objectSize + 4];
-
-        if (r.confidence <= detectionThreshold && !doRawOutputMessages) {
-            continue;
-        }
+    fetchResults(request, cv::Rect(0, 0, static_cast<int>(width), static_cast<int>(height)), -1, results);
+    if (tiles.empty()) return;
 
-        r.location.x = static_cast<int>(detections[i * objectSize + 0] / network_input_width * width);
-        r.location.y = static_cast<int>(detections[i * objectSize + 1] / network_input_height * height);
-        r.location.width = static_cast<int>(detections[i * objectSize + 2] / network_input_width * width - r.location.x);
-        r.location.height = static_cast<int>(detections[i * objectSize + 3] / network_input_height * height - r.location.y);
-
-        // Make square and enlarge face bounding box for more robust operation of face analytics networks
-        int bb_width = r.location.width;
-        int bb_height = r.location.height;
-
-        int bb_center_x = r.location.x + bb_width / 2;
-        int bb_center_y = r.location.y + bb_height / 2;
-
-        int max_of_sizes = std::max(bb_width, bb_height);
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        fetchResults(tileRequests[i], tiles[i], static_cast<int>(i), results);
+    }
 
-        int bb_new_width = static_cast<int>(bb_enlarge_coefficient * max_of_sizes);
-        int bb_new_height = static_cast<int>(bb_enlarge_coefficient * max_of_sizes);
+    // A face on the overlap of tiles, or big enough to be found on the whole frame too, is kept once
+    suppressOverlaps(results, tileNmsThreshold);
+}
 
-        r.location.x = bb_center_x - static_cast<int>(std::floor(bb_dx_coefficient * bb_new_width / 2));
-        r.location.y = bb_center_y - static_cast<int>(std::floor(bb_dy_coefficient * bb_new_height / 2));
+// A face cut by an edge a tile shares with its neighbour is found whole on the neighbour or on the
+// whole frame, its part is dropped so that it cannot win the NMS over the whole face
+static bool isCutByNeighbour(const cv::Rect &box, const cv::Rect &tile, int col, int row, const cv::Size &grid) {
+    const int margin = 2;
+    return (col > 0 && box.x <= tile.x + margin) ||
+           (row > 0 && box.y <= tile.y + margin) ||
+           (col + 1 < grid.width && box.x + box.width >= tile.x + tile.width - margin) ||
+           (row + 1 < grid.height && box.y + box.height >= tile.y + tile.height - margin);
+}
 
-        r.location.width = bb_new_width;
-        r.location.height = bb_new_height;
 
-        if (doRawOutputMessages) {
-            std::cout << "[" << i << "," << r.label << "] element, prob = " << r.confidence <<
-                         "    (" << r.location.x << "," << r.location.y << ")-(" << r.location.width << ","
-                      << r.location.height << ")"
-                      << ((r.confidence > detectionThreshold) ? " WILL BE RENDERED!" : "") << std::endl;
+// Keeps the most confident of the detections overlapping by more than the IoU threshold
+static void suppressOverlaps(std::vector<FaceDetection::Result> &detections, float threshold) {
+    std::stable_sort(detections.begin(), detections.end(),
+                     [](const FaceDetection::Result &a, const FaceDetection::Result &b) {
+        return a.confidence > b.confidence;
+    });
+    std::vector<FaceDetection::Result> kept;
+    for (const auto &r : detections) {
+        bool suppressed = false;
+        for (const auto &k : kept) {
+            const float overlap = static_cast<float>((r.location & k.location).area());
+            if (overlap > threshold * (r.location.area() + k.location.area() - overlap)) {
+                suppressed = true;
+                break;
+            }
         }
-        if (r.confidence > detectionThreshold) {
-            results.push_back(r);
+        if (!suppressed) {
+            kept.push_back(r);
         }
     }
+    detections.swap(kept);
+}
 
-    for (int i = 0; i < maxProposalCount && objectSize == 7; i++) {
-        float image_id = detections[i * objectSize + 0];
-        if (image_id < 0) {
-            break;
-        }
+// Appends the detections of a request to found. The request ran on the area of the frame,
+// tile is its index in tiles or -1 for the whole frame.
+void FaceDetection::fetchResults(const InferRequest::Ptr &req, const cv::Rect &area, int tile,
+                                 std::vector<Result> &found) {
+    const float *detections = req->GetBlob(output)->buffer().as<float *>();
+    const int32_t *labels = !labels_output.empty() ? req->GetBlob(labels_output)->buffer().as<int32_t *>() : nullptr;
+    if (objectSize == DetectionOutputRows::size) {
+        decode<DetectionOutputRows>(detections, labels, area, tile, found);
+    } else {
+        decode<BoxesRows>(detections, labels, area, tile, found);
+    }
+}
+
+template <typename Rows>
+void FaceDetection::decode(const float *detections, const int32_t *labels, const cv::Rect &area, int tile,
+                           std::vector<Result> &found) {
+    int count = 0;
+    while (count < maxProposalCount && !Rows::isEnd(detections + count * Rows::size)) {
+        ++count;
+    }
+
+    // Raw output prints every proposal
+    filterByConfidence<Rows>(detections, count,
+                             doRawOutputMessages ? -std::numeric_limits<float>::infinity()
+                                                 : static_cast<float>(detectionThreshold),
+                             survivors);
+
+    const float scaleX = Rows::normalized ? area.width : area.width / network_input_width;
+    const float scaleY = Rows::normalized ? area.height : area.height / network_input_height;
+    std::vector<Result> decoded;
+    for (int i : survivors) {
+        const float *row = detections + i * Rows::size;
         Result r;
-        r.label = static_cast<int>(detections[i * objectSize + 1]);
-        r.confidence = detections[i * objectSize + 2];
+        r.label = Rows::label(row, labels, i);
+        r.confidence = row[Rows::confidence];
 
-        if (r.confidence <= detectionThreshold && !doRawOutputMessages) {
+        const float *box = row + Rows::box;
+        r.location.x = area.x + static_cast<int>(box[0] * scaleX);
+        r.location.y = area.y + static_cast<int>(box[1] * scaleY);
+        r.location.width = area.x + static_cast<int>(box[2] * scaleX) - r.location.x;
+        r.location.height = area.y + static_cast<int>(box[3] * scaleY) - r.location.y;
+
+        if (tile >= 0 && isCutByNeighbour(r.location, area, tile % tileGrid.width, tile / tileGrid.width, tileGrid)) {
             continue;
         }
 
-        r.location.x = static_cast<int>(detections[i * objectSize + 3] * width);
-        r.location.y = static_cast<int>(detections[i * objectSize + 4] * height);
-        r.location.width = static_cast<int>(detections[i * objectSize + 5] * width - r.location.x);
-        r.location.height = static_cast<int>(detections[i * objectSize + 6] * height - r.location.y);
-
         // Make square and enlarge face bounding box for more robust operation of face analytics networks
         int bb_width = r.location.width;
         int bb_height = r.location.height;
@@ -320,9 +489,14 @@ void FaceDetection::fetchResults() {
                       << ((r.confidence > detectionThreshold) ? " WILL BE RENDERED!" : "") << std::endl;
         }
         if (r.confidence > detectionThreshold) {
-            results.push_back(r);
+            decoded.push_back(r);
         }
     }
+
+    if (nmsThreshold > 0.f) {
+        suppressOverlaps(decoded, nmsThreshold);
+    }
+    found.insert(found.end(), decoded.begin(), decoded.end());
 }
 
 
@@ -344,7 +518,7 @@ void AgeGenderDetection::submitRequest()  {
     enquedFaces = 0;
 }
 
-void AgeGenderDetection::enqueue(const cv::Mat &face) {
+void AgeGenderDetection::enqueue(FaceCrop &face) {
     if (!enabled()) {
         return;
     }
@@ -356,13 +530,16 @@ void AgeGenderDetection::enqueue(const cv::Mat &face) {
     if (!request) {
         request = net.CreateInferRequestPtr();
     }
-    nxtrequest = net.CreateInferRequestPtr();
+    // All faces of a batch go to the same request
+    if (!enquedFaces) {
+        nxtrequest = net.CreateInferRequestPtr();
+    }
     Blob::Ptr inputBlob;
     if(isAsync)
        inputBlob = nxtrequest->GetBlob(input);
     else
        inputBlob = request->GetBlob(input);
-    matU8ToBlob<uint8_t>(face, inputBlob, enquedFaces);
+    face.fill(inputBlob, enquedFaces);
 
     enquedFaces++;
 }
@@ -479,7 +656,7 @@ void HeadPoseDetection::submitRequest()  {
     enquedFaces = 0;
 }
 
-void HeadPoseDetection::enqueue(const cv::Mat &face) {
+void HeadPoseDetection::enqueue(FaceCrop &face) {
     if (!enabled()) {
         return;
     }
@@ -491,14 +668,17 @@ void HeadPoseDetection::enqueue(const cv::Mat &face) {
     if (!request) {
         request = net.CreateInferRequestPtr();
     }
-    nxtrequest = net.CreateInferRequestPtr();
+    // All faces of a batch go to the same request
+    if (!enquedFaces) {
+        nxtrequest = net.CreateInferRequestPtr();
+    }
     Blob::Ptr inputBlob;
     if(isAsync)
        inputBlob = nxtrequest->GetBlob(input);
     else
        inputBlob = request->GetBlob(input);
 
-    matU8ToBlob<uint8_t>(face, inputBlob, enquedFaces);
+    face.fill(inputBlob, enquedFaces);
 
     enquedFaces++;
 }
@@ -605,13 +785,232 @@ CNNNetwork HeadPoseDetection::read(const InferenceEngine::Core& ie) {
 }
 
 
+const std::vector<std::string> EmotionsDetection::emotionsVec = {"neutral", "happy", "sad", "surprise", "anger"};
+
+EmotionsDetection::EmotionsDetection(const std::string &pathToModel,
+                                     const std::string &deviceForInference,
+                                     int maxBatch, bool isBatchDynamic, bool isAsync, bool doRawOutputMessages)
+    : BaseDetection("Emotions Recognition", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync,
+      doRawOutputMessages), enquedFaces(0) {
+}
+
+void EmotionsDetection::submitRequest() {
+    if (!enquedFaces) return;
+    if (isBatchDynamic) {
+        request->SetBatch(enquedFaces);
+    }
+    BaseDetection::submitRequest();
+    enquedFaces = 0;
+}
+
+void EmotionsDetection::enqueue(FaceCrop &face) {
+    if (!enabled()) {
+        return;
+    }
+    if (enquedFaces == maxBatch) {
+        slog::warn << "Number of detected faces more than maximum(" << maxBatch <<
+                        ") processed by Emotions Recognition network" << slog::endl;
+        return;
+    }
+    if (!request) {
+        request = net.CreateInferRequestPtr();
+    }
+    // All faces of a batch go to the same request
+    if (!enquedFaces) {
+        nxtrequest = net.CreateInferRequestPtr();
+    }
+    Blob::Ptr inputBlob;
+    if(isAsync)
+       inputBlob = nxtrequest->GetBlob(input);
+    else
+       inputBlob = request->GetBlob(input);
+
+    face.fill(inputBlob, enquedFaces);
+
+    enquedFaces++;
+}
+
+std::map<std::string, float> EmotionsDetection::operator[] (int idx) const {
+    Blob::Ptr emotionsBlob = request->GetBlob(outputEmotions);
+
+    // The output is either [N x C] or [N x C x 1 x 1], C being the number of emotions
+    size_t numOfChannels = emotionsBlob->getTensorDesc().getDims().at(1);
+    if (numOfChannels != emotionsVec.size()) {
+        throw std::logic_error("Output size (" + std::to_string(numOfChannels) +
+                               ") of the Emotions Recognition network is not equal to the number of emotions (" +
+                               std::to_string(emotionsVec.size()) + ")");
+    }
+
+    const float *emotionsValues = emotionsBlob->buffer().as<float *>() + idx * numOfChannels;
+    std::map<std::string, float> emotions;
+    for (size_t i = 0; i < numOfChannels; i++) {
+        emotions[emotionsVec[i]] = emotionsValues[i];
+    }
+
+    if (doRawOutputMessages) {
+        std::cout << "[" << idx << "] element, predicted emotions (name = prob):" << std::endl;
+        for (size_t i = 0; i < numOfChannels; i++) {
+            std::cout << emotionsVec[i] << " = " << emotionsValues[i];
+            std::cout << ((i + 1 < numOfChannels) ? ", " : "\n");
+        }
+    }
+
+    return emotions;
+}
+
+CNNNetwork EmotionsDetection::read(const InferenceEngine::Core& ie) {
+    slog::info << "Loading network files for Emotions Recognition network" << slog::endl;
+
+    // Read network model
+    auto network = ie.ReadNetwork(pathToModel);
+
+    // Set maximum batch size
+    network.setBatchSize(maxBatch);
+    slog::info << "Batch size is set to " << network.getBatchSize() <<
+                    " for Emotions Recognition network" << slog::endl;
+
+    // ---------------------------Check inputs -------------------------------------------------------------
+    slog::info << "Checking Emotions Recognition network inputs" << slog::endl;
+    InputsDataMap inputInfo(network.getInputsInfo());
+    if (inputInfo.size() != 1) {
+        throw std::logic_error("Emotions Recognition network should have only one input");
+    }
+    InputInfo::Ptr& inputInfoFirst = inputInfo.begin()->second;
+    inputInfoFirst->setPrecision(Precision::U8);
+    input = inputInfo.begin()->first;
+    // -----------------------------------------------------------------------------------------------------
+
+    // ---------------------------Check outputs ------------------------------------------------------------
+    slog::info << "Checking Emotions Recognition network outputs" << slog::endl;
+    OutputsDataMap outputInfo(network.getOutputsInfo());
+    if (outputInfo.size() != 1) {
+        throw std::logic_error("Emotions Recognition network should have one output layer");
+    }
+    for (auto& output : outputInfo) {
+        output.second->setPrecision(Precision::FP32);
+    }
+    outputEmotions = outputInfo.begin()->first;
+
+    slog::info << "Loading Emotions Recognition model to the "<< deviceForInference << " plugin" << slog::endl;
+
+    _enabled = true;
+    return network;
+}
+
+
+FacialLandmarksDetection::FacialLandmarksDetection(const std::string &pathToModel,
+                                                   const std::string &deviceForInference,
+                                                   int maxBatch, bool isBatchDynamic, bool isAsync,
+                                                   bool doRawOutputMessages)
+    : BaseDetection("Facial Landmarks", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync,
+      doRawOutputMessages), enquedFaces(0) {
+}
+
+void FacialLandmarksDetection::submitRequest() {
+    if (!enquedFaces) return;
+    if (isBatchDynamic) {
+        request->SetBatch(enquedFaces);
+    }
+    BaseDetection::submitRequest();
+    enquedFaces = 0;
+}
+
+void FacialLandmarksDetection::enqueue(FaceCrop &face) {
+    if (!enabled()) {
+        return;
+    }
+    if (enquedFaces == maxBatch) {
+        slog::warn << "Number of detected faces more than maximum(" << maxBatch <<
+                        ") processed by Facial Landmarks estimator" << slog::endl;
+        return;
+    }
+    if (!request) {
+        request = net.CreateInferRequestPtr();
+    }
+    // All faces of a batch go to the same request
+    if (!enquedFaces) {
+        nxtrequest = net.CreateInferRequestPtr();
+    }
+    Blob::Ptr inputBlob;
+    if(isAsync)
+       inputBlob = nxtrequest->GetBlob(input);
+    else
+       inputBlob = request->GetBlob(input);
+
+    face.fill(inputBlob, enquedFaces);
+
+    enquedFaces++;
+}
+
+std::vector<float> FacialLandmarksDetection::operator[] (int idx) const {
+    Blob::Ptr landmarksBlob = request->GetBlob(outputFacialLandmarksBlobName);
+
+    // x and y of every point, normalized to the face rectangle
+    size_t numOfValues = landmarksBlob->getTensorDesc().getDims().at(1);
+    const float *normedCoordinates = landmarksBlob->buffer().as<float *>() + idx * numOfValues;
+    std::vector<float> normedLandmarks(normedCoordinates, normedCoordinates + numOfValues);
+
+    if (doRawOutputMessages) {
+        std::cout << "[" << idx << "] element, normed facial landmarks coordinates (x, y):" << std::endl;
+        for (size_t i = 0; i + 1 < numOfValues; i += 2) {
+            std::cout << "\t" << normedLandmarks[i] << ", " << normedLandmarks[i + 1] << std::endl;
+        }
+    }
+
+    return normedLandmarks;
+}
+
+CNNNetwork FacialLandmarksDetection::read(const InferenceEngine::Core& ie) {
+    slog::info << "Loading network files for Facial Landmarks Estimation network" << slog::endl;
+
+    // Read network model
+    auto network = ie.ReadNetwork(pathToModel);
+
+    // Set maximum batch size
+    network.setBatchSize(maxBatch);
+    slog::info << "Batch size is set to " << network.getBatchSize() <<
+                    " for Facial Landmarks Estimation network" << slog::endl;
+
+    // ---------------------------Check inputs -------------------------------------------------------------
+    slog::info << "Checking Facial Landmarks Estimation network inputs" << slog::endl;
+    InputsDataMap inputInfo(network.getInputsInfo());
+    if (inputInfo.size() != 1) {
+        throw std::logic_error("Facial Landmarks Estimation network should have only one input");
+    }
+    InputInfo::Ptr& inputInfoFirst = inputInfo.begin()->second;
+    inputInfoFirst->setPrecision(Precision::U8);
+    input = inputInfo.begin()->first;
+    // -----------------------------------------------------------------------------------------------------
+
+    // ---------------------------Check outputs ------------------------------------------------------------
+    slog::info << "Checking Facial Landmarks Estimation network outputs" << slog::endl;
+    OutputsDataMap outputInfo(network.getOutputsInfo());
+    if (outputInfo.size() != 1) {
+        throw std::logic_error("Facial Landmarks Estimation network should have only one output");
+    }
+    DataPtr& output = outputInfo.begin()->second;
+    const SizeVector outputDims = output->getTensorDesc().getDims();
+    if (outputDims.size() < 2 || outputDims[1] % 2 != 0) {
+        throw std::logic_error("Facial Landmarks Estimation network output should hold x and y of every point");
+    }
+    output->setPrecision(Precision::FP32);
+    outputFacialLandmarksBlobName = outputInfo.begin()->first;
+
+    slog::info << "Loading Facial Landmarks Estimation model to the "<< deviceForInference << " plugin" << slog::endl;
+
+    _enabled = true;
+    return network;
+}
+
+
 Load::Load(BaseDetection& detector) : detector(detector) {  
 }
 
 
-void Load::into(InferenceEngine::Core & ie, const std::string & deviceName, bool enable_dynamic_batch) const {
+void Load::into(InferenceEngine::Core & ie, const std::string & deviceName, bool enable_dynamic_batch,
+                const std::map<std::string, std::string> & deviceConfig) const {
     if (detector.enabled()) {
-        std::map<std::string, std::string> config = { };
+        std::map<std::string, std::string> config = deviceConfig;
         bool isPossibleDynBatch = deviceName.find("CPU") != std::string::npos ||
                                   deviceName.find("GPU") != std::string::npos;
 
@@ -623,6 +1022,28 @@ void Load::into(InferenceEngine::Core & ie, const std::string & deviceName, bool
     }
 }
 
+double Load::cost(InferenceEngine::Core & ie, const std::string & deviceName, bool enable_dynamic_batch, int runs) const {
+    if (!detector.enabled() || runs <= 0) {
+        return 0.0;
+    }
+    into(ie, deviceName, enable_dynamic_batch, {{PluginConfigParams::KEY_CPU_THROUGHPUT_STREAMS, "1"},
+                                                {PluginConfigParams::KEY_CPU_THREADS_NUM, "1"},
+                                                {PluginConfigParams::KEY_CPU_BIND_THREAD, PluginConfigParams::NO}});
+    InferRequest::Ptr request = detector.net.CreateInferRequestPtr();
+    // A dynamic batch runs as many faces as were found, so a single face is its typical cost
+    if (enable_dynamic_batch) {
+        request->SetBatch(1);
+    }
+    request->Infer();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < runs; ++i) {
+        request->Infer();
+    }
+    auto duration = std::chrono::high_resolution_clock::now() - start;
+    return std::chrono::duration_cast<CallStat::ms>(duration).count() / runs;
+}
+
 CallStat::CallStat():
     _number_of_calls(0), _total_duration(0.0), _last_call_duration(0.0), _smoothed_duration(-1.0) {
 }
@@ -7,17 +7,29 @@
 #include <utility>
 #include <list>
 #include <vector>
+#include <algorithm>
+#include <cmath>
 
 #include "face.hpp"
 
 Face::Face(size_t id, cv::Rect& location):
     _location(location), _intensity_mean(0.f), _id(id), _age(-1),
+    _ageGenderSamples(0), _ageSamplesMean(0.f), _ageSamplesM2(0.f), _framesSinceAgeGender(0),
     _maleScore(0), _femaleScore(0), _headPose({0.f, 0.f, 0.f}),
     _isAgeGenderEnabled(false), _isEmotionsEnabled(false), _isHeadPoseEnabled(false), _isLandmarksEnabled(false) {
 }
 
 void Face::updateAge(float value) {
-    _age = (_age == -1) ? value : 0.95f * _age + 0.05f * value;
+    // Plain average of the first estimates, as a cached face gets few of them
+    _ageGenderSamples++;
+    float alpha = std::max(0.05f, 1.f / _ageGenderSamples);
+    _age = (_age == -1) ? value : (1.f - alpha) * _age + alpha * value;
+
+    // Spread of the estimates, tells whether the age has converged
+    float delta = value - _ageSamplesMean;
+    _ageSamplesMean += delta / _ageGenderSamples;
+    _ageSamplesM2 += delta * (value - _ageSamplesMean);
+    _framesSinceAgeGender = 0;
 }
 
 void Face::updateGender(float value) {
@@ -49,6 +61,25 @@ void Face::updateLandmarks(std::vector<float> values) {
     _landmarks = std::move(values);
 }
 
+bool Face::isAgeGenderStale(const AttributeCachePolicy& policy) const {
+    if (policy.refreshInterval == 0 || _ageGenderSamples < std::max<size_t>(policy.minSamples, 2)) {
+        return true;
+    }
+    float ageStdDev = std::sqrt(_ageSamplesM2 / (_ageGenderSamples - 1));
+    if (ageStdDev > policy.maxAgeStdDev || std::fabs(_maleScore - _femaleScore) < policy.minGenderMargin) {
+        return true;
+    }
+    return _framesSinceAgeGender >= policy.refreshInterval;
+}
+
+bool Face::hasAgeGender() const {
+    return _ageGenderSamples > 0;
+}
+
+void Face::skipAgeGender() {
+    _framesSinceAgeGender++;
+}
+
 int Face::getAge() {
     return static_cast<int>(std::floor(_age + 0.5f));
 }
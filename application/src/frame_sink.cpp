@@ -0,0 +1,182 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <samples/slog.hpp>
+
+#include "frame_sink.hpp"
+
+namespace {
+// The window of the demo, ESC in it closes the sink
+class WindowSink : public FrameSink {
+public:
+    explicit WindowSink(const std::string &name) : _name(name), _opened(false), _closed(false) {}
+
+    ~WindowSink() override {
+        if (_opened) {
+            cv::destroyWindow(_name);
+        }
+    }
+
+    void write(const cv::Mat &frame) override {
+        if (!_opened) {
+            cv::namedWindow(_name, cv::WINDOW_NORMAL);
+            _opened = true;
+        }
+        cv::imshow(_name, frame);
+        if (cv::waitKey(1) == 27) {
+            _closed = true;
+        }
+    }
+
+    bool closed() const override { return _closed; }
+
+private:
+    std::string _name;
+    bool _opened;
+    bool _closed;
+};
+
+// Motion JPEG keeps the encoding cheap and every frame seekable
+class VideoFileSink : public FrameSink {
+public:
+    VideoFileSink(const std::string &path, double fps) : _path(path), _fps(fps) {}
+
+    void write(const cv::Mat &frame) override {
+        if (!_writer.isOpened()) {
+            _size = frame.size();
+            if (!_writer.open(_path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), _fps, _size)) {
+                slog::err << "Cannot create the video " << _path << slog::endl;
+                return;
+            }
+        }
+        if (frame.size() == _size) {
+            _writer.write(frame);
+        } else {
+            cv::Mat resized;
+            cv::resize(frame, resized, _size);
+            _writer.write(resized);
+        }
+    }
+
+private:
+    std::string _path;
+    double _fps;
+    cv::Size _size;
+    cv::VideoWriter _writer;
+};
+
+// Frames stay in the ring for a viewer process, the ring is sized for the first frame
+class SharedMemorySink : public FrameSink {
+public:
+    static const uint32_t slots = 4;
+
+    explicit SharedMemorySink(const std::string &name)
+        : _name(name[0] == '/' ? name : "/" + name), _fd(-1), _ring(nullptr), _size(0), _frames(0), _failed(false) {}
+
+    ~SharedMemorySink() override {
+        if (_ring) {
+            munmap(_ring, _size);
+            shm_unlink(_name.c_str());
+        }
+        if (_fd >= 0) {
+            close(_fd);
+        }
+    }
+
+    void write(const cv::Mat &frame) override {
+        if (_failed || (!_ring && !open(frame.size()))) {
+            return;
+        }
+        SharedFrameRing *header = static_cast<SharedFrameRing *>(_ring);
+        const cv::Size size(header->width, header->height);
+        SharedFrameSlot *slot = reinterpret_cast<SharedFrameSlot *>(
+            static_cast<uint8_t *>(_ring) + sizeof(SharedFrameRing) + (_frames % slots) * header->slotSize);
+        cv::Mat pixels(size, CV_8UC3, reinterpret_cast<uint8_t *>(slot) + sizeof(SharedFrameSlot));
+
+        slot->sequence.store(2 * _frames + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot->timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        if (frame.size() == size) {
+            frame.copyTo(pixels);
+        } else {
+            cv::resize(frame, pixels, size);
+        }
+        slot->sequence.store(2 * _frames + 2, std::memory_order_release);
+        header->written.store(++_frames, std::memory_order_release);
+    }
+
+private:
+    // A sink that cannot be opened reports it once and drops the frames, it is not retried per frame
+    bool open(const cv::Size &size) {
+        // The header and the slots are multiples of 64 bytes, so the sequence of every slot is on a cache line
+        // of its own
+        const uint32_t slotSize = (sizeof(SharedFrameSlot) + 3 * size.area() + 63) & ~63u;
+        _fd = shm_open(_name.c_str(), O_CREAT | O_RDWR, 0644);
+        _size = sizeof(SharedFrameRing) + slots * static_cast<size_t>(slotSize);
+        if (_fd < 0 || ftruncate(_fd, _size) != 0) {
+            slog::err << "Cannot create the shared memory " << _name << slog::endl;
+            return fail();
+        }
+        void *ring = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if (ring == MAP_FAILED) {
+            slog::err << "Cannot map the shared memory " << _name << slog::endl;
+            return fail();
+        }
+        _ring = ring;
+
+        // The object may be left over from an earlier run and mapped by a viewer, which must not take
+        // the header for valid while it is rewritten
+        SharedFrameRing *header = static_cast<SharedFrameRing *>(_ring);
+        header->magic = 0;
+        std::atomic_thread_fence(std::memory_order_release);
+        header->slots = slots;
+        header->width = size.width;
+        header->height = size.height;
+        header->slotSize = slotSize;
+        header->written.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = SHARED_FRAME_RING_MAGIC;
+        slog::info << "Writing the frames to the shared memory " << _name << slog::endl;
+        return true;
+    }
+
+    bool fail() {
+        if (_fd >= 0) {
+            close(_fd);
+            _fd = -1;
+        }
+        _failed = true;
+        return false;
+    }
+
+    std::string _name;
+    int _fd;
+    void *_ring;
+    size_t _size;
+    uint64_t _frames;
+    bool _failed;
+};
+}  // namespace
+
+std::unique_ptr<FrameSink> createFrameSink(const std::string &spec, double fps) {
+    static const std::string shm = "shm:";
+    static const std::string avi = ".avi";
+    if (spec == "window") {
+        return std::unique_ptr<FrameSink>(new WindowSink("Detection results"));
+    }
+    if (spec.compare(0, shm.size(), shm) == 0 && spec.size() > shm.size()) {
+        return std::unique_ptr<FrameSink>(new SharedMemorySink(spec.substr(shm.size())));
+    }
+    if (spec.size() > avi.size() && spec.compare(spec.size() - avi.size(), avi.size(), avi) == 0) {
+        return std::unique_ptr<FrameSink>(new VideoFileSink(spec, fps));
+    }
+    return nullptr;
+}
@@ -21,6 +21,9 @@
 #include <iterator>
 #include <map>
 #include <list>
+#include <thread>
+#include <cstdio>
+#include <sched.h>
 
 #include <inference_engine.hpp>
 
@@ -30,7 +33,12 @@
 #include "interactive_face_detection.hpp"
 #include "detectors.hpp"
 #include "face.hpp"
+#include "audience.hpp"
 #include "visualizer.hpp"
+#include "motion_gate.hpp"
+#include "detection_record.hpp"
+#include "frame_sink.hpp"
+#include "vm/thread_defs.h"
 
 #include <ie_iextension.h>
 //#include <ext_list.hpp>
@@ -39,11 +47,14 @@
 
 using namespace InferenceEngine;
 
-struct DemographicsStructure demographics[5];
-
 FaceDetection *faceDetector;
 AgeGenderDetection *ageGenderDetector;
 HeadPoseDetection *headPoseDetector;
+EmotionsDetection *emotionsDetector;
+FacialLandmarksDetection *facialLandmarksDetector;
+static std::unique_ptr<MotionGate> motionGate;
+static cv::Size faceTileSize;  // largest input of the face analytics networks
+static std::unique_ptr<FrameSink> frameSink;  // output of the annotated frames, none when headless
  
 //InferencePlugin plugin;
 
@@ -57,7 +68,7 @@ bool ParseAndCheckCommandLine(int argc, char *argv[]) {
     }
     slog::info << "Parsing input parameters" << slog::endl;
 
-    if (FLAGS_m.empty()) {
+    if (FLAGS_m.empty() && FLAGS_replay.empty()) {
         throw std::logic_error("Parameter -m is not set");
     }
 
@@ -69,6 +80,22 @@ bool ParseAndCheckCommandLine(int argc, char *argv[]) {
         throw std::logic_error("Parameter -n_hp cannot be 0");
     }
 
+    if (FLAGS_n_em < 1) {
+        throw std::logic_error("Parameter -n_em cannot be 0");
+    }
+
+    if (FLAGS_n_lm < 1) {
+        throw std::logic_error("Parameter -n_lm cannot be 0");
+    }
+
+    if (FLAGS_nms < 0.0 || FLAGS_nms > 1.0) {
+        throw std::logic_error("Parameter -nms must be in [0, 1]");
+    }
+
+    if (FLAGS_tile_overlap < 0.0 || FLAGS_tile_overlap >= 1.0) {
+        throw std::logic_error("Parameter -tile_overlap must be in [0, 1)");
+    }
+
     // no need to wait for a key press from a user if an output image/video file is not shown.
     FLAGS_no_wait |= FLAGS_no_show;
 
@@ -78,27 +105,112 @@ bool ParseAndCheckCommandLine(int argc, char *argv[]) {
 
 
 
-// Function to find the age Group in which the age of the person lies
-int GetAgeGroup(int age)
-{
-    int ageGrp = 0;
-    if(age > 0 && age < 14)
-        ageGrp = CHILD;
-    else   
-    if(age >= 14 && age < 29)
-        ageGrp = YOUNG_ADULT;
-    else   
-    if(age >=29 && age < 50)
-        ageGrp = ADULT;
-    else   
-    if(age >= 50 )
-        ageGrp = SENIOR;
 
-    return ageGrp;
+
+// Parses the -tiles grid, "<columns>x<rows>"
+static cv::Size parseTileGrid(const std::string &grid) {
+    int cols = 0, rows = 0;
+    char separator = 0, rest = 0;
+    if (sscanf(grid.c_str(), "%d%c%d%c", &cols, &separator, &rows, &rest) != 3 || separator != 'x' ||
+        cols < 1 || rows < 1) {
+        throw std::logic_error("Parameter -tiles must be given as <columns>x<rows>, but was " + grid);
+    }
+    return cv::Size(cols, rows);
 }
 
+// Parses the -tile_region, "<x>,<y>,<width>,<height>" in fractions of the frame size
+static cv::Rect2f parseTileRegion(const std::string &region) {
+    float x = 0.f, y = 0.f, w = 0.f, h = 0.f;
+    char rest = 0;
+    if (sscanf(region.c_str(), "%f,%f,%f,%f%c", &x, &y, &w, &h, &rest) != 4 ||
+        x < 0.f || y < 0.f || w <= 0.f || h <= 0.f || x + w > 1.001f || y + h > 1.001f) {
+        throw std::logic_error("Parameter -tile_region must be given as <x>,<y>,<width>,<height> inside [0, 1], "
+                               "but was " + region);
+    }
+    return cv::Rect2f(x, y, w, h);
+}
+
+// A network and the configuration it is loaded with
+struct NetworkToLoad {
+    BaseDetection* detector;
+    std::string deviceName;
+    bool dynamicBatch;
+    std::map<std::string, std::string> config;
+};
+
+// CPU plugin configuration of a network, empty options are left to the plugin
+static std::map<std::string, std::string> cpuNetworkConfig(const std::string& deviceName, uint32_t streams,
+                                                           uint32_t threadsPerStream, const std::string& bind) {
+    std::map<std::string, std::string> config;
+    if (deviceName != "CPU") {
+        return config;
+    }
+    if (streams) {
+        config[PluginConfigParams::KEY_CPU_THROUGHPUT_STREAMS] = std::to_string(streams);
+    }
+    if (threadsPerStream) {
+        config[PluginConfigParams::KEY_CPU_THREADS_NUM] = std::to_string(threadsPerStream * std::max(streams, 1u));
+    }
+    if (!bind.empty()) {
+        config[PluginConfigParams::KEY_CPU_BIND_THREAD] = bind;
+    }
+    return config;
+}
 
-int loadModel(int argc, char* argv[])
+// Splits the CPUs the inference thread may run on between the networks running on the CPU in proportion to the
+// cost of their requests measured on a single thread. Binding is disabled, as the plugin would bind the threads
+// of every network starting from the same core.
+static void splitCpuCores(Core& ie, NetworkToLoad networks[], size_t count) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    int cores = sched_getaffinity(0, sizeof(cpus), &cpus) ? (int)std::thread::hardware_concurrency() : CPU_COUNT(&cpus);
+
+    std::vector<double> costs(count, 0.0);
+    double total = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        if (networks[i].deviceName == "CPU" && networks[i].detector->enabled()) {
+            costs[i] = Load(*networks[i].detector).cost(ie, networks[i].deviceName, networks[i].dynamicBatch, 10);
+            slog::info << networks[i].detector->topoName << " request takes " << costs[i] << " ms on one CPU thread"
+                       << slog::endl;
+            total += costs[i];
+        }
+    }
+    if (total <= 0.0) {
+        return;
+    }
+
+    // Every network gets at least one core, the cores left by rounding down go to the network
+    // with the highest cost per thread
+    std::vector<int> threads(count, 0);
+    int assigned = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (costs[i] > 0.0) {
+            threads[i] = std::max(1, (int)(cores * costs[i] / total));
+            assigned += threads[i];
+        }
+    }
+    for (; assigned < cores; ++assigned) {
+        size_t busiest = 0;
+        for (size_t i = 1; i < count; ++i) {
+            if (threads[i] && (!threads[busiest] || costs[i] / threads[i] > costs[busiest] / threads[busiest])) {
+                busiest = i;
+            }
+        }
+        ++threads[busiest];
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (threads[i]) {
+            networks[i].config = {{PluginConfigParams::KEY_CPU_THROUGHPUT_STREAMS, "1"},
+                                  {PluginConfigParams::KEY_CPU_THREADS_NUM, std::to_string(threads[i])},
+                                  {PluginConfigParams::KEY_CPU_BIND_THREAD, PluginConfigParams::NO}};
+            slog::info << networks[i].detector->topoName << " gets " << threads[i] << " of " << cores
+                       << " CPU threads" << slog::endl;
+        }
+    }
+}
+
+int loadModel(int argc, char* argv[], bool nv12Input)
     try {
         std::cout << "InferenceEngine: " << GetInferenceEngineVersion() << std::endl;
 
@@ -106,6 +218,23 @@ int loadModel(int argc, char* argv[])
         if (!ParseAndCheckCommandLine(argc, argv)) {
             return 0;
         }
+        setAudienceOptions({!FLAGS_no_smooth, {5, static_cast<float>(FLAGS_ag_age_stddev), 1.f, FLAGS_ag_refresh},
+                            !FLAGS_m_em.empty(), !FLAGS_m_lm.empty()});
+
+        // A replay runs no network
+        if (!FLAGS_replay.empty()) {
+            return 0;
+        }
+
+        // The annotated frames go to the window unless another sink is given, HighGUI is not used otherwise
+        if (!FLAGS_sink.empty()) {
+            frameSink = createFrameSink(FLAGS_sink, FLAGS_fps > 0 ? FLAGS_fps : 30.0);
+            if (!frameSink) {
+                throw std::logic_error("Parameter -sink must be window, <path>.avi or shm:<name>");
+            }
+        } else if (!FLAGS_no_show) {
+            frameSink = createFrameSink("window", 0);
+        }
         
         // ---------------------------------------------------------------------------------------------------
         // --------------------------- 1. Loading plugin to the Inference Engine -----------------------------
@@ -115,7 +244,9 @@ int loadModel(int argc, char* argv[])
         std::pair<std::string, std::string> cmdOptions[] = {
             {FLAGS_d, FLAGS_m},
             {FLAGS_d_ag, FLAGS_m_ag},
-            {FLAGS_d_hp, FLAGS_m_hp}
+            {FLAGS_d_hp, FLAGS_m_hp},
+            {FLAGS_d_em, FLAGS_m_em},
+            {FLAGS_d_lm, FLAGS_m_lm}
         };
         
         faceDetector = new FaceDetection(FLAGS_m, FLAGS_d, 1, false, FLAGS_async, FLAGS_t, FLAGS_r,
@@ -125,6 +256,22 @@ int loadModel(int argc, char* argv[])
                                                     FLAGS_r);
         headPoseDetector = new HeadPoseDetection(FLAGS_m_hp, FLAGS_d_hp, FLAGS_n_hp, FLAGS_dyn_hp, FLAGS_async,
                                                     FLAGS_r);
+        emotionsDetector = new EmotionsDetection(FLAGS_m_em, FLAGS_d_em, FLAGS_n_em, FLAGS_dyn_em, FLAGS_async,
+                                                 FLAGS_r);
+        facialLandmarksDetector = new FacialLandmarksDetection(FLAGS_m_lm, FLAGS_d_lm, FLAGS_n_lm, FLAGS_dyn_lm,
+                                                               FLAGS_async, FLAGS_r);
+        faceDetector->nv12Input = nv12Input;
+        faceDetector->nmsThreshold = static_cast<float>(FLAGS_nms);
+        if (!FLAGS_tiles.empty()) {
+            faceDetector->tileGrid = parseTileGrid(FLAGS_tiles);
+            faceDetector->tileOverlap = static_cast<float>(FLAGS_tile_overlap);
+            if (!FLAGS_tile_region.empty()) {
+                faceDetector->tileRegion = parseTileRegion(FLAGS_tile_region);
+            }
+        }
+        if (FLAGS_motion) {
+            motionGate.reset(new MotionGate(FLAGS_motion_idle, static_cast<float>(FLAGS_motion_threshold)));
+        }
        
         for (auto && option : cmdOptions) {
             auto deviceName = option.first;
@@ -152,6 +299,14 @@ int loadModel(int argc, char* argv[])
                     slog::info << "CPU Extension loaded: " << FLAGS_l << slog::endl;
                 }
             }*/
+            msdkThreadPlacement placement;
+            if (deviceName.find("CPU") != std::string::npos && msdk_thread_get_placement("inference", placement) &&
+                !placement.cpus.empty()) {
+                // The CPU plugin pool inherits the CPUs of the inference thread, so size it to them and keep it
+                // from re-pinning its threads over the whole machine
+                ie.SetConfig({{PluginConfigParams::KEY_CPU_THREADS_NUM, std::to_string(placement.cpus.size())},
+                              {PluginConfigParams::KEY_CPU_BIND_THREAD, PluginConfigParams::NO}}, "CPU");
+            }
             if (!FLAGS_c.empty()) {
                 // Loading extensions for GPU
                  ie.SetConfig({{PluginConfigParams::KEY_CONFIG_FILE, FLAGS_c}}, "GPU");
@@ -167,9 +322,38 @@ int loadModel(int argc, char* argv[])
 
         // --------------------------- 2. Reading IR models and loading them to plugins ----------------------
         // Disable dynamic batching for face detector as it processes one image at a time
-        Load(*faceDetector).into(ie, FLAGS_d, false);
-        Load(*ageGenderDetector).into(ie, FLAGS_d_ag, FLAGS_dyn_ag);
-        Load(*headPoseDetector).into(ie, FLAGS_d_hp, FLAGS_dyn_hp);
+        NetworkToLoad networks[] = {
+            {faceDetector, FLAGS_d, false, cpuNetworkConfig(FLAGS_d, FLAGS_nstreams, FLAGS_nthreads, FLAGS_pin)},
+            {ageGenderDetector, FLAGS_d_ag, FLAGS_dyn_ag,
+             cpuNetworkConfig(FLAGS_d_ag, FLAGS_nstreams_ag, FLAGS_nthreads_ag, FLAGS_pin_ag)},
+            {headPoseDetector, FLAGS_d_hp, FLAGS_dyn_hp,
+             cpuNetworkConfig(FLAGS_d_hp, FLAGS_nstreams_hp, FLAGS_nthreads_hp, FLAGS_pin_hp)},
+            {emotionsDetector, FLAGS_d_em, FLAGS_dyn_em,
+             cpuNetworkConfig(FLAGS_d_em, FLAGS_nstreams_em, FLAGS_nthreads_em, FLAGS_pin_em)},
+            {facialLandmarksDetector, FLAGS_d_lm, FLAGS_dyn_lm,
+             cpuNetworkConfig(FLAGS_d_lm, FLAGS_nstreams_lm, FLAGS_nthreads_lm, FLAGS_pin_lm)}
+        };
+        if (FLAGS_cpu_auto) {
+            splitCpuCores(ie, networks, sizeof(networks) / sizeof(networks[0]));
+        }
+        for (auto && network : networks) {
+            Load(*network.detector).into(ie, network.deviceName, network.dynamicBatch, network.config);
+        }
+        for (BaseDetection *detector : {static_cast<BaseDetection *>(ageGenderDetector),
+                                        static_cast<BaseDetection *>(headPoseDetector),
+                                        static_cast<BaseDetection *>(emotionsDetector),
+                                        static_cast<BaseDetection *>(facialLandmarksDetector)}) {
+            if (!detector->enabled()) {
+                continue;
+            }
+            for (const auto &inputInfo : detector->net.GetInputsInfo()) {
+                const SizeVector dims = inputInfo.second->getTensorDesc().getDims();
+                if (dims.size() == 4) {
+                    faceTileSize.width = std::max(faceTileSize.width, static_cast<int>(dims[3]));
+                    faceTileSize.height = std::max(faceTileSize.height, static_cast<int>(dims[2]));
+                }
+            }
+        }
         if(FLAGS_async == 0)
             std::cout<<"Application running in sync mode"<<std::endl;
         else
@@ -178,6 +362,8 @@ int loadModel(int argc, char* argv[])
             faceDetector->isAsync = true;
             ageGenderDetector->isAsync = true;
             headPoseDetector->isAsync = true;
+            emotionsDetector->isAsync = true;
+            facialLandmarksDetector->isAsync = true;
         }
         return 0;
         // ----------------------------------------------------------------------------------------------------
@@ -192,61 +378,189 @@ int loadModel(int argc, char* argv[])
     }
 
 
-int analysePeople(cv::Mat frame) {
+// The analysis below runs either on BGR frames from OpenCV capture or on NV12 pictures decoded by
+// Media SDK. These two wrappers hide how faces are detected, where the crops for the face analytics
+// networks come from and what picture the results are drawn on.
+struct BGRFrame {
+    cv::Mat frame;
+
+    int cols() const { return frame.cols; }
+    int rows() const { return frame.rows; }
+
+    void detectFaces(Timer &timer) const {
+        // Detecting all faces on the first frame and reading the next one
+        faceDetector->enqueue(frame);
+        faceDetector->submitRequest();
+
+        if(faceDetector->isAsync)
+            faceDetector->swapRequests();
+        timer.start("total");
+        faceDetector->enqueue(frame);
+        faceDetector->submitRequest();
+        faceDetector->wait();
+        faceDetector->fetchResults();
+    }
+
+    cv::Mat crop(const cv::Rect &rect) const { return frame(rect); }
+    float mean(const cv::Rect &rect) const { return calcMean(frame(rect)); }
+
+    // Downscaling first leaves few pixels to convert
+    cv::Mat luma(const cv::Size &size) const {
+        cv::Mat small, gray;
+        cv::resize(frame, small, size, 0, 0, cv::INTER_AREA);
+        cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+        return gray;
+    }
+    cv::Mat display() const { return frame; }
+};
+
+struct NV12Frame {
+    cv::Mat y;   // full resolution luma
+    cv::Mat uv;  // interleaved chroma, half resolution in both directions
+
+    int cols() const { return y.cols; }
+    int rows() const { return y.rows; }
+
+    void detectFaces(Timer &timer) const {
+        // The planes belong to a decoder surface, so the request reading them must be
+        // finished before returning. There is a single submission per frame.
+        timer.start("total");
+        faceDetector->enqueue(y, uv);
+        faceDetector->submitRequest();
+        if(faceDetector->isAsync)
+            faceDetector->swapRequests();
+        faceDetector->wait();
+        faceDetector->fetchResults();
+    }
+
+    // Only the face region is converted to BGR. Chroma is subsampled 2x2,
+    // so the region is widened to even coordinates.
+    cv::Mat crop(const cv::Rect &rect) const {
+        int x0 = rect.x & ~1;
+        int y0 = rect.y & ~1;
+        int x1 = std::min((rect.x + rect.width + 1) & ~1, y.cols & ~1);
+        int y1 = std::min((rect.y + rect.height + 1) & ~1, y.rows & ~1);
+        cv::Mat bgr;
+        if (x1 > x0 && y1 > y0) {
+            cv::cvtColorTwoPlane(y(cv::Rect(x0, y0, x1 - x0, y1 - y0)),
+                                 uv(cv::Rect(x0 / 2, y0 / 2, (x1 - x0) / 2, (y1 - y0) / 2)),
+                                 bgr, cv::COLOR_YUV2BGR_NV12);
+        }
+        return bgr;
+    }
+
+    // Luma is what calcMean() computes from BGR anyway
+    float mean(const cv::Rect &rect) const { return static_cast<float>(cv::mean(y(rect))[0]); }
+
+    cv::Mat luma(const cv::Size &size) const {
+        cv::Mat small;
+        cv::resize(y, small, size, 0, 0, cv::INTER_AREA);
+        return small;
+    }
+
+    cv::Mat display() const {
+        cv::Mat bgr;
+        cv::cvtColorTwoPlane(y, uv, bgr, cv::COLOR_YUV2BGR_NV12);
+        return bgr;
+    }
+};
+
+// Optional recording of the inference results, opened by the first analysed frame so that the playback
+// process forked after the models are loaded does not inherit it
+static std::unique_ptr<DetectionRecorder> recorder;
+static bool adFinished = false;  // stored with the next recorded frame
+
+template <typename Frame>
+static int analyseFrame(const Frame &input) {
+        CTraceSpan frameSpan("Analyse frame");
         Timer timer;
-        static int frameCount = 0, dataCount = 0;
-        if(dataCount == 5 && frameCount % 5 == 0)
-            dataCount = 0;
-        
-        if(frameCount % 5 == 0)
-        {
-            demographics[dataCount] = {0};
+        const auto analysed = std::chrono::system_clock::now();
+        if (!FLAGS_record.empty() && !recorder) {
+            recorder.reset(new DetectionRecorder);
+            if (!recorder->open(FLAGS_record)) {
+                slog::err << "Cannot create the recording " << FLAGS_record << slog::endl;
+                return 1;
+            }
         }
+        beginDemographics();
 
-        cv::namedWindow("Detection results", cv::WINDOW_NORMAL );
-        
-        const size_t width  = static_cast<size_t>(frame.cols);
-        const size_t height = static_cast<size_t>(frame.rows);
+        const size_t width  = static_cast<size_t>(input.cols());
+        const size_t height = static_cast<size_t>(input.rows());
 
                 // --------------------------- 3. Doing inference -----------------------------------------------------
         // Starting inference & calculating performance
         bool isFaceAnalyticsEnabled = ageGenderDetector->enabled() || headPoseDetector->enabled();
 
         std::ostringstream out;
-        int delay = 1;
-        double msrate = -1;
-        static std::list<Face::Ptr> faces;
-        size_t id = 0;
         Visualizer::Ptr visualizer;
         
-        if (!FLAGS_no_show) {
+        if (frameSink) {
             visualizer = std::make_shared<Visualizer>(cv::Size(width, height));
+            if (emotionsDetector->enabled()) {
+                visualizer->enableEmotionBar(emotionsDetector->emotionsVec);
+            }
         }
-        // Detecting all faces on the first frame and reading the next one
-        faceDetector->enqueue(frame);
-        faceDetector->submitRequest();
-        
-        if(faceDetector->isAsync)
-            faceDetector->request.swap(faceDetector->nxtrequest);
-        timer.start("total");
-        faceDetector->enqueue(frame);
-        faceDetector->submitRequest();
-        faceDetector->wait();
-        faceDetector->fetchResults();
-        auto prev_detection_results = faceDetector->results;
-        
-        // Filling inputs of face analytics networks
-        for (auto &&face : prev_detection_results) {
-            if (isFaceAnalyticsEnabled) {
-                auto clippedRect = face.location & cv::Rect(0, 0, width, height);
-                cv::Mat face = frame(clippedRect);
-                ageGenderDetector->enqueue(face);
-                headPoseDetector->enqueue(face);
+        // On a static scene without tracked faces the detection is throttled, there are no faces then
+        std::vector<FaceDetection::Result> prev_detection_results;
+        const bool detected = !motionGate ||
+                              motionGate->update(input.luma(MotionGate::lumaSize(input.cols(), input.rows())),
+                                                 !trackedFaces().empty());
+        if (detected) {
+            input.detectFaces(timer);
+            prev_detection_results = faceDetector->results;
+            faceDetector->inferredItems++;
+            if (motionGate) {
+                motionGate->detectionDone();
+            }
+        } else {
+            timer.start("total");
+            faceDetector->skippedItems++;
+        }
+
+        // The recording needs the brightness of the faces as well, the replay tracks them with it
+        std::vector<cv::Rect> rects;
+        std::vector<float> intensities;
+        for (auto &&result : prev_detection_results) {
+            rects.push_back(result.location & cv::Rect(0, 0, width, height));
+            intensities.push_back(!FLAGS_no_smooth || recorder ? input.mean(rects.back()) : 0.f);
+        }
+        std::vector<Face::Ptr> tracked_faces = trackFaces(rects, intensities);
+
+        // Every face is extracted once, when a network first needs it, and shared by all face analytics networks
+        std::vector<FaceCrop> faceCrops(prev_detection_results.size());
+        auto faceCrop = [&](size_t i) -> FaceCrop & {
+            if (faceCrops[i].empty()) {
+                CTraceSpan span("Face crop");
+                faceCrops[i].extract(input.crop(rects[i]), faceTileSize);
+            }
+            return faceCrops[i];
+        };
+
+        // Filling inputs of face analytics networks. Age/Gender only gets the faces whose cached results
+        // are stale, ageGenderIndex maps a detected face to its index in the batch, -1 if it was not enqueued.
+        const AttributeCachePolicy &ageGenderPolicy = getAudienceOptions().ageGender;
+        std::vector<int> ageGenderIndex(prev_detection_results.size(), -1);
+        if (isFaceAnalyticsEnabled) {
+            int enqueued = 0;
+            for (size_t i = 0; i < prev_detection_results.size(); i++) {
+                if (ageGenderDetector->enabled()) {
+                    if (tracked_faces[i]->isAgeGenderStale(ageGenderPolicy)) {
+                        ageGenderDetector->enqueue(faceCrop(i));
+                        ageGenderDetector->inferredItems++;
+                        ageGenderIndex[i] = enqueued++;
+                    } else {
+                        tracked_faces[i]->skipAgeGender();
+                        ageGenderDetector->skippedItems++;
+                    }
+                }
+                if (headPoseDetector->enabled()) {
+                    headPoseDetector->enqueue(faceCrop(i));
+                    headPoseDetector->inferredItems++;
+                }
             }
         }
 
-        // Running Age/Gender Recognition, Head Pose Estimation, Emotions Recognition, and Facial Landmarks Estimation
-        // networks simultaneously
+        // Running Age/Gender Recognition and Head Pose Estimation networks simultaneously
         if (isFaceAnalyticsEnabled) {
             ageGenderDetector->submitRequest();
             headPoseDetector->submitRequest();
@@ -263,77 +577,110 @@ int analysePeople(cv::Mat frame) {
             headPoseDetector->wait();
         }
 
-        //  Postprocessing
-        std::list<Face::Ptr> prev_faces;
+        // Emotions and landmarks are a second stage gated by the head pose: only the faces looking at the
+        // screen are batched into their requests, unless gating is disabled or there is no head pose.
+        // gatedIndex maps a detected face to its index in the second stage batch, -1 if it was not enqueued.
+        bool isEngagementEnabled = emotionsDetector->enabled() || facialLandmarksDetector->enabled();
+        std::vector<int> gatedIndex(prev_detection_results.size(), -1);
+        if (isEngagementEnabled) {
+            bool isGated = !FLAGS_no_gate && headPoseDetector->enabled();
+            int enqueued = 0;
+            for (size_t i = 0; i < prev_detection_results.size(); i++) {
+                bool isEngaged = !isGated ||
+                                 (i < headPoseDetector->maxBatch && isLookingAtScreen((*headPoseDetector)[i]));
+                for (BaseDetection *detector : {static_cast<BaseDetection *>(emotionsDetector),
+                                                static_cast<BaseDetection *>(facialLandmarksDetector)}) {
+                    if (detector->enabled()) {
+                        (isEngaged ? detector->inferredItems : detector->skippedItems)++;
+                    }
+                }
+                if (!isEngaged) {
+                    continue;
+                }
+                FaceCrop &face = faceCrop(i);
+                emotionsDetector->enqueue(face);
+                facialLandmarksDetector->enqueue(face);
+                gatedIndex[i] = enqueued++;
+            }
 
-        if (!FLAGS_no_smooth) {
-            prev_faces.insert(prev_faces.begin(), faces.begin(), faces.end());
+            emotionsDetector->submitRequest();
+            facialLandmarksDetector->submitRequest();
+            if(emotionsDetector->isAsync)
+                emotionsDetector->request.swap(emotionsDetector->nxtrequest);
+            if(facialLandmarksDetector->isAsync)
+                facialLandmarksDetector->request.swap(facialLandmarksDetector->nxtrequest);
+            emotionsDetector->wait();
+            facialLandmarksDetector->wait();
         }
 
-        faces.clear();
-
+        //  Postprocessing
         // For every detected face
+        const mfxI64 postprocessing = msdk_trace_begin();
+        std::vector<RecordedFace> recordedFaces;
+        // The results are gathered as they are recorded and the face updated from them like on replay
         for (size_t i = 0; i < prev_detection_results.size(); i++) {
-            auto& result = prev_detection_results[i];
-            cv::Rect rect = result.location & cv::Rect(0, 0, width, height);
-
-            Face::Ptr face;
-            if (!FLAGS_no_smooth) {
-                face = matchFace(rect, prev_faces);
-                float intensity_mean = calcMean(frame(rect));
-
-                if ((face == nullptr) ||
-                    ((face != nullptr) && ((std::abs(intensity_mean - face->_intensity_mean) / face->_intensity_mean)
-                     > 0.07f))) {
-                    face = std::make_shared<Face>(id++, rect);
-                } else {
-                    prev_faces.remove(face);
-                }
-
-                face->_intensity_mean = intensity_mean;
-                face->_location = rect;
-            } else {
-                face = std::make_shared<Face>(id++, rect);
+            Face::Ptr face = tracked_faces[i];
+            RecordedFace recorded = {static_cast<int16_t>(rects[i].x), static_cast<int16_t>(rects[i].y),
+                                     static_cast<int16_t>(rects[i].width), static_cast<int16_t>(rects[i].height),
+                                     prev_detection_results[i].confidence, intensities[i],
+                                     0.f, 0.f, 0.f, 0.f, 0.f, {0.f}, 0};
+
+            int ageGender = ageGenderIndex[i];
+            if (ageGender >= 0 && static_cast<size_t>(ageGender) < ageGenderDetector->maxBatch) {
+                AgeGenderDetection::Result ageGenderResult = (*ageGenderDetector)[ageGender];
+                recorded.age = ageGenderResult.age;
+                recorded.maleProb = ageGenderResult.maleProb;
+                recorded.flags |= RECORDED_AGE_GENDER;
             }
 
-            face->ageGenderEnable((ageGenderDetector->enabled() &&
-                                   i < ageGenderDetector->maxBatch));
-            if (face->isAgeGenderEnabled()) {
-                AgeGenderDetection::Result ageGenderResult = (*ageGenderDetector)[i];
-                face->updateGender(ageGenderResult.maleProb);
-                face->updateAge(ageGenderResult.age);
-                if(frameCount % 5 == 0) {
-                    if (ageGenderResult.maleProb > 0.5) {
-                        demographics[dataCount].male.count++;
-                        int ageRange = GetAgeGroup(ageGenderResult.age);
-                        demographics[dataCount].male.ageGroup[ageRange]++;
-                    } else {
-                        demographics[dataCount].female.count++;
-                        int ageRange = GetAgeGroup(ageGenderResult.age);
-                        demographics[dataCount].female.ageGroup[ageRange]++;
-                    }
-                }
-                
+            if (headPoseDetector->enabled() && i < headPoseDetector->maxBatch) {
+                HeadPoseDetection::Results headPose = (*headPoseDetector)[i];
+                recorded.yaw = headPose.angle_y;
+                recorded.pitch = headPose.angle_p;
+                recorded.roll = headPose.angle_r;
+                recorded.flags |= RECORDED_HEAD_POSE;
             }
 
-            face->headPoseEnable((headPoseDetector->enabled() &&
-                                  i < headPoseDetector->maxBatch));
-            if (face->isHeadPoseEnabled()) {
-                face->updateHeadPose((*headPoseDetector)[i]);
-                if((*headPoseDetector)[i].angle_y > -30 && (*headPoseDetector)[i].angle_y < 30)
-                {
-                    demographics[dataCount].interestedCount++;
-                }
-                else
-                {
-                    out<<" not interested ";
+            int gated = gatedIndex[i];
+            if (emotionsDetector->enabled() && gated >= 0 && static_cast<size_t>(gated) < emotionsDetector->maxBatch) {
+                std::map<std::string, float> emotions = (*emotionsDetector)[gated];
+                for (size_t e = 0; e < EmotionsDetection::emotionsVec.size(); ++e) {
+                    recorded.emotions[e] = emotions[EmotionsDetection::emotionsVec[e]];
                 }
+                recorded.flags |= RECORDED_EMOTIONS;
+            }
+            if (facialLandmarksDetector->enabled() && gated >= 0 &&
+                static_cast<size_t>(gated) < facialLandmarksDetector->maxBatch) {
+                recorded.flags |= RECORDED_LANDMARKS;
             }
 
-            faces.push_back(face);
-            cv::rectangle(frame, result.location, cv::Scalar(0, 0, 255), 1);
+            updateFace(face, recorded);
+            if (face->isLandmarksEnabled()) {
+                face->updateLandmarks((*facialLandmarksDetector)[gated]);
+            }
+            addFace(face);
+            recordedFaces.push_back(recorded);
         }
-        if (!FLAGS_no_show) {
+        msdk_trace_end("Postprocessing", postprocessing);
+        if (recorder) {
+            RecordedFrame recorded = {
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                    analysed.time_since_epoch()).count()),
+                static_cast<uint16_t>(width), static_cast<uint16_t>(height),
+                static_cast<uint16_t>(recordedFaces.size()),
+                static_cast<uint16_t>((detected ? RECORDED_DETECTED : 0) | (adFinished ? RECORDED_AD_FINISHED : 0) |
+                                      recordedNetworks())};
+            recorder->write(recorded, recordedFaces);
+            adFinished = false;
+        }
+        if (frameSink) {
+            CTraceSpan span("Draw and output");
+            // For NV12 input this is the only full frame color conversion
+            cv::Mat frame = input.display();
+            for (auto &&result : prev_detection_results) {
+                cv::rectangle(frame, result.location, cv::Scalar(0, 0, 255), 1);
+            }
+
             out.str("");
             out << "Total image throughput: " << std::fixed << std::setprecision(2)
                 << 1000.f / (timer["total"].getSmoothedDuration()) << " fps";
@@ -341,22 +688,15 @@ int analysePeople(cv::Mat frame) {
                         cv::Scalar(255, 0, 0), 2);
 
             // drawing faces
-            visualizer->draw(frame, faces);
+            visualizer->draw(frame, trackedFaces());
 
-            if (!FLAGS_no_show) {
-                cv::imshow("Detection results", frame);
-                cv::waitKey(1);
-            }
+            frameSink->write(frame);
         }
 
         timer.finish("total");
 
-        if(frameCount % 5 == 0)
-        {
-            demographics[dataCount].peopleCount = prev_detection_results.size();
-            dataCount++;
-        }
-        
+        endDemographics(prev_detection_results.size());
+
         // Showing performance results
         if (FLAGS_pc) {
             //faceDetector->printPerformanceCounts(getFullDeviceName(ie, FLAGS_d));
@@ -364,6 +704,58 @@ int analysePeople(cv::Mat frame) {
             //headPoseDetector->printPerformanceCounts(getFullDeviceName(ie, FLAGS_d_hp));
         }
         // ---------------------------------------------------------------------------------------------------
-        frameCount++;
     return 0;
 }
+
+std::vector<InferenceCounters> getInferenceCounters() {
+    std::vector<InferenceCounters> counters;
+    for (BaseDetection *detector : {static_cast<BaseDetection *>(faceDetector),
+                                    static_cast<BaseDetection *>(ageGenderDetector),
+                                    static_cast<BaseDetection *>(headPoseDetector),
+                                    static_cast<BaseDetection *>(emotionsDetector),
+                                    static_cast<BaseDetection *>(facialLandmarksDetector)}) {
+        if (detector && detector->enabled()) {
+            counters.push_back({detector->topoName, detector->inferredItems, detector->skippedItems,
+                                detector->latency});
+        }
+    }
+    return counters;
+}
+
+bool getMotionGateStats(MotionGate::Stats &stats) {
+    if (!motionGate) {
+        return false;
+    }
+    stats = motionGate->stats();
+    return true;
+}
+
+int analysePeople(cv::Mat frame) {
+    return analyseFrame(BGRFrame{frame});
+}
+
+int analysePeople(const cv::Mat &y, const cv::Mat &uv) {
+    return analyseFrame(NV12Frame{y, uv});
+}
+
+bool quitRequested() {
+    return frameSink && frameSink->closed();
+}
+
+void finishAnalysis() {
+    // In asynchronous mode the detection of the next frame is in flight
+    if (faceDetector && faceDetector->isAsync && faceDetector->nxtrequest) {
+        faceDetector->swapRequests();
+        faceDetector->wait();
+    }
+    recorder.reset();
+    frameSink.reset();
+}
+
+void markAdFinished() {
+    adFinished = true;
+}
+
+std::string getReplayFile() {
+    return FLAGS_replay;
+}
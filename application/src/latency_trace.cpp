@@ -0,0 +1,51 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "latency_trace.hpp"
+
+static double toMilliseconds(msdk_tick from, msdk_tick to) {
+    return to > from ? (to - from) * 1000.0 / msdk_time_get_frequency() : 0.0;
+}
+
+double AdPlayback::fps() const {
+    return frames > 1 && lastRendered > firstRendered
+        ? (frames - 1) * static_cast<double>(msdk_time_get_frequency()) / (lastRendered - firstRendered) : 0.0;
+}
+
+LatencyReport::Hops LatencyReport::add(const AdAck &ack) {
+    const AdTrace &trace = ack.trace;
+    Hops hops;
+    hops.analysis = toMilliseconds(trace.frame.captured, trace.frame.analysed);
+    hops.aggregation = toMilliseconds(trace.frame.analysed, trace.aggregated);
+    hops.decision = toMilliseconds(trace.aggregated, trace.decided);
+    hops.request = toMilliseconds(trace.decided, trace.sent);
+    const msdk_tick rendered = ack.playback.firstRendered;
+    hops.playback = toMilliseconds(trace.sent, rendered);
+    hops.total = toMilliseconds(trace.frame.captured, rendered ? rendered : trace.sent);
+
+    _analysis.AddValue(hops.analysis);
+    _aggregation.AddValue(hops.aggregation);
+    _decision.AddValue(hops.decision);
+    _request.AddValue(hops.request);
+    if (rendered) {
+        _playback.AddValue(hops.playback);
+    }
+    _total.AddValue(hops.total);
+    return hops;
+}
+
+void LatencyReport::print() const {
+    if (!_total.GetCount()) {
+        return;
+    }
+    msdk_printf(MSDK_STRING("\nLatency from a captured frame to the ad it influenced:\n"));
+    _total.PrintSummary(MSDK_STRING("  end to end: "));
+    _analysis.PrintSummary(MSDK_STRING("  analysis:   "));
+    _aggregation.PrintSummary(MSDK_STRING("  aggregation:"));
+    _decision.PrintSummary(MSDK_STRING("  decision:   "));
+    _request.PrintSummary(MSDK_STRING("  request:    "));
+    if (_playback.GetCount()) {
+        _playback.PrintSummary(MSDK_STRING("  playback:   "));
+    }
+}
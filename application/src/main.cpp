@@ -24,27 +24,158 @@
 #include <fcntl.h>
 #include "influxdb.h"
 #include "main.hpp"
+#include "decode_frame_source.h"
+#include "capture_source.h"
+#include "metrics_server.hpp"
+#include "trace_events.h"
+#include "vm/thread_defs.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <chrono>
 # include <unistd.h>
+#include <sys/wait.h>
 #include <nlohmann/json.hpp>
-// Macros defining which address in "pCount" variable contains what data
-// pCount variable contains the demographics data
-#define NO_OF_PEOPLE 0
-#define NO_OF_MALE 1
-#define NO_OF_FEMALE 2
-#define NO_OF_PEOPLE_INTERESTED 3
 using namespace cv;
 using json = nlohmann::json;
 json jsonobj;
 
 
-// Store the gender and age group based on which the ad will play
-struct playAdForData 
+// State of the ad selection, kept between the ads
+struct AdSelection
 {
-    char gender;
-    unsigned int ageGroup;
+    float pCount[4] = {0.0f};
+    // Default gender and age group for which ad needs to be played if any error occurs
+    // or if their is no person in front of digital signage
+    struct playAdForData genderAgeData = {'M',2};
+    std::string adToPlay;
+    std::string previousAd;
+    // Frame behind the latest decision and the times it was taken at
+    AdTrace trace = {};
+};
+
+// Databases the data is written to, a replay writes to databases of its own
+std::string demographicsDB = "Demographics";
+std::string adDataDB = "AdData";
+
+// Time of the points written in nanoseconds since the epoch, 0 for the time they are written at
+long long pointTime = 0;
+
+// Counters behind the metrics endpoint, updated by the analytics process
+struct PipelineMetrics
+{
+    unsigned long long framesAnalysed = 0;
+    unsigned long long adsPlayed = 0;
+    double playbackFps = 0;            // of the latest ad played
+    unsigned long long influxWrites = 0;
+    CLatencyHistogram influxWriteTime; // ms per point written, the writes are synchronous
 };
+PipelineMetrics metrics;
+
+// Set by SIGTERM and SIGINT, the main loop then stops after the current frame
+volatile sig_atomic_t stopRequested = 0;
+
+void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+// SIGUSR1 writes the trace events recorded so far, the playback process also writes them on SIGTERM
+void requestTraceDump(int)
+{
+    msdk_trace_request_dump();
+}
+
+void dumpTraceAndExit(int)
+{
+    msdk_trace_request_dump(EXIT_SUCCESS);
+}
+
+
+
+/*
+* Connection to InfluxDB shared by all writes, each connection opens the log file
+*
+* @return InfluxDB connection
+*/
+influx::InfluxDB& influxDB()
+{
+    static influx::InfluxDB db;
+    return db;
+}
+
+
+
+/*
+* Write a point to an InfluxDB database and exit on failure
+*
+* @param Name of the database
+* @param Point to write, it gets the time set by pointTime if any
+*/
+void writePoint(const std::string& dbName, influx::Data& data)
+{
+    if (pointTime != 0)
+        data.add_timestamp(pointTime);
+    CTraceSpan span("InfluxDB write");
+    msdk_tick start = msdk_time_get_tick();
+    if (influxDB().write_point(dbName, data) == -1)
+    {
+        std::cout<<"Error writing data to InfluxDB "<<dbName<<std::endl;
+        exit(0);
+    }
+    metrics.influxWrites++;
+    metrics.influxWriteTime.AddValue((msdk_time_get_tick() - start) * 1000.0 / msdk_time_get_frequency());
+}
+
+
+
+/*
+* Publish the counters of the pipeline to the metrics endpoint
+*
+* @param Server of the endpoint
+* @param Capture source of the input, NULL if it is not captured
+* @param Latencies of the ads played
+*/
+void publishMetrics(MetricsServer& server, const CCaptureSource* captureSource, const LatencyReport& latencyReport)
+{
+    CTraceSpan span("Publish metrics");
+    PrometheusText page;
+    page.family("kiosk_frames_analysed_total", "counter", "Frames of the input analysed.");
+    page.sample("kiosk_frames_analysed_total", (double)metrics.framesAnalysed);
+    if (captureSource)
+    {
+        page.family("kiosk_frames_dropped_total", "counter", "Frames dropped by the capture device as no buffer was free.");
+        page.sample("kiosk_frames_dropped_total", (double)captureSource->GetDroppedFrames());
+        page.family("kiosk_capture_queue_frames", "gauge", "Frames captured and waiting for the analysis.");
+        page.sample("kiosk_capture_queue_frames", captureSource->GetQueuedFrames());
+    }
+
+    std::vector<InferenceCounters> networks = getInferenceCounters();
+    page.family("kiosk_inference_items_total", "counter", "Frames or faces each network was run on or skipped for.");
+    for (auto&& counters : networks)
+    {
+        page.sample("kiosk_inference_items_total", (double)counters.inferred,
+                    {{"network", counters.network}, {"result", "inferred"}});
+        page.sample("kiosk_inference_items_total", (double)counters.skipped,
+                    {{"network", counters.network}, {"result", "skipped"}});
+    }
+    page.family("kiosk_inference_blocked_seconds", "summary", "Time the analysis waited for a network per request.");
+    for (auto&& counters : networks)
+        page.summary("kiosk_inference_blocked_seconds", counters.latency, {{"network", counters.network}});
+
+    page.family("kiosk_ads_played_total", "counter", "Ads played to the end.");
+    page.sample("kiosk_ads_played_total", (double)metrics.adsPlayed);
+    page.family("kiosk_ad_playback_fps", "gauge", "Rate the frames of the latest ad were rendered at.");
+    page.sample("kiosk_ad_playback_fps", metrics.playbackFps);
+    page.family("kiosk_ad_latency_seconds", "summary", "Time from a captured frame to the first frame of the ad it influenced.");
+    page.summary("kiosk_ad_latency_seconds", latencyReport.total());
+
+    page.family("kiosk_influxdb_writes_total", "counter", "Points written to InfluxDB.");
+    page.sample("kiosk_influxdb_writes_total", (double)metrics.influxWrites);
+    page.family("kiosk_influxdb_write_seconds", "summary", "Time the analysis waited for InfluxDB per point.");
+    page.summary("kiosk_influxdb_write_seconds", metrics.influxWriteTime);
+
+    server.publish(page.str());
+}
 
 
 
@@ -58,19 +189,77 @@ struct playAdForData
 */
 void writeToDemographicsInfluxDB(int people, int male, int female, int uniqueCount)
 {
-    std::string resp;
-    influx::InfluxDB db;
     influx::Data data;
     data.add_measure("Demographics");
     data.add_field("Total people", people);
     data.add_field("Total female", female);
     data.add_field("Total male", male);
     data.add_field("Unique visitors", uniqueCount);
-    int status = db.write_point("Demographics", data);
-    if (status == -1 )
+    writePoint(demographicsDB, data);
+}
+
+
+
+/*
+* Send the number of people showing each emotion and whose facial landmarks were estimated, averaged
+* over the frames stored in "demographics", to influxDB "Demographics"
+*/
+void writeToEngagementInfluxDB()
+{
+    std::vector<std::string> emotions = getEmotionNames();
+    bool landmarks = isLandmarksEstimated();
+    if (emotions.empty() && !landmarks)
+        return;
+
+    influx::Data data;
+    data.add_measure("Engagement");
+    for (size_t emotion = 0; emotion < emotions.size() && emotion < NO_OF_EMOTIONS; emotion++)
     {
-        std::cout<<"Error writing data to InfluxDB Demographics"<<std::endl;
-        exit(0);
+        int count = 0;
+        for (int i = 0; i < 5; i++)
+            count += demographics[i].emotions[emotion];
+        data.add_field(emotions[emotion], (int)floor(count / 5.0f + 0.5f));
+    }
+    if (landmarks)
+    {
+        int count = 0;
+        for (int i = 0; i < 5; i++)
+            count += demographics[i].landmarksCount;
+        data.add_field("Faces with landmarks", (int)floor(count / 5.0f + 0.5f));
+    }
+    writePoint(demographicsDB, data);
+}
+
+
+
+/*
+* Send the number of frames or faces each network was run on and skipped for, and the motion gating
+* statistics, to influxDB "Demographics"
+*/
+void writeToInferenceInfluxDB()
+{
+    for (auto&& counters : getInferenceCounters())
+    {
+        influx::Data data;
+        data.add_measure("Inference");
+        data.add_tag("network", counters.network);
+        data.add_field("inferred", (long long)counters.inferred);
+        data.add_field("skipped", (long long)counters.skipped);
+        writePoint(demographicsDB, data);
+    }
+
+    MotionGate::Stats stats;
+    if (getMotionGateStats(stats))
+    {
+        influx::Data data;
+        data.add_measure("Motion");
+        data.add_field("frames", (long long)stats.frames);
+        data.add_field("skipped", (long long)stats.skipped);
+        data.add_field("skipRatio", stats.frames ? (double)stats.skipped / stats.frames : 0.0);
+        data.add_field("wakeups", (long long)stats.wakeups);
+        data.add_field("meanWakeLatencyMs", stats.wakeups ? stats.totalWakeLatency / stats.wakeups : 0.0);
+        data.add_field("maxWakeLatencyMs", stats.maxWakeLatency);
+        writePoint(demographicsDB, data);
     }
 }
 
@@ -86,185 +275,337 @@ void writeToDemographicsInfluxDB(int people, int male, int female, int uniqueCou
 */
 void  writeToAdDataInfluxDB(std::string previousAd, std::string currentAd ,int interested, int notInterested)
 {
-    influx::InfluxDB db;
     influx::Data data;
     data.add_measure("AdData");
     data.add_field("previousAd", previousAd);
     data.add_field("currentAd", currentAd);
     data.add_field("peopleInterested", interested);
     data.add_field("peopleNotInterested", notInterested);
-    if (db.write_point("AdData", data) == -1 )
-    {
-        std::cout<<"Error writing data to InfluxDB AdData"<<std::endl;
-        exit(0);
-    }
+    writePoint(adDataDB, data);
 }
 
 
 
 /*
-* Select the Advertisement to be played
+* Send the latency from a captured frame to the ad it influenced, and of every hop on the way, to influxDB "AdData"
 *
-* @param Structure containing gender and age group based on which ad has to be selected
+* @param Acknowledge of the played ad
+* @param Latencies of the ad in milliseconds
+*/
+void writeToLatencyInfluxDB(const AdAck& ack, const LatencyReport::Hops& hops)
+{
+    influx::Data data;
+    data.add_measure("Latency");
+    data.add_field("frameId", (long long)ack.trace.frame.frameId);
+    data.add_field("analysisMs", hops.analysis);
+    data.add_field("aggregationMs", hops.aggregation);
+    data.add_field("decisionMs", hops.decision);
+    data.add_field("requestMs", hops.request);
+    if (ack.playback.firstRendered)
+        data.add_field("playbackMs", hops.playback);
+    data.add_field("totalMs", hops.total);
+    writePoint(adDataDB, data);
+}
+
+
+
+/*
+* Select the first ad from the demographics of the first 30 frames and publish them
+*
+* @param State of the ad selection
 * @return Advertisement name on success, "NULL" in case of failure
 */
-std::string getAd(struct playAdForData genderAgeData)
-{ 
-    // To avoid Advertisement repetition
-    static unsigned int AdIndex[TOTAL_JSON_INSTANCES] = {0};
+std::string selectFirstAd(AdSelection& selection)
+{
+    memset(selection.pCount, 0, sizeof(selection.pCount));
+
+    // Find the total number people of people, number of male and female
+    getPeopleCount(selection.pCount);
+    selection.trace.aggregated = msdk_time_get_tick();
+
+    // Get the unique count of visitors
+    int uniqueVisitors = getUniqueVisitorCount(selection.pCount[NO_OF_PEOPLE]);
 
-    // Iterate through the data in variable adsData
-    for (int instance = 0; instance < TOTAL_JSON_INSTANCES; instance++)
+    // Write the demographics data to InfluxDB 
+    writeToDemographicsInfluxDB(selection.pCount[NO_OF_PEOPLE], selection.pCount[NO_OF_MALE], selection.pCount[NO_OF_FEMALE], uniqueVisitors);
+
+    // Check if there are people in front of digital signage
+    if ((selection.pCount[NO_OF_PEOPLE]) != 0)
     {
-        if ((adsData[instance].ageGroup == genderAgeData.ageGroup) && (adsData[instance].gender == genderAgeData.gender))
-        {
-            if (AdIndex[instance] >= adsData[instance].Ads.size())
-                AdIndex[instance] = 1;
-            else
-                AdIndex[instance]++;
-            return adsData[instance].Ads[AdIndex[instance] - 1];
-        }
+        // Get dominant gender and Age Group and store it in genderAgeData
+        selection.genderAgeData = getGenderAgeGroup(selection.pCount);
     }
-    return "NULL";
+
+    // Select the ad to be played based on demographics
+    selection.adToPlay = getAd(selection.genderAgeData);
+    selection.trace.decided = msdk_time_get_tick();
+    if (selection.adToPlay != "NULL")
+    {
+        std::cout<<"\n\n\n*********** Playing Add for Gender : "<<selection.genderAgeData.gender<<", Age Group : "<<selection.genderAgeData.ageGroup<<" ***********\n";
+        std::cout<<"*********** Playing Ad: "<<selection.adToPlay<<"***********\n\n\n";
+    }
+    return selection.adToPlay;
 }
 
 
 
 /*
-* Find the total number of people, number of male, number of female.
-* It gets the data from  circular array "demographics" defined in main.hpp and find the mean of the respective data to get the demographics
+* Send the demographics data, done every 30th frame (approx 1 sec)
 *
-* @param Float array of size 4, which will be updated with the demographics data
+* @param State of the ad selection
 */
-void getPeopleCount(float pCount[])
+void publishDemographics(AdSelection& selection)
 {
-    pCount[NO_OF_PEOPLE] = 0.0f;
-    pCount[NO_OF_MALE] = 0.0f;
-    pCount[NO_OF_FEMALE] = 0.0f;
-    pCount[NO_OF_PEOPLE_INTERESTED] = 0.0f;
-    float femaleCount =0.0f;
-    float maleCount = 0.0f;
-    float totalCount = 0.0f;
-
-    // Find the sum of the total people, number of the male, female and people interested in the ad count 
-    for (int i = 0; i < 5; i++)
-    {
-        pCount[NO_OF_PEOPLE] = pCount[NO_OF_PEOPLE] + demographics[i].peopleCount;
-        pCount[NO_OF_MALE] = pCount[NO_OF_MALE] + demographics[i].male.count;
-        pCount[NO_OF_FEMALE] = pCount[NO_OF_FEMALE] + demographics[i].female.count;
-        pCount[NO_OF_PEOPLE_INTERESTED] = pCount[NO_OF_PEOPLE_INTERESTED] + demographics[i].interestedCount;
-    }
+    getPeopleCount(selection.pCount);
+    int uniqueVisitors = getUniqueVisitorCount(selection.pCount[NO_OF_PEOPLE]);
+    std::cout<<"\nUnique visitors count : "<<uniqueVisitors<<std::endl; 
+    writeToDemographicsInfluxDB(selection.pCount[NO_OF_PEOPLE], selection.pCount[NO_OF_MALE], selection.pCount[NO_OF_FEMALE], uniqueVisitors);
+    writeToEngagementInfluxDB();
+    writeToInferenceInfluxDB();
+}
 
-    // Find the mean to remove to the inconsistency in the data if any
-    totalCount = pCount[NO_OF_PEOPLE]/5;
-    maleCount = pCount[NO_OF_MALE]/5;
-    femaleCount = pCount[NO_OF_FEMALE]/5;
 
-    pCount[NO_OF_PEOPLE] = floor(totalCount + 0.5);
-    pCount[NO_OF_MALE] = floor(maleCount + 0.5);
-    pCount[NO_OF_FEMALE] = floor(femaleCount  + 0.5);
-    pCount[NO_OF_PEOPLE_INTERESTED] = floor(pCount[NO_OF_PEOPLE_INTERESTED]/5 + 0.5);
 
-    // Remove the error in the mismatch of total number of people and sum of male and female, if any
-    if(pCount[NO_OF_PEOPLE] < pCount[NO_OF_MALE] + pCount[NO_OF_FEMALE])
+/*
+* Select the next ad once the previous one finished playing, and publish how many people were interested in it
+*
+* @param State of the ad selection
+* @return Advertisement name, the ad of the default gender and age group if none could be selected
+*/
+std::string selectNextAd(AdSelection& selection)
+{
+    // Find the total number people of people, number of male and female
+    getPeopleCount(selection.pCount);
+    selection.trace.aggregated = msdk_time_get_tick();
+    selection.previousAd = selection.adToPlay;
+
+    // Check if there are people in front of digital signage
+    if ((selection.pCount[NO_OF_PEOPLE]) != 0)
     {
-        pCount[NO_OF_PEOPLE] = ceil(totalCount);
+        std::cout<<"\nPeople interested: "<<selection.pCount[NO_OF_PEOPLE_INTERESTED]<<std::endl;
+        // Get dominant gender and Age Group and store it in genderAgeData
+        selection.genderAgeData = getGenderAgeGroup(selection.pCount);
+    }
+
+    // Select the ad to be played based on demographics
+    selection.adToPlay = getAd( selection.genderAgeData );
+    selection.trace.decided = msdk_time_get_tick();
+    int notInterested  = selection.pCount[NO_OF_PEOPLE] - selection.pCount[NO_OF_PEOPLE_INTERESTED];
+    writeToAdDataInfluxDB(selection.previousAd, selection.adToPlay, selection.pCount[NO_OF_PEOPLE_INTERESTED], notInterested);
+    if(selection.adToPlay == "NULL")            
+    {
+        // Default gender and age group for which ad needs to be played if any error occurs
+        // or if their is no person in front of digital signage  
+        selection.genderAgeData = {'M',2};
+        std::cout<<"Error occurred while selecting the ad!"<<std::endl;
+        selection.adToPlay = getAd( selection.genderAgeData );
+        selection.trace.decided = msdk_time_get_tick();
     }
     else
-    if(pCount[NO_OF_PEOPLE] > pCount[NO_OF_MALE] + pCount[NO_OF_FEMALE])
     {
-        if( femaleCount > maleCount)
-            pCount[NO_OF_FEMALE] = ceil(femaleCount);
-        else
-            pCount[NO_OF_MALE] = ceil(maleCount);
+        std::cout<<"\n\n\n*********** Playing Ad for Gender : "<<selection.genderAgeData.gender<<", Age Group : "<<selection.genderAgeData.ageGroup<<" ***********\n";
+        std::cout<<"*********** Playing Ad: "<<selection.adToPlay<<" ***********\n\n\n";
     }
-   
+    return selection.adToPlay;
 }
 
 
 
 /*
-* Find the unique count of people who visited kiosk
+* Send the ad name followed by its trace to the video decoding process, exit on failure
 *
-* @param Number of people currently in front of digital signage
-* @return Count of unique visitors
+* @param Write end of the pipe to the video decoding process
+* @param Process id of the video decoding process
+* @param Path of the ad
+* @param Trace of the decision, the time it is sent is set
 */
-int getUniqueVisitorCount(int peopleCount)
+void sendAd(int pipeFd, pid_t PID, const std::string& adName, AdTrace& trace)
 {
-    static int previousPeopleCount = 0;
-    static int uniqueCount = 0;
-    if(previousPeopleCount == 0 )
+    CTraceSpan span("Send ad request");
+    trace.sent = msdk_time_get_tick();
+    std::string message = adName;
+    message.push_back('\0');
+    message.append(reinterpret_cast<const char*>(&trace), sizeof(trace));
+    if(write(pipeFd, message.data(), message.size()) == -1)
     {
-        uniqueCount = peopleCount + uniqueCount; 
-    }
-    else if(previousPeopleCount < peopleCount)
-    {
-        uniqueCount = uniqueCount + peopleCount - previousPeopleCount;
+        std::cout<<"Error occurred while writing to the pipe!"<<std::endl;
+        kill(PID, SIGKILL);
+        exit(EXIT_FAILURE);
     }
-    previousPeopleCount = peopleCount;
-    return uniqueCount;
 }
 
 
 
 /*
-* Find the dominant age among the dominant gender
+* Replay a recording made with -record through the tracking, demographics, ad selection and InfluxDB output
+* as fast as possible. The ads are selected at the frames the recorded ones finished playing at, and the
+* points get the recorded time
 *
-* @param Array of type float containing the demographics data
-* @return Structure containing age and gender for which the ad has to be played
+* @param Path of the recording
+* @return EXIT_SUCCESS on success, EXIT_FAILURE in case of failure
 */
-struct playAdForData getGenderAgeGroup(float pCount[])
+int replayRecording(const std::string& path)
 {
-    struct playAdForData data;
-    char gender;
-    int ageGroup, maxAgeGroup, max;
-    float meanAge[5] = {0};
+    DetectionReplay replay;
+    if (!replay.open(path))
+    {
+        std::cout<<"Error occurred while reading the recording "<<path<<std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Replaying the recording " << path << std::endl;
 
-    // Check people of which gender is more in number
-    if (pCount[NO_OF_MALE] > pCount[NO_OF_FEMALE])
+    demographicsDB = "DemographicsReplay";
+    adDataDB = "AdDataReplay";
+    influxDB().create_database(demographicsDB);
+    influxDB().create_database(adDataDB);
+
+    AdSelection selection;
+    RecordedFrame frame;
+    std::vector<RecordedFace> faces;
+    unsigned long frameCount = 1;
+    uint64_t firstTimestamp = 0;
+    uint64_t lastTimestamp = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (replay.next(frame, faces))
     {
-        gender = 'M';
-        for (int i = 0; i < 5; i++)
+        if (frameCount == 1)
+            firstTimestamp = frame.timestamp;
+        lastTimestamp = frame.timestamp;
+        pointTime = (long long)frame.timestamp * 1000;
+
+        // Same order as the live loop: the ad selection sees the demographics of the frames before
+        if (frameCount == 30 && selectFirstAd(selection) == "NULL")
         {
-            for (int ageGroup = 1; ageGroup < 5; ageGroup++)
-            {
-               meanAge[ageGroup] = meanAge[ageGroup] + demographics[i].male.ageGroup[ageGroup];
-            }
+            std::cout<<"Error occurred while selecting the ad!"<<std::endl;
+            break;
         }
-    }
-    else
-    {
-        gender = 'F';
-        for (int i = 0; i < 5; i++)
+        if (frameCount % 30 == 0)
+            publishDemographics(selection);
+        if (frame.flags & RECORDED_AD_FINISHED)
+            selectNextAd(selection);
+
+        if (replayPeople(frame, faces) != 0)
         {
-            for (int ageGroup = 1; ageGroup < 5; ageGroup++)
-            {
-                meanAge[ageGroup] = meanAge[ageGroup] + demographics[i].female.ageGroup[ageGroup];
-            }
+            std::cout<<"Error occurred while analysing the audience"<<std::endl;
+            return EXIT_FAILURE;
         }
+        frameCount++;
     }
 
-    // Find the mean of the number of people on different ageGroup of the dominant gender
-    for (int ageGroup = 1; ageGroup < 5; ageGroup++)
+    double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double recordedTime = (lastTimestamp - firstTimestamp) / 1e6;
+    std::cout << "\nReplayed " << frameCount - 1 << " frames, " << recordedTime << " s recorded in " << wallTime << " s";
+    if (wallTime > 0)
+        std::cout << " (" << recordedTime / wallTime << "x real time)";
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+
+
+/*
+* Analyse the audience on a decoded NV12 surface, the planes are used in place
+*
+* @param Surface returned by the decode frame source
+* @return 0 on success, 1 on failure
+*/
+int analyseSurface(const mfxFrameSurface1* surface)
+{
+    const mfxFrameInfo& info = surface->Info;
+    const mfxFrameData& data = surface->Data;
+    mfxU8* y = data.Y + info.CropY * data.Pitch + info.CropX;
+    mfxU8* uv = data.UV + (info.CropY / 2) * data.Pitch + info.CropX;
+
+    cv::Mat yPlane(info.CropH & ~1, info.CropW & ~1, CV_8UC1, y, data.Pitch);
+    cv::Mat uvPlane(info.CropH / 2, info.CropW / 2, CV_8UC2, uv, data.Pitch);
+    return analysePeople(yPlane, uvPlane);
+}
+
+
+
+/*
+* Analyse the audience on a captured picture. NV12 is used in place, YUY2 is converted to BGR once
+*
+* @param Picture returned by the capture source
+* @return 0 on success, 1 on failure
+*/
+int analyseCapturedFrame(const sCaptureFrame& captured)
+{
+    if (captured.fourcc == MFX_FOURCC_NV12)
     {
-        meanAge[ageGroup] = meanAge[ageGroup] / 5;
+        cv::Mat yPlane(captured.height, captured.width, CV_8UC1, captured.data, captured.pitch);
+        cv::Mat uvPlane(captured.height / 2, captured.width / 2, CV_8UC2,
+                        captured.data + captured.pitch * captured.height, captured.pitch);
+        return analysePeople(yPlane, uvPlane);
     }
 
-    max = meanAge[1], maxAgeGroup = 1;
+    cv::Mat yuyv(captured.height, captured.width, CV_8UC2, captured.data, captured.pitch);
+    cv::Mat bgr;
+    cv::cvtColor(yuyv, bgr, cv::COLOR_YUV2BGR_YUYV);
+    return analysePeople(bgr);
+}
+
+
+
+/*
+* Read the optional capture backend settings of the input
+*
+* @param Input entry of the config file
+* @param Parameters to fill
+* @return Capture source to use, NULL if the input is read with OpenCV or decoded with Media SDK
+*/
+CCaptureSource* createCaptureSource(const json& input, sCaptureParams& params)
+{
+    std::string type = input.value("capture", std::string());
+    if (type.empty())
+        return NULL;
+
+    params.device = input["video"];
+    params.fourcc = (input.value("format", std::string("nv12")) == "yuyv") ? MFX_FOURCC_YUY2 : MFX_FOURCC_NV12;
+    params.width = input.value("width", 640);
+    params.height = input.value("height", 480);
+    params.numBuffers = input.value("buffers", 4);
+    params.frameRate = input.value("fps", 0.0);
+    params.loop = input.value("loop", false);
+
+    if (type == "v4l2")
+        return new CV4L2CaptureSource;
+    if (type == "file")
+        return new CFileCaptureSource;
+
+    std::cout << "Unknown capture type " << type << std::endl;
+    exit(EXIT_FAILURE);
+}
+
 
-    // Find the dominant age group (Age group having maximum number of people)
-    for (int ageGroup = 1; ageGroup < 5; ageGroup++)
+
+/*
+* Set the CPU placement and scheduling of the application threads
+*
+* @param "threads" entry of the config file, maps a thread role to its "cpus", "sched" and "priority"
+*/
+void setThreadPlacements(const json& threads)
+{
+    for (auto it = threads.begin(); it != threads.end(); ++it)
     {
-        if (max < meanAge[ageGroup])
+        msdkThreadPlacement placement;
+        std::string cpus = it.value().value("cpus", std::string());
+        if (!cpus.empty() && msdk_thread_parse_cpu_list(cpus.c_str(), placement.cpus) != MFX_ERR_NONE)
+        {
+            std::cout << "Invalid CPU list " << cpus << " of the " << it.key() << " threads" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::string sched = it.value().value("sched", std::string());
+        if (!sched.empty() && msdk_thread_get_schedtype(sched.c_str(), placement.schedType) != MFX_ERR_NONE)
         {
-            maxAgeGroup = ageGroup;
-            max = meanAge[ageGroup];
+            std::cout << "Invalid scheduling type " << sched << " of the " << it.key() << " threads" << std::endl;
+            msdk_thread_printf_scheduling_help();
+            exit(EXIT_FAILURE);
         }
-    }    
-    data.gender = gender;
-    data.ageGroup = maxAgeGroup;
-    return data;
-} 
+        placement.priority = it.value().value("priority", 0);
+        msdk_thread_set_placement(it.key().c_str(), placement);
+    }
+}
 
 
 
@@ -275,18 +616,20 @@ int main(int argc, char *argv[])
 {
 
     cv::Mat frame;
-    float pCount[4] ={0.0f};
     int fd[4];
-    int flag = 0; 
+    AdAck ack;
     int frameCount = 1;
     int status = 0;
-    int uniqueVisitors = 0;
     int delay = 5;
+    int exitStatus = EXIT_SUCCESS;
     pid_t PID;
-    std::string adToPlay = "\0";
-    std::string previousAd = "\0";
-    std::string adName = "\0";
-    std::string response = "\0";
+    AdSelection selection;
+    // Latest frame analysed, the ad decisions are traced back to it
+    FrameTrace lastAnalysed = {0, 0, 0};
+    LatencyReport latencyReport;
+    MetricsServer metricsServer;
+    bool isMetricsServed = false;
+    msdk_tick metricsPublished = 0;
     std::string fileName = "../resources/AdList.json";
     std::string pathToAds = "../resources/";
     std::string conf_file = "../resources/config.json";
@@ -295,11 +638,41 @@ int main(int argc, char *argv[])
     confFile>>jsonobj;
     auto obj = jsonobj["inputs"];
     std::string input = obj[0]["video"];
+    // Optional codec of the input, if set the stream is decoded by Media SDK into NV12 and fed to inference as is
+    std::string codec = obj[0].value("codec", std::string());
+    // Optional V4L2 or raw file capture, takes precedence over the codec and OpenCV capture
+    sCaptureParams captureParams;
+    std::unique_ptr<CCaptureSource> captureSource(createCaptureSource(obj[0], captureParams));
+    bool nv12Input = captureSource ? (captureParams.fourcc == MFX_FOURCC_NV12) : !codec.empty();
+
+    // Optional placement of the application threads, the report of their CPU time is printed at exit
+    if (jsonobj.count("threads"))
+    {
+        setThreadPlacements(jsonobj["threads"]);
+        atexit(msdk_thread_print_cpu_report);
+    }
+    // This thread runs inference, the inference engine threads created from it inherit its placement
+    msdk_thread_enter("inference");
+
+    // Optional periodic reports of the ad decoding latency, printed by the playback process
+    mfxU32 latencyPeriod = 0;
+    if (jsonobj.count("playback"))
+        latencyPeriod = jsonobj["playback"].value("latency_period", 0u);
+
+    // Optional trace events of both processes, written to <path>.<pid>.json
+    std::string tracePath;
+    mfxU32 traceEvents = 0;
+    if (jsonobj.count("trace"))
+    {
+        tracePath = jsonobj["trace"].value("path", std::string("kiosk-trace"));
+        traceEvents = jsonobj["trace"].value("events", 65536u);
+        if (msdk_trace_start(tracePath.c_str(), traceEvents) != MFX_ERR_NONE)
+        {
+            std::cout << "Cannot start the trace" << std::endl;
+            tracePath.clear();
+        }
+    }
 
-    // Default gender and age group for which ad needs to be played if any error occurs
-    // or if their is no person in front of digital signage 
-    struct playAdForData genderAgeData = {'M',2};
-    
     // Parse the json file contaning the list of ads and store in "adsDataStructure" structure
     if (parseJsonFile(fileName) == false)
     {
@@ -308,17 +681,21 @@ int main(int argc, char *argv[])
     }
 
     // Read the Intermediate representation (read network model and load its weights)
-    if (loadModel(argc, argv) == 1)
+    if (loadModel(argc, argv, nv12Input) == 1)
     {
 
         std::cout << "Error occurred while reading Intermediate Representation" << std::endl;
         return EXIT_FAILURE;
     }
 
+    // A replay needs neither the input nor the playback process
+    std::string replayFile = getReplayFile();
+    if (!replayFile.empty())
+        return replayRecording(replayFile);
+
     // Create databases Demographics and AdData in InfluxDB to store data
-    influx::InfluxDB db;
-    db.create_database("Demographics");
-    db.create_database("AdData");
+    influxDB().create_database(demographicsDB);
+    influxDB().create_database(adDataDB);
 
 
     // Create pipes for interprocess communication between Audience Analytics process and MediaSDK process
@@ -341,10 +718,31 @@ int main(int argc, char *argv[])
     // Create a process which will decode Ad using H265 codec and play it
     PID = fork();
     cv::VideoCapture capture;
+    CDecodeFrameSource decoder;
 
     // MediaSDK process for video decoding
     if (PID == 0)
     {
+        // Ads are decoded and rendered by this process, keep it off the CPUs of the analytics
+        msdk_thread_enter("playback");
+        // Ctrl+C reaches the whole process group, only the parent stops this process, with SIGTERM once the
+        // analysis is done
+        struct sigaction ignoreAction;
+        memset(&ignoreAction, 0, sizeof(ignoreAction));
+        sigemptyset(&ignoreAction.sa_mask);
+        ignoreAction.sa_handler = SIG_IGN;
+        sigaction(SIGINT, &ignoreAction, NULL);
+        // The trace of this process is written on SIGTERM as well
+        if (!tracePath.empty() && msdk_trace_start(tracePath.c_str(), traceEvents) == MFX_ERR_NONE)
+        {
+            struct sigaction traceAction;
+            memset(&traceAction, 0, sizeof(traceAction));
+            sigemptyset(&traceAction.sa_mask);
+            traceAction.sa_handler = requestTraceDump;
+            sigaction(SIGUSR1, &traceAction, NULL);
+            traceAction.sa_handler = dumpTraceAndExit;
+            sigaction(SIGTERM, &traceAction, NULL);
+        }
         // Close the pipe ends not required by child process
         close(fd[P1_READ]);
         close(fd[P1_WRITE]);
@@ -357,13 +755,28 @@ int main(int argc, char *argv[])
                 ad.push_back(ch);
             else
             {
+                // The trace of the decision follows the ad name, it is returned with the acknowledge
+                memset(&ack, 0, sizeof(ack));
+                char* trace = reinterpret_cast<char*>(&ack.trace);
+                size_t received = 0;
+                while (received < sizeof(ack.trace))
+                {
+                    ssize_t size = read(fd[P2_READ], trace + received, sizeof(ack.trace) - received);
+                    if (size <= 0)
+                        break;
+                    received += size;
+                }
+
                 // Pass ad name to media_sdk() function to decode and play the ad 
-               result = media_sdk(ad.c_str());
+               {
+                   CTraceSpan span("Play ad");
+                   result = media_sdk(ad.c_str(), &ack.playback, latencyPeriod);
+               }
                 if(result != 0)
                 {
-                    flag = 1;
+                    ack.status = 1;
                     // Send negative acknowledge to the audience analytics process if any error occurred while decoding
-                    if(write(fd[P2_WRITE], &flag, sizeof(flag)) == -1)
+                    if(write(fd[P2_WRITE], &ack, sizeof(ack)) == -1)
                     {
                         std::cout<<"Error occurred while writing to the pipe!"<<std::endl;
                         exit(EXIT_FAILURE);
@@ -372,9 +785,9 @@ int main(int argc, char *argv[])
                 }
                 else
                 {
-                    flag = 0;
+                    ack.status = 0;
                     // Send the acknowledge to the audience analytics process on success
-                    if(write(fd[P2_WRITE], &flag, sizeof(flag)) == -1)
+                    if(write(fd[P2_WRITE], &ack, sizeof(ack)) == -1)
                     {
                         std::cout<<"Error occurred while writing to the pipe!"<<std::endl;
                         exit(EXIT_FAILURE);
@@ -394,7 +807,50 @@ int main(int argc, char *argv[])
         // Close the pipes not required by parent process
         close(fd[P2_READ]);
         close(fd[P2_WRITE]);
-        if (input.size() == 1 && *(input.c_str()) >= '0' && *(input.c_str()) <= '9')
+
+        // Stop on SIGTERM and SIGINT once the frame being analysed is done, the playback process ignores
+        // SIGINT and is stopped with SIGTERM at the end
+        struct sigaction stopAction;
+        memset(&stopAction, 0, sizeof(stopAction));
+        stopAction.sa_handler = requestStop;
+        sigemptyset(&stopAction.sa_mask);
+        sigaction(SIGTERM, &stopAction, NULL);
+        sigaction(SIGINT, &stopAction, NULL);
+        if (!tracePath.empty())
+        {
+            stopAction.sa_handler = requestTraceDump;
+            sigaction(SIGUSR1, &stopAction, NULL);
+        }
+
+        // Optional Prometheus endpoint on the loopback interface, "metrics": { "port": 9100 }
+        if (jsonobj.count("metrics"))
+        {
+            int port = jsonobj["metrics"].value("port", 0);
+            isMetricsServed = port > 0 && metricsServer.start(port);
+            if (!isMetricsServed)
+                std::cout<<"The metrics are not served"<<std::endl;
+        }
+        if (captureSource)
+        {
+            std::cout << "Capturing from " << input << std::endl;
+            if(captureSource->Open(captureParams) != MFX_ERR_NONE)
+            {
+                std::cout<<"\nError opening the capture device!\n"<<std::endl;
+                kill(PID, SIGKILL);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!codec.empty())
+        {
+            std::cout << "Decoding the video " << input << " with Media SDK" << std::endl;
+            if(decoder.Open(input.c_str(), codec.c_str()) != MFX_ERR_NONE)
+            {
+                std::cout<<"\nError decoding the video!\n"<<std::endl;
+                kill(PID, SIGKILL);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (input.size() == 1 && *(input.c_str()) >= '0' && *(input.c_str()) <= '9')
         {
             std::cout << "Input from camera " << std::endl;
             if(capture.open(std::stoi(input)) == false)
@@ -415,125 +871,113 @@ int main(int argc, char *argv[])
             }
 
         }
-        double fps = capture.get(CAP_PROP_FPS);
-        delay = 1000/fps;
+        if (capture.isOpened())
+        {
+            double fps = capture.get(CAP_PROP_FPS);
+            delay = 1000/fps;
+        }
         while (1)
         {
-            capture >> frame;
-
-            // If frame is empty, exit the application
-            if (frame.empty())
+            // ESC in the window or a signal
+            if (stopRequested || quitRequested())
             {
-                // Kill the video decoding process
-                kill(PID, SIGKILL);
-                exit(EXIT_SUCCESS);
+                std::cout<<"Stopping the analysis"<<std::endl;
+                break;
             }
 
-            // Analyse the data till 30th frame and then play the ad along with publishing the data to Grafana
-            if (frameCount == 30)
+            // The page is rebuilt about once a second, a scrape reads the latest one
+            if (isMetricsServed && msdk_time_get_tick() - metricsPublished >= msdk_time_get_frequency())
             {
-                memset(pCount, 0, sizeof(pCount));
-
-                // Find the total number people of people, number of male and female
-                getPeopleCount(pCount);
+                metricsPublished = msdk_time_get_tick();
+                publishMetrics(metricsServer, captureSource.get(), latencyReport);
+            }
 
-                // Get the unique count of visitors
-                uniqueVisitors = getUniqueVisitorCount(pCount[NO_OF_PEOPLE]);
+            mfxFrameSurface1* surface = NULL;
+            sCaptureFrame captured;
+            bool isCaptured = false;
+            FrameTrace current = {(uint64_t)frameCount, 0, 0};
+            if (!codec.empty() || captureSource)
+            {
+                mfxStatus sts = MFX_ERR_NONE;
+                if (captureSource)
+                {
+                    sts = captureSource->GetFrame(captured);
+                    isCaptured = true;
+                    // Taken by the capture thread as the buffer was dequeued
+                    current.captured = captured.timestamp;
+                }
+                else
+                {
+                    sts = decoder.GetFrame(&surface);
+                    current.captured = msdk_time_get_tick();
+                }
 
-                // Write the demographics data to InfluxDB 
-                writeToDemographicsInfluxDB(pCount[NO_OF_PEOPLE], pCount[NO_OF_MALE], pCount[NO_OF_FEMALE], uniqueVisitors);
-                
-                // Check if there are people in front of digital signage
-                if ((pCount[NO_OF_PEOPLE]) != 0)
+                // If the stream is over, exit the application
+                if (sts != MFX_ERR_NONE)
+                {
+                    if (sts != MFX_ERR_MORE_DATA)
+                    {
+                        std::cout<<"Error occurred while reading the video!"<<std::endl;
+                        exitStatus = EXIT_FAILURE;
+                    }
+                    break;
+                }
+            }
+            else
+            {
                 {
-                    // Get dominant gender and Age Group and store it in genderAgeData
-                    genderAgeData = getGenderAgeGroup(pCount);
+                    CTraceSpan span("Read frame");
+                    capture >> frame;
                 }
+                current.captured = msdk_time_get_tick();
 
-                // Select the ad to be played based on demographics
-                adToPlay = getAd(genderAgeData);
+                // If frame is empty, exit the application
+                if (frame.empty())
+                    break;
+            }
 
-                if(adToPlay == "NULL")
+            // Analyse the data till 30th frame and then play the ad along with publishing the data to Grafana
+            if (frameCount == 30)
+            {
+                selection.trace.frame = lastAnalysed;
+                if(selectFirstAd(selection) == "NULL")
                 {
                     std::cout<<"Error occurred while selecting the ad!"<<std::endl;
                     break;
                 }
-                std::cout<<"\n\n\n*********** Playing Add for Gender : "<<genderAgeData.gender<<", Age Group : "<<genderAgeData.ageGroup<<" ***********\n";
-                std::cout<<"*********** Playing Ad: "<<adToPlay<<"***********\n\n\n";
-                adName = pathToAds + adToPlay;
 
                 // Send the ad name to video decoding process
-                if(write(fd[P1_WRITE], adName.c_str(), adName.length() + 1) == -1)
-                {
-                    std::cout<<"Error occurred while writing to the pipe!"<<std::endl;
-                    kill(PID, SIGKILL);
-                    exit(EXIT_FAILURE);
-                }
+                sendAd(fd[P1_WRITE], PID, pathToAds + selection.adToPlay, selection.trace);
             }
 
             // Send the demographics data every 30th frame (approx 1 sec)
             if(frameCount % 30 == 0)
             {
-                getPeopleCount(pCount);
-                uniqueVisitors = getUniqueVisitorCount(pCount[NO_OF_PEOPLE]);
-                std::cout<<"\nUnique visitors count : "<<uniqueVisitors<<std::endl; 
-                writeToDemographicsInfluxDB(pCount[NO_OF_PEOPLE], pCount[NO_OF_MALE], pCount[NO_OF_FEMALE], uniqueVisitors);
+                publishDemographics(selection);
             }
 
             // Get the acknowledgment of ad completion from video decoding process 
-            if (read(fd[P1_READ], &flag, sizeof(flag)) != -1)
+            mfxI64 ackRead = msdk_trace_begin();
+            if (read(fd[P1_READ], &ack, sizeof(ack)) == sizeof(ack))
             {   
-                if (flag == 1)
+                msdk_trace_end("Read ad ack", ackRead);
+                if (ack.status == 1)
                 {
                     std::cout<<"Error occurred while playing the ad!"<<std::endl;
                     break;
                 }
-                if (flag == 0)
+                if (ack.status == 0)
                 {
-                    // Find the total number people of people, number of male and female
-                    getPeopleCount(pCount);
-                    previousAd = adToPlay;
+                    if (ack.trace.frame.frameId != 0)
+                        writeToLatencyInfluxDB(ack, latencyReport.add(ack));
+                    metrics.adsPlayed++;
+                    metrics.playbackFps = ack.playback.fps();
 
-                    // Check if there are people in front of digital signage
-                    if ((pCount[NO_OF_PEOPLE]) != 0)
-                    {
-                        std::cout<<"\nPeople interested: "<<pCount[NO_OF_PEOPLE_INTERESTED]<<std::endl;
-                        // Get dominant gender and Age Group and store it in genderAgeData
-                        genderAgeData = getGenderAgeGroup(pCount);
-                    }
-
-                    // Select the ad to be played based on demographics
-                    adToPlay = getAd( genderAgeData );
-                    int notInterested  = pCount[NO_OF_PEOPLE] - pCount[NO_OF_PEOPLE_INTERESTED];
-                    writeToAdDataInfluxDB(previousAd, adToPlay, pCount[NO_OF_PEOPLE_INTERESTED], notInterested);
-                    if(adToPlay == "NULL")            
-                    {
-                        // Default gender and age group for which ad needs to be played if any error occurs
-                        // or if their is no person in front of digital signage  
-                        genderAgeData = {'M',2};
-                        std::cout<<"Error occurred while selecting the ad!"<<std::endl;
-                        adToPlay = getAd( genderAgeData );
-                        adName = pathToAds + adToPlay;
-                        if(write(fd[P1_WRITE], adName.c_str(), adName.length() + 1) == -1)
-                        {
-                            std::cout<<"Error occurred while writing to the pipe!"<<std::endl;
-                            kill(PID, SIGKILL);
-                            exit(EXIT_FAILURE);
-                        }
- 
-                    }
-                    else
-                    {
-                        std::cout<<"\n\n\n*********** Playing Ad for Gender : "<<genderAgeData.gender<<", Age Group : "<<genderAgeData.ageGroup<<" ***********\n";
-                        std::cout<<"*********** Playing Ad: "<<adToPlay<<" ***********\n\n\n";
-                        adName = pathToAds + adToPlay;
-                        if(write(fd[P1_WRITE], adName.c_str(), adName.length() + 1) == -1)
-                        {
-                            std::cout<<"Error occurred while writing to the pipe!"<<std::endl;
-                            kill(PID, SIGKILL);
-                            exit(EXIT_FAILURE);
-                        }
-                    }
+                    // A replay of the recording selects the next ad at the same frame
+                    markAdFinished();
+                    selection.trace.frame = lastAnalysed;
+                    std::string adName = pathToAds + selectNextAd(selection);
+                    sendAd(fd[P1_WRITE], PID, adName, selection.trace);
                 }
             }
 
@@ -542,26 +986,44 @@ int main(int argc, char *argv[])
             * It analysis the audience in front of digital signage and store the age and gender of the people in 
             * the "demographics" circular array defined in main.hpp
             */  
-            status = analysePeople(frame);
-            if(cv::waitKey(1) == 27)
+            if (surface)
             {
-                kill(PID, SIGKILL);
-                exit(0);
+                status = analyseSurface(surface);
+                // Let the decoder continue with the next frame
+                decoder.ReleaseFrame();
             }
+            else if (isCaptured)
+            {
+                status = analyseCapturedFrame(captured);
+                // The buffer goes back to the capture device
+                captureSource->ReleaseFrame(captured);
+            }
+            else
+                status = analysePeople(frame);
             if (status != 0)
             {
                 std::cout<<"Error occurred while analysing the audience"<<std::endl;
                 break;
             }
+            current.analysed = msdk_time_get_tick();
+            lastAnalysed = current;
             frameCount++;
+            metrics.framesAnalysed++;
 
         }
     }
 
-    //close windows
-    cv::destroyAllWindows();
+    // Let the inference in flight, the recording and the frame sink finish, then stop the ad playback.
+    // The capture source and the decoder are closed on return.
+    finishAnalysis();
+    kill(PID, SIGTERM);
+    waitpid(PID, NULL, 0);
+    metricsServer.stop();
+    msdk_trace_stop();
+    latencyReport.print();
     // finished with write-side
     close(fd[P1_READ]);
     close(fd[P1_WRITE]);
+    return exitStatus;
 
 }
@@ -0,0 +1,217 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <samples/slog.hpp>
+
+#include "vm/thread_defs.h"
+#include "metrics_server.hpp"
+
+// Label values may hold any text, the backslash, the double quote and the line feed are escaped
+static std::string escapeLabel(const std::string &value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void PrometheusText::family(const std::string &name, const std::string &type, const std::string &help) {
+    _text << "# HELP " << name << ' ' << help << '\n' << "# TYPE " << name << ' ' << type << '\n';
+}
+
+void PrometheusText::sample(const std::string &name, double value, const Labels &labels) {
+    write(name, labels, value);
+}
+
+void PrometheusText::summary(const std::string &name, const CLatencyHistogram &histogram, const Labels &labels) {
+    for (double q : {0.5, 0.9, 0.99}) {
+        std::ostringstream quantile;
+        quantile << q;
+        Labels withQuantile = labels;
+        withQuantile["quantile"] = quantile.str();
+        write(name, withQuantile, histogram.GetCount() ? histogram.GetQuantile(q) / 1000 : 0.0);
+    }
+    write(name + "_sum", labels, histogram.GetAvg() * histogram.GetCount() / 1000);
+    write(name + "_count", labels, static_cast<double>(histogram.GetCount()));
+}
+
+// 15 significant digits keep the counters exact and the seconds free of rounding noise
+void PrometheusText::write(const std::string &name, const Labels &labels, double value) {
+    _text << name;
+    if (!labels.empty()) {
+        const char *separator = "{";
+        for (const auto &label : labels) {
+            _text << separator << label.first << "=\"" << escapeLabel(label.second) << '"';
+            separator = ",";
+        }
+        _text << '}';
+    }
+    _text.precision(15);
+    _text << ' ' << value << '\n';
+}
+
+MetricsServer::MetricsServer() : _socket(-1), _stop(false) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(int port) {
+    stop();
+    _socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (_socket < 0) {
+        slog::err << "Cannot create the metrics socket" << slog::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Loopback only, the metrics are meant for a scraper or a tunnel on the same host
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(_socket, 8) != 0) {
+        slog::err << "Cannot listen for the metrics on 127.0.0.1:" << port << slog::endl;
+        close(_socket);
+        _socket = -1;
+        return false;
+    }
+
+    mfxStatus sts = MFX_ERR_NONE;
+    _stop = false;
+    _thread.reset(new MSDKThread(sts, serveThreadFunc, this, "metrics"));
+    if (sts != MFX_ERR_NONE) {
+        _thread.reset();
+        close(_socket);
+        _socket = -1;
+        return false;
+    }
+    slog::info << "Serving the metrics at http://127.0.0.1:" << port << "/metrics" << slog::endl;
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (_thread) {
+        _stop = true;
+        _thread->Wait();
+        _thread.reset();
+    }
+    if (_socket >= 0) {
+        close(_socket);
+        _socket = -1;
+    }
+}
+
+void MetricsServer::publish(const std::string &page) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _page = page;
+}
+
+unsigned int MFX_STDCALL MetricsServer::serveThreadFunc(void *ctx) {
+    static_cast<MetricsServer *>(ctx)->serve();
+    return 0;
+}
+
+// The listening socket is polled with a timeout, so stop() is noticed without closing it under the thread
+void MetricsServer::serve() {
+    while (!_stop) {
+        pollfd listening = {_socket, POLLIN, 0};
+        if (poll(&listening, 1, 200) <= 0 || !(listening.revents & POLLIN)) {
+            continue;
+        }
+        int client = accept(_socket, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        answer(client);
+        close(client);
+    }
+}
+
+// Waits until the client is ready for the events or the deadline has passed
+static bool waitForClient(int client, short events, std::chrono::steady_clock::time_point deadline) {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now()).count();
+    if (remaining <= 0) {
+        return false;
+    }
+    pollfd ready = {client, events, 0};
+    return poll(&ready, 1, static_cast<int>(remaining)) > 0 && (ready.revents & events);
+}
+
+// One request per connection, read and answered within a second of the accept. The deadline covers the
+// whole exchange, so a client trickling a byte at a time is dropped as well and cannot hold the thread.
+void MetricsServer::answer(int client) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        if (!waitForClient(client, POLLIN, deadline)) {
+            return;
+        }
+        ssize_t size = recv(client, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (size <= 0) {
+            return;
+        }
+        request.append(buffer, size);
+    }
+
+    const std::string line = request.substr(0, request.find("\r\n"));
+    const bool isGet = line.compare(0, 4, "GET ") == 0;
+    const std::string target = isGet ? line.substr(4, line.find(' ', 4) - 4) : std::string();
+    const std::string path = target.substr(0, target.find('?'));
+
+    std::string status, type, body;
+    if (!isGet) {
+        status = "405 Method Not Allowed";
+        type = "text/plain";
+        body = "Only GET is supported\n";
+    } else if (path != "/metrics") {
+        status = "404 Not Found";
+        type = "text/plain";
+        body = "The metrics are at /metrics\n";
+    } else {
+        status = "200 OK";
+        type = "text/plain; version=0.0.4; charset=utf-8";
+        std::lock_guard<std::mutex> lock(_mutex);
+        body = _page;
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: " << type << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    const std::string text = response.str();
+    size_t sent = 0;
+    while (sent < text.size()) {
+        if (!waitForClient(client, POLLOUT, deadline)) {
+            return;
+        }
+        ssize_t size = send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (size <= 0) {
+            return;
+        }
+        sent += size;
+    }
+}
@@ -0,0 +1,68 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <algorithm>
+
+#include "motion_gate.hpp"
+
+MotionGate::MotionGate(size_t idleInterval, float changedFraction, int pixelThreshold, size_t holdFrames):
+    _idleInterval(std::max<size_t>(idleInterval, 1)), _changedFraction(changedFraction),
+    _pixelThreshold(pixelThreshold), _holdFrames(holdFrames), _framesSinceMotion(0), _framesSinceDetection(0),
+    _wasActive(true), _wakePending(false), _stats({0, 0, 0, 0.0, 0.0}) {
+}
+
+bool MotionGate::update(const cv::Mat& luma, bool hasTracks) {
+    _frameArrival = Clock::now();
+    _stats.frames++;
+
+    bool motion = true;
+    if (_background.empty() || _background.size() != luma.size()) {
+        luma.convertTo(_background, CV_32F);
+    } else {
+        cv::Mat background, diff;
+        _background.convertTo(background, CV_8U);
+        cv::absdiff(luma, background, diff);
+        int changed = cv::countNonZero(diff > _pixelThreshold);
+        motion = changed > _changedFraction * luma.total();
+
+        // Slow enough for a person to show as motion for a while, fast enough to follow the daylight
+        cv::accumulateWeighted(luma, _background, 0.05);
+    }
+    _framesSinceMotion = motion ? 0 : _framesSinceMotion + 1;
+
+    bool active = hasTracks || _framesSinceMotion <= _holdFrames;
+    if (active && !_wasActive) {
+        _stats.wakeups++;
+        _wakePending = true;
+    }
+    _wasActive = active;
+
+    if (active || _framesSinceDetection + 1 >= _idleInterval) {
+        _framesSinceDetection = 0;
+        return true;
+    }
+    _framesSinceDetection++;
+    _stats.skipped++;
+    return false;
+}
+
+void MotionGate::detectionDone() {
+    if (!_wakePending) {
+        return;
+    }
+    double latency = std::chrono::duration<double, std::milli>(Clock::now() - _frameArrival).count();
+    _stats.totalWakeLatency += latency;
+    _stats.maxWakeLatency = std::max(_stats.maxWakeLatency, latency);
+    _wakePending = false;
+}
+
+const MotionGate::Stats& MotionGate::stats() const {
+    return _stats;
+}
+
+cv::Size MotionGate::lumaSize(int cols, int rows) {
+    // A 160 pixel wide frame is enough to notice a person entering the scene
+    int width = std::min(cols, 160);
+    return cv::Size(width, std::max(1, rows * width / std::max(cols, 1)));
+}
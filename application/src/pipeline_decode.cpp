@@ -78,6 +78,9 @@ CDecodingPipeline::CDecodingPipeline()
 
     m_pDeliverOutputSemaphore = NULL;
     m_pDeliveredEvent = NULL;
+    m_firstRenderTick = 0;
+    m_lastRenderTick = 0;
+    m_renderedFrames = 0;
     m_error = MFX_ERR_NONE;
     m_bStopDeliverLoop = false;
 
@@ -87,6 +90,10 @@ CDecodingPipeline::CDecodingPipeline()
     m_bIsVideoWall = false;
     m_bIsCompleteFrame = false;
     m_bPrintLatency = false;
+    m_bUseSurfaceArena = false;
+    m_pFrameSink = NULL;
+    m_latencyPeriod = 0;
+    m_latencyReportTick = 0;
     m_fourcc = 0;
 
     m_nTimeout = 0;
@@ -105,9 +112,6 @@ CDecodingPipeline::CDecodingPipeline()
     m_bResetFileWriter = false;
     m_bResetFileReader = false;
 
-    m_startTick = 0;
-    m_delayTicks = 0;
-
     MSDK_ZERO_MEMORY(m_VppDoNotUse);
     m_VppDoNotUse.Header.BufferId = MFX_EXTBUFF_VPP_DONOTUSE;
     m_VppDoNotUse.Header.BufferSz = sizeof(m_VppDoNotUse);
@@ -143,7 +147,6 @@ CDecodingPipeline::CDecodingPipeline()
 
     m_monitorType = 0;
     totalBytesProcessed = 0;
-    m_vLatency.reserve(1000); // reserve some space to reduce dynamic reallocation impact on pipeline execution
 }
 
 CDecodingPipeline::~CDecodingPipeline()
@@ -169,6 +172,11 @@ mfxStatus CDecodingPipeline::Init(sInputParams *pParams)
             m_bIsCompleteFrame = true;
             m_bPrintLatency = pParams->bCalLat;
             break;
+        case MFX_CODEC_HEVC:
+            m_FileReader.reset(new CHEVCFrameReader());
+            m_bIsCompleteFrame = true;
+            m_bPrintLatency = pParams->bCalLat;
+            break;
         case MFX_CODEC_JPEG:
             m_FileReader.reset(new CJPEGFrameReader());
             m_bIsCompleteFrame = true;
@@ -181,7 +189,7 @@ mfxStatus CDecodingPipeline::Init(sInputParams *pParams)
             m_bPrintLatency = pParams->bCalLat;
             break;
         default:
-            return MFX_ERR_UNSUPPORTED; // latency mode is supported only for H.264 and JPEG codecs
+            return MFX_ERR_UNSUPPORTED; // latency mode is supported only for H.264, H.265, JPEG, VP8 and VP9 codecs
         }
     }
     else
@@ -218,8 +226,11 @@ mfxStatus CDecodingPipeline::Init(sInputParams *pParams)
     m_nFrames = pParams->nFrames ? pParams->nFrames : MFX_INFINITE;
 
     m_bOutI420 = pParams->outI420;
+    m_bUseSurfaceArena = pParams->bUseSurfaceArena;
+    m_pFrameSink = pParams->pFrameSink;
 
     m_nTimeout = pParams->nTimeout;
+    m_latencyPeriod = (msdk_tick)pParams->nLatencyPeriod * msdk_time_get_frequency();
 
     // Initializing file reader
     totalBytesProcessed = 0;
@@ -335,8 +346,6 @@ mfxStatus CDecodingPipeline::Init(sInputParams *pParams)
 #endif
     }
 
-    m_delayTicks = pParams->nMaxFPS ? msdk_time_get_frequency() / pParams->nMaxFPS : 0;
-
     // create decoder
     m_pmfxDEC = new MFXVideoDECODE(m_mfxSession);
     MSDK_CHECK_POINTER(m_pmfxDEC, MFX_ERR_MEMORY_ALLOC);
@@ -394,6 +403,8 @@ mfxStatus CDecodingPipeline::Init(sInputParams *pParams)
     sts = InitMfxParams(pParams);
     MSDK_CHECK_STATUS(sts, "InitMfxParams failed");
 
+    InitPresentationScheduler();
+
     if (m_bVppIsUsed)
         m_bDecOutSysmem = pParams->bUseHWLib ? false : true;
     else
@@ -1293,6 +1304,18 @@ mfxStatus CDecodingPipeline::CreateAllocator()
         //m_pGeneralAllocator = new SysMemFrameAllocator;
         //MSDK_CHECK_POINTER(m_pGeneralAllocator, MFX_ERR_MEMORY_ALLOC);
 
+        if (m_bUseSurfaceArena)
+        {
+            // the arena outlives the pipeline, so the next stream of the same resolution reuses the surfaces
+            static SysMemSurfaceArena surfaceArena;
+
+            SysMemAllocatorParams *pSysMemAllocParams = new SysMemAllocatorParams;
+            MSDK_CHECK_POINTER(pSysMemAllocParams, MFX_ERR_MEMORY_ALLOC);
+            pSysMemAllocParams->pArena = &surfaceArena;
+
+            m_pmfxAllocatorParams = pSysMemAllocParams;
+        }
+
         /* In case of system memory we demonstrate "no external allocator" usage model.
         We don't call SetAllocator, MediaSDK uses internal allocator.
         We use system memory allocator simply as a memory manager for application*/
@@ -1414,6 +1437,14 @@ void CDecodingPipeline::DeallocateExtMVCBuffers()
     m_bIsExtBuffers = false;
 }
 
+void CDecodingPipeline::InitPresentationScheduler()
+{
+    // InitMfxParams sets the frame rate of streams which do not signal one to 30 fps
+    mfxF64 frameRate = m_nMaxFps ? m_nMaxFps
+        : CalculateFrameRate(m_mfxVideoParams.mfx.FrameInfo.FrameRateExtN, m_mfxVideoParams.mfx.FrameInfo.FrameRateExtD);
+    m_presentationScheduler.Init(frameRate);
+}
+
 mfxStatus CDecodingPipeline::ResetDecoder(sInputParams *pParams)
 {
     mfxStatus sts = MFX_ERR_NONE;
@@ -1438,6 +1469,9 @@ mfxStatus CDecodingPipeline::ResetDecoder(sInputParams *pParams)
     sts = InitMfxParams(pParams);
     MSDK_CHECK_STATUS(sts, "InitMfxParams failed");
 
+    // the new stream may come at another frame rate
+    InitPresentationScheduler();
+
     // in case of HW accelerated decode frames must be allocated prior to decoder initialization
     sts = AllocFrames();
     MSDK_CHECK_STATUS(sts, "AllocFrames failed");
@@ -1467,6 +1501,7 @@ mfxStatus CDecodingPipeline::ResetDecoder(sInputParams *pParams)
 
 mfxStatus CDecodingPipeline::DeliverOutput(mfxFrameSurface1* frame)
 {
+    MFX_ITT_TASK("DeliverOutput");
     CAutoTimer timer_fwrite(m_tick_fwrite);
 
     mfxStatus res = MFX_ERR_NONE, sts = MFX_ERR_NONE;
@@ -1475,6 +1510,17 @@ mfxStatus CDecodingPipeline::DeliverOutput(mfxFrameSurface1* frame)
         return MFX_ERR_NULL_PTR;
     }
 
+    if (m_pFrameSink) {
+        if (!m_bExternalAlloc) {
+            return m_pFrameSink->OnFrame(frame);
+        }
+        res = m_pGeneralAllocator->Lock(m_pGeneralAllocator->pthis, frame->Data.MemId, &(frame->Data));
+        if (MFX_ERR_NONE == res) {
+            res = m_pFrameSink->OnFrame(frame);
+            sts = m_pGeneralAllocator->Unlock(m_pGeneralAllocator->pthis, frame->Data.MemId, &(frame->Data));
+        }
+        return (MFX_ERR_NONE == res) ? sts : res;
+    }
 
     if (m_bResetFileWriter)
     {
@@ -1495,17 +1541,22 @@ mfxStatus CDecodingPipeline::DeliverOutput(mfxFrameSurface1* frame)
                 res = sts;
             }
         } else if (m_eWorkMode == MODE_RENDERING) {
+            // sleeps until the frame is due, late frames are skipped to stay on the timeline
+            if (m_presentationScheduler.WaitForDeadline(frame->Data.TimeStamp)) {
+                MFX_ITT_TASK("RenderFrame");
 #if D3D_SURFACES_SUPPORT
-            res = m_d3dRender.RenderFrame(frame, m_pGeneralAllocator);
+                res = m_d3dRender.RenderFrame(frame, m_pGeneralAllocator);
 #elif LIBVA_SUPPORT
-            res = m_hwdev->RenderFrame(frame, m_pGeneralAllocator);
+                res = m_hwdev->RenderFrame(frame, m_pGeneralAllocator);
 #endif
-
-            while( m_delayTicks && (m_startTick + m_delayTicks > msdk_time_get_tick()) )
-            {
-                MSDK_SLEEP(0);
-            };
-            m_startTick=msdk_time_get_tick();
+                if (MFX_ERR_NONE == res) {
+                    m_lastRenderTick = msdk_time_get_tick();
+                    if (!m_firstRenderTick) {
+                        m_firstRenderTick = m_lastRenderTick;
+                    }
+                    m_renderedFrames++;
+                }
+            }
         }
     }
     else {
@@ -1577,6 +1628,7 @@ void CDecodingPipeline::PrintPerFrameStat(bool force)
 
 mfxStatus CDecodingPipeline::SyncOutputSurface(mfxU32 wait)
 {
+    MFX_ITT_TASK("SyncOutputSurface");
     if (!m_pCurrentOutputSurface) {
         m_pCurrentOutputSurface = m_OutputSurfacesPool.GetSurface();
     }
@@ -1600,13 +1652,31 @@ mfxStatus CDecodingPipeline::SyncOutputSurface(mfxU32 wait)
         // we got completely decoded frame - pushing it to the delivering thread...
         ++m_synced_count;
         if (m_bPrintLatency) {
-            m_vLatency.push_back(m_timer_overall.Sync() - m_pCurrentOutputSurface->surface->submit);
+            msdk_tick now = m_timer_overall.Sync();
+            mfxF64 latency = CTimer::ConvertToSeconds(now - m_pCurrentOutputSurface->surface->submit) * 1000;
+            m_latencyHistogram.AddValue(latency);
+            if (m_latencyPeriod) {
+                m_latencyPeriodHistogram.AddValue(latency);
+                if (now - m_latencyReportTick >= m_latencyPeriod) {
+                    CLatencyHistogram snapshot;
+                    m_latencyPeriodHistogram.TakeSnapshot(snapshot);
+                    snapshot.PrintSummary(MSDK_STRING("Latency:"));
+                    m_latencyReportTick = now;
+                }
+            }
         }
         else {
             PrintPerFrameStat();
         }
 
         if (m_eWorkMode == MODE_PERFORMANCE) {
+            if (m_pFrameSink) {
+                // the sink works on the surface in place, it is reused only after the call returns
+                sts = DeliverOutput(&(m_pCurrentOutputSurface->surface->frame));
+                if (MFX_ERR_NONE != sts) {
+                    sts = MFX_ERR_UNKNOWN;
+                }
+            }
             m_output_count = m_synced_count;
             ReturnSurfaceToBuffers(m_pCurrentOutputSurface);
         } else if (m_eWorkMode == MODE_FILE_DUMP) {
@@ -1641,10 +1711,14 @@ mfxStatus CDecodingPipeline::RunDecoding()
     mfxExtDecodeErrorReport *pDecodeErrorReport = NULL;
 #endif
 
+    m_latencyPeriodHistogram.Reset();
+    m_latencyReportTick = m_timer_overall.Sync();
+
     if (m_eWorkMode == MODE_RENDERING) {
+        m_presentationScheduler.Reset();
         m_pDeliverOutputSemaphore = new MSDKSemaphore(sts);
         m_pDeliveredEvent = new MSDKEvent(sts, false, false);
-        pDeliverThread = new MSDKThread(sts, DeliverThreadFunc, this);
+        pDeliverThread = new MSDKThread(sts, DeliverThreadFunc, this, "render");
         if (!pDeliverThread || !m_pDeliverOutputSemaphore || !m_pDeliveredEvent) {
             MSDK_SAFE_DELETE(pDeliverThread);
             MSDK_SAFE_DELETE(m_pDeliverOutputSemaphore);
@@ -1761,7 +1835,10 @@ mfxStatus CDecodingPipeline::RunDecoding()
                     pDecodeErrorReport = (mfxExtDecodeErrorReport *)GetExtBuffer(pBitstream->ExtParam, pBitstream->NumExtParam, MFX_EXTBUFF_DECODE_ERROR_REPORT);
                 }
 #endif
-                sts = m_pmfxDEC->DecodeFrameAsync(pBitstream, &(m_pCurrentFreeSurface->frame), &pOutSurface, &(m_pCurrentFreeOutputSurface->syncp));
+                {
+                    MFX_ITT_TASK("DecodeFrameAsync");
+                    sts = m_pmfxDEC->DecodeFrameAsync(pBitstream, &(m_pCurrentFreeSurface->frame), &pOutSurface, &(m_pCurrentFreeOutputSurface->syncp));
+                }
 
 #if (MFX_VERSION >= 1025)
                 PrintDecodeErrorReport(pDecodeErrorReport);
@@ -1924,19 +2001,9 @@ mfxStatus CDecodingPipeline::RunDecoding()
 
     PrintPerFrameStat(true);
 
-    if (m_bPrintLatency && m_vLatency.size() > 0) {
-        unsigned int frame_idx = 0;
-        msdk_tick sum = 0;
-        for (std::vector<msdk_tick>::iterator it = m_vLatency.begin(); it != m_vLatency.end(); ++it)
-        {
-            sum += *it;
-            msdk_printf(MSDK_STRING("Frame %4d, latency=%5.5f ms\n"), ++frame_idx, CTimer::ConvertToSeconds(*it)*1000);
-        }
+    if (m_bPrintLatency && m_latencyHistogram.GetCount() > 0) {
         msdk_printf(MSDK_STRING("\nLatency summary:\n"));
-        msdk_printf(MSDK_STRING("\nAVG=%5.5f ms, MAX=%5.5f ms, MIN=%5.5f ms"),
-            CTimer::ConvertToSeconds((msdk_tick)((mfxF64)sum/m_vLatency.size()))*1000,
-            CTimer::ConvertToSeconds(*std::max_element(m_vLatency.begin(), m_vLatency.end()))*1000,
-            CTimer::ConvertToSeconds(*std::min_element(m_vLatency.begin(), m_vLatency.end()))*1000);
+        m_latencyHistogram.PrintSummary(MSDK_STRING(""));
     }
 
     if (m_eWorkMode == MODE_RENDERING) {
@@ -1944,6 +2011,8 @@ mfxStatus CDecodingPipeline::RunDecoding()
         m_pDeliverOutputSemaphore->Post();
         if (pDeliverThread)
             pDeliverThread->Wait();
+
+        m_presentationScheduler.PrintStatistics();
     }
 
     MSDK_SAFE_DELETE(m_pDeliverOutputSemaphore);
@@ -0,0 +1,72 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <samples/ocv_common.hpp>
+
+#include "preprocess.hpp"
+#include "resize_kernel.hpp"
+
+using namespace InferenceEngine;
+
+// The kernel writes 8-bit BGR planes
+static bool isPlanarBgr(const TensorDesc &desc) {
+    const SizeVector &dims = desc.getDims();
+    return dims.size() == 4 && dims[1] == 3 && desc.getPrecision() == Precision::U8 && desc.getLayout() == Layout::NCHW;
+}
+
+void resizeToBlob(const cv::Mat &image, const Blob::Ptr &blob, size_t batchIndex, bool parallel) {
+    const SizeVector dims = blob->getTensorDesc().getDims();
+    if (image.type() != CV_8UC3 || !isPlanarBgr(blob->getTensorDesc())) {
+        Blob::Ptr target = blob;
+        matU8ToBlob<uint8_t>(image, target, static_cast<int>(batchIndex));
+        return;
+    }
+
+    const int width = static_cast<int>(dims[3]);
+    const int height = static_cast<int>(dims[2]);
+    uint8_t *planes = blob->buffer().as<uint8_t *>() + batchIndex * 3 * width * height;
+    const ResizeTaps columns(image.cols, width, 3);
+    const ResizeTaps rows(image.rows, height, 1);
+    if (parallel) {
+        cv::parallel_for_(cv::Range(0, height), [&](const cv::Range &range) {
+            resizeBgrRows(image.ptr<uint8_t>(), image.step, columns, rows, planes, width, height,
+                          range.start, range.end);
+        });
+    } else {
+        resizeBgrRows(image.ptr<uint8_t>(), image.step, columns, rows, planes, width, height, 0, height);
+    }
+}
+
+void FaceCrop::extract(const cv::Mat &face, const cv::Size &tileSize) {
+    _filled.clear();
+    if (tileSize.area() > 0 && (face.cols > tileSize.width || face.rows > tileSize.height)) {
+        cv::resize(face, _tile, cv::Size(std::min(face.cols, tileSize.width), std::min(face.rows, tileSize.height)),
+                   0, 0, cv::INTER_AREA);
+    } else {
+        _tile = face;
+    }
+}
+
+void FaceCrop::fill(const Blob::Ptr &blob, size_t batchIndex) {
+    if (!isPlanarBgr(blob->getTensorDesc())) {
+        resizeToBlob(_tile, blob, batchIndex);
+        return;
+    }
+    const SizeVector dims = blob->getTensorDesc().getDims();
+    const cv::Size size(static_cast<int>(dims[3]), static_cast<int>(dims[2]));
+    const size_t imageSize = 3 * size.area();
+    uint8_t *image = blob->buffer().as<uint8_t *>() + batchIndex * imageSize;
+    for (const auto &filled : _filled) {
+        if (filled.first == size) {
+            std::memcpy(image, filled.second, imageSize);
+            return;
+        }
+    }
+    resizeToBlob(_tile, blob, batchIndex);
+    _filled.emplace_back(size, image);
+}
@@ -0,0 +1,101 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "resize_kernel.hpp"
+
+ResizeTaps::ResizeTaps(int srcSize, int dstSize, int stride) : first(dstSize), second(dstSize), weight(dstSize) {
+    const float scale = static_cast<float>(srcSize) / dstSize;
+    for (int i = 0; i < dstSize; ++i) {
+        const float f = (i + 0.5f) * scale - 0.5f;
+        int s = static_cast<int>(std::floor(f));
+        float w = f - s;
+        if (s < 0) {
+            s = 0;
+            w = 0.f;
+        }
+        if (s >= srcSize - 1) {
+            s = srcSize - 1;
+            w = 0.f;
+        }
+        first[i] = s * stride;
+        second[i] = std::min(s + 1, srcSize - 1) * stride;
+        weight[i] = w;
+    }
+}
+
+namespace {
+// Interpolates a source BGR row horizontally into three planar rows of width floats
+void interpolateRow(const uint8_t *src, const ResizeTaps &columns, int width, float *dst) {
+    float *blue = dst;
+    float *green = dst + width;
+    float *red = dst + 2 * width;
+    for (int x = 0; x < width; ++x) {
+        const uint8_t *a = src + columns.first[x];
+        const uint8_t *b = src + columns.second[x];
+        const float w = columns.weight[x];
+        blue[x] = a[0] + (b[0] - a[0]) * w;
+        green[x] = a[1] + (b[1] - a[1]) * w;
+        red[x] = a[2] + (b[2] - a[2]) * w;
+    }
+}
+}  // namespace
+
+// The blended values lie in [0, 255], so adding 0.5 and truncating rounds half up. _mm_cvtps_epi32 would
+// round half to even and let the last pixels of a row, left to the scalar loop, round differently.
+void blendRow(const float *top, const float *bottom, float weight, uint8_t *dst, int width) {
+    int x = 0;
+#ifdef __SSE2__
+    const __m128 w = _mm_set1_ps(weight);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; x + 8 <= width; x += 8) {
+        const __m128 t0 = _mm_loadu_ps(top + x);
+        const __m128 t1 = _mm_loadu_ps(top + x + 4);
+        const __m128 b0 = _mm_loadu_ps(bottom + x);
+        const __m128 b1 = _mm_loadu_ps(bottom + x + 4);
+        const __m128i v0 = _mm_cvttps_epi32(_mm_add_ps(_mm_add_ps(t0, _mm_mul_ps(_mm_sub_ps(b0, t0), w)), half));
+        const __m128i v1 = _mm_cvttps_epi32(_mm_add_ps(_mm_add_ps(t1, _mm_mul_ps(_mm_sub_ps(b1, t1), w)), half));
+        const __m128i v = _mm_packs_epi32(v0, v1);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(v, v));
+    }
+#endif
+    blendRowScalar(top + x, bottom + x, weight, dst + x, width - x);
+}
+
+void blendRowScalar(const float *top, const float *bottom, float weight, uint8_t *dst, int width) {
+    for (int x = 0; x < width; ++x) {
+        dst[x] = static_cast<uint8_t>(top[x] + (bottom[x] - top[x]) * weight + 0.5f);
+    }
+}
+
+void resizeBgrRows(const uint8_t *src, size_t srcStep, const ResizeTaps &columns, const ResizeTaps &rows,
+                   uint8_t *planes, int width, int height, int begin, int end) {
+    std::vector<float> top(3 * width), bottom(3 * width);
+    const size_t planeSize = static_cast<size_t>(width) * height;
+    int topRow = -1, bottomRow = -1;
+    for (int y = begin; y < end; ++y) {
+        // When upscaling, neighbouring output rows share their source rows
+        if (rows.first[y] == bottomRow) {
+            top.swap(bottom);
+            std::swap(topRow, bottomRow);
+        }
+        if (rows.first[y] != topRow) {
+            topRow = rows.first[y];
+            interpolateRow(src + topRow * srcStep, columns, width, top.data());
+        }
+        if (rows.second[y] != bottomRow) {
+            bottomRow = rows.second[y];
+            interpolateRow(src + bottomRow * srcStep, columns, width, bottom.data());
+        }
+        for (int c = 0; c < 3; ++c) {
+            blendRow(top.data() + c * width, bottom.data() + c * width, rows.weight[y],
+                     planes + c * planeSize + static_cast<size_t>(y) * width, width);
+        }
+    }
+}
@@ -31,7 +31,7 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 
 
 // Takes the video 
-int media_sdk(const char* fileName)
+int media_sdk(const char* fileName, AdPlayback* playback, mfxU32 latencyPeriod)
 {
     sInputParams        Params;   // input parameters from command line
     CDecodingPipeline   Pipeline; // pipeline for decoding, includes input file reader, decoder and output file writer
@@ -51,6 +51,9 @@ int media_sdk(const char* fileName)
     msdk_opt_read("700", Params.Width);
     msdk_opt_read("400", Params.Height);
     Params.bUseHWLib = true;
+    // the latency is measured on complete frames, summed up per period and for the whole ad
+    Params.bCalLat = latencyPeriod > 0;
+    Params.nLatencyPeriod = latencyPeriod;
     if (Params.nAsyncDepth == 0)
     {
         Params.nAsyncDepth = 4; //set by default;
@@ -138,6 +141,12 @@ int media_sdk(const char* fileName)
     }
 
     msdk_printf(MSDK_STRING("\nDecoding finished\n"));
+    if (playback)
+    {
+        playback->firstRendered = Pipeline.GetFirstRenderTick();
+        playback->lastRendered = Pipeline.GetLastRenderTick();
+        playback->frames = Pipeline.GetRenderedFrames();
+    }
 
     return 0;
 }
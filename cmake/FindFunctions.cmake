@@ -76,6 +76,9 @@ function( create_build )
   # endforeach()
   add_subdirectory( sample_common )
   add_subdirectory( application )
+  add_subdirectory( decode_benchmark )
+  add_subdirectory( micro_benchmark )
+  add_subdirectory( tests )
 endfunction()
 
 # .....................................................
@@ -264,7 +267,7 @@ COMPILE_PDB_NAME ${target})
 
   target_link_libraries( ${target} format_reader -lcurl ${InferenceEngine_LIBRARIES} gflags)
   if(UNIX)
-    target_link_libraries(  ${target} ${LIB_DL} pthread ${OpenCV_LIBRARIES})
+    target_link_libraries(  ${target} ${LIB_DL} pthread rt ${OpenCV_LIBRARIES})
   endif()
   set( target ${target} PARENT_SCOPE )
 endfunction()
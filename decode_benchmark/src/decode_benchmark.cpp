@@ -0,0 +1,278 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// Headless decode benchmark: runs CDecodingPipeline in performance mode
+// (system memory, no rendering) over a list of input files and reports
+// decode fps, per-frame latency percentiles and memory use.
+
+#include "mfx_samples_config.h"
+
+#include "pipeline_decode.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#ifndef MFX_VERSION
+#error MFX_VERSION not defined
+#endif
+
+struct sBenchmarkResult
+{
+    std::string file;
+    mfxU32      frames;
+    mfxF64      seconds;
+    mfxF64      latency_p50;
+    mfxF64      latency_p90;
+    mfxF64      latency_p99;
+    mfxF64      latency_max;
+    long        rss_kb;
+
+    sBenchmarkResult():
+        frames(0), seconds(0),
+        latency_p50(0), latency_p90(0), latency_p99(0), latency_max(0),
+        rss_kb(0)
+    {
+    }
+};
+
+static void PrintHelp(const char* app)
+{
+    printf("Usage: %s [options] file1 [file2 ...]\n", app);
+    printf("Options:\n");
+    printf("   [-c codec]    - input codec: h264|h265|mpeg2|vc1|mvc|jpeg|vp8|vp9 (default h265)\n");
+    printf("   [-a depth]    - async depth of the decoder (default 4)\n");
+    printf("   [-n frames]   - decode at most this number of frames per file\n");
+    printf("   [-r repeat]   - number of passes over every file (default 1)\n");
+    printf("   [-t threads]  - number of threads of the SW library\n");
+    printf("   [-lp seconds] - also print the latency of the frames of every period of this length\n");
+    printf("   [-hw]         - use the HW library instead of the SW one\n");
+    printf("   [-arena]      - reuse hugepage-backed surfaces between runs\n");
+}
+
+// resident set size of the process in kilobytes
+static long GetCurrentRSS()
+{
+    long pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+    if (fscanf(f, "%ld %ld", &pages, &resident) != 2)
+        resident = 0;
+    fclose(f);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static long GetPeakRSS()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+    return usage.ru_maxrss;
+}
+
+static bool IsLatencySupported(mfxU32 codec)
+{
+    // complete frame readers are available only for these codecs
+    switch (codec)
+    {
+    case MFX_CODEC_AVC:
+    case MFX_CODEC_HEVC:
+    case MFX_CODEC_JPEG:
+    case MFX_CODEC_VP8:
+    case MFX_CODEC_VP9:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static mfxStatus RunFile(sInputParams& Params, sBenchmarkResult& result)
+{
+    std::unique_ptr<CDecodingPipeline> Pipeline(new CDecodingPipeline);
+    mfxStatus sts = MFX_ERR_NONE;
+
+    if (Params.bIsMVC)
+        Pipeline->SetMultiView();
+
+    sts = Pipeline->Init(&Params);
+    MSDK_CHECK_STATUS(sts, "Pipeline.Init failed");
+
+    mfxU64 prevResetBytesCount = 0xFFFFFFFFFFFFFFFF;
+    for (;;)
+    {
+        sts = Pipeline->RunDecoding();
+        if (MFX_ERR_INCOMPATIBLE_VIDEO_PARAM == sts || MFX_ERR_DEVICE_LOST == sts || MFX_ERR_DEVICE_FAILED == sts)
+        {
+            if (prevResetBytesCount == Pipeline->GetTotalBytesProcessed())
+            {
+                msdk_printf(MSDK_STRING("\nERROR: No input data was consumed since last reset. Quitting to avoid looping forever.\n"));
+                break;
+            }
+            prevResetBytesCount = Pipeline->GetTotalBytesProcessed();
+
+            if (MFX_ERR_DEVICE_LOST == sts || MFX_ERR_DEVICE_FAILED == sts)
+            {
+                sts = Pipeline->ResetDevice();
+                MSDK_CHECK_STATUS(sts, "Pipeline.ResetDevice failed");
+            }
+
+            sts = Pipeline->ResetDecoder(&Params);
+            MSDK_CHECK_STATUS(sts, "Pipeline.ResetDecoder failed");
+            continue;
+        }
+        MSDK_CHECK_STATUS(sts, "Pipeline.RunDecoding failed");
+        break;
+    }
+
+    result.frames = Pipeline->m_output_count;
+    result.seconds = CTimer::ConvertToSeconds(Pipeline->m_tick_overall);
+    const CLatencyHistogram& latency = Pipeline->GetLatencyHistogram();
+    result.latency_p50 = latency.GetQuantile(0.5);
+    result.latency_p90 = latency.GetQuantile(0.9);
+    result.latency_p99 = latency.GetQuantile(0.99);
+    result.latency_max = latency.GetMax();
+    result.rss_kb = GetCurrentRSS();
+
+    return sts;
+}
+
+int main(int argc, char* argv[])
+{
+    sInputParams Params;
+    char codec[16] = "h265";
+    mfxU32 nRepeat = 1;
+    std::vector<const char*> files;
+    mfxStatus sts = MFX_ERR_NONE;
+
+    Params.mode = MODE_PERFORMANCE;
+    Params.memType = SYSTEM_MEMORY;
+    Params.bUseHWLib = false;
+    Params.nAsyncDepth = 4;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-hw"))
+        {
+            Params.bUseHWLib = true;
+        }
+        else if (!strcmp(argv[i], "-arena"))
+        {
+            Params.bUseSurfaceArena = true;
+        }
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+        {
+            snprintf(codec, sizeof(codec), "%s", argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-a") && i + 1 < argc)
+        {
+            sts = msdk_opt_read(argv[++i], Params.nAsyncDepth);
+        }
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            sts = msdk_opt_read(argv[++i], Params.nFrames);
+        }
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+        {
+            sts = msdk_opt_read(argv[++i], nRepeat);
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+        {
+            sts = msdk_opt_read(argv[++i], Params.nThreadsNum);
+        }
+        else if (!strcmp(argv[i], "-lp") && i + 1 < argc)
+        {
+            sts = msdk_opt_read(argv[++i], Params.nLatencyPeriod);
+        }
+        else if (argv[i][0] == '-')
+        {
+            PrintHelp(argv[0]);
+            return 1;
+        }
+        else
+        {
+            files.push_back(argv[i]);
+        }
+
+        if (sts != MFX_ERR_NONE)
+        {
+            printf("error: invalid value of option %s\n", argv[i - 1]);
+            return 1;
+        }
+    }
+
+    if (files.empty() || !nRepeat || !Params.nAsyncDepth)
+    {
+        PrintHelp(argv[0]);
+        return 1;
+    }
+
+    sts = StrFormatToCodecFormatFourCC(codec, Params.videoType);
+    if (sts != MFX_ERR_NONE || !IsDecodeCodecSupported(Params.videoType))
+    {
+        printf("error: unsupported codec %s\n", codec);
+        return 1;
+    }
+    if (Params.videoType == CODEC_MVC)
+    {
+        Params.videoType = MFX_CODEC_AVC;
+        Params.bIsMVC = true;
+    }
+    // per-frame latency is measured on complete frames only
+    Params.bCalLat = IsLatencySupported(Params.videoType);
+
+    std::vector<sBenchmarkResult> results;
+    for (mfxU32 pass = 0; pass < nRepeat; pass++)
+    {
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            sBenchmarkResult result;
+            result.file = files[i];
+
+            msdk_opt_read(files[i], Params.strSrcFile);
+            msdk_printf(MSDK_STRING("Decoding %s (pass %u)\n"), files[i], pass + 1);
+
+            sts = RunFile(Params, result);
+            if (sts != MFX_ERR_NONE)
+                return 1;
+
+            results.push_back(result);
+        }
+    }
+
+    printf("\n%-32s %8s %10s %10s %10s %10s %10s %10s\n",
+        "file", "frames", "fps", "p50 ms", "p90 ms", "p99 ms", "max ms", "rss KB");
+    mfxU64 totalFrames = 0;
+    mfxF64 totalSeconds = 0;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const sBenchmarkResult& r = results[i];
+        printf("%-32s %8u %10.2f %10.3f %10.3f %10.3f %10.3f %10ld\n",
+            r.file.c_str(), r.frames, r.seconds > 0 ? r.frames / r.seconds : 0.0,
+            r.latency_p50, r.latency_p90, r.latency_p99, r.latency_max, r.rss_kb);
+        totalFrames += r.frames;
+        totalSeconds += r.seconds;
+    }
+    printf("\nimpl=%s async=%u frames=%llu fps=%.2f peak rss=%ld KB\n",
+        Params.bUseHWLib ? "hw" : "sw", Params.nAsyncDepth, (unsigned long long)totalFrames,
+        totalSeconds > 0 ? totalFrames / totalSeconds : 0.0, GetPeakRSS());
+
+    return 0;
+}
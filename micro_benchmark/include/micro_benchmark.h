@@ -0,0 +1,64 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __MICRO_BENCHMARK_H__
+#define __MICRO_BENCHMARK_H__
+
+#include "mfxdefs.h"
+#include "vm/time_defs.h"
+
+struct sMicroBenchmarkParams
+{
+    mfxU32 nSizeMB;     // size of the data of the modes working on a buffer
+    mfxU32 nRepeat;     // number of timed runs, the fastest one is reported
+    mfxU32 nIterations; // number of operations of one run of the modes timing single operations
+    mfxU32 nThreads;    // number of threads of the modes measuring contention
+
+    sMicroBenchmarkParams():
+        nSizeMB(64), nRepeat(5), nIterations(1000000), nThreads(4)
+    {
+    }
+};
+
+/** \brief Returns the shortest of repeat runs of func, in seconds. */
+template <class Func>
+mfxF64 MeasureBestRun(mfxU32 repeat, Func func)
+{
+    mfxF64 best = 0;
+    for (mfxU32 i = 0; i < repeat; i++)
+    {
+        msdk_tick start = msdk_time_get_tick();
+        func();
+        mfxF64 seconds = MSDK_GET_TIME(msdk_time_get_tick(), start, msdk_time_get_frequency());
+        if (!i || seconds < best)
+            best = seconds;
+    }
+    return best;
+}
+
+/** \brief Results are added to it, so the compiler cannot drop the work measured. */
+extern volatile mfxU64 g_benchmarkSink;
+
+int RunScanBenchmark(const sMicroBenchmarkParams& params);
+int RunAtomicListBenchmark(const sMicroBenchmarkParams& params);
+int RunSemaphoreBenchmark(const sMicroBenchmarkParams& params);
+int RunDetectionFilterBenchmark(const sMicroBenchmarkParams& params);
+int RunResizeBenchmark(const sMicroBenchmarkParams& params);
+
+#endif // __MICRO_BENCHMARK_H__
@@ -0,0 +1,110 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// Contention on msdkAtomicList: producer threads push items while one consumer takes them,
+// the way decoder threads return surfaces to msdkFreeSurfacesPool. The same list guarded by
+// MSDKMutex, as the pools were before, is the reference.
+
+#include "micro_benchmark.h"
+#include "mfx_buffering.h"
+
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct sBenchmarkItem
+{
+    sBenchmarkItem* next;
+};
+
+class CMutexList
+{
+public:
+    CMutexList():
+        m_pHead(NULL) {}
+
+    void Push(sBenchmarkItem* item) {
+        AutomaticMutex lock(m_mutex);
+        item->next = m_pHead;
+        m_pHead = item;
+    }
+    sBenchmarkItem* TakeAll() {
+        AutomaticMutex lock(m_mutex);
+        sBenchmarkItem* head = m_pHead;
+        m_pHead = NULL;
+        return head;
+    }
+
+private:
+    MSDKMutex       m_mutex;
+    sBenchmarkItem* m_pHead;
+};
+
+// Seconds the producers need to push all the items and the consumer to take them
+template <class List>
+mfxF64 RunContention(const sMicroBenchmarkParams& params, mfxU32 threads, std::vector<sBenchmarkItem>& items)
+{
+    return MeasureBestRun(params.nRepeat, [&]() {
+        List list;
+        const size_t perThread = items.size() / threads;
+        std::vector<std::thread> producers;
+        for (mfxU32 t = 0; t < threads; t++)
+        {
+            producers.push_back(std::thread([&list, &items, perThread, t]() {
+                for (size_t i = t * perThread; i < (t + 1) * perThread; i++)
+                    list.Push(&items[i]);
+            }));
+        }
+
+        size_t taken = 0;
+        while (taken < perThread * threads)
+        {
+            for (sBenchmarkItem* item = list.TakeAll(); item; item = item->next)
+                taken++;
+        }
+        for (size_t t = 0; t < producers.size(); t++)
+            producers[t].join();
+        g_benchmarkSink += taken;
+    });
+}
+
+} // namespace
+
+int RunAtomicListBenchmark(const sMicroBenchmarkParams& params)
+{
+    std::vector<sBenchmarkItem> items(params.nIterations);
+
+    printf("%u items, best of %u runs, one consumer\n\n", params.nIterations, params.nRepeat);
+    printf("%-10s %14s %14s %10s\n", "producers", "mutex Mops/s", "atomic Mops/s", "speedup");
+
+    for (mfxU32 threads = 1; threads <= params.nThreads; threads *= 2)
+    {
+        mfxF64 mutexSeconds = RunContention<CMutexList>(params, threads, items);
+        mfxF64 atomicSeconds = RunContention<msdkAtomicList<sBenchmarkItem> >(params, threads, items);
+        printf("%-10u %14.2f %14.2f %10.2f\n", threads,
+            mutexSeconds > 0 ? items.size() / mutexSeconds / 1e6 : 0.0,
+            atomicSeconds > 0 ? items.size() / atomicSeconds / 1e6 : 0.0,
+            atomicSeconds > 0 ? mutexSeconds / atomicSeconds : 0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// Confidence filter of the face detection decoder (application/include/detection_rows.hpp): the rows
+// of an output are compared four at a time with SSE2 against the branchless scalar loop. The confidences
+// are strided by the row size, so the SSE2 loop gathers them with scalar loads.
+
+#include "micro_benchmark.h"
+#include "detection_rows.hpp"
+
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+
+const float THRESHOLD = 0.5f;
+
+// Mostly background proposals, with a face every 50 rows
+template <typename Rows>
+std::vector<float> MakeDetections(int count)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> background(0.f, 0.3f);
+    std::vector<float> detections((size_t)count * Rows::size);
+    for (int i = 0; i < count; i++)
+    {
+        float* row = &detections[(size_t)i * Rows::size];
+        for (int j = 0; j < Rows::size; j++)
+            row[j] = background(random);
+        row[Rows::confidence] = i % 50 ? background(random) : 0.9f;
+    }
+    return detections;
+}
+
+template <typename Rows, class Filter>
+mfxF64 MeasureFilter(const sMicroBenchmarkParams& params, const std::vector<float>& detections, int count,
+    Filter filter)
+{
+    std::vector<int> survivors;
+    survivors.reserve((size_t)count);
+    return MeasureBestRun(params.nRepeat, [&]() {
+        for (mfxU32 i = 0; i < params.nIterations; i++)
+        {
+            filter(&detections[0], count, THRESHOLD, survivors);
+            g_benchmarkSink += survivors.size();
+        }
+    });
+}
+
+template <typename Rows>
+int RunLayout(const sMicroBenchmarkParams& params, const char* layout, int count)
+{
+    std::vector<float> detections = MakeDetections<Rows>(count);
+
+    std::vector<int> expected, actual;
+    filterByConfidenceScalar<Rows>(&detections[0], count, THRESHOLD, expected);
+    filterByConfidence<Rows>(&detections[0], count, THRESHOLD, actual);
+    if (expected != actual)
+    {
+        printf("%-18s %6d: the filter differs from the scalar loop\n", layout, count);
+        return 1;
+    }
+
+    mfxF64 reference = MeasureFilter<Rows>(params, detections, count, filterByConfidenceScalar<Rows>);
+    mfxF64 seconds = MeasureFilter<Rows>(params, detections, count, filterByConfidence<Rows>);
+    printf("%-18s %6d %-6s %10.1f %10.2f\n", layout, count, "C", reference * 1e9 / params.nIterations, 1.0);
+#ifdef __SSE2__
+    printf("%-18s %6d %-6s %10.1f %10.2f\n", layout, count, "SSE2", seconds * 1e9 / params.nIterations,
+        seconds > 0 ? reference / seconds : 0.0);
+#else
+    (void)seconds;
+#endif
+    return 0;
+}
+
+} // namespace
+
+int RunDetectionFilterBenchmark(const sMicroBenchmarkParams& params)
+{
+    printf("%u calls per run, best of %u runs, speedup against C\n\n", params.nIterations, params.nRepeat);
+    printf("%-18s %6s %-6s %10s %10s\n", "layout", "rows", "isa", "ns/call", "speedup");
+
+    // 200 proposals for the SSD face detectors, the boxes outputs hold up to a few thousand
+    int sts = RunLayout<DetectionOutputRows>(params, "DetectionOutput", 200);
+    sts |= RunLayout<BoxesRows>(params, "Boxes", 200);
+    sts |= RunLayout<BoxesRows>(params, "Boxes", 2000);
+    return sts;
+}
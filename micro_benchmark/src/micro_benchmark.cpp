@@ -0,0 +1,109 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// Microbenchmarks of the kernels and primitives of the samples, one mode per run.
+// Every mode prints a table comparing the variants of what it measures.
+
+#include "micro_benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+volatile mfxU64 g_benchmarkSink = 0;
+
+struct sBenchmarkMode
+{
+    const char* name;
+    const char* description;
+    int (*run)(const sMicroBenchmarkParams& params);
+};
+
+static const sBenchmarkMode g_modes[] =
+{
+    { "scan", "start code search and dword swapping copy of bitstream_scan.h, per instruction set", RunScanBenchmark },
+    { "atomic_list", "msdkAtomicList against a mutex guarded list, 1 to -t producer threads and one consumer", RunAtomicListBenchmark },
+    { "semaphore", "MSDKSemaphore and MSDKEvent against mutex and condition variable pairs, ping-pong between two threads", RunSemaphoreBenchmark },
+    { "detection_filter", "confidence filter of the face detection decoder, SSE2 against the scalar loop", RunDetectionFilterBenchmark },
+    { "resize", "bilinear BGR to planes resize of the network inputs against matU8ToBlob, SSE2 against the scalar row blend", RunResizeBenchmark },
+};
+
+static void PrintHelp(const char* app)
+{
+    printf("Usage: %s mode [options]\n", app);
+    printf("Modes:\n");
+    for (size_t i = 0; i < sizeof(g_modes) / sizeof(g_modes[0]); i++)
+        printf("   %-16s - %s\n", g_modes[i].name, g_modes[i].description);
+    printf("Options:\n");
+    printf("   [-s MB]       - size of the data of the buffer modes (default 64)\n");
+    printf("   [-r repeat]   - number of runs, the fastest one is reported (default 5)\n");
+    printf("   [-n count]    - number of operations per run of the single operation modes (default 1000000)\n");
+    printf("   [-t threads]  - number of threads of the contention modes (default 4)\n");
+}
+
+static bool ReadValue(const char* value, mfxU32& result)
+{
+    char* end = NULL;
+    unsigned long parsed = strtoul(value, &end, 10);
+    if (!*value || *end || !parsed)
+        return false;
+    result = (mfxU32)parsed;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    sMicroBenchmarkParams params;
+
+    if (argc < 2)
+    {
+        PrintHelp(argv[0]);
+        return 1;
+    }
+
+    for (int i = 2; i < argc; i++)
+    {
+        bool ok = i + 1 < argc;
+        if (ok && !strcmp(argv[i], "-s"))
+            ok = ReadValue(argv[++i], params.nSizeMB);
+        else if (ok && !strcmp(argv[i], "-r"))
+            ok = ReadValue(argv[++i], params.nRepeat);
+        else if (ok && !strcmp(argv[i], "-n"))
+            ok = ReadValue(argv[++i], params.nIterations);
+        else if (ok && !strcmp(argv[i], "-t"))
+            ok = ReadValue(argv[++i], params.nThreads);
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            PrintHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(g_modes) / sizeof(g_modes[0]); i++)
+    {
+        if (!strcmp(argv[1], g_modes[i].name))
+            return g_modes[i].run(params);
+    }
+
+    PrintHelp(argv[0]);
+    return 1;
+}
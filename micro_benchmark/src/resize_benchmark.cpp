@@ -0,0 +1,177 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// Bilinear resize of the network inputs (application/include/resize_kernel.hpp): a camera frame for face
+// detection and a face for the face analytics networks, against matU8ToBlob, which it replaced. The row
+// blend, the vectorised part of the kernel, is also timed on its own against the scalar loop it replaced.
+
+#include "micro_benchmark.h"
+#include "resize_kernel.hpp"
+
+#include <samples/ocv_common.hpp>
+
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace InferenceEngine;
+
+namespace
+{
+
+struct sResizeCase
+{
+    const char* name;
+    int srcWidth;
+    int srcHeight;
+    int width;
+    int height;
+};
+
+const sResizeCase RESIZE_CASES[] =
+{
+    { "1080p to face detection", 1920, 1080, 672, 384 },
+    { "face to age/gender", 200, 200, 62, 62 },
+    { "face to head pose", 200, 200, 60, 60 },
+    { "face to emotions", 200, 200, 64, 64 },
+};
+
+// Frames of -s MB of source data per run. matU8ToBlob resizes with cv::resize into a temporary image
+// and copies it into the blob pixel by pixel, the kernel writes the planes of the blob directly.
+int RunResize(const sMicroBenchmarkParams& params, const sResizeCase& test)
+{
+    std::mt19937 random(1);
+    cv::Mat image(test.srcHeight, test.srcWidth, CV_8UC3);
+    for (int y = 0; y < image.rows; y++)
+    {
+        mfxU8* row = image.ptr<mfxU8>(y);
+        for (int x = 0; x < image.cols * 3; x++)
+            row[x] = (mfxU8)random();
+    }
+    const size_t planesSize = (size_t)3 * test.width * test.height;
+    Blob::Ptr blob = make_shared_blob<uint8_t>(
+        TensorDesc(Precision::U8, {1, 3, (size_t)test.height, (size_t)test.width}, Layout::NCHW));
+    blob->allocate();
+    mfxU8* planes = blob->buffer().as<mfxU8*>();
+
+    const ResizeTaps columns(test.srcWidth, test.width, 3);
+    const ResizeTaps rows(test.srcHeight, test.height, 1);
+
+    // cv::resize rounds in fixed point, the kernel in floating point
+    matU8ToBlob<uint8_t>(image, blob);
+    std::vector<mfxU8> expected(planes, planes + planesSize);
+    resizeBgrRows(image.ptr<mfxU8>(), image.step, columns, rows, planes, test.width, test.height, 0, test.height);
+    for (size_t i = 0; i < planesSize; i++)
+    {
+        if (abs((int)planes[i] - (int)expected[i]) > 1)
+        {
+            printf("%s: differs from matU8ToBlob by more than one level at %zu\n", test.name, i);
+            return 1;
+        }
+    }
+
+    const size_t imageSize = (size_t)test.srcWidth * test.srcHeight * 3;
+    const mfxU32 calls = std::max<mfxU32>(1, (mfxU32)((mfxU64)params.nSizeMB * 1024 * 1024 / imageSize));
+    mfxF64 reference = MeasureBestRun(params.nRepeat, [&]() {
+        for (mfxU32 i = 0; i < calls; i++)
+        {
+            matU8ToBlob<uint8_t>(image, blob);
+            g_benchmarkSink += planes[i % planesSize];
+        }
+    });
+    mfxF64 seconds = MeasureBestRun(params.nRepeat, [&]() {
+        for (mfxU32 i = 0; i < calls; i++)
+        {
+            resizeBgrRows(image.ptr<mfxU8>(), image.step, columns, rows, planes, test.width, test.height, 0, test.height);
+            g_benchmarkSink += planes[i % planesSize];
+        }
+    });
+
+    const mfxF64 pixels = (mfxF64)calls * test.width * test.height;
+    printf("%-26s %4dx%-4d %4dx%-4d %-12s %10.1f %10.1f %10.2f\n", test.name, test.srcWidth, test.srcHeight,
+        test.width, test.height, "matU8ToBlob", reference * 1e6 / calls, reference > 0 ? pixels / reference / 1e6 : 0.0, 1.0);
+    printf("%-26s %4dx%-4d %4dx%-4d %-12s %10.1f %10.1f %10.2f\n", test.name, test.srcWidth, test.srcHeight,
+        test.width, test.height, "kernel", seconds * 1e6 / calls, seconds > 0 ? pixels / seconds / 1e6 : 0.0,
+        seconds > 0 ? reference / seconds : 0.0);
+    return 0;
+}
+
+// The rows hold every blend of two bytes, the halves included, so both loops must round them the same way
+int RunBlend(const sMicroBenchmarkParams& params, int width)
+{
+    std::mt19937 random(1);
+    std::vector<float> top(width), bottom(width);
+    for (int x = 0; x < width; x++)
+    {
+        top[x] = (float)(random() % 256);
+        bottom[x] = (float)(random() % 256);
+    }
+    std::vector<mfxU8> expected(width), actual(width);
+    for (int i = 0; i <= 16; i++)
+    {
+        blendRowScalar(&top[0], &bottom[0], i / 16.f, &expected[0], width);
+        blendRow(&top[0], &bottom[0], i / 16.f, &actual[0], width);
+        if (expected != actual)
+        {
+            printf("blendRow %d: differs from the scalar loop at the weight %d/16\n", width, i);
+            return 1;
+        }
+    }
+
+    auto measure = [&](void (*blend)(const float*, const float*, float, mfxU8*, int)) {
+        return MeasureBestRun(params.nRepeat, [&]() {
+            for (mfxU32 i = 0; i < params.nIterations; i++)
+            {
+                blend(&top[0], &bottom[0], (i & 15) / 16.f, &actual[0], width);
+                g_benchmarkSink += actual[i % width];
+            }
+        });
+    };
+    mfxF64 reference = measure(blendRowScalar);
+    mfxF64 seconds = measure(blendRow);
+    printf("%-26s %9d %-9s %10.1f %10.2f\n", "blendRow", width, "C", reference * 1e9 / params.nIterations, 1.0);
+#ifdef __SSE2__
+    printf("%-26s %9d %-9s %10.1f %10.2f\n", "blendRow", width, "SSE2", seconds * 1e9 / params.nIterations,
+        seconds > 0 ? reference / seconds : 0.0);
+#else
+    (void)seconds;
+#endif
+    return 0;
+}
+
+} // namespace
+
+int RunResizeBenchmark(const sMicroBenchmarkParams& params)
+{
+    printf("%u MB of source frames per run, best of %u runs\n\n", params.nSizeMB, params.nRepeat);
+    printf("%-26s %9s %9s %-12s %10s %10s %10s\n", "resize", "source", "output", "variant", "us/frame", "Mpixel/s",
+        "speedup");
+    int sts = 0;
+    for (size_t i = 0; i < sizeof(RESIZE_CASES) / sizeof(RESIZE_CASES[0]); i++)
+        sts |= RunResize(params, RESIZE_CASES[i]);
+
+    printf("\n%u rows per run, speedup against C\n\n", params.nIterations);
+    printf("%-26s %9s %-9s %10s %10s\n", "function", "width", "isa", "ns/row", "speedup");
+    // the widths of the inputs above, the last pixels of 62 are left to the scalar loop
+    sts |= RunBlend(params, 672);
+    sts |= RunBlend(params, 62);
+    return sts;
+}
@@ -0,0 +1,116 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// Throughput of bitstream_scan.h over a buffer of several MB, the way the splitters use it:
+// the start codes are searched one after another, the payload between them is copied swapped.
+
+#include "micro_benchmark.h"
+#include "bitstream_scan.h"
+
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+
+// A start code every 16 KB on average, about a slice of a 1080p stream
+const mfxU32 AVERAGE_NAL_SIZE = 16 * 1024;
+
+void FillBitstream(std::vector<mfxU8>& data)
+{
+    std::mt19937 random(1);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        // payload never holds 00 00 01, emulation prevention guarantees it in real streams
+        data[i] = (mfxU8)(random() % 255 + 1);
+    }
+    for (size_t i = random() % AVERAGE_NAL_SIZE; i + 3 <= data.size(); i += 4 + random() % (2 * AVERAGE_NAL_SIZE))
+    {
+        data[i] = 0;
+        data[i + 1] = 0;
+        data[i + 2] = 1;
+    }
+}
+
+mfxU64 FindAllTriples(const BitstreamScanFunctions& funcs, const std::vector<mfxU8>& data)
+{
+    mfxU64 count = 0;
+    const mfxU32 size = (mfxU32)data.size();
+    for (mfxU32 pos = funcs.findByteTriple(&data[0], size, 0, 0, 1); pos < size; count++)
+        pos += 3 + funcs.findByteTriple(&data[pos + 3], size - pos - 3, 0, 0, 1);
+    return count;
+}
+
+mfxU64 FindAllPairs(const BitstreamScanFunctions& funcs, const std::vector<mfxU8>& data)
+{
+    mfxU64 count = 0;
+    const mfxU32 size = (mfxU32)data.size();
+    for (mfxU32 pos = funcs.findBytePair(&data[0], size, 0, 0); pos < size; count++)
+        pos += 2 + funcs.findBytePair(&data[pos + 2], size - pos - 2, 0, 0);
+    return count;
+}
+
+void PrintRow(const char* function, msdkCpuIsa isa, mfxF64 bytes, mfxF64 seconds, mfxF64 referenceSeconds)
+{
+    printf("%-26s %-6s %10.2f %10.2f\n", function, msdk_cpu_isa_name(isa),
+        seconds > 0 ? bytes / seconds / 1e9 : 0.0, seconds > 0 ? referenceSeconds / seconds : 0.0);
+}
+
+} // namespace
+
+int RunScanBenchmark(const sMicroBenchmarkParams& params)
+{
+    std::vector<mfxU8> data((size_t)params.nSizeMB * 1024 * 1024);
+    std::vector<mfxU8> copy(data.size());
+    FillBitstream(data);
+
+    printf("%u MB, best of %u runs, speedup against C\n\n", params.nSizeMB, params.nRepeat);
+    printf("%-26s %-6s %10s %10s\n", "function", "isa", "GB/s", "speedup");
+
+    const msdkCpuIsa isas[] = { MSDK_CPU_ISA_C, MSDK_CPU_ISA_SSE2, MSDK_CPU_ISA_AVX2 };
+    mfxF64 reference[3] = { 0, 0, 0 };
+    for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); i++)
+    {
+        BitstreamScanFunctions funcs;
+        if (!GetBitstreamScanFunctions(isas[i], funcs))
+            continue;
+
+        mfxF64 seconds = MeasureBestRun(params.nRepeat, [&]() { g_benchmarkSink += FindAllTriples(funcs, data); });
+        if (!i)
+            reference[0] = seconds;
+        PrintRow("FindByteTriple", isas[i], (mfxF64)data.size(), seconds, reference[0]);
+
+        seconds = MeasureBestRun(params.nRepeat, [&]() { g_benchmarkSink += FindAllPairs(funcs, data); });
+        if (!i)
+            reference[1] = seconds;
+        PrintRow("FindBytePair", isas[i], (mfxF64)data.size(), seconds, reference[1]);
+
+        // an odd destination offset, as when a NAL is appended after a start code
+        seconds = MeasureBestRun(params.nRepeat, [&]() {
+            funcs.copyBytesSwappingDwords(&copy[0], 3, &data[0], (mfxU32)data.size() - 4);
+            g_benchmarkSink += copy[data.size() / 2];
+        });
+        if (!i)
+            reference[2] = seconds;
+        PrintRow("CopyBytesSwappingDwords", isas[i], (mfxF64)data.size(), seconds, reference[2]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// Hand-off cost of MSDKSemaphore and MSDKEvent, backed by futex words, against the
+// mutex and condition variable pairs they replaced: two threads pass a token back and
+// forth (a wake up per hand-off), one thread posts and waits (no waiter to wake).
+
+#include "micro_benchmark.h"
+#include "vm/thread_defs.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <thread>
+
+namespace
+{
+
+// The previous implementation of MSDKSemaphore
+class CCondSemaphore
+{
+public:
+    CCondSemaphore():
+        m_count(0)
+    {
+        pthread_mutex_init(&m_mutex, NULL);
+        pthread_cond_init(&m_cond, NULL);
+    }
+    ~CCondSemaphore()
+    {
+        pthread_cond_destroy(&m_cond);
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+    void Post()
+    {
+        pthread_mutex_lock(&m_mutex);
+        if (0 == m_count++)
+            pthread_cond_signal(&m_cond);
+        pthread_mutex_unlock(&m_mutex);
+    }
+    void Wait()
+    {
+        pthread_mutex_lock(&m_mutex);
+        while (!m_count)
+            pthread_cond_wait(&m_cond, &m_mutex);
+        --m_count;
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+private:
+    pthread_mutex_t m_mutex;
+    pthread_cond_t  m_cond;
+    mfxU32          m_count;
+};
+
+// The previous implementation of an auto reset MSDKEvent
+class CCondEvent
+{
+public:
+    CCondEvent():
+        m_state(false)
+    {
+        pthread_mutex_init(&m_mutex, NULL);
+        pthread_cond_init(&m_cond, NULL);
+    }
+    ~CCondEvent()
+    {
+        pthread_cond_destroy(&m_cond);
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+    void Post()
+    {
+        pthread_mutex_lock(&m_mutex);
+        if (!m_state)
+        {
+            m_state = true;
+            pthread_cond_signal(&m_cond);
+        }
+        pthread_mutex_unlock(&m_mutex);
+    }
+    void Wait()
+    {
+        pthread_mutex_lock(&m_mutex);
+        while (!m_state)
+            pthread_cond_wait(&m_cond, &m_mutex);
+        m_state = false;
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+private:
+    pthread_mutex_t m_mutex;
+    pthread_cond_t  m_cond;
+    bool            m_state;
+};
+
+class CFutexSemaphore
+{
+public:
+    CFutexSemaphore():
+        m_semaphore(m_sts) {}
+
+    void Post() { m_semaphore.Post(); }
+    void Wait() { m_semaphore.Wait(); }
+
+private:
+    mfxStatus     m_sts;
+    MSDKSemaphore m_semaphore;
+};
+
+class CFutexEvent
+{
+public:
+    CFutexEvent():
+        m_event(m_sts, false, false) {}
+
+    void Post() { m_event.Signal(); }
+    void Wait() { m_event.Wait(); }
+
+private:
+    mfxStatus m_sts;
+    MSDKEvent m_event;
+};
+
+// Seconds of count round trips between two threads
+template <class Primitive>
+mfxF64 RunPingPong(const sMicroBenchmarkParams& params)
+{
+    return MeasureBestRun(params.nRepeat, [&]() {
+        Primitive ping, pong;
+        const mfxU32 count = params.nIterations;
+        std::thread partner([&ping, &pong, count]() {
+            for (mfxU32 i = 0; i < count; i++)
+            {
+                ping.Wait();
+                pong.Post();
+            }
+        });
+        for (mfxU32 i = 0; i < count; i++)
+        {
+            ping.Post();
+            pong.Wait();
+        }
+        partner.join();
+    });
+}
+
+// Seconds of count posts each followed by a wait on the same thread
+template <class Primitive>
+mfxF64 RunUncontended(const sMicroBenchmarkParams& params)
+{
+    return MeasureBestRun(params.nRepeat, [&]() {
+        Primitive primitive;
+        for (mfxU32 i = 0; i < params.nIterations; i++)
+        {
+            primitive.Post();
+            primitive.Wait();
+        }
+    });
+}
+
+void PrintRow(const char* primitive, const char* test, mfxF64 condSeconds, mfxF64 futexSeconds, mfxU32 count)
+{
+    printf("%-10s %-12s %12.1f %12.1f %10.2f\n", primitive, test,
+        condSeconds / count * 1e9, futexSeconds / count * 1e9,
+        futexSeconds > 0 ? condSeconds / futexSeconds : 0.0);
+}
+
+} // namespace
+
+int RunSemaphoreBenchmark(const sMicroBenchmarkParams& params)
+{
+    printf("%u operations, best of %u runs, %u CPUs\n\n", params.nIterations, params.nRepeat, std::thread::hardware_concurrency());
+    printf("%-10s %-12s %12s %12s %10s\n", "primitive", "test", "cond ns/op", "futex ns/op", "speedup");
+
+    PrintRow("semaphore", "ping-pong", RunPingPong<CCondSemaphore>(params), RunPingPong<CFutexSemaphore>(params), params.nIterations);
+    PrintRow("semaphore", "uncontended", RunUncontended<CCondSemaphore>(params), RunUncontended<CFutexSemaphore>(params), params.nIterations);
+    PrintRow("event", "ping-pong", RunPingPong<CCondEvent>(params), RunPingPong<CFutexEvent>(params), params.nIterations);
+    PrintRow("event", "uncontended", RunUncontended<CCondEvent>(params), RunUncontended<CFutexEvent>(params), params.nIterations);
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __ASYNC_FILE_WRITER_H__
+#define __ASYNC_FILE_WRITER_H__
+
+#include "mfxdefs.h"
+#include "vm/strings_defs.h"
+#include "vm/thread_defs.h"
+
+#include <sys/uio.h>
+#include <vector>
+
+/** \brief Writes a file from a background thread using two staging buffers.
+ *
+ * The caller reserves space in the current staging buffer, fills it (e.g. converts a whole
+ * frame there) and commits it. When the buffer is full it is handed to the writer thread,
+ * which flushes all committed chunks with writev, while the caller continues with the
+ * other buffer. The caller blocks only when both buffers are waiting for the disk.
+ *
+ * @note Reserve/Commit/Flush are expected to be called from a single thread.
+ */
+class CAsyncFileWriter
+{
+public:
+    CAsyncFileWriter();
+    ~CAsyncFileWriter();
+
+    /** \brief Creates (truncates) the file and starts the writer thread.
+     *
+     * @param bufferSize size of each of the two staging buffers
+     */
+    mfxStatus Open(const msdk_char *strFileName, mfxU32 bufferSize = DEFAULT_BUFFER_SIZE);
+
+    /** \brief Writes out everything committed, stops the writer thread and closes the file.
+     */
+    mfxStatus Close();
+
+    inline bool IsOpen() const
+    {
+        return m_fd >= 0;
+    }
+
+    /** \brief Returns a pointer to size bytes of the staging buffer, aligned to 64 bytes.
+     *
+     * May block until the writer thread frees a buffer. The data is written only after Commit.
+     */
+    mfxStatus Reserve(mfxU32 size, mfxU8 **ppData);
+
+    /** \brief Appends size bytes from the last reserved pointer to the file.
+     */
+    mfxStatus Commit(mfxU32 size);
+
+    /** \brief Hands the current buffer to the writer thread and waits until all data is written.
+     */
+    mfxStatus Flush();
+
+    enum
+    {
+        DEFAULT_BUFFER_SIZE = 16 * 1024 * 1024
+    };
+
+protected:
+    struct sStagingBuffer
+    {
+        mfxU8                    *pData;
+        mfxU32                   capacity;
+        mfxU32                   used;
+        std::vector<struct iovec> chunks;
+    };
+
+    static unsigned int MFX_STDCALL WriterThreadFunc(void *pCtx);
+    void WriterLoop();
+    mfxStatus WriteChunks(sStagingBuffer &buffer);
+    mfxStatus Submit();
+    mfxStatus Allocate(sStagingBuffer &buffer, mfxU32 size);
+    mfxStatus GetError();
+
+    int             m_fd;
+    sStagingBuffer  m_buffers[2];
+    mfxU32          m_current;      // buffer filled by the caller
+    mfxU32          m_writing;      // next buffer to be written by the writer thread
+    mfxU32          m_reserved;     // offset of the last reserved chunk in the current buffer
+
+    MSDKSemaphore   *m_pFilled;     // buffers handed to the writer thread
+    MSDKSemaphore   *m_pFree;       // written buffers which may be reused by the caller
+    MSDKThread      *m_pThread;
+    bool            m_bStop;
+    mfxStatus       m_error;        // first write error, set by the writer thread
+    MSDKMutex       m_errorMutex;
+
+private:
+    CAsyncFileWriter(const CAsyncFileWriter&);
+    void operator=(const CAsyncFileWriter&);
+};
+
+#endif // __ASYNC_FILE_WRITER_H__
@@ -44,6 +44,9 @@ public:
 
     void SetSuggestedSize(mfxU32 size);
 
+    // MFX_CODEC_AVC (default) or MFX_CODEC_HEVC, selects how NAL unit header is reported
+    void SetCodec(mfxU32 codecId);
+
     mfxI32 CheckNalUnitType(mfxBitstream * source);
 
     mfxI32 GetNALUnit(mfxBitstream * source, mfxBitstream * destination);
@@ -62,7 +65,10 @@ private:
     mfxU32  m_nSourceBaseSize;
 
     mfxU32  m_suggestedSize;
+    mfxU32  m_codecId;
 
+protected:
+    mfxI32 GetNalUnitCode(mfxU8 header) const;
     mfxI32 FindStartCode(mfxU8 * (&pb), mfxU32 & size, mfxI32 & startCodeSize);
 };
 
@@ -87,6 +93,11 @@ public:
         m_pStartCodeIter.SetSuggestedSize(size);
     }
 
+    virtual void SetCodec(mfxU32 codecId)
+    {
+        m_pStartCodeIter.SetCodec(codecId);
+    }
+
 protected:
 
     StartCodeIterator m_pStartCodeIter;
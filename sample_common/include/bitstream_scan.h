@@ -0,0 +1,53 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __BITSTREAM_SCAN_H__
+#define __BITSTREAM_SCAN_H__
+
+#include "mfxdefs.h"
+#include "cpu_features.h"
+
+// Byte pattern search used by the bitstream splitters and frame readers.
+// SSE2/AVX2 versions are selected at runtime on x86, other platforms use plain C.
+
+// Returns offset of the first position i where pData[i] == first and pData[i + 1] == second,
+// or size if there is no such position.
+mfxU32 FindBytePair(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second);
+
+// Returns offset of the first position i where pData[i..i+2] == {first, second, third},
+// or size if there is no such position.
+mfxU32 FindByteTriple(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second, mfxU8 third);
+
+// Writes size bytes of pSrc into pDst starting at byte position dstPos as if pDst were
+// a sequence of big endian dwords (byte order inside each dword is reversed on little endian).
+void CopyBytesSwappingDwords(mfxU8 *pDst, mfxU32 dstPos, const mfxU8 *pSrc, mfxU32 size);
+
+// The functions above as implemented for one instruction set.
+struct BitstreamScanFunctions
+{
+    mfxU32 (*findBytePair)(const mfxU8 *, mfxU32, mfxU8, mfxU8);
+    mfxU32 (*findByteTriple)(const mfxU8 *, mfxU32, mfxU8, mfxU8, mfxU8);
+    void (*copyBytesSwappingDwords)(mfxU8 *, mfxU32, const mfxU8 *, mfxU32);
+};
+
+// Returns false if the CPU does not support isa. Lets the tests and benchmarks run
+// every implementation, not only the one selected for the CPU.
+bool GetBitstreamScanFunctions(msdkCpuIsa isa, BitstreamScanFunctions &funcs);
+
+#endif // __BITSTREAM_SCAN_H__
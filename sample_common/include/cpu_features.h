@@ -0,0 +1,57 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __CPU_FEATURES_H__
+#define __CPU_FEATURES_H__
+
+#include "mfxdefs.h"
+
+// Runtime detection of the instruction sets used by the SIMD kernels of the samples.
+// A kernel for an instruction set is compiled with MSDK_CPU_TARGET and called only if
+// msdk_cpu_supports reports the instruction set, so the build needs no -m flags.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MSDK_CPU_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define MSDK_CPU_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MSDK_CPU_TARGET(isa)
+#endif
+
+// Ordered from the plain C kernels to the widest ones
+enum msdkCpuIsa
+{
+    MSDK_CPU_ISA_C = 0,
+    MSDK_CPU_ISA_SSE2,
+    MSDK_CPU_ISA_AVX2,
+};
+
+// Returns true if the kernels for isa may run on this CPU, MSDK_CPU_ISA_C is always supported.
+bool msdk_cpu_supports(msdkCpuIsa isa);
+
+// Returns the widest instruction set supported, detected once per process.
+msdkCpuIsa msdk_cpu_best_isa();
+
+// Returns "C", "SSE2" or "AVX2".
+const char* msdk_cpu_isa_name(msdkCpuIsa isa);
+
+#endif // __CPU_FEATURES_H__
@@ -0,0 +1,267 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef _HEVC_SPL_H__
+#define _HEVC_SPL_H__
+
+#include <vector>
+#include <memory>
+
+#include "abstract_splitter.h"
+
+#include "avc_bitstream.h"
+#include "avc_headers.h"
+#include "avc_nal_spl.h"
+
+namespace ProtectedLibrary
+{
+
+// HEVC NAL unit types, see table 7-1 of H.265 standard
+enum HEVC_NAL_Unit_Type
+{
+    HEVC_NAL_UT_TRAIL_N         = 0,
+    HEVC_NAL_UT_TRAIL_R         = 1,
+    HEVC_NAL_UT_RASL_R          = 9,
+    HEVC_NAL_UT_BLA_W_LP        = 16,
+    HEVC_NAL_UT_IDR_W_RADL      = 19,
+    HEVC_NAL_UT_IDR_N_LP        = 20,
+    HEVC_NAL_UT_CRA             = 21,
+    HEVC_NAL_UT_IRAP_RESERVED   = 23,
+    HEVC_NAL_UT_VPS             = 32,
+    HEVC_NAL_UT_SPS             = 33,
+    HEVC_NAL_UT_PPS             = 34,
+    HEVC_NAL_UT_AUD             = 35,
+    HEVC_NAL_UT_EOS             = 36,
+    HEVC_NAL_UT_EOB             = 37,
+    HEVC_NAL_UT_FD              = 38,
+    HEVC_NAL_UT_SEI_PREFIX      = 39,
+    HEVC_NAL_UT_SEI_SUFFIX      = 40
+};
+
+enum
+{
+    HEVC_NAL_UNITTYPE_BITS_MASK = 0x3f,
+
+    HEVC_MAX_NUM_VPS            = 16,
+    HEVC_MAX_NUM_SPS            = 16,
+    HEVC_MAX_NUM_PPS            = 64,
+    HEVC_MAX_SUB_LAYERS         = 7
+};
+
+// HEVC slice_type values, see table 7-7 of H.265 standard
+enum
+{
+    HEVC_SLICE_B = 0,
+    HEVC_SLICE_P = 1,
+    HEVC_SLICE_I = 2
+};
+
+inline bool IsHEVCSlice(mfxU32 nalType)
+{
+    return (nalType <= HEVC_NAL_UT_RASL_R) ||
+           (nalType >= HEVC_NAL_UT_BLA_W_LP && nalType <= HEVC_NAL_UT_CRA);
+}
+
+inline bool IsHEVCIRAP(mfxU32 nalType)
+{
+    return (nalType >= HEVC_NAL_UT_BLA_W_LP) && (nalType <= HEVC_NAL_UT_IRAP_RESERVED);
+}
+
+// Only the syntax elements the splitter needs to find access unit boundaries are kept
+
+struct HEVCVideoParamSet
+{
+    mfxU8   vps_video_parameter_set_id;
+    mfxU8   vps_max_sub_layers;
+
+    HEVCVideoParamSet()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+
+    mfxU32 GetID() const
+    {
+        return vps_video_parameter_set_id;
+    }
+};
+
+struct HEVCSeqParamSet
+{
+    mfxU8   sps_video_parameter_set_id;
+    mfxU8   sps_max_sub_layers;
+    mfxU8   sps_seq_parameter_set_id;
+    mfxU8   chroma_format_idc;
+    mfxU8   separate_colour_plane_flag;
+    mfxU32  pic_width_in_luma_samples;
+    mfxU32  pic_height_in_luma_samples;
+    mfxU8   log2_max_pic_order_cnt_lsb;
+    mfxU8   log2_min_luma_coding_block_size;
+    mfxU8   log2_ctb_size;
+    mfxU32  pic_size_in_ctbs;
+
+    HEVCSeqParamSet()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+
+    mfxU32 GetID() const
+    {
+        return sps_seq_parameter_set_id;
+    }
+};
+
+struct HEVCPicParamSet
+{
+    mfxU8   pps_pic_parameter_set_id;
+    mfxU8   pps_seq_parameter_set_id;
+    mfxU8   dependent_slice_segments_enabled_flag;
+    mfxU8   output_flag_present_flag;
+    mfxU8   num_extra_slice_header_bits;
+
+    HEVCPicParamSet()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+
+    mfxU32 GetID() const
+    {
+        return pps_pic_parameter_set_id;
+    }
+};
+
+struct HEVCSliceHeader
+{
+    mfxU8   nal_unit_type;
+    mfxU8   nuh_layer_id;
+    mfxU8   nuh_temporal_id;
+    mfxU8   first_slice_segment_in_pic_flag;
+    mfxU8   dependent_slice_segment_flag;
+    mfxU8   slice_pic_parameter_set_id;
+    mfxU32  slice_segment_address;
+    mfxU8   slice_type;
+    mfxU32  slice_pic_order_cnt_lsb;
+};
+
+inline mfxU32 CalculateSuggestedSize(const HEVCSeqParamSet * sps)
+{
+    mfxU32 base_size = sps->pic_width_in_luma_samples * sps->pic_height_in_luma_samples;
+    mfxU32 size = 0;
+
+    switch (sps->chroma_format_idc)
+    {
+    case 0:  // YUV400
+        size = base_size;
+        break;
+    case 1:  // YUV420
+        size = (base_size * 3) / 2;
+        break;
+    case 2: // YUV422
+        size = base_size + base_size;
+        break;
+    case 3: // YUV444
+        size = base_size + base_size + base_size;
+        break;
+    };
+
+    return size;
+}
+
+class HEVCHeadersBitstream : public AVCBaseBitstream
+{
+public:
+
+    HEVCHeadersBitstream();
+
+    mfxStatus GetNALUnitHeader(HEVCSliceHeader *hdr);
+
+    mfxStatus GetVideoParamSet(HEVCVideoParamSet *vps);
+    mfxStatus GetSequenceParamSet(HEVCSeqParamSet *sps);
+    mfxStatus GetPictureParamSet(HEVCPicParamSet *pps);
+
+    // Decodes slice segment header up to slice_pic_order_cnt_lsb
+    mfxStatus GetSliceHeader(HEVCSliceHeader *hdr, const HEVCPicParamSet *pps, const HEVCSeqParamSet *sps);
+
+private:
+    void SkipProfileTierLevel(mfxU32 maxSubLayersMinus1);
+    void SkipBits(mfxU32 nbits);
+};
+
+class HEVC_Spl : public AbstractSplitter
+{
+public:
+
+    HEVC_Spl();
+
+    virtual ~HEVC_Spl();
+
+    virtual mfxStatus Reset();
+
+    virtual mfxStatus GetFrame(mfxBitstream * bs_in, FrameSplitterInfo ** frame);
+
+    virtual mfxStatus PostProcessing(FrameSplitterInfo *frame, mfxU32 sliceNum);
+
+    void ResetCurrentState();
+
+protected:
+    std::unique_ptr<NALUnitSplitter> m_pNALSplitter;
+
+    mfxStatus Init();
+
+    void Close();
+
+    // Returns MFX_ERR_NONE when nalUnit starts the next access unit and current frame is complete,
+    // MFX_ERR_MORE_DATA when it was added to current frame, or the error adding it
+    mfxStatus ProcessNalUnit(mfxI32 nalCode, mfxBitstream * nalUnit);
+
+    mfxStatus DecodeHeader(mfxU32 nalType, mfxBitstream * nalUnit);
+    bool DecodeSliceHeader(mfxBitstream * nalUnit, HEVCSliceHeader * slice, mfxU32 & headerLength);
+
+    mfxU8 * GetMemoryForSwapping(mfxU32 size);
+
+    mfxStatus ReserveFrame(mfxU32 size);
+    mfxStatus AddNalUnit(mfxBitstream * nalUnit);
+    mfxStatus AddSliceNalUnit(mfxBitstream * nalUnit, const HEVCSliceHeader * slice, mfxU32 headerLength);
+
+    bool                m_WaitForIRAP;
+
+    HeaderSet<HEVCVideoParamSet>  m_vps;
+    HeaderSet<HEVCSeqParamSet>    m_sps;
+    HeaderSet<HEVCPicParamSet>    m_pps;
+
+    // NAL unit which starts the next access unit, added when the next frame is requested
+    mfxBitstream *      m_lastNalUnit;
+    bool                m_bLastIsSlice;
+    HEVCSliceHeader     m_lastSlice;
+    mfxU32              m_lastHeaderLength;
+
+    enum
+    {
+        BUFFER_SIZE = 1024 * 1024   // initial size of the frame buffer
+    };
+
+    std::vector<mfxU8>  m_currentFrame;
+    std::vector<mfxU8>  m_swappingMemory;
+
+    std::vector<SliceSplitterInfo>  m_slices;
+    FrameSplitterInfo m_frame;
+};
+
+} // namespace ProtectedLibrary
+
+#endif // _HEVC_SPL_H__
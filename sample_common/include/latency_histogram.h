@@ -0,0 +1,103 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __LATENCY_HISTOGRAM_H__
+#define __LATENCY_HISTOGRAM_H__
+
+#include "mfxdefs.h"
+#include "vm/strings_defs.h"
+
+/** \brief Fixed-memory histogram of latency samples with streaming quantiles.
+ *
+ * Samples are kept in log-linear buckets with microsecond resolution: 16 buckets per
+ * power of two, so quantiles are reported with at most ~6% relative error while the
+ * memory footprint does not depend on the number of samples. Exact count, mean, min
+ * and max are kept along with the buckets.
+ *
+ * @note The histogram is not thread-safe, samples and snapshots are expected to come
+ * from the same thread.
+ */
+class CLatencyHistogram
+{
+public:
+    CLatencyHistogram();
+
+    /** \brief Adds a sample, in milliseconds.
+     */
+    void AddValue(mfxF64 ms);
+
+    /** \brief Drops all samples.
+     */
+    void Reset();
+
+    /** \brief Copies the current state to snapshot and resets the histogram.
+     */
+    void TakeSnapshot(CLatencyHistogram& snapshot);
+
+    /** \brief Returns the value below which the given fraction of samples falls, in milliseconds.
+     *
+     * @param q quantile in [0, 1]
+     */
+    mfxF64 GetQuantile(mfxF64 q) const;
+
+    inline mfxU64 GetCount() const
+    {
+        return m_count;
+    }
+
+    inline mfxF64 GetAvg() const
+    {
+        return m_count ? m_sum / m_count / 1000 : 0;
+    }
+
+    inline mfxF64 GetMin() const
+    {
+        return m_count ? m_min / 1000.0 : 0;
+    }
+
+    inline mfxF64 GetMax() const
+    {
+        return m_count ? m_max / 1000.0 : 0;
+    }
+
+    /** \brief Prints count, AVG/MIN/MAX and P50/P90/P99 on one line after the prefix.
+     */
+    void PrintSummary(const msdk_char* prefix) const;
+
+protected:
+    enum
+    {
+        SUB_BUCKET_BITS = 4,
+        SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+        MAX_VALUE_BITS = 40, // ~12 days in microseconds, larger samples are clamped
+        NUM_BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS
+    };
+
+    static mfxU32 GetBucketIndex(mfxU64 us);
+    static mfxU64 GetBucketLowerBound(mfxU32 index);
+    static mfxU64 GetBucketWidth(mfxU32 index);
+
+    mfxU32  m_buckets[NUM_BUCKETS];
+    mfxU64  m_count;
+    mfxF64  m_sum;  // in microseconds
+    mfxU64  m_min;
+    mfxU64  m_max;
+};
+
+#endif // __LATENCY_HISTOGRAM_H__
@@ -21,6 +21,7 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #define __MFX_BUFFERING_H__
 
 #include <stdio.h>
+#include <atomic>
 
 #include "mfxstructures.h"
 
@@ -55,14 +56,131 @@ struct msdkOutputSurface
 
 class CBuffering;
 
+/** \brief Lock-free LIFO list of items linked through their 'next' field.
+ *
+ * Any thread may add items, items are taken all at once by exchanging the list head,
+ * so there is no ABA problem. Item 'next' field is written only before the item is published.
+ */
+template <class T>
+class msdkAtomicList
+{
+public:
+    msdkAtomicList():
+        m_pHead(NULL) {}
+
+    inline void Push(T* item) {
+        T* head = m_pHead.load(std::memory_order_relaxed);
+        do {
+            item->next = head;
+        } while (!m_pHead.compare_exchange_weak(head, item, std::memory_order_release, std::memory_order_relaxed));
+    }
+    /** \brief The function detaches all items, the most recently added one is returned first.
+     */
+    inline T* TakeAll() {
+        if (!m_pHead.load(std::memory_order_relaxed)) {
+            return NULL;
+        }
+        return m_pHead.exchange(NULL, std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<T*> m_pHead;
+
+    msdkAtomicList(const msdkAtomicList&);
+    void operator=(const msdkAtomicList&);
+};
+
+/** \brief Lock-free bounded FIFO for exactly one producer and one consumer thread.
+ *
+ * Push() may only be called from the producer thread and Pop() from the consumer thread.
+ * Each side caches the other side's index and reloads it only when the queue looks full
+ * or empty, so in the steady state the indices do not bounce between cores.
+ */
+template <class T>
+class msdkSPSCQueue
+{
+public:
+    msdkSPSCQueue():
+        m_pItems(NULL), m_mask(0), m_head(0), m_cachedTail(0), m_tail(0), m_cachedHead(0) {}
+
+    ~msdkSPSCQueue() {
+        delete[] m_pItems;
+    }
+
+    /** \brief The function allocates the queue, capacity is rounded up to a power of two.
+     *
+     * @note Not thread-safe, has to be called before the producer and the consumer start.
+     */
+    mfxStatus Init(mfxU32 capacity) {
+        mfxU32 size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        delete[] m_pItems;
+        m_pItems = new T[size];
+        m_mask = size - 1;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_cachedHead = m_cachedTail = 0;
+        return MFX_ERR_NONE;
+    }
+
+    /** \brief Producer side, returns false if the queue is full. */
+    inline bool Push(const T& item) {
+        const mfxU32 tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask) {
+                return false;
+            }
+        }
+        m_pItems[tail & m_mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** \brief Consumer side, returns false if the queue is empty. */
+    inline bool Pop(T& item) {
+        const mfxU32 head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return false;
+            }
+        }
+        item = m_pItems[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** \brief Number of queued items, exact only when called from one of the two sides. */
+    inline mfxU32 GetSize() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    T*     m_pItems;
+    mfxU32 m_mask;
+
+    // consumer side
+    alignas(64) std::atomic<mfxU32> m_head;
+    mfxU32 m_cachedTail;
+
+    // producer side
+    alignas(64) std::atomic<mfxU32> m_tail;
+    mfxU32 m_cachedHead;
+
+    msdkSPSCQueue(const msdkSPSCQueue&);
+    void operator=(const msdkSPSCQueue&);
+};
+
 // LIFO list of frame surfaces
 class msdkFreeSurfacesPool
 {
     friend class CBuffering;
 public:
-    msdkFreeSurfacesPool(MSDKMutex* mutex):
-        m_pSurfaces(NULL),
-        m_pMutex(mutex) {}
+    msdkFreeSurfacesPool():
+        m_pSurfaces(NULL) {}
 
     ~msdkFreeSurfacesPool() {
         m_pSurfaces = NULL;
@@ -72,49 +190,45 @@ public:
      * @note That's caller responsibility to pass valid surface.
      * @note We always add and get free surface from the array head. In case not all surfaces
      * will be actually used we have good chance to avoid actual allocation of the surface memory.
+     * @note Can be called from any thread.
      */
     inline void AddSurface(msdkFrameSurface* surface) {
-        AutomaticMutex lock(*m_pMutex);
-        AddSurfaceUnsafe(surface);
+        MSDK_SELF_CHECK(surface);
+        MSDK_SELF_CHECK(!surface->prev);
+        MSDK_SELF_CHECK(!surface->next);
+
+        m_Returned.Push(surface);
     }
     /** \brief The function gets the next free surface from the free surfaces array.
      *
      * @note Surface is detached from the free surfaces array.
+     * @note Only one thread may get surfaces: it owns the local list and refills it
+     * with surfaces added by other threads when the local list is empty.
      */
     inline msdkFrameSurface* GetSurface() {
-        AutomaticMutex lock(*m_pMutex);
-        return GetSurfaceUnsafe();
-    }
-
-private:
-    inline void AddSurfaceUnsafe(msdkFrameSurface* surface) {
-        msdkFrameSurface* head;
-
-        MSDK_SELF_CHECK(surface);
-        MSDK_SELF_CHECK(!surface->prev);
-        MSDK_SELF_CHECK(!surface->next);
-
-        head = m_pSurfaces;
-        m_pSurfaces = surface;
-        m_pSurfaces->next = head;
-    }
-    inline msdkFrameSurface* GetSurfaceUnsafe() {
-
         msdkFrameSurface* surface = NULL;
 
+        if (!m_pSurfaces) {
+            m_pSurfaces = m_Returned.TakeAll();
+        }
         if (m_pSurfaces) {
             surface = m_pSurfaces;
             m_pSurfaces = m_pSurfaces->next;
             surface->prev = surface->next = NULL;
-            MSDK_SELF_CHECK(!surface->prev);
-            MSDK_SELF_CHECK(!surface->next);
         }
         return surface;
     }
 
+private:
+    // not thread-safe, used on (re)initialization only
+    inline void Reset(msdkFrameSurface* surfaces) {
+        m_Returned.TakeAll();
+        m_pSurfaces = surfaces;
+    }
+
 protected:
-    msdkFrameSurface* m_pSurfaces;
-    MSDKMutex* m_pMutex;
+    msdkFrameSurface* m_pSurfaces; // owned by the thread getting surfaces
+    msdkAtomicList<msdkFrameSurface> m_Returned;
 
 private:
     msdkFreeSurfacesPool(const msdkFreeSurfacesPool&);
@@ -211,16 +325,15 @@ private:
     void operator=(const msdkUsedSurfacesPool&);
 };
 
-// FIFO list of surfaces
+// FIFO list of surfaces, one thread adds surfaces and one thread gets them
 class msdkOutputSurfacesPool
 {
     friend class CBuffering;
 public:
-    msdkOutputSurfacesPool(MSDKMutex* mutex):
+    msdkOutputSurfacesPool():
         m_pSurfacesHead(NULL),
         m_pSurfacesTail(NULL),
-        m_SurfacesCount(0),
-        m_pMutex(mutex) {}
+        m_SurfacesCount(0) {}
 
     ~msdkOutputSurfacesPool() {
         m_pSurfacesHead = NULL;
@@ -228,36 +341,19 @@ public:
     }
 
     inline void AddSurface(msdkOutputSurface* surface) {
-        AutomaticMutex lock(*m_pMutex);
-        AddSurfaceUnsafe(surface);
-    }
-    inline msdkOutputSurface* GetSurface() {
-        AutomaticMutex lock(*m_pMutex);
-        return GetSurfaceUnsafe();
-    }
-
-    inline mfxU32 GetSurfaceCount() {
-        return m_SurfacesCount;
-    }
-private:
-    inline void AddSurfaceUnsafe(msdkOutputSurface* surface)
-    {
         MSDK_SELF_CHECK(surface);
         MSDK_SELF_CHECK(!surface->next);
-        surface->next = NULL;
 
-        if (m_pSurfacesTail) {
-            m_pSurfacesTail->next = surface;
-            m_pSurfacesTail = m_pSurfacesTail->next;
-        } else {
-            m_pSurfacesHead = m_pSurfacesTail = surface;
-        }
-        ++m_SurfacesCount;
+        // counted before it is published, so GetSurface() cannot take the count below zero
+        m_SurfacesCount.fetch_add(1, std::memory_order_relaxed);
+        m_Added.Push(surface);
     }
-    inline msdkOutputSurface* GetSurfaceUnsafe()
-    {
+    inline msdkOutputSurface* GetSurface() {
         msdkOutputSurface* surface = NULL;
 
+        if (!m_pSurfacesHead) {
+            TakeAddedSurfaces();
+        }
         if (m_pSurfacesHead) {
             surface = m_pSurfacesHead;
             m_pSurfacesHead = m_pSurfacesHead->next;
@@ -265,18 +361,55 @@ private:
                 // there was only one surface in the array...
                 m_pSurfacesTail = NULL;
             }
-            --m_SurfacesCount;
+            m_SurfacesCount.fetch_sub(1, std::memory_order_relaxed);
             surface->next = NULL;
             MSDK_SELF_CHECK(!surface->next);
         }
         return surface;
     }
 
+    inline mfxU32 GetSurfaceCount() {
+        return m_SurfacesCount.load(std::memory_order_relaxed);
+    }
+private:
+    // moves newly added surfaces (LIFO order) to the tail of the local FIFO list
+    inline void TakeAddedSurfaces()
+    {
+        msdkOutputSurface* added = m_Added.TakeAll();
+        msdkOutputSurface* head = NULL;
+        msdkOutputSurface* tail = added;
+
+        while (added) {
+            msdkOutputSurface* next = added->next;
+            added->next = head;
+            head = added;
+            added = next;
+        }
+        if (!head) {
+            return;
+        }
+        if (m_pSurfacesTail) {
+            m_pSurfacesTail->next = head;
+        } else {
+            m_pSurfacesHead = head;
+        }
+        m_pSurfacesTail = tail;
+    }
+    // not thread-safe, used on release only
+    inline msdkOutputSurface* DetachAll()
+    {
+        TakeAddedSurfaces();
+        msdkOutputSurface* surfaces = m_pSurfacesHead;
+        m_pSurfacesHead = m_pSurfacesTail = NULL;
+        m_SurfacesCount = 0;
+        return surfaces;
+    }
+
 protected:
-    msdkOutputSurface*      m_pSurfacesHead; // oldest surface
-    msdkOutputSurface*      m_pSurfacesTail; // youngest surface
-    mfxU32                  m_SurfacesCount;
-    MSDKMutex*              m_pMutex;
+    msdkOutputSurface*      m_pSurfacesHead; // oldest surface, owned by the thread getting surfaces
+    msdkOutputSurface*      m_pSurfacesTail; // youngest surface, owned by the thread getting surfaces
+    std::atomic<mfxU32>     m_SurfacesCount;
+    msdkAtomicList<msdkOutputSurface> m_Added;
 
 private:
     msdkOutputSurfacesPool(const msdkOutputSurfacesPool&);
@@ -316,28 +449,25 @@ protected: // functions
         return (msdkFrameSurface*)(frame);
     }
 
-    inline void AddFreeOutputSurfaceUnsafe(msdkOutputSurface* surface)
-    {
-        msdkOutputSurface* head = m_pFreeOutputSurfaces;
-
+    inline void AddFreeOutputSurface(msdkOutputSurface* surface) {
         MSDK_SELF_CHECK(surface);
         MSDK_SELF_CHECK(!surface->next);
-        m_pFreeOutputSurfaces = surface;
-        m_pFreeOutputSurfaces->next = head;
-    }
-    inline void AddFreeOutputSurface(msdkOutputSurface* surface) {
-        AutomaticMutex lock(m_Mutex);
-        AddFreeOutputSurfaceUnsafe(surface);
+        m_FreeOutputSurfaces.Push(surface);
     }
 
-    inline msdkOutputSurface* GetFreeOutputSurfaceUnsafe()
+    /** \brief The function gets free output surface, allocating a new one if all are in use.
+     *
+     * @note Must be called from the decoding thread only, other threads may only return surfaces.
+     */
+    inline msdkOutputSurface* GetFreeOutputSurface()
     {
         msdkOutputSurface* surface = NULL;
 
         if (!m_pFreeOutputSurfaces) {
-            m_Mutex.Unlock();
+            m_pFreeOutputSurfaces = m_FreeOutputSurfaces.TakeAll();
+        }
+        if (!m_pFreeOutputSurfaces) {
             AllocOutputBuffer();
-            m_Mutex.Lock();
         }
         if (m_pFreeOutputSurfaces) {
             surface = m_pFreeOutputSurfaces;
@@ -347,10 +477,6 @@ protected: // functions
         }
         return surface;
     }
-    inline msdkOutputSurface* GetFreeOutputSurface() {
-        AutomaticMutex lock(m_Mutex);
-        return GetFreeOutputSurfaceUnsafe();
-    }
 
     /** \brief Function returns surface data to the corresponding buffers.
      */
@@ -383,8 +509,9 @@ protected: // variables
     msdkUsedSurfacesPool    m_UsedSurfacesPool;
     msdkUsedSurfacesPool    m_UsedVppSurfacesPool;
 
-    // LIFO list of output surfaces
+    // LIFO list of output surfaces: local list of the decoding thread and surfaces returned by other threads
     msdkOutputSurface*      m_pFreeOutputSurfaces;
+    msdkAtomicList<msdkOutputSurface> m_FreeOutputSurfaces;
 
     // FIFO list of surfaces
     msdkOutputSurfacesPool  m_OutputSurfacesPool;
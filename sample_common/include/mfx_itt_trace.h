@@ -20,10 +20,15 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #ifndef __MFX_ITT_TRACE_H__
 #define __MFX_ITT_TRACE_H__
 
+#include "trace_events.h"
+
 #ifdef ITT_SUPPORT
 #include <ittnotify.h>
 #endif
 
+/* MFX_ITT_TASK(name) records a span to the end of the scope for the trace events, see trace_events.h.
+   With ITT_SUPPORT the span is also reported to VTune as an ITT task. */
+
 
 #ifdef ITT_SUPPORT
 
@@ -37,7 +42,8 @@ static inline __itt_domain* mfx_itt_get_domain() {
 class MFX_ITT_Tracer
 {
 public:
-    MFX_ITT_Tracer(const char* trace_name)
+    MFX_ITT_Tracer(const char* trace_name) :
+        m_span(trace_name)
     {
         m_domain = mfx_itt_get_domain();
         if (m_domain)
@@ -48,12 +54,13 @@ public:
         if (m_domain) __itt_task_end(m_domain);
     }
 private:
+    CTraceSpan m_span;
     __itt_domain* m_domain;
 };
 #define MFX_ITT_TASK(x) MFX_ITT_Tracer __mfx_itt_tracer(x);
 
 #else
-#define MFX_ITT_TASK(x)
+#define MFX_ITT_TASK(x) CTraceSpan __mfx_itt_tracer(x);
 #endif
 
 #endif //__MFX_ITT_TRACE_H__
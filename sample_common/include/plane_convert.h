@@ -0,0 +1,52 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __PLANE_CONVERT_H__
+#define __PLANE_CONVERT_H__
+
+#include "mfxdefs.h"
+#include "cpu_features.h"
+
+// Whole-plane copy and conversion used by the YUV writer.
+// SSE2/AVX2 versions are selected at runtime on x86, other platforms use plain C.
+// Destination planes are tightly packed, rows of the source are srcPitch bytes apart.
+
+// Copies height rows of widthBytes bytes.
+void CopyPlane(mfxU8 *pDst, const mfxU8 *pSrc, mfxU32 srcPitch, mfxU32 widthBytes, mfxU32 height);
+
+// De-interleaves an NV12-like UV plane of widthBytes bytes per row: even bytes go to pDstU
+// ((widthBytes + 1) / 2 bytes per row), odd bytes go to pDstV (widthBytes / 2 bytes per row).
+void SplitUVPlane(mfxU8 *pDstU, mfxU8 *pDstV, const mfxU8 *pSrc, mfxU32 srcPitch, mfxU32 widthBytes, mfxU32 height);
+
+// Copies height rows of width 16-bit samples shifting every sample right by shift bits
+// (MS-P010 to P010 conversion).
+void CopyPlaneShiftRight16(mfxU16 *pDst, const mfxU8 *pSrc, mfxU32 srcPitch, mfxU32 width, mfxU32 height, mfxU32 shift);
+
+// The row kernels of the functions above as implemented for one instruction set.
+struct PlaneConvertFunctions
+{
+    void (*splitUVRow)(mfxU8 *, mfxU8 *, const mfxU8 *, mfxU32);
+    void (*shiftRight16Row)(mfxU16 *, const mfxU16 *, mfxU32, mfxU32);
+};
+
+// Returns false if the CPU does not support isa. Lets the tests and benchmarks run
+// every implementation, not only the one selected for the CPU.
+bool GetPlaneConvertFunctions(msdkCpuIsa isa, PlaneConvertFunctions &funcs);
+
+#endif // __PLANE_CONVERT_H__
@@ -0,0 +1,103 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __PRESENTATION_SCHEDULER_H__
+#define __PRESENTATION_SCHEDULER_H__
+
+#include "mfxdefs.h"
+#include "vm/time_defs.h"
+
+/** \brief Paces frame presentation by sleeping until absolute per-frame deadlines.
+ *
+ * Deadlines follow stream timestamps (90 kHz) when they are present and increasing,
+ * otherwise frames are spaced by the nominal frame rate. Frames which are later than
+ * one frame interval are reported to be dropped. If playback falls far behind
+ * (e.g. after a stall), the timeline is restarted instead of dropping everything.
+ *
+ * @note WaitForDeadline is expected to be called from a single presentation thread.
+ */
+class CPresentationScheduler
+{
+public:
+    CPresentationScheduler();
+
+    /** \brief Enables pacing at the given nominal frame rate, 0 disables pacing.
+     */
+    void Init(mfxF64 frameRate);
+
+    /** \brief Restarts the timeline and statistics, keeps the frame rate.
+     */
+    void Reset();
+
+    inline bool IsEnabled() const
+    {
+        return m_frameInterval != 0;
+    }
+
+    /** \brief Sleeps until presentation deadline of the frame.
+     *
+     * @param timeStamp frame timestamp in 90 kHz units, (mfxU64)-1 if unknown
+     * @return false if the frame is late and should not be presented
+     */
+    bool WaitForDeadline(mfxU64 timeStamp);
+
+    /** \brief Prints presented/dropped frame counts, presentation jitter and CPU use.
+     */
+    void PrintStatistics();
+
+    inline mfxU64 GetPresentedCount() const
+    {
+        return m_presented;
+    }
+
+    inline mfxU64 GetDroppedCount() const
+    {
+        return m_dropped;
+    }
+
+protected:
+    msdk_tick GetDeadline(mfxU64 timeStamp, msdk_tick now);
+    void Restart(mfxU64 timeStamp, msdk_tick now);
+
+    msdk_tick   m_frameInterval;
+    msdk_tick   m_lateThreshold;    // frames later than that are dropped
+    msdk_tick   m_resyncThreshold;  // timeline is restarted if playback is behind more than that
+
+    bool        m_bStarted;
+    msdk_tick   m_baseTick;         // deadline of the frame with m_baseTimeStamp
+    mfxU64      m_baseTimeStamp;
+    mfxU64      m_lastTimeStamp;
+    msdk_tick   m_lastDeadline;
+
+    // statistics
+    mfxU64      m_presented;
+    mfxU64      m_dropped;
+    mfxU64      m_restarts;
+    mfxF64      m_jitterSum;        // in ticks
+    mfxF64      m_jitterSquares;
+    msdk_tick   m_jitterMax;
+
+    msdk_tick   m_startTick;
+    msdk_tick   m_startProcessCpuTick;
+    msdk_tick   m_startThreadCpuTick;
+    msdk_tick   m_lastTick;
+    msdk_tick   m_lastThreadCpuTick;
+};
+
+#endif // __PRESENTATION_SCHEDULER_H__
@@ -45,6 +45,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include "avc_spl.h"
 #include "avc_headers.h"
 #include "avc_nal_spl.h"
+#include "hevc_spl.h"
+#include "async_file_writer.h"
 
 #ifdef ENABLE_MCTF
 #include  <stdexcept>
@@ -163,7 +165,9 @@ public :
     void SetMultiView() { m_bIsMultiView = true; }
 
 protected:
-    FILE         *m_fDest, **m_fDestMVC;
+    CAsyncFileWriter* GetDestination(mfxU32 viewId);
+
+    std::vector<CAsyncFileWriter*> m_pDest; // one file per view in MVC mode
     bool         m_bInited, m_bIsMultiView;
     mfxU32       m_numCreatedFiles;
     msdk_string  m_sFile;
@@ -199,6 +203,10 @@ public:
     virtual mfxStatus Init(const msdk_char *strFileName);
     virtual mfxStatus ReadNextFrame(mfxBitstream *pBS);
 
+protected:
+    // Creates splitter which extracts complete frames from the elementary stream
+    virtual AbstractSplitter * CreateSplitter();
+
 private:
     mfxBitstream *m_processedBS;
     // input bit stream
@@ -216,17 +224,24 @@ private:
     mfxBitstream m_outBS;
 };
 
+class CHEVCFrameReader : public CH264FrameReader
+{
+protected:
+    virtual AbstractSplitter * CreateSplitter();
+};
+
 //provides output bistream with at least 1 frame, reports about error
 class CJPEGFrameReader : public CSmplBitstreamReader
 {
+public:
+    virtual mfxStatus ReadNextFrame(mfxBitstream *pBS);
+protected:
     enum JPEGMarker
     {
         SOI=0xD8FF,
         EOI=0xD9FF
     };
-public:
-    virtual mfxStatus ReadNextFrame(mfxBitstream *pBS);
-protected:
+
     mfxU32 FindMarker(mfxBitstream *pBS,mfxU32 startOffset,JPEGMarker marker);
 };
 
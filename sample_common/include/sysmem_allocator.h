@@ -21,7 +21,10 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #define __SYSMEM_ALLOCATOR_H__
 
 #include <stdlib.h>
+#include <list>
+#include <map>
 #include "base_allocator.h"
+#include "vm/thread_defs.h"
 
 struct sBuffer
 {
@@ -36,11 +39,70 @@ struct sFrame
     mfxFrameInfo    info;
 };
 
+/** \brief Keeps large 2 MB aligned memory regions for frame surfaces and reuses them.
+ *
+ * Each region holds all surfaces of one allocation request. Regions are backed by
+ * hugetlbfs pages (MAP_HUGETLB) when the system has them reserved, otherwise by normal
+ * pages with transparent hugepages requested, and are pre-faulted when mapped.
+ * Released regions are cached and handed out again for requests with the same surface
+ * size, so that restarting a pipeline with the same resolution does not touch the heap.
+ * The arena may be shared between allocators and threads, it must outlive them.
+ */
+class SysMemSurfaceArena
+{
+public:
+    /** \brief maxCachedBytes limits memory kept in released regions, older regions are unmapped first.
+     */
+    SysMemSurfaceArena(mfxU64 maxCachedBytes = DEFAULT_MAX_CACHED_BYTES);
+    ~SysMemSurfaceArena();
+
+    /** \brief Returns a region of at least count slots of slotSize bytes each.
+     */
+    mfxStatus Acquire(mfxU32 slotSize, mfxU32 count, mfxHDL *pRegion, mfxU8 **ppBase);
+
+    /** \brief Returns the region to the cache.
+     */
+    void Release(mfxHDL region);
+
+    /** \brief Unmaps all cached regions.
+     */
+    void Trim();
+
+    mfxU64 GetMappedBytes();
+
+    enum
+    {
+        DEFAULT_MAX_CACHED_BYTES = 256 * 1024 * 1024
+    };
+
+protected:
+    struct sRegion
+    {
+        mfxU8   *pBase;
+        size_t  size;
+        mfxU32  slotSize;
+        mfxU32  count;
+        bool    bInUse;
+    };
+
+    static mfxU8* MapRegion(size_t size, size_t *pMappedSize);
+    void TrimCache(mfxU64 maxCachedBytes);
+
+    std::list<sRegion>  m_regions;  // most recently released regions go first
+    mfxU64              m_maxCachedBytes;
+    MSDKMutex           m_mutex;
+
+private:
+    SysMemSurfaceArena(const SysMemSurfaceArena&);
+    void operator=(const SysMemSurfaceArena&);
+};
+
 struct SysMemAllocatorParams : mfxAllocatorParams
 {
     SysMemAllocatorParams()
-        : mfxAllocatorParams(), pBufferAllocator(NULL) { }
+        : mfxAllocatorParams(), pBufferAllocator(NULL), pArena(NULL) { }
     MFXBufferAllocator *pBufferAllocator;
+    SysMemSurfaceArena *pArena; // carve surfaces out of arena regions, ignored with pBufferAllocator
 };
 
 class SysMemFrameAllocator: public BaseFrameAllocator
@@ -59,9 +121,12 @@ protected:
     virtual mfxStatus CheckRequestType(mfxFrameAllocRequest *request);
     virtual mfxStatus ReleaseResponse(mfxFrameAllocResponse *response);
     virtual mfxStatus AllocImpl(mfxFrameAllocRequest *request, mfxFrameAllocResponse *response);
+    mfxStatus AllocFromArena(mfxFrameAllocRequest *request, mfxU32 nbytes, mfxFrameAllocResponse *response);
 
     MFXBufferAllocator *m_pBufferAllocator;
     bool m_bOwnBufferAllocator;
+    SysMemSurfaceArena *m_pArena;
+    std::map<mfxMemId*, mfxHDL> m_arenaRegions; // arena region of each response, by mids array
 };
 
 class SysMemBufferAllocator : public MFXBufferAllocator
@@ -22,8 +22,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include "mfxstructures.h"
 #include "vm/time_defs.h"
 #include "vm/strings_defs.h"
+#include "latency_histogram.h"
 #include "math.h"
-#include <vector>
 #include <stdio.h>
 
 #pragma warning(disable:4100)
@@ -64,7 +64,7 @@ public:
         totalTimeSquares+=delta*delta;
         // dump in ms:
         if(m_bNeedDumping)
-            m_time_deltas.push_back(delta * 1000);
+            m_histogram.AddValue(delta * 1000);
 
         if(delta<minTime)
         {
@@ -106,6 +106,21 @@ public:
                 prefix,totalTime,numMeasurements,
                 GetAvgTime(false),GetTimeStdDev(false),
                 GetMinTime(false),GetMaxTime(false));
+        if(m_histogram.GetCount())
+        {
+            m_histogram.PrintSummary(prefix);
+        }
+    }
+
+    // moves dumped samples to snapshot, so that dumping can stay on for long runs
+    inline void TakeSnapshot(CLatencyHistogram& snapshot)
+    {
+        m_histogram.TakeSnapshot(snapshot);
+    }
+
+    inline const CLatencyHistogram& GetHistogram() const
+    {
+        return m_histogram;
     }
 
     inline mfxU64 GetNumMeasurements()
@@ -154,7 +169,7 @@ public:
         minTime=1E100;
         maxTime=-1;
         numMeasurements=0;
-        m_time_deltas.clear();
+        m_histogram.Reset();
         TurnOffDumping();
     }
 
@@ -167,7 +182,7 @@ protected:
     mfxF64 minTime;
     mfxF64 maxTime;
     mfxU64 numMeasurements;
-    std::vector<mfxF64> m_time_deltas;
+    CLatencyHistogram m_histogram;
     bool m_bNeedDumping;
 
 };
@@ -219,6 +234,11 @@ public:
     {
     }
 
+    inline void TakeSnapshot(CLatencyHistogram& snapshot)
+    {
+        snapshot.Reset();
+    }
+
     inline mfxU64 GetNumMeasurements()
     {
         return 0;
@@ -0,0 +1,94 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __TRACE_EVENTS_H__
+#define __TRACE_EVENTS_H__
+
+#include "mfxdefs.h"
+
+/** \brief Recording of scoped trace events, written as Chrome trace event JSON.
+ *
+ * Every thread appends its spans to a ring buffer of its own, so recording takes no lock. The buffer of
+ * an exited thread is reused once it has been dumped, or when more recent threads exited.
+ * A dump copies the rings and writes <prefix>.<pid>.json, which chrome://tracing and the
+ * Perfetto UI open as a timeline. The times come from the monotonic clock, so the files of
+ * several processes can be merged into one timeline.
+ *
+ * @note The names of the spans are not copied: they must be string literals or come from
+ * msdk_trace_name.
+ */
+
+/** \brief Spans of this many exited threads wait for the next dump, the buffers of older ones are reused. */
+const mfxU32 MSDK_TRACE_EXITED_BUFFERS = 16;
+
+/** \brief Starts recording, each thread keeps its latest eventsPerThread spans.
+ *
+ * Starts the thread writing the dumps requested with msdk_trace_request_dump. Calling it again in a
+ * forked child starts the dump thread of the child, the events recorded before the fork stay with the parent.
+ */
+mfxStatus msdk_trace_start(const char* prefix, mfxU32 eventsPerThread);
+
+/** \brief Writes a last dump and stops the dump thread, the recording stops. */
+void msdk_trace_stop();
+
+bool msdk_trace_enabled();
+
+/** \brief Writes the spans recorded so far to <prefix>.<pid>.json, from the calling thread. */
+mfxStatus msdk_trace_dump();
+
+/** \brief Async-signal-safe request of a dump, written by the dump thread within 100 ms.
+ *
+ * @param exitCode if not negative, the process exits with it once the dump is written
+ */
+void msdk_trace_request_dump(mfxI32 exitCode = -1);
+
+/** \brief Returns a copy of the name that lives as long as the process, for names built at run time. */
+const char* msdk_trace_name(const char* name);
+
+/** \brief Returns the start tick of a span, 0 when the recording is off. */
+mfxI64 msdk_trace_begin();
+
+/** \brief Records the span started at start, if it is not 0. */
+void msdk_trace_end(const char* name, mfxI64 start);
+
+/** \brief Records a span from its construction to the end of the scope.
+ */
+class CTraceSpan
+{
+public:
+    explicit CTraceSpan(const char* name) :
+        m_name(name),
+        m_start(msdk_trace_begin())
+    {
+    }
+
+    ~CTraceSpan()
+    {
+        msdk_trace_end(m_name, m_start);
+    }
+
+private:
+    CTraceSpan(const CTraceSpan&);
+    void operator=(const CTraceSpan&);
+
+    const char* m_name;
+    mfxI64      m_start;
+};
+
+#endif // __TRACE_EVENTS_H__
@@ -28,6 +28,7 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include <string.h>
 #include <fcntl.h>
 #include "sample_defs.h"
+#include "mfx_buffering.h"
 
 /* MIPI DRIVER Configurations*/
 #define _ISP_MODE_NONE          0x0000
@@ -115,6 +116,10 @@ protected:
     enum AtomISPMode m_MipiMode;
     enum V4L2PixelFormat m_v4l2Format;
     int m_fd;
+
+    // indices of captured buffers, filled by PollingThread and drained by GetOffQ
+    msdkSPSCQueue<int> m_queue;
+    MSDKSemaphore* m_pQueued;
 };
 
 #endif // ifdef __V4L2_UTIL_H__
@@ -30,34 +30,38 @@ typedef unsigned int (MFX_STDCALL * msdk_thread_callback)(void*);
 #include <errno.h>
 #include <sys/time.h>
 #include <sys/resource.h>
+#include <vector>
+#include <atomic>
 
 struct msdkMutexHandle
 {
     pthread_mutex_t m_mutex;
 };
 
+// Semaphores and events are futex words, an uncontended post, signal or wait makes no system call.
+// The waiter counters let the posting side skip the wake up call when nobody sleeps on the word.
 struct msdkSemaphoreHandle
 {
     msdkSemaphoreHandle(mfxU32 count):
-        m_count(count)
+        m_count((int)count),
+        m_waiters(0)
     {}
 
-    mfxU32 m_count;
-    pthread_cond_t m_semaphore;
-    pthread_mutex_t m_mutex;
+    std::atomic<int> m_count;
+    std::atomic<int> m_waiters;
 };
 
 struct msdkEventHandle
 {
     msdkEventHandle(bool manual, bool state):
         m_manual(manual),
-        m_state(state)
+        m_state(state ? 1 : 0),
+        m_waiters(0)
     {}
 
     bool m_manual;
-    bool m_state;
-    pthread_cond_t m_event;
-    pthread_mutex_t m_mutex;
+    std::atomic<int> m_state;
+    std::atomic<int> m_waiters;
 };
 
 class MSDKEvent;
@@ -66,15 +70,18 @@ struct msdkThreadHandle
 {
     msdkThreadHandle(
         msdk_thread_callback func,
-        void* arg):
+        void* arg,
+        const char* role):
       m_func(func),
       m_arg(arg),
+      m_role(role),
       m_event(0),
       m_thread(0)
     {}
 
     msdk_thread_callback m_func;
     void* m_arg;
+    const char* m_role;
     MSDKEvent* m_event;
     pthread_t m_thread;
 };
@@ -146,7 +153,8 @@ private:
 class MSDKThread: public msdkThreadHandle
 {
 public:
-    MSDKThread(mfxStatus &sts, msdk_thread_callback func, void* arg);
+    /** \brief Starts the thread, a non-NULL role is entered by the thread before func is called, see msdk_thread_enter. */
+    MSDKThread(mfxStatus &sts, msdk_thread_callback func, void* arg, const char* role = NULL);
     ~MSDKThread(void);
 
     mfxStatus Wait(void);
@@ -165,4 +173,33 @@ mfxStatus msdk_setrlimit_vmem(mfxU64 size);
 mfxStatus msdk_thread_get_schedtype(const msdk_char*, mfxI32 &type);
 void msdk_thread_printf_scheduling_help();
 
+/** \brief CPU placement and scheduling of the threads playing one role (decode, render, capture, ...). */
+struct msdkThreadPlacement
+{
+    msdkThreadPlacement():
+        schedType(-1),
+        priority(0)
+    {}
+
+    std::vector<mfxU32> cpus; // CPUs the thread may run on, empty - inherited from the creator
+    mfxI32 schedType;         // SCHED_* policy, -1 - inherited from the creator
+    mfxI32 priority;          // static priority for fifo and rr, per-thread nice value otherwise
+};
+
+/** \brief Parses a CPU list in the cpuset(7) format, e.g. "0-3,6". */
+mfxStatus msdk_thread_parse_cpu_list(const msdk_char* str, std::vector<mfxU32>& cpus);
+/** \brief Sets the placement applied to the threads entering the role, affects threads entering it afterwards. */
+void msdk_thread_set_placement(const char* role, const msdkThreadPlacement& placement);
+/** \brief Returns false if no placement has been set for the role. */
+bool msdk_thread_get_placement(const char* role, msdkThreadPlacement& placement);
+/** \brief Names the calling thread after the role, applies the role placement and registers the thread for the CPU report.
+    Entering another role re-applies the placement, e.g. in a forked child process. The main thread keeps its name,
+    which is the name of the process. */
+mfxStatus msdk_thread_enter(const char* role);
+/** \brief Records the CPU time of the calling thread, called by the thread before it exits.
+    The records of the exited threads of a role are summed up into one. */
+void msdk_thread_leave();
+/** \brief Prints the CPU time, context switches and effective CPUs of every thread of this process that entered a role. */
+void msdk_thread_print_cpu_report();
+
 #endif //__THREAD_DEFS_H__
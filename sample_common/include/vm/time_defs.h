@@ -45,6 +45,13 @@ typedef mfxI64 msdk_tick;
 
 msdk_tick msdk_time_get_tick(void);
 msdk_tick msdk_time_get_frequency(void);
+
+/* Sleeps until msdk_time_get_tick() reaches the given absolute tick */
+void msdk_time_sleep_until(msdk_tick deadline);
+
+/* CPU time consumed by the process and by the calling thread, in msdk_time_get_frequency() units */
+msdk_tick msdk_time_get_process_cpu_tick(void);
+msdk_tick msdk_time_get_thread_cpu_tick(void);
 mfxU64 rdtsc(void);
 
 #endif // #ifndef __TIME_DEFS_H__
@@ -0,0 +1,301 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "mfx_samples_config.h"
+
+#include "async_file_writer.h"
+#include "sample_defs.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+CAsyncFileWriter::CAsyncFileWriter()
+    : m_fd(-1)
+    , m_current(0)
+    , m_writing(0)
+    , m_reserved(0)
+    , m_pFilled(NULL)
+    , m_pFree(NULL)
+    , m_pThread(NULL)
+    , m_bStop(false)
+    , m_error(MFX_ERR_NONE)
+{
+    for (mfxU32 i = 0; i < 2; i++)
+    {
+        m_buffers[i].pData = NULL;
+        m_buffers[i].capacity = 0;
+        m_buffers[i].used = 0;
+    }
+}
+
+CAsyncFileWriter::~CAsyncFileWriter()
+{
+    Close();
+}
+
+mfxStatus CAsyncFileWriter::Allocate(sStagingBuffer &buffer, mfxU32 size)
+{
+    free(buffer.pData);
+    buffer.pData = NULL;
+    buffer.capacity = 0;
+    // page alignment keeps the buffers usable for direct I/O as well
+    if (posix_memalign((void **)&buffer.pData, 4096, size))
+    {
+        buffer.pData = NULL;
+        return MFX_ERR_MEMORY_ALLOC;
+    }
+    buffer.capacity = size;
+    buffer.used = 0;
+    buffer.chunks.clear();
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CAsyncFileWriter::Open(const msdk_char *strFileName, mfxU32 bufferSize)
+{
+    MSDK_CHECK_POINTER(strFileName, MFX_ERR_NULL_PTR);
+
+    Close();
+
+    mfxStatus sts = MFX_ERR_NONE;
+    for (mfxU32 i = 0; i < 2 && sts == MFX_ERR_NONE; i++)
+    {
+        sts = Allocate(m_buffers[i], MSDK_ALIGN(MSDK_MAX(bufferSize, (mfxU32)64), 64));
+    }
+    MSDK_CHECK_STATUS(sts, "CAsyncFileWriter: staging buffer allocation failed");
+
+    m_fd = open(strFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0)
+        return MFX_ERR_NULL_PTR;
+
+    m_current = 0;
+    m_writing = 0;
+    m_reserved = 0;
+    m_bStop = false;
+    m_error = MFX_ERR_NONE;
+
+    m_pFilled = new MSDKSemaphore(sts, 0);
+    MSDK_CHECK_STATUS(sts, "MSDKSemaphore creation failed");
+    m_pFree = new MSDKSemaphore(sts, 1);
+    MSDK_CHECK_STATUS(sts, "MSDKSemaphore creation failed");
+    m_pThread = new MSDKThread(sts, WriterThreadFunc, this, "writer");
+    MSDK_CHECK_STATUS(sts, "MSDKThread creation failed");
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CAsyncFileWriter::Close()
+{
+    mfxStatus sts = MFX_ERR_NONE;
+
+    if (m_pThread)
+    {
+        sts = Flush();
+
+        m_bStop = true;
+        m_pFilled->Post();
+        m_pThread->Wait();
+    }
+
+    MSDK_SAFE_DELETE(m_pThread);
+    MSDK_SAFE_DELETE(m_pFilled);
+    MSDK_SAFE_DELETE(m_pFree);
+
+    if (m_fd >= 0)
+    {
+        if (close(m_fd) && sts == MFX_ERR_NONE)
+            sts = MFX_ERR_UNDEFINED_BEHAVIOR;
+        m_fd = -1;
+    }
+
+    for (mfxU32 i = 0; i < 2; i++)
+    {
+        free(m_buffers[i].pData);
+        m_buffers[i].pData = NULL;
+        m_buffers[i].capacity = 0;
+        m_buffers[i].used = 0;
+        m_buffers[i].chunks.clear();
+    }
+
+    return sts;
+}
+
+mfxStatus CAsyncFileWriter::Reserve(mfxU32 size, mfxU8 **ppData)
+{
+    MSDK_CHECK_POINTER(ppData, MFX_ERR_NULL_PTR);
+    MSDK_CHECK_POINTER(m_pThread, MFX_ERR_NOT_INITIALIZED);
+
+    mfxStatus sts = MFX_ERR_NONE;
+    sStagingBuffer *pBuffer = &m_buffers[m_current];
+    mfxU32 offset = MSDK_ALIGN(pBuffer->used, 64);
+
+    if (offset + size > pBuffer->capacity)
+    {
+        if (pBuffer->used)
+        {
+            sts = Submit();
+            MSDK_CHECK_STATUS(sts, "CAsyncFileWriter: write failed");
+            pBuffer = &m_buffers[m_current];
+        }
+        if (size > pBuffer->capacity)
+        {
+            // a single chunk larger than the buffer, this buffer is not shared with the writer thread now
+            sts = Allocate(*pBuffer, MSDK_ALIGN(size, 64));
+            MSDK_CHECK_STATUS(sts, "CAsyncFileWriter: staging buffer allocation failed");
+        }
+        offset = 0;
+    }
+
+    m_reserved = offset;
+    *ppData = pBuffer->pData + offset;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CAsyncFileWriter::Commit(mfxU32 size)
+{
+    MSDK_CHECK_POINTER(m_pThread, MFX_ERR_NOT_INITIALIZED);
+
+    sStagingBuffer &buffer = m_buffers[m_current];
+    if (m_reserved + size > buffer.capacity)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    if (!size)
+        return MFX_ERR_NONE;
+
+    if (!buffer.chunks.empty() && m_reserved == buffer.used)
+    {
+        // contiguous with the previous chunk
+        buffer.chunks.back().iov_len += size;
+    }
+    else
+    {
+        struct iovec chunk;
+        chunk.iov_base = buffer.pData + m_reserved;
+        chunk.iov_len = size;
+        buffer.chunks.push_back(chunk);
+    }
+    buffer.used = m_reserved + size;
+    m_reserved = buffer.used;
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CAsyncFileWriter::Submit()
+{
+    // hand the current buffer over and wait for the other one to be written
+    m_pFilled->Post();
+    m_pFree->Wait();
+    m_current ^= 1;
+    m_reserved = 0;
+
+    return GetError();
+}
+
+mfxStatus CAsyncFileWriter::Flush()
+{
+    MSDK_CHECK_POINTER(m_pThread, MFX_ERR_NOT_INITIALIZED);
+
+    if (m_buffers[m_current].used)
+    {
+        mfxStatus sts = Submit();
+        MSDK_CHECK_STATUS(sts, "CAsyncFileWriter: write failed");
+    }
+
+    // wait for the buffer which is still in flight, then give it back
+    m_pFree->Wait();
+    m_pFree->Post();
+
+    return GetError();
+}
+
+mfxStatus CAsyncFileWriter::GetError()
+{
+    AutomaticMutex lock(m_errorMutex);
+    return m_error;
+}
+
+unsigned int MFX_STDCALL CAsyncFileWriter::WriterThreadFunc(void *pCtx)
+{
+    CAsyncFileWriter *pWriter = (CAsyncFileWriter *)pCtx;
+    pWriter->WriterLoop();
+    return 0;
+}
+
+void CAsyncFileWriter::WriterLoop()
+{
+    for (;;)
+    {
+        m_pFilled->Wait();
+        if (m_bStop)
+            break;
+
+        sStagingBuffer &buffer = m_buffers[m_writing];
+        // after the first error the data is dropped, the caller gets the error on the next submit
+        if (GetError() == MFX_ERR_NONE)
+        {
+            mfxStatus sts = WriteChunks(buffer);
+            AutomaticMutex lock(m_errorMutex);
+            m_error = sts;
+        }
+        buffer.used = 0;
+        buffer.chunks.clear();
+
+        m_writing ^= 1;
+        m_pFree->Post();
+    }
+}
+
+mfxStatus CAsyncFileWriter::WriteChunks(sStagingBuffer &buffer)
+{
+    struct iovec *pChunks = buffer.chunks.empty() ? NULL : &buffer.chunks[0];
+    size_t count = buffer.chunks.size();
+
+    while (count)
+    {
+        int batch = (int)MSDK_MIN(count, (size_t)IOV_MAX);
+        ssize_t written = writev(m_fd, pChunks, batch);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return MFX_ERR_UNDEFINED_BEHAVIOR;
+        }
+
+        // skip fully written chunks, partial write leaves the rest of a chunk for the next call
+        size_t left = (size_t)written;
+        while (count && left >= pChunks->iov_len)
+        {
+            left -= pChunks->iov_len;
+            pChunks++;
+            count--;
+        }
+        if (count)
+        {
+            pChunks->iov_base = (mfxU8 *)pChunks->iov_base + left;
+            pChunks->iov_len -= left;
+        }
+    }
+
+    return MFX_ERR_NONE;
+}
@@ -20,6 +20,7 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include "sample_defs.h"
 #include "avc_structures.h"
 #include "avc_nal_spl.h"
+#include "bitstream_scan.h"
 
 namespace ProtectedLibrary
 {
@@ -43,7 +44,11 @@ static mfxU8 start_code_prefix[] = {0, 0, 0, 1};
 
 enum
 {
-    AVC_NAL_UNITTYPE_BITS_MASK  = 0x1f
+    AVC_NAL_UNITTYPE_BITS_MASK  = 0x1f,
+
+    // HEVC nal_unit_type may be zero (TRAIL_N), so the whole header byte is
+    // reported with this bit set to keep zero meaning "no NAL unit"
+    HEVC_NAL_UNIT_PRESENT       = 0x100
 };
 
 
@@ -108,6 +113,7 @@ StartCodeIterator::StartCodeIterator()
     , m_pSourceBase(0)
     , m_nSourceBaseSize(0)
     , m_suggestedSize(10 * 1024)
+    , m_codecId(MFX_CODEC_AVC)
 {
     Reset();
 }
@@ -136,6 +142,19 @@ void StartCodeIterator::SetSuggestedSize(mfxU32 size)
         m_suggestedSize = size;
 }
 
+void StartCodeIterator::SetCodec(mfxU32 codecId)
+{
+    m_codecId = codecId;
+}
+
+mfxI32 StartCodeIterator::GetNalUnitCode(mfxU8 header) const
+{
+    if (MFX_CODEC_HEVC == m_codecId)
+        return HEVC_NAL_UNIT_PRESENT | header;
+
+    return header & AVC_NAL_UNITTYPE_BITS_MASK;
+}
+
 mfxI32 StartCodeIterator::CheckNalUnitType(mfxBitstream * source)
 {
     if (!source)
@@ -286,6 +305,21 @@ mfxI32 StartCodeIterator::FindStartCode(mfxU8 * (&pb), mfxU32 & size, mfxI32 & s
 
     for (mfxU32 i = 0 ; i < (mfxU32)size; i++, pb++)
     {
+        if (!zeroCount)
+        {
+            // start code can't begin before the next pair of zero bytes,
+            // a single zero at the very end is kept for the next portion of data
+            mfxU32 left = size - i;
+            mfxU32 skip = FindBytePair(pb, left, 0, 0);
+            if (skip == left && !pb[left - 1])
+                skip--;
+
+            i += skip;
+            pb += skip;
+            if (i >= (mfxU32)size)
+                break;
+        }
+
         switch(pb[0])
         {
         case 0x00:
@@ -300,7 +334,7 @@ mfxI32 StartCodeIterator::FindStartCode(mfxU8 * (&pb), mfxU32 & size, mfxI32 & s
                 zeroCount = 0;
                 if (size >= 1)
                 {
-                    return pb[0] & AVC_NAL_UNITTYPE_BITS_MASK;
+                    return GetNalUnitCode(pb[0]);
                 }
                 else
                 {
@@ -374,161 +408,38 @@ mfxI32 NALUnitSplitter::GetNalUnits(mfxBitstream * source, mfxBitstream * &desti
     return iCode;
 }
 
-/* temporal class definition */
-class H264DwordPointer_
-{
-public:
-    // Default constructor
-    H264DwordPointer_(void)
-    {
-        m_pDest = NULL;
-        m_nByteNum = 0;
-        m_iCur = 0;
-    }
-
-    H264DwordPointer_ operator = (void *pDest)
-    {
-        m_pDest = (mfxU32 *) pDest;
-        m_nByteNum = 0;
-        m_iCur = 0;
-
-        return *this;
-    }
-
-    // Increment operator
-    H264DwordPointer_ &operator ++ (void)
-    {
-        if (4 == ++m_nByteNum)
-        {
-            *m_pDest = m_iCur;
-            m_pDest += 1;
-            m_nByteNum = 0;
-            m_iCur = 0;
-        }
-        else
-            m_iCur <<= 8;
-
-        return *this;
-    }
-
-    mfxU8 operator = (mfxU8 nByte)
-    {
-        m_iCur = (m_iCur & ~0x0ff) | ((mfxU32) nByte);
-
-        return nByte;
-    }
-
-protected:
-    mfxU32 *m_pDest;                                            // pointer to destination buffer
-    mfxU32 m_nByteNum;                                          // number of current byte in dword
-    mfxU32 m_iCur;                                              // current dword
-};
-
-class H264SourcePointer_
-{
-public:
-    // Default constructor
-    H264SourcePointer_(void)
-    {
-        m_pSource = NULL;
-        m_nRemovedBytes=0;
-        m_nZeros=0;
-    }
-
-    H264SourcePointer_ &operator = (mfxU8 *pSource)
-    {
-        m_pSource = (mfxU8 *) pSource;
-
-        m_nZeros = 0;
-        m_nRemovedBytes = 0;
-
-        return *this;
-    }
-
-    H264SourcePointer_ &operator ++ (void)
-    {
-        mfxU8 bCurByte = m_pSource[0];
-
-        if (0 == bCurByte)
-            m_nZeros += 1;
-        else
-        {
-            if ((3 == bCurByte) && (2 <= m_nZeros))
-                m_nRemovedBytes += 1;
-            m_nZeros = 0;
-        }
-
-        m_pSource += 1;
-
-        return *this;
-    }
-
-    bool IsPrevent(void)
-    {
-        if ((3 == m_pSource[0]) && (2 <= m_nZeros))
-            return true;
-        else
-            return false;
-    }
-
-    operator mfxU8 (void)
-    {
-        return m_pSource[0];
-    }
-
-    mfxU32 GetRemovedBytes(void)
-    {
-        return m_nRemovedBytes;
-    }
-
-protected:
-    mfxU8 *m_pSource;                                           // pointer to destination buffer
-    mfxU32 m_nZeros;                                            // number of preceding zeros
-    mfxU32 m_nRemovedBytes;                                     // number of removed bytes
-};
-
 void SwapMemoryAndRemovePreventingBytes(mfxU8 *pDestination, mfxU32 &nDstSize, mfxU8 *pSource, mfxU32 nSrcSize)
 {
-    H264DwordPointer_ pDst;
-    H264SourcePointer_ pSrc;
-    size_t i;
-
-    // DwordPointer object is swapping written bytes
-    // H264SourcePointer_ removes preventing start-code bytes
-
-    // reset pointer(s)
-    pSrc = pSource;
-    pDst = pDestination;
+    // Destination is written as big endian dwords, preventing start-code bytes (0x03 after
+    // two zero bytes) are removed. Data between such sequences is copied in whole spans.
+    mfxU32 srcPos = 0;
+    mfxU32 dstPos = 0;
 
-    // first two bytes
-    i = 0;
-    while (i < (mfxU32) MSDK_MIN(2, nSrcSize))
+    while (srcPos < nSrcSize)
     {
-        pDst = (mfxU8) pSrc;
-        ++pDst;
-        ++pSrc;
-        ++i;
-    }
+        mfxU32 left = nSrcSize - srcPos;
+        mfxU32 span = FindByteTriple(pSource + srcPos, left, 0, 0, 3);
 
-    // do swapping
-    while (i < (mfxU32) nSrcSize)
-    {
-        if (false == pSrc.IsPrevent())
+        if (span == left)
         {
-            pDst = (mfxU8) pSrc;
-            ++pDst;
+            CopyBytesSwappingDwords(pDestination, dstPos, pSource + srcPos, left);
+            dstPos += left;
+            break;
         }
-        ++pSrc;
-        ++i;
+
+        // keep both zeros, skip 0x03
+        CopyBytesSwappingDwords(pDestination, dstPos, pSource + srcPos, span + 2);
+        dstPos += span + 2;
+        srcPos += span + 3;
     }
 
     // write padding bytes
-    nDstSize = nSrcSize - pSrc.GetRemovedBytes();
-    while (nDstSize & 3)
+    static const mfxU8 padding[3] = {0, 0, 0};
+    nDstSize = dstPos;
+    if (nDstSize & 3)
     {
-        pDst = (mfxU8) (0);
-        ++nDstSize;
-        ++pDst;
+        CopyBytesSwappingDwords(pDestination, nDstSize, padding, 4 - (nDstSize & 3));
+        nDstSize += 4 - (nDstSize & 3);
     }
 }
 
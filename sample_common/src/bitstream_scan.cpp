@@ -0,0 +1,261 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "bitstream_scan.h"
+#include "cpu_features.h"
+
+#if defined(MSDK_CPU_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+
+// Plain C versions, also used for the tails of the vector loops
+
+mfxU32 FindBytePair_C(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second)
+{
+    for (mfxU32 i = 0; i + 1 < size; i++)
+    {
+        if (pData[i] == first && pData[i + 1] == second)
+            return i;
+    }
+    return size;
+}
+
+mfxU32 FindByteTriple_C(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second, mfxU8 third)
+{
+    for (mfxU32 i = 0; i + 2 < size; i++)
+    {
+        if (pData[i] == first && pData[i + 1] == second && pData[i + 2] == third)
+            return i;
+    }
+    return size;
+}
+
+// Samples support little endian hosts only, so byte n of a big endian dword lives at offset 3 - n
+inline void CopyBytesSwappingDwords_Tail(mfxU8 *pDst, mfxU32 dstPos, const mfxU8 *pSrc, mfxU32 size)
+{
+    for (mfxU32 i = 0; i < size; i++, dstPos++)
+    {
+        pDst[(dstPos & ~3u) + 3 - (dstPos & 3)] = pSrc[i];
+    }
+}
+
+inline mfxU32 BytesToDwordBoundary(mfxU32 dstPos, mfxU32 size)
+{
+    mfxU32 head = (4 - (dstPos & 3)) & 3;
+    return head < size ? head : size;
+}
+
+void CopyBytesSwappingDwords_C(mfxU8 *pDst, mfxU32 dstPos, const mfxU8 *pSrc, mfxU32 size)
+{
+    CopyBytesSwappingDwords_Tail(pDst, dstPos, pSrc, size);
+}
+
+#if defined(MSDK_CPU_X86)
+
+inline mfxU32 FirstSetBit(mfxU32 mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (mfxU32)index;
+#else
+    return (mfxU32)__builtin_ctz(mask);
+#endif
+}
+
+MSDK_CPU_TARGET("sse2")
+mfxU32 FindBytePair_SSE2(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second)
+{
+    const __m128i vFirst = _mm_set1_epi8((char)first);
+    const __m128i vSecond = _mm_set1_epi8((char)second);
+
+    mfxU32 i = 0;
+    for (; i + 16 + 1 <= size; i += 16)
+    {
+        __m128i x0 = _mm_loadu_si128((const __m128i *)(pData + i));
+        __m128i x1 = _mm_loadu_si128((const __m128i *)(pData + i + 1));
+        mfxU32 mask = (mfxU32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(x0, vFirst), _mm_cmpeq_epi8(x1, vSecond)));
+        if (mask)
+            return i + FirstSetBit(mask);
+    }
+    return i + FindBytePair_C(pData + i, size - i, first, second);
+}
+
+MSDK_CPU_TARGET("sse2")
+mfxU32 FindByteTriple_SSE2(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second, mfxU8 third)
+{
+    const __m128i vFirst = _mm_set1_epi8((char)first);
+    const __m128i vSecond = _mm_set1_epi8((char)second);
+    const __m128i vThird = _mm_set1_epi8((char)third);
+
+    mfxU32 i = 0;
+    for (; i + 16 + 2 <= size; i += 16)
+    {
+        __m128i x0 = _mm_loadu_si128((const __m128i *)(pData + i));
+        __m128i x1 = _mm_loadu_si128((const __m128i *)(pData + i + 1));
+        __m128i x2 = _mm_loadu_si128((const __m128i *)(pData + i + 2));
+        __m128i match = _mm_and_si128(_mm_cmpeq_epi8(x0, vFirst), _mm_cmpeq_epi8(x1, vSecond));
+        mfxU32 mask = (mfxU32)_mm_movemask_epi8(_mm_and_si128(match, _mm_cmpeq_epi8(x2, vThird)));
+        if (mask)
+            return i + FirstSetBit(mask);
+    }
+    return i + FindByteTriple_C(pData + i, size - i, first, second, third);
+}
+
+MSDK_CPU_TARGET("sse2")
+void CopyBytesSwappingDwords_SSE2(mfxU8 *pDst, mfxU32 dstPos, const mfxU8 *pSrc, mfxU32 size)
+{
+    mfxU32 head = BytesToDwordBoundary(dstPos, size);
+    CopyBytesSwappingDwords_Tail(pDst, dstPos, pSrc, head);
+    dstPos += head;
+    pSrc += head;
+    size -= head;
+
+    for (; size >= 16; size -= 16, pSrc += 16, dstPos += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)pSrc);
+        // swap 16 bit words inside dwords, then bytes inside words
+        x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1);
+        x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        _mm_storeu_si128((__m128i *)(pDst + dstPos), x);
+    }
+
+    CopyBytesSwappingDwords_Tail(pDst, dstPos, pSrc, size);
+}
+
+MSDK_CPU_TARGET("avx2")
+mfxU32 FindBytePair_AVX2(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second)
+{
+    const __m256i vFirst = _mm256_set1_epi8((char)first);
+    const __m256i vSecond = _mm256_set1_epi8((char)second);
+
+    mfxU32 i = 0;
+    for (; i + 32 + 1 <= size; i += 32)
+    {
+        __m256i x0 = _mm256_loadu_si256((const __m256i *)(pData + i));
+        __m256i x1 = _mm256_loadu_si256((const __m256i *)(pData + i + 1));
+        mfxU32 mask = (mfxU32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(x0, vFirst), _mm256_cmpeq_epi8(x1, vSecond)));
+        if (mask)
+            return i + FirstSetBit(mask);
+    }
+    return i + FindBytePair_SSE2(pData + i, size - i, first, second);
+}
+
+MSDK_CPU_TARGET("avx2")
+mfxU32 FindByteTriple_AVX2(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second, mfxU8 third)
+{
+    const __m256i vFirst = _mm256_set1_epi8((char)first);
+    const __m256i vSecond = _mm256_set1_epi8((char)second);
+    const __m256i vThird = _mm256_set1_epi8((char)third);
+
+    mfxU32 i = 0;
+    for (; i + 32 + 2 <= size; i += 32)
+    {
+        __m256i x0 = _mm256_loadu_si256((const __m256i *)(pData + i));
+        __m256i x1 = _mm256_loadu_si256((const __m256i *)(pData + i + 1));
+        __m256i x2 = _mm256_loadu_si256((const __m256i *)(pData + i + 2));
+        __m256i match = _mm256_and_si256(_mm256_cmpeq_epi8(x0, vFirst), _mm256_cmpeq_epi8(x1, vSecond));
+        mfxU32 mask = (mfxU32)_mm256_movemask_epi8(_mm256_and_si256(match, _mm256_cmpeq_epi8(x2, vThird)));
+        if (mask)
+            return i + FirstSetBit(mask);
+    }
+    return i + FindByteTriple_SSE2(pData + i, size - i, first, second, third);
+}
+
+MSDK_CPU_TARGET("avx2")
+void CopyBytesSwappingDwords_AVX2(mfxU8 *pDst, mfxU32 dstPos, const mfxU8 *pSrc, mfxU32 size)
+{
+    const __m256i vSwap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+    mfxU32 head = BytesToDwordBoundary(dstPos, size);
+    CopyBytesSwappingDwords_Tail(pDst, dstPos, pSrc, head);
+    dstPos += head;
+    pSrc += head;
+    size -= head;
+
+    for (; size >= 32; size -= 32, pSrc += 32, dstPos += 32)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)pSrc);
+        _mm256_storeu_si256((__m256i *)(pDst + dstPos), _mm256_shuffle_epi8(x, vSwap));
+    }
+
+    CopyBytesSwappingDwords_SSE2(pDst, dstPos, pSrc, size);
+}
+
+#endif // MSDK_CPU_X86
+
+BitstreamScanFunctions SelectScanFunctions()
+{
+    BitstreamScanFunctions funcs;
+    GetBitstreamScanFunctions(msdk_cpu_best_isa(), funcs);
+    return funcs;
+}
+
+const BitstreamScanFunctions & GetScanFunctions()
+{
+    static const BitstreamScanFunctions funcs = SelectScanFunctions();
+    return funcs;
+}
+
+} // namespace
+
+bool GetBitstreamScanFunctions(msdkCpuIsa isa, BitstreamScanFunctions &funcs)
+{
+    if (!msdk_cpu_supports(isa))
+        return false;
+
+    BitstreamScanFunctions c = { FindBytePair_C, FindByteTriple_C, CopyBytesSwappingDwords_C };
+    funcs = c;
+
+#if defined(MSDK_CPU_X86)
+    if (isa == MSDK_CPU_ISA_AVX2)
+    {
+        funcs.findBytePair = FindBytePair_AVX2;
+        funcs.findByteTriple = FindByteTriple_AVX2;
+        funcs.copyBytesSwappingDwords = CopyBytesSwappingDwords_AVX2;
+    }
+    else if (isa == MSDK_CPU_ISA_SSE2)
+    {
+        funcs.findBytePair = FindBytePair_SSE2;
+        funcs.findByteTriple = FindByteTriple_SSE2;
+        funcs.copyBytesSwappingDwords = CopyBytesSwappingDwords_SSE2;
+    }
+#endif
+
+    return true;
+}
+
+mfxU32 FindBytePair(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second)
+{
+    return GetScanFunctions().findBytePair(pData, size, first, second);
+}
+
+mfxU32 FindByteTriple(const mfxU8 *pData, mfxU32 size, mfxU8 first, mfxU8 second, mfxU8 third)
+{
+    return GetScanFunctions().findByteTriple(pData, size, first, second, third);
+}
+
+void CopyBytesSwappingDwords(mfxU8 *pDst, mfxU32 dstPos, const mfxU8 *pSrc, mfxU32 size)
+{
+    GetScanFunctions().copyBytesSwappingDwords(pDst, dstPos, pSrc, size);
+}
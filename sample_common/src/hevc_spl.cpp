@@ -0,0 +1,638 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+
+#include <exception>
+#include <stdio.h>
+
+#include "hevc_spl.h"
+#include "sample_defs.h"
+
+namespace ProtectedLibrary
+{
+
+HEVCHeadersBitstream::HEVCHeadersBitstream()
+    : AVCBaseBitstream()
+{
+}
+
+void HEVCHeadersBitstream::SkipBits(mfxU32 nbits)
+{
+    while (nbits > 16)
+    {
+        GetBits(16);
+        nbits -= 16;
+    }
+
+    if (nbits)
+        GetBits(nbits);
+}
+
+void HEVCHeadersBitstream::SkipProfileTierLevel(mfxU32 maxSubLayersMinus1)
+{
+    // general_profile_space .. general_inbld_flag/reserved bit
+    SkipBits(88);
+    // general_level_idc
+    GetBits(8);
+
+    mfxU8 sub_layer_profile_present_flag[HEVC_MAX_SUB_LAYERS] = {};
+    mfxU8 sub_layer_level_present_flag[HEVC_MAX_SUB_LAYERS] = {};
+
+    for (mfxU32 i = 0; i < maxSubLayersMinus1; i++)
+    {
+        sub_layer_profile_present_flag[i] = (mfxU8)Get1Bit();
+        sub_layer_level_present_flag[i] = (mfxU8)Get1Bit();
+    }
+
+    if (maxSubLayersMinus1 > 0)
+    {
+        for (mfxU32 i = maxSubLayersMinus1; i < 8; i++)
+            GetBits(2); // reserved_zero_2bits
+    }
+
+    for (mfxU32 i = 0; i < maxSubLayersMinus1; i++)
+    {
+        if (sub_layer_profile_present_flag[i])
+            SkipBits(88);
+
+        if (sub_layer_level_present_flag[i])
+            GetBits(8);
+    }
+}
+
+mfxStatus HEVCHeadersBitstream::GetNALUnitHeader(HEVCSliceHeader *hdr)
+{
+    if (Get1Bit()) // forbidden_zero_bit
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    hdr->nal_unit_type = (mfxU8)GetBits(6);
+    hdr->nuh_layer_id = (mfxU8)GetBits(6);
+
+    mfxU32 nuh_temporal_id_plus1 = GetBits(3);
+    if (!nuh_temporal_id_plus1)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    hdr->nuh_temporal_id = (mfxU8)(nuh_temporal_id_plus1 - 1);
+    return MFX_ERR_NONE;
+}
+
+mfxStatus HEVCHeadersBitstream::GetVideoParamSet(HEVCVideoParamSet *vps)
+{
+    vps->vps_video_parameter_set_id = (mfxU8)GetBits(4);
+
+    GetBits(2); // vps_base_layer_internal_flag, vps_base_layer_available_flag
+    GetBits(6); // vps_max_layers_minus1
+
+    vps->vps_max_sub_layers = (mfxU8)(GetBits(3) + 1);
+    if (vps->vps_max_sub_layers > HEVC_MAX_SUB_LAYERS)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus HEVCHeadersBitstream::GetSequenceParamSet(HEVCSeqParamSet *sps)
+{
+    sps->sps_video_parameter_set_id = (mfxU8)GetBits(4);
+
+    sps->sps_max_sub_layers = (mfxU8)(GetBits(3) + 1);
+    if (sps->sps_max_sub_layers > HEVC_MAX_SUB_LAYERS)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    Get1Bit(); // sps_temporal_id_nesting_flag
+
+    SkipProfileTierLevel(sps->sps_max_sub_layers - 1);
+
+    mfxU32 sps_id = (mfxU32)GetVLCElement(false);
+    if (sps_id >= HEVC_MAX_NUM_SPS)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    sps->sps_seq_parameter_set_id = (mfxU8)sps_id;
+
+    sps->chroma_format_idc = (mfxU8)GetVLCElement(false);
+    if (sps->chroma_format_idc > 3)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    if (sps->chroma_format_idc == 3)
+        sps->separate_colour_plane_flag = (mfxU8)Get1Bit();
+
+    sps->pic_width_in_luma_samples = (mfxU32)GetVLCElement(false);
+    sps->pic_height_in_luma_samples = (mfxU32)GetVLCElement(false);
+    if (!sps->pic_width_in_luma_samples || !sps->pic_height_in_luma_samples)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    if (Get1Bit()) // conformance_window_flag
+    {
+        GetVLCElement(false); // conf_win_left_offset
+        GetVLCElement(false); // conf_win_right_offset
+        GetVLCElement(false); // conf_win_top_offset
+        GetVLCElement(false); // conf_win_bottom_offset
+    }
+
+    GetVLCElement(false); // bit_depth_luma_minus8
+    GetVLCElement(false); // bit_depth_chroma_minus8
+
+    mfxU32 log2_max_pic_order_cnt_lsb_minus4 = (mfxU32)GetVLCElement(false);
+    if (log2_max_pic_order_cnt_lsb_minus4 > 12)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    sps->log2_max_pic_order_cnt_lsb = (mfxU8)(log2_max_pic_order_cnt_lsb_minus4 + 4);
+
+    mfxU32 sps_sub_layer_ordering_info_present_flag = Get1Bit();
+    for (mfxU32 i = sps_sub_layer_ordering_info_present_flag ? 0 : sps->sps_max_sub_layers - 1; i < sps->sps_max_sub_layers; i++)
+    {
+        GetVLCElement(false); // sps_max_dec_pic_buffering_minus1
+        GetVLCElement(false); // sps_max_num_reorder_pics
+        GetVLCElement(false); // sps_max_latency_increase_plus1
+    }
+
+    mfxU32 log2_min_luma_coding_block_size_minus3 = (mfxU32)GetVLCElement(false);
+    mfxU32 log2_diff_max_min_luma_coding_block_size = (mfxU32)GetVLCElement(false);
+
+    sps->log2_min_luma_coding_block_size = (mfxU8)(log2_min_luma_coding_block_size_minus3 + 3);
+    sps->log2_ctb_size = (mfxU8)(sps->log2_min_luma_coding_block_size + log2_diff_max_min_luma_coding_block_size);
+    if (sps->log2_ctb_size < 4 || sps->log2_ctb_size > 6)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    mfxU32 ctbSize = 1 << sps->log2_ctb_size;
+    mfxU32 widthInCtbs = (sps->pic_width_in_luma_samples + ctbSize - 1) >> sps->log2_ctb_size;
+    mfxU32 heightInCtbs = (sps->pic_height_in_luma_samples + ctbSize - 1) >> sps->log2_ctb_size;
+    sps->pic_size_in_ctbs = widthInCtbs * heightInCtbs;
+
+    // the rest of sequence parameter set is not needed to find frame boundaries
+    return MFX_ERR_NONE;
+}
+
+mfxStatus HEVCHeadersBitstream::GetPictureParamSet(HEVCPicParamSet *pps)
+{
+    mfxU32 pps_id = (mfxU32)GetVLCElement(false);
+    if (pps_id >= HEVC_MAX_NUM_PPS)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    pps->pps_pic_parameter_set_id = (mfxU8)pps_id;
+
+    mfxU32 sps_id = (mfxU32)GetVLCElement(false);
+    if (sps_id >= HEVC_MAX_NUM_SPS)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    pps->pps_seq_parameter_set_id = (mfxU8)sps_id;
+
+    pps->dependent_slice_segments_enabled_flag = (mfxU8)Get1Bit();
+    pps->output_flag_present_flag = (mfxU8)Get1Bit();
+    pps->num_extra_slice_header_bits = (mfxU8)GetBits(3);
+
+    // the rest of picture parameter set is not needed to find frame boundaries
+    return MFX_ERR_NONE;
+}
+
+mfxStatus HEVCHeadersBitstream::GetSliceHeader(HEVCSliceHeader *hdr, const HEVCPicParamSet *pps, const HEVCSeqParamSet *sps)
+{
+    if (!hdr->first_slice_segment_in_pic_flag)
+    {
+        if (pps->dependent_slice_segments_enabled_flag)
+            hdr->dependent_slice_segment_flag = (mfxU8)Get1Bit();
+
+        mfxU32 addressBits = 0;
+        while ((1u << addressBits) < sps->pic_size_in_ctbs)
+            addressBits++;
+
+        hdr->slice_segment_address = addressBits ? GetBits(addressBits) : 0;
+        if (hdr->slice_segment_address >= sps->pic_size_in_ctbs)
+            return MFX_ERR_UNDEFINED_BEHAVIOR;
+    }
+
+    if (hdr->dependent_slice_segment_flag)
+        return MFX_ERR_NONE;
+
+    if (pps->num_extra_slice_header_bits)
+        GetBits(pps->num_extra_slice_header_bits); // slice_reserved_flag[]
+
+    hdr->slice_type = (mfxU8)GetVLCElement(false);
+    if (hdr->slice_type > HEVC_SLICE_I)
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    if (pps->output_flag_present_flag)
+        Get1Bit(); // pic_output_flag
+
+    if (sps->separate_colour_plane_flag)
+        GetBits(2); // colour_plane_id
+
+    if (hdr->nal_unit_type != HEVC_NAL_UT_IDR_W_RADL && hdr->nal_unit_type != HEVC_NAL_UT_IDR_N_LP)
+        hdr->slice_pic_order_cnt_lsb = GetBits(sps->log2_max_pic_order_cnt_lsb);
+
+    return MFX_ERR_NONE;
+}
+
+HEVC_Spl::HEVC_Spl()
+    : m_WaitForIRAP(true)
+    , m_lastNalUnit(0)
+    , m_bLastIsSlice(false)
+    , m_lastHeaderLength(0)
+{
+    Init();
+}
+
+HEVC_Spl::~HEVC_Spl()
+{
+    Close();
+}
+
+mfxStatus HEVC_Spl::Init()
+{
+    Close();
+
+    m_pNALSplitter.reset(new NALUnitSplitter());
+    m_pNALSplitter->Init();
+    m_pNALSplitter->SetCodec(MFX_CODEC_HEVC);
+
+    m_WaitForIRAP = true;
+
+    m_currentFrame.resize(BUFFER_SIZE);
+
+    m_slices.resize(128);
+    memset(&m_frame, 0, sizeof(m_frame));
+    m_frame.Data = &m_currentFrame[0];
+    m_frame.Slice = &m_slices[0];
+
+    return MFX_ERR_NONE;
+}
+
+void HEVC_Spl::Close()
+{
+    m_lastNalUnit = 0;
+    m_bLastIsSlice = false;
+    m_lastHeaderLength = 0;
+    memset(&m_lastSlice, 0, sizeof(m_lastSlice));
+}
+
+mfxStatus HEVC_Spl::Reset()
+{
+    m_pNALSplitter->Reset();
+    m_WaitForIRAP = true;
+    m_lastNalUnit = 0;
+    m_bLastIsSlice = false;
+    ResetCurrentState();
+    return MFX_ERR_NONE;
+}
+
+void HEVC_Spl::ResetCurrentState()
+{
+    m_frame.DataLength = 0;
+    m_frame.SliceNum = 0;
+    m_frame.FirstFieldSliceNum = 0;
+}
+
+mfxU8 * HEVC_Spl::GetMemoryForSwapping(mfxU32 size)
+{
+    if (m_swappingMemory.size() <= size + 8)
+        m_swappingMemory.resize(size + 8);
+
+    return &(m_swappingMemory[0]);
+}
+
+mfxStatus HEVC_Spl::DecodeHeader(mfxU32 nalType, mfxBitstream * nalUnit)
+{
+    mfxStatus umcRes = MFX_ERR_NONE;
+
+    HEVCHeadersBitstream bitStream;
+
+    try
+    {
+        mfxU32 swappingSize = nalUnit->DataLength;
+        mfxU8 * swappingMemory = GetMemoryForSwapping(swappingSize);
+
+        BytesSwapper::SwapMemory(swappingMemory, swappingSize, nalUnit->Data + nalUnit->DataOffset, nalUnit->DataLength);
+
+        bitStream.Reset(swappingMemory, swappingSize);
+
+        HEVCSliceHeader nalHeader;
+        umcRes = bitStream.GetNALUnitHeader(&nalHeader);
+        if (umcRes != MFX_ERR_NONE)
+            return umcRes;
+
+        switch(nalType)
+        {
+        case HEVC_NAL_UT_VPS:
+            {
+                HEVCVideoParamSet vps;
+                umcRes = bitStream.GetVideoParamSet(&vps);
+                if (umcRes == MFX_ERR_NONE)
+                    m_vps.AddHeader(&vps);
+            }
+            break;
+
+        case HEVC_NAL_UT_SPS:
+            {
+                HEVCSeqParamSet sps;
+                umcRes = bitStream.GetSequenceParamSet(&sps);
+                if (umcRes == MFX_ERR_NONE)
+                {
+                    m_sps.AddHeader(&sps);
+                    m_pNALSplitter->SetSuggestedSize(CalculateSuggestedSize(&sps));
+                }
+            }
+            break;
+
+        case HEVC_NAL_UT_PPS:
+            {
+                HEVCPicParamSet pps;
+                umcRes = bitStream.GetPictureParamSet(&pps);
+                if (umcRes == MFX_ERR_NONE)
+                {
+                    if (!m_sps.GetHeader(pps.pps_seq_parameter_set_id))
+                        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+                    m_pps.AddHeader(&pps);
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+    catch(const AVC_exception & ex)
+    {
+        return (mfxStatus)ex.GetStatus();
+    }
+    catch(...)
+    {
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    }
+
+    return umcRes;
+}
+
+bool HEVC_Spl::DecodeSliceHeader(mfxBitstream * nalUnit, HEVCSliceHeader * slice, mfxU32 & headerLength)
+{
+    memset(slice, 0, sizeof(*slice));
+
+    mfxU32 swappingSize = nalUnit->DataLength;
+    mfxU8 * swappingMemory = GetMemoryForSwapping(swappingSize);
+
+    BytesSwapper::SwapMemory(swappingMemory, swappingSize, nalUnit->Data + nalUnit->DataOffset, nalUnit->DataLength);
+
+    if (!swappingSize)
+        return false;
+
+    HEVCHeadersBitstream bitStream;
+    bitStream.Reset(swappingMemory, swappingSize);
+
+    try
+    {
+        if (MFX_ERR_NONE != bitStream.GetNALUnitHeader(slice))
+            return false;
+
+        slice->first_slice_segment_in_pic_flag = (mfxU8)bitStream.Get1Bit();
+
+        if (IsHEVCIRAP(slice->nal_unit_type))
+            bitStream.Get1Bit(); // no_output_of_prior_pics_flag
+
+        mfxU32 pps_id = (mfxU32)bitStream.GetVLCElement(false);
+        if (pps_id >= HEVC_MAX_NUM_PPS)
+            return false;
+        slice->slice_pic_parameter_set_id = (mfxU8)pps_id;
+
+        HEVCPicParamSet * pps = m_pps.GetHeader(pps_id);
+        if (!pps)
+            return false;
+
+        HEVCSeqParamSet * sps = m_sps.GetHeader(pps->pps_seq_parameter_set_id);
+        if (!sps)
+            return false;
+
+        if (MFX_ERR_NONE != bitStream.GetSliceHeader(slice, pps, sps))
+            return false;
+    }
+    catch(const AVC_exception & )
+    {
+        return false;
+    }
+    catch(...)
+    {
+        return false;
+    }
+
+    headerLength = bitStream.BytesDecoded();
+
+    // add number of 003 sequence to headerLength
+    mfxU8 * start = nalUnit->Data + nalUnit->DataOffset;
+    for (mfxU8 * ptr = start; ptr + 2 < start + nalUnit->DataLength && ptr < start + headerLength; ptr++)
+    {
+        if (ptr[0]==0 && ptr[1]==0 && ptr[2]==3)
+        {
+            headerLength++;
+        }
+    }
+
+    return true;
+}
+
+// The frame grows with its access unit, an access unit larger than BUFFER_SIZE is kept whole
+mfxStatus HEVC_Spl::ReserveFrame(mfxU32 size)
+{
+    if (m_frame.DataLength + size < m_frame.DataLength)
+        return MFX_ERR_NOT_ENOUGH_BUFFER;
+
+    if (m_frame.DataLength + size > m_currentFrame.size())
+    {
+        m_currentFrame.resize(MSDK_MAX((size_t)m_frame.DataLength + size, 2 * m_currentFrame.size()));
+        m_frame.Data = &m_currentFrame[0];
+    }
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus HEVC_Spl::AddNalUnit(mfxBitstream * nalUnit)
+{
+    static mfxU8 start_code_prefix[] = {0, 0, 1};
+
+    mfxStatus sts = ReserveFrame((mfxU32)(nalUnit->DataLength + sizeof(start_code_prefix)));
+    if (sts != MFX_ERR_NONE)
+        return sts;
+
+    MSDK_MEMCPY_BUF(m_frame.Data, m_frame.DataLength, m_currentFrame.size(), start_code_prefix, sizeof(start_code_prefix));
+    MSDK_MEMCPY_BUF(m_frame.Data, m_frame.DataLength + sizeof(start_code_prefix), m_currentFrame.size(), nalUnit->Data + nalUnit->DataOffset, nalUnit->DataLength);
+
+    m_frame.DataLength += (mfxU32)(nalUnit->DataLength + sizeof(start_code_prefix));
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus HEVC_Spl::AddSliceNalUnit(mfxBitstream * nalUnit, const HEVCSliceHeader * slice, mfxU32 headerLength)
+{
+    static mfxU8 start_code_prefix[] = {0, 0, 1};
+
+    mfxU32 sliceLength = (mfxU32)(nalUnit->DataLength + sizeof(start_code_prefix));
+
+    mfxStatus sts = ReserveFrame(sliceLength);
+    if (sts != MFX_ERR_NONE)
+        return sts;
+
+    MSDK_MEMCPY_BUF(m_frame.Data, m_frame.DataLength, m_currentFrame.size(), start_code_prefix, sizeof(start_code_prefix));
+    MSDK_MEMCPY_BUF(m_frame.Data, m_frame.DataLength + sizeof(start_code_prefix), m_currentFrame.size(), nalUnit->Data + nalUnit->DataOffset, nalUnit->DataLength);
+
+    if (!m_frame.SliceNum)
+    {
+        m_frame.TimeStamp = nalUnit->TimeStamp;
+    }
+
+    m_frame.SliceNum++;
+
+    if (m_slices.size() <= m_frame.SliceNum)
+    {
+        m_slices.resize(m_frame.SliceNum + 10);
+        m_frame.Slice = &m_slices[0];
+    }
+
+    SliceSplitterInfo & newSlice = m_slices[m_frame.SliceNum - 1];
+
+    newSlice.HeaderLength = headerLength + sizeof(start_code_prefix);
+    newSlice.DataLength = sliceLength;
+    newSlice.DataOffset = m_frame.DataLength;
+
+    // dependent slice segment inherits slice_type of the preceding independent one
+    if (slice->dependent_slice_segment_flag && m_frame.SliceNum > 1)
+        newSlice.SliceType = m_slices[m_frame.SliceNum - 2].SliceType;
+    else if (slice->slice_type == HEVC_SLICE_I)
+        newSlice.SliceType = TYPE_I;
+    else if (slice->slice_type == HEVC_SLICE_P)
+        newSlice.SliceType = TYPE_P;
+    else
+        newSlice.SliceType = TYPE_B;
+
+    m_frame.DataLength += sliceLength;
+    m_frame.FirstFieldSliceNum++;
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus HEVC_Spl::ProcessNalUnit(mfxI32 nalCode, mfxBitstream * nalUnit)
+{
+    if (!nalUnit || !nalCode || nalUnit->DataLength < 2)
+        return MFX_ERR_MORE_DATA;
+
+    mfxU32 nalType = (nalUnit->Data[nalUnit->DataOffset] >> 1) & HEVC_NAL_UNITTYPE_BITS_MASK;
+
+    if (IsHEVCSlice(nalType))
+    {
+        HEVCSliceHeader slice;
+        mfxU32 headerLength = 0;
+
+        if (!DecodeSliceHeader(nalUnit, &slice, headerLength))
+            return MFX_ERR_MORE_DATA;
+
+        if (m_WaitForIRAP)
+        {
+            if (!IsHEVCIRAP(nalType))
+                return MFX_ERR_MORE_DATA;
+
+            m_WaitForIRAP = false;
+        }
+
+        // first slice segment of the next picture completes current frame
+        if (m_frame.SliceNum && slice.first_slice_segment_in_pic_flag)
+        {
+            m_lastNalUnit = nalUnit;
+            m_bLastIsSlice = true;
+            m_lastSlice = slice;
+            m_lastHeaderLength = headerLength;
+            return MFX_ERR_NONE;
+        }
+
+        mfxStatus sts = AddSliceNalUnit(nalUnit, &slice, headerLength);
+        return sts == MFX_ERR_NONE ? MFX_ERR_MORE_DATA : sts;
+    }
+
+    mfxStatus sts = MFX_ERR_NONE;
+    switch (nalType)
+    {
+    case HEVC_NAL_UT_VPS:
+    case HEVC_NAL_UT_SPS:
+    case HEVC_NAL_UT_PPS:
+        DecodeHeader(nalType, nalUnit);
+        // fall through
+    case HEVC_NAL_UT_AUD:
+    case HEVC_NAL_UT_SEI_PREFIX:
+    case 41: case 42: case 43: case 44: // RSV_NVCL41..RSV_NVCL44
+    case 48: case 49: case 50: case 51: // UNSPEC48..UNSPEC55
+    case 52: case 53: case 54: case 55:
+        // these NAL units may only precede the first slice of access unit
+        if (m_frame.SliceNum)
+        {
+            m_lastNalUnit = nalUnit;
+            m_bLastIsSlice = false;
+            return MFX_ERR_NONE;
+        }
+        sts = AddNalUnit(nalUnit);
+        break;
+
+    case HEVC_NAL_UT_SEI_SUFFIX:
+    case HEVC_NAL_UT_EOS:
+    case HEVC_NAL_UT_EOB:
+        sts = AddNalUnit(nalUnit);
+        break;
+
+    case HEVC_NAL_UT_FD:
+    default:
+        break;
+    };
+
+    return sts == MFX_ERR_NONE ? MFX_ERR_MORE_DATA : sts;
+}
+
+mfxStatus HEVC_Spl::GetFrame(mfxBitstream * bs_in, FrameSplitterInfo ** frame)
+{
+    *frame = 0;
+
+    if (m_lastNalUnit)
+    {
+        mfxStatus sts = m_bLastIsSlice ?
+            AddSliceNalUnit(m_lastNalUnit, &m_lastSlice, m_lastHeaderLength) :
+            AddNalUnit(m_lastNalUnit);
+
+        m_lastNalUnit = 0;
+        m_bLastIsSlice = false;
+
+        if (sts != MFX_ERR_NONE)
+            return sts;
+    }
+
+    do
+    {
+        mfxBitstream * destination;
+        mfxI32 nalCode = m_pNALSplitter->GetNalUnits(bs_in, destination);
+        mfxStatus sts = ProcessNalUnit(nalCode, destination);
+        if (sts != MFX_ERR_NONE && sts != MFX_ERR_MORE_DATA)
+            return sts;
+
+        if (sts == MFX_ERR_NONE || (!bs_in && m_frame.SliceNum))
+        {
+            *frame = &m_frame;
+            return MFX_ERR_NONE;
+        }
+
+    } while (bs_in && bs_in->DataLength > MINIMAL_DATA_SIZE);
+
+    return MFX_ERR_MORE_DATA;
+}
+
+mfxStatus HEVC_Spl::PostProcessing(FrameSplitterInfo *frame, mfxU32 sliceNum)
+{
+    UNREFERENCED_PARAMETER(frame);
+    UNREFERENCED_PARAMETER(sliceNum);
+    return MFX_ERR_NONE;
+}
+
+} // namespace ProtectedLibrary
@@ -0,0 +1,119 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "mfx_samples_config.h"
+
+#include "latency_histogram.h"
+#include "sample_defs.h"
+
+CLatencyHistogram::CLatencyHistogram()
+{
+    Reset();
+}
+
+void CLatencyHistogram::Reset()
+{
+    MSDK_ZERO_MEMORY(m_buckets);
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+void CLatencyHistogram::TakeSnapshot(CLatencyHistogram& snapshot)
+{
+    snapshot = *this;
+    Reset();
+}
+
+// values below SUB_BUCKETS map one to one, then every power of two
+// [2^e, 2^(e+1)) is split into SUB_BUCKETS equal buckets
+mfxU32 CLatencyHistogram::GetBucketIndex(mfxU64 us)
+{
+    const mfxU64 maxValue = ((mfxU64)1 << MAX_VALUE_BITS) - 1;
+    if (us > maxValue)
+        us = maxValue;
+    if (us < SUB_BUCKETS)
+        return (mfxU32)us;
+
+    mfxU32 exponent = SUB_BUCKET_BITS;
+    while (us >> (exponent + 1))
+        exponent++;
+    mfxU32 shift = exponent - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + (mfxU32)((us >> shift) - SUB_BUCKETS);
+}
+
+mfxU64 CLatencyHistogram::GetBucketLowerBound(mfxU32 index)
+{
+    if (index < SUB_BUCKETS)
+        return index;
+
+    mfxU32 shift = index / SUB_BUCKETS - 1;
+    return (mfxU64)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+}
+
+mfxU64 CLatencyHistogram::GetBucketWidth(mfxU32 index)
+{
+    return (index < SUB_BUCKETS) ? 1 : (mfxU64)1 << (index / SUB_BUCKETS - 1);
+}
+
+void CLatencyHistogram::AddValue(mfxF64 ms)
+{
+    mfxU64 us = (ms > 0) ? (mfxU64)(ms * 1000 + 0.5) : 0;
+
+    if (!m_count || us < m_min)
+        m_min = us;
+    if (!m_count || us > m_max)
+        m_max = us;
+    m_sum += (mfxF64)us;
+    m_count++;
+    m_buckets[GetBucketIndex(us)]++;
+}
+
+mfxF64 CLatencyHistogram::GetQuantile(mfxF64 q) const
+{
+    if (!m_count)
+        return 0;
+
+    q = MSDK_MIN(MSDK_MAX(q, 0.0), 1.0);
+    // nearest rank, 1-based
+    mfxU64 rank = (mfxU64)(q * m_count + 0.5);
+    rank = MSDK_MIN(MSDK_MAX(rank, (mfxU64)1), m_count);
+
+    mfxU64 seen = 0;
+    for (mfxU32 i = 0; i < NUM_BUCKETS; i++)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+        {
+            // report the middle of the bucket, but never outside of the observed range
+            mfxU64 value = GetBucketLowerBound(i) + GetBucketWidth(i) / 2;
+            value = MSDK_MIN(MSDK_MAX(value, m_min), m_max);
+            return value / 1000.0;
+        }
+    }
+    return m_max / 1000.0;
+}
+
+void CLatencyHistogram::PrintSummary(const msdk_char* prefix) const
+{
+    msdk_printf(MSDK_STRING("%s %llu smpls, AVG=%5.3f ms, MIN=%5.3f ms, MAX=%5.3f ms, P50=%5.3f ms, P90=%5.3f ms, P99=%5.3f ms\n"),
+        prefix, (unsigned long long)m_count, GetAvg(), GetMin(), GetMax(),
+        GetQuantile(0.5), GetQuantile(0.9), GetQuantile(0.99));
+}
@@ -28,13 +28,9 @@ CBuffering::CBuffering():
     m_OutputSurfacesNumber(0),
     m_pSurfaces(NULL),
     m_pVppSurfaces(NULL),
-    m_FreeSurfacesPool(&m_Mutex),
-    m_FreeVppSurfacesPool(&m_Mutex),
     m_UsedSurfacesPool(&m_Mutex),
     m_UsedVppSurfacesPool(&m_Mutex),
-    m_pFreeOutputSurfaces(NULL),
-    m_OutputSurfacesPool(&m_Mutex),
-    m_DeliveredSurfacesPool(&m_Mutex)
+    m_pFreeOutputSurfaces(NULL)
 {
 }
 
@@ -88,8 +84,6 @@ CBuffering::AllocVppBuffers(mfxU32 VppSurfaceNumber)
 void
 CBuffering::AllocOutputBuffer()
 {
-    AutomaticMutex lock(m_Mutex);
-
     m_pFreeOutputSurfaces = (msdkOutputSurface*)calloc(1, sizeof(msdkOutputSurface));
 }
 
@@ -116,24 +110,30 @@ CBuffering::FreeBuffers()
         m_pVppSurfaces = NULL;
     }
 
+    msdkOutputSurface* returned = m_FreeOutputSurfaces.TakeAll();
+    msdkOutputSurface* output = m_OutputSurfacesPool.DetachAll();
+    msdkOutputSurface* delivered = m_DeliveredSurfacesPool.DetachAll();
+
     FreeList(m_pFreeOutputSurfaces);
-    FreeList(m_OutputSurfacesPool.m_pSurfacesHead);
-    FreeList(m_DeliveredSurfacesPool.m_pSurfacesHead);
+    FreeList(returned);
+    FreeList(output);
+    FreeList(delivered);
 
     m_UsedSurfacesPool.m_pSurfacesHead = NULL;
     m_UsedSurfacesPool.m_pSurfacesTail = NULL;
     m_UsedVppSurfacesPool.m_pSurfacesHead = NULL;
     m_UsedVppSurfacesPool.m_pSurfacesTail = NULL;
 
-    m_FreeSurfacesPool.m_pSurfaces = NULL;
-    m_FreeVppSurfacesPool.m_pSurfaces = NULL;
+    m_FreeSurfacesPool.Reset(NULL);
+    m_FreeVppSurfacesPool.Reset(NULL);
 }
 
 void
 CBuffering::ResetBuffers()
 {
     mfxU32 i;
-    msdkFrameSurface* pFreeSurf = m_FreeSurfacesPool.m_pSurfaces = m_pSurfaces;
+    msdkFrameSurface* pFreeSurf = m_pSurfaces;
+    m_FreeSurfacesPool.Reset(m_pSurfaces);
 
     for (i = 0; i < m_SurfacesNumber; ++i) {
         if (i < (m_SurfacesNumber-1)) {
@@ -147,7 +147,8 @@ void
 CBuffering::ResetVppBuffers()
 {
     mfxU32 i;
-    msdkFrameSurface* pFreeVppSurf = m_FreeVppSurfacesPool.m_pSurfaces = m_pVppSurfaces;
+    msdkFrameSurface* pFreeVppSurf = m_pVppSurfaces;
+    m_FreeVppSurfacesPool.Reset(m_pVppSurfaces);
 
     for (i = 0; i < m_OutputSurfacesNumber; ++i) {
         if (i < (m_OutputSurfacesNumber-1)) {
@@ -173,7 +174,7 @@ CBuffering::SyncFrameSurfaces()
         } else {
             // frame was unlocked: moving it to the free surfaces array
             m_UsedSurfacesPool.DetachSurfaceUnsafe(cur);
-            m_FreeSurfacesPool.AddSurfaceUnsafe(cur);
+            m_FreeSurfacesPool.AddSurface(cur);
 
             cur = next;
         }
@@ -196,7 +197,7 @@ CBuffering::SyncVppFrameSurfaces()
         } else {
             // frame was unlocked: moving it to the free surfaces array
             m_UsedVppSurfacesPool.DetachSurfaceUnsafe(cur);
-            m_FreeVppSurfacesPool.AddSurfaceUnsafe(cur);
+            m_FreeVppSurfacesPool.AddSurface(cur);
 
             cur = next;
         }
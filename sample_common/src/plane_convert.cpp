@@ -0,0 +1,184 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "plane_convert.h"
+#include "cpu_features.h"
+
+#include <string.h>
+
+namespace
+{
+
+// Plain C versions of the row kernels, also used for the tails of the vector loops
+
+void SplitUVRow_C(mfxU8 *pDstU, mfxU8 *pDstV, const mfxU8 *pSrc, mfxU32 widthBytes)
+{
+    mfxU32 i = 0;
+    for (; i + 1 < widthBytes; i += 2)
+    {
+        pDstU[i / 2] = pSrc[i];
+        pDstV[i / 2] = pSrc[i + 1];
+    }
+    if (i < widthBytes)
+        pDstU[i / 2] = pSrc[i];
+}
+
+void ShiftRight16Row_C(mfxU16 *pDst, const mfxU16 *pSrc, mfxU32 width, mfxU32 shift)
+{
+    for (mfxU32 i = 0; i < width; i++)
+        pDst[i] = (mfxU16)(pSrc[i] >> shift);
+}
+
+#if defined(MSDK_CPU_X86)
+
+MSDK_CPU_TARGET("sse2")
+void SplitUVRow_SSE2(mfxU8 *pDstU, mfxU8 *pDstV, const mfxU8 *pSrc, mfxU32 widthBytes)
+{
+    const __m128i vLowBytes = _mm_set1_epi16(0x00FF);
+
+    mfxU32 i = 0;
+    for (; i + 32 <= widthBytes; i += 32)
+    {
+        __m128i x0 = _mm_loadu_si128((const __m128i *)(pSrc + i));
+        __m128i x1 = _mm_loadu_si128((const __m128i *)(pSrc + i + 16));
+        __m128i u = _mm_packus_epi16(_mm_and_si128(x0, vLowBytes), _mm_and_si128(x1, vLowBytes));
+        __m128i v = _mm_packus_epi16(_mm_srli_epi16(x0, 8), _mm_srli_epi16(x1, 8));
+        _mm_storeu_si128((__m128i *)(pDstU + i / 2), u);
+        _mm_storeu_si128((__m128i *)(pDstV + i / 2), v);
+    }
+    SplitUVRow_C(pDstU + i / 2, pDstV + i / 2, pSrc + i, widthBytes - i);
+}
+
+MSDK_CPU_TARGET("sse2")
+void ShiftRight16Row_SSE2(mfxU16 *pDst, const mfxU16 *pSrc, mfxU32 width, mfxU32 shift)
+{
+    const __m128i vShift = _mm_cvtsi32_si128((int)shift);
+
+    mfxU32 i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)(pSrc + i));
+        _mm_storeu_si128((__m128i *)(pDst + i), _mm_srl_epi16(x, vShift));
+    }
+    ShiftRight16Row_C(pDst + i, pSrc + i, width - i, shift);
+}
+
+MSDK_CPU_TARGET("avx2")
+void SplitUVRow_AVX2(mfxU8 *pDstU, mfxU8 *pDstV, const mfxU8 *pSrc, mfxU32 widthBytes)
+{
+    const __m256i vLowBytes = _mm256_set1_epi16(0x00FF);
+
+    mfxU32 i = 0;
+    for (; i + 64 <= widthBytes; i += 64)
+    {
+        __m256i x0 = _mm256_loadu_si256((const __m256i *)(pSrc + i));
+        __m256i x1 = _mm256_loadu_si256((const __m256i *)(pSrc + i + 32));
+        // packus works inside 128-bit lanes, restore the order of the qwords afterwards
+        __m256i u = _mm256_packus_epi16(_mm256_and_si256(x0, vLowBytes), _mm256_and_si256(x1, vLowBytes));
+        __m256i v = _mm256_packus_epi16(_mm256_srli_epi16(x0, 8), _mm256_srli_epi16(x1, 8));
+        _mm256_storeu_si256((__m256i *)(pDstU + i / 2), _mm256_permute4x64_epi64(u, 0xD8));
+        _mm256_storeu_si256((__m256i *)(pDstV + i / 2), _mm256_permute4x64_epi64(v, 0xD8));
+    }
+    SplitUVRow_SSE2(pDstU + i / 2, pDstV + i / 2, pSrc + i, widthBytes - i);
+}
+
+MSDK_CPU_TARGET("avx2")
+void ShiftRight16Row_AVX2(mfxU16 *pDst, const mfxU16 *pSrc, mfxU32 width, mfxU32 shift)
+{
+    const __m128i vShift = _mm_cvtsi32_si128((int)shift);
+
+    mfxU32 i = 0;
+    for (; i + 16 <= width; i += 16)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(pSrc + i));
+        _mm256_storeu_si256((__m256i *)(pDst + i), _mm256_srl_epi16(x, vShift));
+    }
+    ShiftRight16Row_SSE2(pDst + i, pSrc + i, width - i, shift);
+}
+
+#endif // MSDK_CPU_X86
+
+PlaneConvertFunctions SelectConvertFunctions()
+{
+    PlaneConvertFunctions funcs;
+    GetPlaneConvertFunctions(msdk_cpu_best_isa(), funcs);
+    return funcs;
+}
+
+const PlaneConvertFunctions & GetConvertFunctions()
+{
+    static const PlaneConvertFunctions funcs = SelectConvertFunctions();
+    return funcs;
+}
+
+} // namespace
+
+bool GetPlaneConvertFunctions(msdkCpuIsa isa, PlaneConvertFunctions &funcs)
+{
+    if (!msdk_cpu_supports(isa))
+        return false;
+
+    PlaneConvertFunctions c = { SplitUVRow_C, ShiftRight16Row_C };
+    funcs = c;
+
+#if defined(MSDK_CPU_X86)
+    if (isa == MSDK_CPU_ISA_AVX2)
+    {
+        funcs.splitUVRow = SplitUVRow_AVX2;
+        funcs.shiftRight16Row = ShiftRight16Row_AVX2;
+    }
+    else if (isa == MSDK_CPU_ISA_SSE2)
+    {
+        funcs.splitUVRow = SplitUVRow_SSE2;
+        funcs.shiftRight16Row = ShiftRight16Row_SSE2;
+    }
+#endif
+
+    return true;
+}
+
+void CopyPlane(mfxU8 *pDst, const mfxU8 *pSrc, mfxU32 srcPitch, mfxU32 widthBytes, mfxU32 height)
+{
+    if (srcPitch == widthBytes)
+    {
+        memcpy(pDst, pSrc, (size_t)widthBytes * height);
+        return;
+    }
+    for (mfxU32 i = 0; i < height; i++, pDst += widthBytes, pSrc += srcPitch)
+        memcpy(pDst, pSrc, widthBytes);
+}
+
+void SplitUVPlane(mfxU8 *pDstU, mfxU8 *pDstV, const mfxU8 *pSrc, mfxU32 srcPitch, mfxU32 widthBytes, mfxU32 height)
+{
+    const PlaneConvertFunctions &funcs = GetConvertFunctions();
+    for (mfxU32 i = 0; i < height; i++)
+    {
+        funcs.splitUVRow(pDstU, pDstV, pSrc, widthBytes);
+        pDstU += (widthBytes + 1) / 2;
+        pDstV += widthBytes / 2;
+        pSrc += srcPitch;
+    }
+}
+
+void CopyPlaneShiftRight16(mfxU16 *pDst, const mfxU8 *pSrc, mfxU32 srcPitch, mfxU32 width, mfxU32 height, mfxU32 shift)
+{
+    const PlaneConvertFunctions &funcs = GetConvertFunctions();
+    for (mfxU32 i = 0; i < height; i++, pDst += width, pSrc += srcPitch)
+        funcs.shiftRight16Row(pDst, (const mfxU16 *)pSrc, width, shift);
+}
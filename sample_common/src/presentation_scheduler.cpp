@@ -0,0 +1,191 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "mfx_samples_config.h"
+
+#include <math.h>
+
+#include "presentation_scheduler.h"
+#include "sample_defs.h"
+
+static const mfxU32 MFX_TIME_STAMP_FREQUENCY = 90000;
+static const mfxU64 MFX_TIME_STAMP_INVALID = (mfxU64)-1;
+
+CPresentationScheduler::CPresentationScheduler()
+    : m_frameInterval(0)
+    , m_lateThreshold(0)
+    , m_resyncThreshold(0)
+{
+    Reset();
+}
+
+void CPresentationScheduler::Init(mfxF64 frameRate)
+{
+    m_frameInterval = (frameRate > 0) ? (msdk_tick)(msdk_time_get_frequency() / frameRate) : 0;
+    m_lateThreshold = m_frameInterval;
+    // half a second behind means a stall rather than a slow frame
+    m_resyncThreshold = MSDK_MAX(msdk_time_get_frequency() / 2, 4 * m_frameInterval);
+
+    Reset();
+}
+
+void CPresentationScheduler::Reset()
+{
+    m_bStarted = false;
+    m_baseTick = 0;
+    m_baseTimeStamp = MFX_TIME_STAMP_INVALID;
+    m_lastTimeStamp = MFX_TIME_STAMP_INVALID;
+    m_lastDeadline = 0;
+
+    m_presented = 0;
+    m_dropped = 0;
+    m_restarts = 0;
+    m_jitterSum = 0;
+    m_jitterSquares = 0;
+    m_jitterMax = 0;
+
+    m_startTick = 0;
+    m_startProcessCpuTick = 0;
+    m_startThreadCpuTick = 0;
+    m_lastTick = 0;
+    m_lastThreadCpuTick = 0;
+}
+
+void CPresentationScheduler::Restart(mfxU64 timeStamp, msdk_tick now)
+{
+    m_baseTick = now;
+    m_baseTimeStamp = timeStamp;
+    m_lastTimeStamp = timeStamp;
+    m_lastDeadline = now;
+}
+
+msdk_tick CPresentationScheduler::GetDeadline(mfxU64 timeStamp, msdk_tick now)
+{
+    if (!m_bStarted)
+    {
+        m_bStarted = true;
+        Restart(timeStamp, now);
+        return now;
+    }
+
+    msdk_tick deadline = m_lastDeadline + m_frameInterval;
+
+    if (timeStamp != MFX_TIME_STAMP_INVALID && m_baseTimeStamp != MFX_TIME_STAMP_INVALID && timeStamp > m_lastTimeStamp)
+    {
+        msdk_tick streamDeadline = m_baseTick +
+            (msdk_tick)((timeStamp - m_baseTimeStamp) * (mfxF64)msdk_time_get_frequency() / MFX_TIME_STAMP_FREQUENCY);
+
+        // a jump in timestamps is a discontinuity, not a reason to freeze the picture
+        if (streamDeadline - m_lastDeadline <= m_resyncThreshold)
+        {
+            deadline = streamDeadline;
+        }
+        else
+        {
+            m_baseTick = deadline;
+            m_baseTimeStamp = timeStamp;
+        }
+    }
+    else
+    {
+        // no usable timestamp: keep nominal rate and count following timestamps from here
+        m_baseTick = deadline;
+        m_baseTimeStamp = timeStamp;
+    }
+
+    m_lastTimeStamp = timeStamp;
+    m_lastDeadline = deadline;
+    return deadline;
+}
+
+bool CPresentationScheduler::WaitForDeadline(mfxU64 timeStamp)
+{
+    if (!IsEnabled())
+        return true;
+
+    msdk_tick now = msdk_time_get_tick();
+
+    if (!m_bStarted)
+    {
+        m_startTick = now;
+        m_startProcessCpuTick = msdk_time_get_process_cpu_tick();
+        m_startThreadCpuTick = msdk_time_get_thread_cpu_tick();
+    }
+
+    msdk_tick deadline = GetDeadline(timeStamp, now);
+    bool bPresent = true;
+
+    if (now - deadline > m_resyncThreshold)
+    {
+        // presented right away, the new timeline starts with this frame
+        Restart(timeStamp, now);
+        m_restarts++;
+        m_presented++;
+    }
+    else if (now - deadline > m_lateThreshold)
+    {
+        m_dropped++;
+        bPresent = false;
+    }
+    else
+    {
+        if (now < deadline)
+        {
+            msdk_time_sleep_until(deadline);
+            now = msdk_time_get_tick();
+        }
+
+        msdk_tick jitter = now - deadline;
+        m_jitterSum += (mfxF64)jitter;
+        m_jitterSquares += (mfxF64)jitter * jitter;
+        if (jitter > m_jitterMax)
+            m_jitterMax = jitter;
+        m_presented++;
+    }
+
+    m_lastTick = now;
+    m_lastThreadCpuTick = msdk_time_get_thread_cpu_tick();
+
+    return bPresent;
+}
+
+void CPresentationScheduler::PrintStatistics()
+{
+    if (!IsEnabled() || !m_bStarted)
+        return;
+
+    mfxF64 freq = (mfxF64)msdk_time_get_frequency();
+    mfxF64 avg = m_presented ? m_jitterSum / m_presented : 0;
+    mfxF64 stdDev = m_presented ? sqrt(MSDK_MAX(m_jitterSquares / m_presented - avg * avg, 0.0)) : 0;
+
+    msdk_tick now = msdk_time_get_tick();
+    mfxF64 wall = (mfxF64)(now - m_startTick);
+    mfxF64 presentWall = (mfxF64)(m_lastTick - m_startTick);
+    mfxF64 processCpu = (mfxF64)(msdk_time_get_process_cpu_tick() - m_startProcessCpuTick);
+    mfxF64 threadCpu = (mfxF64)(m_lastThreadCpuTick - m_startThreadCpuTick);
+
+    msdk_printf(MSDK_STRING("\nPresentation summary:\n"));
+    msdk_printf(MSDK_STRING("Frames presented=%llu, late frames dropped=%llu, timeline restarts=%llu\n"),
+        (unsigned long long)m_presented, (unsigned long long)m_dropped, (unsigned long long)m_restarts);
+    msdk_printf(MSDK_STRING("Jitter AVG=%5.3f ms, STDDEV=%5.3f ms, MAX=%5.3f ms\n"),
+        avg / freq * 1000, stdDev / freq * 1000, m_jitterMax / freq * 1000);
+    msdk_printf(MSDK_STRING("CPU use: process=%.1f%%, presentation thread=%.1f%%\n"),
+        wall > 0 ? processCpu / wall * 100 : 0.0,
+        presentWall > 0 ? threadCpu / presentWall * 100 : 0.0);
+}
@@ -29,6 +29,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include "time_statistics.h"
 #include "sample_defs.h"
 #include "sample_utils.h"
+#include "bitstream_scan.h"
+#include "plane_convert.h"
 #include "mfxcommon.h"
 #include "mfxjpeg.h"
 #include "mfxvp8.h"
@@ -576,14 +578,14 @@ mfxStatus CSmplBitstreamReader::ReadNextFrame(mfxBitstream *pBS)
 
 mfxU32 CJPEGFrameReader::FindMarker(mfxBitstream *pBS,mfxU32 startOffset,CJPEGFrameReader::JPEGMarker marker)
 {
-    for (mfxU32 i = startOffset; i + sizeof(mfxU16) <= pBS->DataLength; i++)
-    {
-        if ( *(mfxU16*)(pBS->Data + i)==(mfxU16)marker)
-        {
-            return i;
-        }
-    }
-    return 0xFFFFFFFF;
+    if (startOffset + sizeof(mfxU16) > pBS->DataLength)
+        return 0xFFFFFFFF;
+
+    // marker is compared as a little endian word, so its low byte comes first
+    mfxU32 size = pBS->DataLength - startOffset;
+    mfxU32 offset = FindBytePair(pBS->Data + startOffset, size, (mfxU8)(marker & 0xFF), (mfxU8)((marker >> 8) & 0xFF));
+
+    return (offset < size) ? startOffset + offset : 0xFFFFFFFF;
 }
 
 mfxStatus CJPEGFrameReader::ReadNextFrame(mfxBitstream *pBS)
@@ -688,8 +690,6 @@ CSmplYUVWriter::CSmplYUVWriter()
 {
     m_bInited = false;
     m_bIsMultiView = false;
-    m_fDest = NULL;
-    m_fDestMVC = NULL;
     m_numCreatedFiles = 0;
     m_nViews = 0;
 };
@@ -708,8 +708,9 @@ mfxStatus CSmplYUVWriter::Init(const msdk_char *strFileName, const mfxU32 numVie
 
     if (!m_bIsMultiView)
     {
-        MSDK_FOPEN(m_fDest, m_sFile.c_str(), MSDK_STRING("wb"));
-        MSDK_CHECK_POINTER(m_fDest, MFX_ERR_NULL_PTR);
+        m_pDest.push_back(new CAsyncFileWriter);
+        mfxStatus sts = m_pDest.back()->Open(m_sFile.c_str());
+        MSDK_CHECK_STATUS(sts, "CAsyncFileWriter::Open failed");
         ++m_numCreatedFiles;
     }
     else
@@ -718,11 +719,11 @@ mfxStatus CSmplYUVWriter::Init(const msdk_char *strFileName, const mfxU32 numVie
 
         MSDK_CHECK_ERROR(numViews, 0, MFX_ERR_NOT_INITIALIZED);
 
-        m_fDestMVC = new FILE*[numViews];
         for (i = 0; i < numViews; ++i)
         {
-            MSDK_FOPEN(m_fDestMVC[i], FormMVCFileName(m_sFile.c_str(), i).c_str(), MSDK_STRING("wb"));
-            MSDK_CHECK_POINTER(m_fDestMVC[i], MFX_ERR_NULL_PTR);
+            m_pDest.push_back(new CAsyncFileWriter);
+            mfxStatus sts = m_pDest.back()->Open(FormMVCFileName(m_sFile.c_str(), i).c_str());
+            MSDK_CHECK_STATUS(sts, "CAsyncFileWriter::Open failed");
             ++m_numCreatedFiles;
         }
     }
@@ -747,31 +748,25 @@ CSmplYUVWriter::~CSmplYUVWriter()
 
 void CSmplYUVWriter::Close()
 {
-    if (m_fDest)
+    // waits for the background writes to complete
+    for (size_t i = 0; i < m_pDest.size(); ++i)
     {
-        fclose(m_fDest);
-        m_fDest = NULL;
-    }
-
-    if (m_fDestMVC)
-    {
-        mfxU32 i = 0;
-        for (i = 0; i < m_numCreatedFiles; ++i)
-        {
-            if  (m_fDestMVC[i] != NULL)
-            {
-                fclose(m_fDestMVC[i]);
-                m_fDestMVC[i] = NULL;
-            }
-        }
-        delete m_fDestMVC;
-        m_fDestMVC = NULL;
+        MSDK_SAFE_DELETE(m_pDest[i]);
     }
+    m_pDest.clear();
 
     m_numCreatedFiles = 0;
     m_bInited = false;
 }
 
+CAsyncFileWriter* CSmplYUVWriter::GetDestination(mfxU32 viewId)
+{
+    mfxU32 idx = m_bIsMultiView ? viewId : 0;
+    return idx < m_pDest.size() ? m_pDest[idx] : NULL;
+}
+
+// Frames are converted plane by plane into the staging buffer of the file writer
+// and written out by its background thread.
 mfxStatus CSmplYUVWriter::WriteNextFrame(mfxFrameSurface1 *pSurface)
 {
     MSDK_CHECK_ERROR(m_bInited, false,   MFX_ERR_NOT_INITIALIZED);
@@ -780,136 +775,69 @@ mfxStatus CSmplYUVWriter::WriteNextFrame(mfxFrameSurface1 *pSurface)
     mfxFrameInfo &pInfo = pSurface->Info;
     mfxFrameData &pData = pSurface->Data;
 
-    mfxU32 i, h, w;
-    mfxU32 vid = pInfo.FrameId.ViewId;
-
-    // Temporary buffer to convert MS-P010 to P010
-    std::vector<mfxU16> tmp;
-
-    if (!m_bIsMultiView)
-    {
-        MSDK_CHECK_POINTER(m_fDest, MFX_ERR_NULL_PTR);
-    }
-    else
-    {
-        MSDK_CHECK_POINTER(m_fDestMVC, MFX_ERR_NULL_PTR);
-        MSDK_CHECK_POINTER(m_fDestMVC[vid], MFX_ERR_NULL_PTR);
-    }
+    mfxU32 h, w;
+    mfxU32 lumaSize, chromaSize, frameSize;
+    mfxU8 *pDst = NULL;
+    mfxStatus sts = MFX_ERR_NONE;
 
-    FILE* dstFile = m_bIsMultiView ? m_fDestMVC[vid] : m_fDest;
+    CAsyncFileWriter* dstFile = GetDestination(pInfo.FrameId.ViewId);
+    MSDK_CHECK_POINTER(dstFile, MFX_ERR_NULL_PTR);
 
     switch (pInfo.FourCC)
     {
-        case MFX_FOURCC_YV12:
         case MFX_FOURCC_NV12:
-        for (i = 0; i < pInfo.CropH; i++)
         {
-                MSDK_CHECK_NOT_EQUAL(
-                    fwrite(pData.Y + (pInfo.CropY * pData.Pitch + pInfo.CropX)+ i * pData.Pitch, 1, pInfo.CropW, dstFile),
-                    pInfo.CropW, MFX_ERR_UNDEFINED_BEHAVIOR);
-        }
-        break;
-        case MFX_FOURCC_P010:
-        case MFX_FOURCC_P210:
-        {
-            for (i = 0; i < pInfo.CropH; i++)
-            {
-                mfxU16* shortPtr = (mfxU16*)(pData.Y + (pInfo.CropY * pData.Pitch + pInfo.CropX) + i * pData.Pitch);
-                if (pInfo.Shift)
-                {
-                    // Convert MS-P010 to P010 and write
-                    tmp.resize(pData.Pitch);
+            lumaSize = (mfxU32)pInfo.CropW * pInfo.CropH;
+            chromaSize = (mfxU32)pInfo.CropW * (pInfo.CropH / 2);
+            frameSize = lumaSize + chromaSize;
 
-                    for (int idx = 0; idx < pInfo.CropW; idx++)
-                    {
-                        tmp[idx] = shortPtr[idx] >> 6;
-                    }
-
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(&tmp[0], 1, (mfxU32)pInfo.CropW * 2, dstFile),
-                        (mfxU32)pInfo.CropW * 2, MFX_ERR_UNDEFINED_BEHAVIOR);
-
-                }
-                else
-                {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(shortPtr, 1, (mfxU32)pInfo.CropW * 2, dstFile),
-                        (mfxU32)pInfo.CropW * 2, MFX_ERR_UNDEFINED_BEHAVIOR);
-                }
-            }
+            sts = dstFile->Reserve(frameSize, &pDst);
+            MSDK_CHECK_STATUS(sts, "CAsyncFileWriter::Reserve failed");
 
+            CopyPlane(pDst, pData.Y + (pInfo.CropY * pData.Pitch + pInfo.CropX), pData.Pitch, pInfo.CropW, pInfo.CropH);
+            CopyPlane(pDst + lumaSize, pData.UV + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2), pData.Pitch, pInfo.CropW, pInfo.CropH / 2);
             break;
         }
-        case MFX_FOURCC_RGB4:
-        case 100: //DXGI_FORMAT_AYUV
-        case MFX_FOURCC_A2RGB10:
-            // Implementation for RGB4 and A2RGB10 in the next switch below
-        break;
-
-        default:
-            return MFX_ERR_UNSUPPORTED;
-    }
-    switch (pInfo.FourCC)
-    {
         case MFX_FOURCC_YV12:
         {
-            for (i = 0; i < (mfxU32) pInfo.CropH/2; i++)
-            {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(pData.V + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2)+ i * pData.Pitch, 1, pInfo.CropW, dstFile),
-                        (mfxU32)pInfo.CropW/2, MFX_ERR_UNDEFINED_BEHAVIOR);
-            }
-            for (i = 0; i < (mfxU32)pInfo.CropH/2; i++)
-            {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(pData.U + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2)+ i * pData.Pitch / 2, 1, pInfo.CropW/2, dstFile),
-                        (mfxU32)pInfo.CropW/2, MFX_ERR_UNDEFINED_BEHAVIOR);
-            }
-            break;
-        }
-        case MFX_FOURCC_NV12:
-        {
-            for (i = 0; i < (mfxU32) pInfo.CropH/2; i++)
-            {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(pData.UV + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2) + i * pData.Pitch, 1, pInfo.CropW, dstFile),
-                        pInfo.CropW, MFX_ERR_UNDEFINED_BEHAVIOR);
-            }
+            lumaSize = (mfxU32)pInfo.CropW * pInfo.CropH;
+            chromaSize = (mfxU32)(pInfo.CropW / 2) * (pInfo.CropH / 2);
+            frameSize = lumaSize + 2 * chromaSize;
+
+            sts = dstFile->Reserve(frameSize, &pDst);
+            MSDK_CHECK_STATUS(sts, "CAsyncFileWriter::Reserve failed");
+
+            CopyPlane(pDst, pData.Y + (pInfo.CropY * pData.Pitch + pInfo.CropX), pData.Pitch, pInfo.CropW, pInfo.CropH);
+            CopyPlane(pDst + lumaSize, pData.V + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2), pData.Pitch / 2, pInfo.CropW / 2, pInfo.CropH / 2);
+            CopyPlane(pDst + lumaSize + chromaSize, pData.U + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2), pData.Pitch / 2, pInfo.CropW / 2, pInfo.CropH / 2);
             break;
         }
         case MFX_FOURCC_P010:
         case MFX_FOURCC_P210:
         {
-            mfxU32 height = pInfo.FourCC == MFX_FOURCC_P010 ? (mfxU32)pInfo.CropH / 2 : (mfxU32)pInfo.CropH;
-
-            for (i = 0; i < height; i++)
-            {
-                mfxU16* shortPtr = (mfxU16*)(pData.UV + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX) + i * pData.Pitch);
-                if (pInfo.Shift)
-                {
-                    // Convert MS-P010 to P010 and write
-                    tmp.resize(pData.Pitch);
+            mfxU32 chromaH = pInfo.FourCC == MFX_FOURCC_P010 ? (mfxU32)pInfo.CropH / 2 : (mfxU32)pInfo.CropH;
+            lumaSize = (mfxU32)pInfo.CropW * 2 * pInfo.CropH;
+            chromaSize = (mfxU32)pInfo.CropW * 2 * chromaH;
+            frameSize = lumaSize + chromaSize;
 
-                    for (int idx = 0; idx < pInfo.CropW; idx++)
-                    {
-                        tmp[idx] = shortPtr[idx] >> 6;
-                    }
+            sts = dstFile->Reserve(frameSize, &pDst);
+            MSDK_CHECK_STATUS(sts, "CAsyncFileWriter::Reserve failed");
 
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(&tmp[0], 1, (mfxU32)pInfo.CropW * 2, dstFile),
-                        (mfxU32)pInfo.CropW * 2, MFX_ERR_UNDEFINED_BEHAVIOR);
-
-                }
-                else
-                {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(shortPtr, 1, (mfxU32)pInfo.CropW * 2, dstFile),
-                        (mfxU32)pInfo.CropW * 2, MFX_ERR_UNDEFINED_BEHAVIOR);
-                }
+            const mfxU8* pY = pData.Y + (pInfo.CropY * pData.Pitch + pInfo.CropX);
+            const mfxU8* pUV = pData.UV + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX);
+            if (pInfo.Shift)
+            {
+                // Convert MS-P010 to P010
+                CopyPlaneShiftRight16((mfxU16*)pDst, pY, pData.Pitch, pInfo.CropW, pInfo.CropH, 6);
+                CopyPlaneShiftRight16((mfxU16*)(pDst + lumaSize), pUV, pData.Pitch, pInfo.CropW, chromaH, 6);
+            }
+            else
+            {
+                CopyPlane(pDst, pY, pData.Pitch, (mfxU32)pInfo.CropW * 2, pInfo.CropH);
+                CopyPlane(pDst + lumaSize, pUV, pData.Pitch, (mfxU32)pInfo.CropW * 2, chromaH);
             }
             break;
         }
-
         case MFX_FOURCC_RGB4:
         case 100: //DXGI_FORMAT_AYUV
         case MFX_FOURCC_A2RGB10:
@@ -926,15 +854,15 @@ mfxStatus CSmplYUVWriter::WriteNextFrame(mfxFrameSurface1 *pSurface)
                 w = pInfo.Width;
                 h = pInfo.Height;
             }
+            frameSize = 4 * w * h;
+
+            sts = dstFile->Reserve(frameSize, &pDst);
+            MSDK_CHECK_STATUS(sts, "CAsyncFileWriter::Reserve failed");
 
             ptr = MSDK_MIN( MSDK_MIN(pData.R, pData.G), pData.B);
             ptr = ptr + pInfo.CropX + pInfo.CropY * pData.Pitch;
 
-            for(i = 0; i < h; i++)
-            {
-                MSDK_CHECK_NOT_EQUAL(fwrite(ptr + i * pData.Pitch, 1, 4*w, dstFile), 4*w, MFX_ERR_UNDEFINED_BEHAVIOR);
-            }
-            fflush(dstFile);
+            CopyPlane(pDst, ptr, pData.Pitch, 4 * w, h);
             break;
         }
 
@@ -942,6 +870,9 @@ mfxStatus CSmplYUVWriter::WriteNextFrame(mfxFrameSurface1 *pSurface)
             return MFX_ERR_UNSUPPORTED;
     }
 
+    sts = dstFile->Commit(frameSize);
+    MSDK_CHECK_NOT_EQUAL(sts, MFX_ERR_NONE, MFX_ERR_UNDEFINED_BEHAVIOR);
+
     return MFX_ERR_NONE;
 }
 
@@ -953,126 +884,41 @@ mfxStatus CSmplYUVWriter::WriteNextFrameI420(mfxFrameSurface1 *pSurface)
     mfxFrameInfo &pInfo = pSurface->Info;
     mfxFrameData &pData = pSurface->Data;
 
-    mfxU32 i, j, h, w;
-    mfxU32 vid = pInfo.FrameId.ViewId;
+    mfxU8 *pDst = NULL;
+    mfxStatus sts = MFX_ERR_NONE;
 
-    if (!m_bIsMultiView)
-    {
-        MSDK_CHECK_POINTER(m_fDest, MFX_ERR_NULL_PTR);
-    }
-    else
-    {
-        MSDK_CHECK_POINTER(m_fDestMVC, MFX_ERR_NULL_PTR);
-        MSDK_CHECK_POINTER(m_fDestMVC[vid], MFX_ERR_NULL_PTR);
-    }
+    CAsyncFileWriter* dstFile = GetDestination(pInfo.FrameId.ViewId);
+    MSDK_CHECK_POINTER(dstFile, MFX_ERR_NULL_PTR);
 
-    // Write Y
-    switch (pInfo.FourCC)
-    {
-        case MFX_FOURCC_YV12:
-        case MFX_FOURCC_NV12:
-        {
-            for (i = 0; i < pInfo.CropH; i++)
-            {
-                if (!m_bIsMultiView)
-                {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(pData.Y + (pInfo.CropY * pData.Pitch + pInfo.CropX)+ i * pData.Pitch, 1, pInfo.CropW, m_fDest),
-                        pInfo.CropW, MFX_ERR_UNDEFINED_BEHAVIOR);
-                }
-                else
-                {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(pData.Y + (pInfo.CropY * pData.Pitch + pInfo.CropX)+ i * pData.Pitch, 1, pInfo.CropW, m_fDestMVC[vid]),
-                        pInfo.CropW, MFX_ERR_UNDEFINED_BEHAVIOR);
-                }
-            }
-            break;
-        }
-        default:
-        {
-            msdk_printf(MSDK_STRING("ERROR: I420 output is accessible only for NV12 and YV12.\n"));
-            return MFX_ERR_UNSUPPORTED;
-        }
-    }
+    mfxU32 lumaSize = (mfxU32)pInfo.CropW * pInfo.CropH;
+    mfxU32 uSize, vSize;
 
-    // Write U and V
     switch (pInfo.FourCC)
     {
         case MFX_FOURCC_YV12:
         {
-            for (i = 0; i < (mfxU32) pInfo.CropH/2; i++)
-            {
-                if (!m_bIsMultiView)
-                {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(pData.U + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2)+ i * pData.Pitch / 2, 1, pInfo.CropW/2, m_fDest),
-                        (mfxU32)pInfo.CropW/2, MFX_ERR_UNDEFINED_BEHAVIOR);
-                }
-                else
-                {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(pData.U + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2)+ i * pData.Pitch / 2, 1, pInfo.CropW/2, m_fDestMVC[vid]),
-                        (mfxU32)pInfo.CropW/2, MFX_ERR_UNDEFINED_BEHAVIOR);
-                }
-            }
-            for (i = 0; i < (mfxU32)pInfo.CropH/2; i++)
-            {
-                if (!m_bIsMultiView)
-                {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(pData.V + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2)+ i * pData.Pitch / 2, 1, pInfo.CropW/2, m_fDest),
-                        (mfxU32)pInfo.CropW/2, MFX_ERR_UNDEFINED_BEHAVIOR);
-                }
-                else
-                {
-                    MSDK_CHECK_NOT_EQUAL(
-                        fwrite(pData.V + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2)+ i * pData.Pitch / 2, 1, pInfo.CropW/2, m_fDestMVC[vid]),
-                        (mfxU32)pInfo.CropW/2, MFX_ERR_UNDEFINED_BEHAVIOR);
-                }
-            }
+            uSize = vSize = (mfxU32)(pInfo.CropW / 2) * (pInfo.CropH / 2);
+
+            sts = dstFile->Reserve(lumaSize + uSize + vSize, &pDst);
+            MSDK_CHECK_STATUS(sts, "CAsyncFileWriter::Reserve failed");
+
+            CopyPlane(pDst, pData.Y + (pInfo.CropY * pData.Pitch + pInfo.CropX), pData.Pitch, pInfo.CropW, pInfo.CropH);
+            CopyPlane(pDst + lumaSize, pData.U + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2), pData.Pitch / 2, pInfo.CropW / 2, pInfo.CropH / 2);
+            CopyPlane(pDst + lumaSize + uSize, pData.V + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX / 2), pData.Pitch / 2, pInfo.CropW / 2, pInfo.CropH / 2);
             break;
         }
         case MFX_FOURCC_NV12:
         {
-            h = pInfo.CropH / 2;
-            w = pInfo.CropW;
-            for (i = 0; i < h; i++)
-            {
-                for (j = 0; j < w; j += 2)
-                {
-                    if (!m_bIsMultiView)
-                    {
-                        MSDK_CHECK_NOT_EQUAL(
-                            fwrite(pData.UV + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX) + i * pData.Pitch + j, 1, 1, m_fDest),
-                            1, MFX_ERR_UNDEFINED_BEHAVIOR);
-                    }
-                    else
-                    {
-                        MSDK_CHECK_NOT_EQUAL(
-                            fwrite(pData.UV + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX) + i * pData.Pitch + j, 1, 1, m_fDestMVC[vid]),
-                            1, MFX_ERR_UNDEFINED_BEHAVIOR);
-                    }
-                }
-            }
-            for (i = 0; i < h; i++)
-            {
-                for (j = 1; j < w; j += 2)
-                {
-                    if (!m_bIsMultiView)
-                    {
-                        MSDK_CHECK_NOT_EQUAL(
-                            fwrite(pData.UV + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX)+ i * pData.Pitch + j, 1, 1, m_fDest),
-                            1, MFX_ERR_UNDEFINED_BEHAVIOR);
-                    }
-                    else
-                    {
-                        MSDK_CHECK_NOT_EQUAL(
-                            fwrite(pData.UV + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX)+ i * pData.Pitch + j, 1, 1, m_fDestMVC[vid]),
-                            1, MFX_ERR_UNDEFINED_BEHAVIOR);
-                    }
-                }
-            }
+            // even bytes of the interleaved plane are U samples, odd bytes are V samples
+            uSize = (mfxU32)((pInfo.CropW + 1) / 2) * (pInfo.CropH / 2);
+            vSize = (mfxU32)(pInfo.CropW / 2) * (pInfo.CropH / 2);
+
+            sts = dstFile->Reserve(lumaSize + uSize + vSize, &pDst);
+            MSDK_CHECK_STATUS(sts, "CAsyncFileWriter::Reserve failed");
+
+            CopyPlane(pDst, pData.Y + (pInfo.CropY * pData.Pitch + pInfo.CropX), pData.Pitch, pInfo.CropW, pInfo.CropH);
+            SplitUVPlane(pDst + lumaSize, pDst + lumaSize + uSize,
+                pData.UV + (pInfo.CropY * pData.Pitch / 2 + pInfo.CropX), pData.Pitch, pInfo.CropW, pInfo.CropH / 2);
             break;
         }
         default:
@@ -1082,6 +928,9 @@ mfxStatus CSmplYUVWriter::WriteNextFrameI420(mfxFrameSurface1 *pSurface)
         }
     }
 
+    sts = dstFile->Commit(lumaSize + uSize + vSize);
+    MSDK_CHECK_NOT_EQUAL(sts, MFX_ERR_NONE, MFX_ERR_UNDEFINED_BEHAVIOR);
+
     return MFX_ERR_NONE;
 }
 
@@ -2198,7 +2047,7 @@ mfxStatus CH264FrameReader::Init(const msdk_char *strFileName)
     if (sts != MFX_ERR_NONE)
         return sts;
 
-    m_pNALSplitter.reset(new ProtectedLibrary::AVC_Spl());
+    m_pNALSplitter.reset(CreateSplitter());
 
     m_frame = 0;
     m_plainBuffer = 0;
@@ -2207,6 +2056,11 @@ mfxStatus CH264FrameReader::Init(const msdk_char *strFileName)
     return sts;
 }
 
+AbstractSplitter * CH264FrameReader::CreateSplitter()
+{
+    return new ProtectedLibrary::AVC_Spl();
+}
+
 mfxStatus CH264FrameReader::ReadNextFrame(mfxBitstream *pBS)
 {
     mfxStatus sts = MFX_ERR_NONE;
@@ -2308,6 +2162,11 @@ mfxStatus CH264FrameReader::PrepareNextFrame(mfxBitstream *in, mfxBitstream **ou
     return sts;
 }
 
+AbstractSplitter * CHEVCFrameReader::CreateSplitter()
+{
+    return new ProtectedLibrary::HEVC_Spl();
+}
+
 
 // 1 ms provides better result in range [0..5] ms
 #define DEVICE_WAIT_TIME 1
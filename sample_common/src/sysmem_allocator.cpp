@@ -19,14 +19,21 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 
 #include "sysmem_allocator.h"
 
+#include <unistd.h>
+#include <sys/mman.h>
+
 #define MSDK_ALIGN32(X) (((mfxU32)((X)+31)) & (~ (mfxU32)31))
 #define ID_BUFFER MFX_MAKEFOURCC('B','U','F','F')
 #define ID_FRAME  MFX_MAKEFOURCC('F','R','M','E')
 
 #pragma warning(disable : 4100)
 
+#define ARENA_REGION_ALIGNMENT (2 * 1024 * 1024)
+#define ARENA_SLOT_ALIGNMENT 4096
+#define ARENA_ALIGN(X, A) ((((X) + (A) - 1) / (A)) * (A))
+
 SysMemFrameAllocator::SysMemFrameAllocator()
-: m_pBufferAllocator(0), m_bOwnBufferAllocator(false)
+: m_pBufferAllocator(0), m_bOwnBufferAllocator(false), m_pArena(0)
 {
 }
 
@@ -47,6 +54,7 @@ mfxStatus SysMemFrameAllocator::Init(mfxAllocatorParams *pParams)
 
         m_pBufferAllocator = pSysMemParams->pBufferAllocator;
         m_bOwnBufferAllocator = false;
+        m_pArena = pSysMemParams->pArena;
     }
 
     // if buffer allocator wasn't passed from application create own
@@ -277,6 +285,10 @@ mfxStatus SysMemFrameAllocator::AllocImpl(mfxFrameAllocRequest *request, mfxFram
         return MFX_ERR_UNSUPPORTED;
     }
 
+    // arena slots mimic the layout of SysMemBufferAllocator buffers, so they need our own buffer allocator
+    if (m_pArena && m_bOwnBufferAllocator)
+        return AllocFromArena(request, nbytes, response);
+
     safe_array<mfxMemId> mids(new mfxMemId[request->NumFrameSuggested]);
     if (!mids.get())
         return MFX_ERR_MEMORY_ALLOC;
@@ -323,7 +335,14 @@ mfxStatus SysMemFrameAllocator::ReleaseResponse(mfxFrameAllocResponse *response)
 
     mfxStatus sts = MFX_ERR_NONE;
 
-    if (response->mids)
+    std::map<mfxMemId*, mfxHDL>::iterator region = m_arenaRegions.find(response->mids);
+    if (response->mids && region != m_arenaRegions.end())
+    {
+        // surfaces stay mapped for the next allocation
+        m_pArena->Release(region->second);
+        m_arenaRegions.erase(region);
+    }
+    else if (response->mids)
     {
         for (mfxU32 i = 0; i < response->NumFrameActual; i++)
         {
@@ -342,6 +361,199 @@ mfxStatus SysMemFrameAllocator::ReleaseResponse(mfxFrameAllocResponse *response)
     return sts;
 }
 
+mfxStatus SysMemFrameAllocator::AllocFromArena(mfxFrameAllocRequest *request, mfxU32 nbytes, mfxFrameAllocResponse *response)
+{
+    // same layout as a buffer from SysMemBufferAllocator::AllocBuffer: header, alignment, sFrame, planes
+    mfxU32 payload = nbytes + MSDK_ALIGN32(sizeof(sFrame));
+    mfxU32 slotSize = ARENA_ALIGN(MSDK_ALIGN32(sizeof(sBuffer)) + payload + 32, ARENA_SLOT_ALIGNMENT);
+
+    safe_array<mfxMemId> mids(new mfxMemId[request->NumFrameSuggested]);
+    if (!mids.get())
+        return MFX_ERR_MEMORY_ALLOC;
+
+    mfxHDL region = 0;
+    mfxU8 *pBase = 0;
+    mfxStatus sts = m_pArena->Acquire(slotSize, request->NumFrameSuggested, &region, &pBase);
+    if (MFX_ERR_NONE != sts)
+        return sts;
+
+    for (mfxU32 i = 0; i < request->NumFrameSuggested; i++)
+    {
+        sBuffer *bs = (sBuffer *)(pBase + (size_t)i * slotSize);
+        bs->id = ID_BUFFER;
+        bs->type = request->Type;
+        bs->nbytes = payload;
+        mids.get()[i] = (mfxMemId)bs;
+
+        sFrame *fs;
+        sts = m_pBufferAllocator->Lock(m_pBufferAllocator->pthis, mids.get()[i], (mfxU8 **)&fs);
+        if (MFX_ERR_NONE != sts)
+        {
+            m_pArena->Release(region);
+            return sts;
+        }
+
+        fs->id = ID_FRAME;
+        fs->info = request->Info;
+        m_pBufferAllocator->Unlock(m_pBufferAllocator->pthis, mids.get()[i]);
+    }
+
+    response->NumFrameActual = request->NumFrameSuggested;
+    response->mids = mids.release();
+    m_arenaRegions[response->mids] = region;
+
+    return MFX_ERR_NONE;
+}
+
+SysMemSurfaceArena::SysMemSurfaceArena(mfxU64 maxCachedBytes)
+    : m_maxCachedBytes(maxCachedBytes)
+{
+}
+
+SysMemSurfaceArena::~SysMemSurfaceArena()
+{
+    for (std::list<sRegion>::iterator it = m_regions.begin(); it != m_regions.end(); ++it)
+    {
+        munmap(it->pBase, it->size);
+    }
+}
+
+mfxU8* SysMemSurfaceArena::MapRegion(size_t size, size_t *pMappedSize)
+{
+    size_t hugeSize = ARENA_ALIGN(size, (size_t)ARENA_REGION_ALIGNMENT);
+    void *ptr;
+
+#if defined(MAP_HUGETLB)
+    // succeeds only if the administrator reserved hugetlbfs pages
+    ptr = mmap(NULL, hugeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+    if (ptr != MAP_FAILED)
+    {
+        *pMappedSize = hugeSize;
+        return (mfxU8 *)ptr;
+    }
+#endif
+
+    // over-map to cut out a 2 MB aligned range which transparent hugepages can back
+    size_t rawSize = hugeSize + ARENA_REGION_ALIGNMENT;
+    ptr = mmap(NULL, rawSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED)
+        return NULL;
+
+    mfxU8 *pRaw = (mfxU8 *)ptr;
+    mfxU8 *pBase = (mfxU8 *)ARENA_ALIGN((size_t)pRaw, (size_t)ARENA_REGION_ALIGNMENT);
+    if (pBase > pRaw)
+        munmap(pRaw, pBase - pRaw);
+    if (pRaw + rawSize > pBase + hugeSize)
+        munmap(pBase + hugeSize, pRaw + rawSize - (pBase + hugeSize));
+
+#if defined(MADV_HUGEPAGE)
+    madvise(pBase, hugeSize, MADV_HUGEPAGE);
+#endif
+    // take the page faults now rather than on the first decoded frames
+    long pageSize = sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < hugeSize; offset += pageSize)
+        pBase[offset] = 0;
+
+    *pMappedSize = hugeSize;
+    return pBase;
+}
+
+mfxStatus SysMemSurfaceArena::Acquire(mfxU32 slotSize, mfxU32 count, mfxHDL *pRegion, mfxU8 **ppBase)
+{
+    if (!pRegion || !ppBase)
+        return MFX_ERR_NULL_PTR;
+
+    AutomaticMutex lock(m_mutex);
+
+    // prefer the smallest cached region which fits
+    std::list<sRegion>::iterator best = m_regions.end();
+    for (std::list<sRegion>::iterator it = m_regions.begin(); it != m_regions.end(); ++it)
+    {
+        if (!it->bInUse && it->slotSize == slotSize && it->count >= count &&
+            (best == m_regions.end() || it->count < best->count))
+        {
+            best = it;
+        }
+    }
+
+    if (best == m_regions.end())
+    {
+        sRegion region;
+        region.pBase = MapRegion((size_t)slotSize * count, &region.size);
+        if (!region.pBase)
+        {
+            // give the cache back to the system and retry once
+            TrimCache(0);
+            region.pBase = MapRegion((size_t)slotSize * count, &region.size);
+            if (!region.pBase)
+                return MFX_ERR_MEMORY_ALLOC;
+        }
+        region.slotSize = slotSize;
+        region.count = (mfxU32)(region.size / slotSize);
+        region.bInUse = false;
+        best = m_regions.insert(m_regions.begin(), region);
+    }
+
+    best->bInUse = true;
+    *pRegion = (mfxHDL)best->pBase;
+    *ppBase = best->pBase;
+
+    return MFX_ERR_NONE;
+}
+
+void SysMemSurfaceArena::Release(mfxHDL region)
+{
+    AutomaticMutex lock(m_mutex);
+
+    for (std::list<sRegion>::iterator it = m_regions.begin(); it != m_regions.end(); ++it)
+    {
+        if (it->pBase == (mfxU8 *)region)
+        {
+            it->bInUse = false;
+            m_regions.splice(m_regions.begin(), m_regions, it);
+            break;
+        }
+    }
+
+    TrimCache(m_maxCachedBytes);
+}
+
+void SysMemSurfaceArena::Trim()
+{
+    AutomaticMutex lock(m_mutex);
+    TrimCache(0);
+}
+
+void SysMemSurfaceArena::TrimCache(mfxU64 maxCachedBytes)
+{
+    mfxU64 cached = 0;
+    std::list<sRegion>::iterator it = m_regions.begin();
+    while (it != m_regions.end())
+    {
+        if (!it->bInUse)
+        {
+            if (cached + it->size > maxCachedBytes)
+            {
+                munmap(it->pBase, it->size);
+                it = m_regions.erase(it);
+                continue;
+            }
+            cached += it->size;
+        }
+        ++it;
+    }
+}
+
+mfxU64 SysMemSurfaceArena::GetMappedBytes()
+{
+    AutomaticMutex lock(m_mutex);
+
+    mfxU64 total = 0;
+    for (std::list<sRegion>::iterator it = m_regions.begin(); it != m_regions.end(); ++it)
+        total += it->size;
+    return total;
+}
+
 SysMemBufferAllocator::SysMemBufferAllocator()
 {
 
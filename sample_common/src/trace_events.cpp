@@ -0,0 +1,419 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "mfx_samples_config.h"
+
+#include "trace_events.h"
+#include "vm/thread_defs.h"
+#include "vm/time_defs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <pthread.h>
+#include <set>
+#include <signal.h>
+#include <stdio.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    struct msdkTraceEvent
+    {
+        const char* name;
+        msdk_tick start;
+        msdk_tick end;
+    };
+
+    // Appended to by its thread only. Event n goes to events[n % size], the size is a power of two.
+    // Like a seqlock, started is advanced before an event is written and written after it.
+    struct msdkTraceBuffer
+    {
+        pid_t tid;
+        std::string name;                   // thread name when the buffer was created
+        std::vector<msdkTraceEvent> events;
+        std::atomic<mfxU64> started;
+        std::atomic<mfxU64> written;
+    };
+
+    struct msdkTraceRegistry
+    {
+        MSDKMutex mutex;
+        std::vector<msdkTraceBuffer*> buffers;  // of the live threads and of the exited ones not dumped yet
+        std::deque<msdkTraceBuffer*> exited;    // exited threads in buffers, the oldest first
+        std::vector<msdkTraceBuffer*> spare;    // of exited threads, for the next threads
+        mfxU32 dumps;               // dumps reading the buffers without the lock, no buffer is reused meanwhile
+        pthread_key_t key;          // its destructor retires the buffer of an exiting thread
+        std::set<std::string> names;
+        std::string prefix;
+        mfxU32 capacity;
+        pid_t pid;                  // process the dump thread runs in
+        MSDKThread* dumper;
+        std::atomic<bool> stop;
+        bool forkHandled;
+
+        msdkTraceRegistry() :
+            dumps(0),
+            capacity(0),
+            pid(0),
+            dumper(NULL),
+            stop(false),
+            forkHandled(false)
+        {
+        }
+    };
+
+    msdkTraceRegistry& msdk_trace_registry()
+    {
+        static msdkTraceRegistry registry;
+        return registry;
+    }
+
+    std::atomic<bool> msdk_trace_on(false);
+    // set from signal handlers
+    volatile sig_atomic_t msdk_trace_dump_requested = 0;
+    volatile sig_atomic_t msdk_trace_exit_code = -1;
+
+    // buffer of the calling thread, copied to the child on fork
+    __thread msdkTraceBuffer* msdk_trace_buffer = NULL;
+
+    msdkTraceBuffer* msdk_trace_create_buffer()
+    {
+        msdkTraceRegistry& registry = msdk_trace_registry();
+        AutomaticMutex lock(registry.mutex);
+
+        msdkTraceBuffer* buffer = NULL;
+        if (!registry.spare.empty() && !registry.dumps) {
+            buffer = registry.spare.back();
+            registry.spare.pop_back();
+        }
+        else {
+            buffer = new msdkTraceBuffer;
+        }
+        buffer->tid = syscall(SYS_gettid);
+        char name[16] = {0};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        buffer->name = name;
+        buffer->events.resize(registry.capacity);
+        buffer->started = 0;
+        buffer->written = 0;
+        registry.buffers.push_back(buffer);
+        pthread_setspecific(registry.key, buffer);
+        return buffer;
+    }
+
+    // The buffer of an exited thread is no longer dumped and goes to the next thread, called with the lock held
+    void msdk_trace_retire(msdkTraceRegistry& registry, msdkTraceBuffer* buffer)
+    {
+        std::deque<msdkTraceBuffer*>::iterator it = std::find(registry.exited.begin(), registry.exited.end(), buffer);
+        if (it == registry.exited.end()) return;
+
+        registry.exited.erase(it);
+        registry.buffers.erase(std::find(registry.buffers.begin(), registry.buffers.end(), buffer));
+        registry.spare.push_back(buffer);
+    }
+
+    // Drops the spans of the oldest exited threads beyond MSDK_TRACE_EXITED_BUFFERS, unless a dump is reading them
+    void msdk_trace_limit_exited(msdkTraceRegistry& registry)
+    {
+        while (registry.exited.size() > MSDK_TRACE_EXITED_BUFFERS && !registry.dumps) {
+            msdk_trace_retire(registry, registry.exited.front());
+        }
+    }
+
+    // Destructor of the key, run by a thread that recorded spans when it exits. Its spans stay for the next
+    // dump, the render thread of every ad would otherwise leave a buffer behind.
+    void msdk_trace_thread_exit(void* value)
+    {
+        msdk_trace_buffer = NULL;
+        msdkTraceRegistry& registry = msdk_trace_registry();
+        AutomaticMutex lock(registry.mutex);
+        registry.exited.push_back(static_cast<msdkTraceBuffer*>(value));
+        msdk_trace_limit_exited(registry);
+    }
+
+    // The fork happens with the registry locked, so the child gets it in a consistent state. Only the forking
+    // thread exists in the child, its events recorded before the fork are dropped there and the buffers of
+    // the other threads are reused. No dump is running in the child.
+    void msdk_trace_prepare_fork()
+    {
+        msdk_trace_registry().mutex.Lock();
+    }
+
+    void msdk_trace_parent_fork()
+    {
+        msdk_trace_registry().mutex.Unlock();
+    }
+
+    void msdk_trace_child_fork()
+    {
+        msdkTraceRegistry& registry = msdk_trace_registry();
+        std::vector<msdkTraceBuffer*> buffers;
+        buffers.swap(registry.buffers);
+        registry.exited.clear();
+        registry.dumps = 0;
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            if (buffers[i] == msdk_trace_buffer) {
+                buffers[i]->tid = syscall(SYS_gettid);
+                buffers[i]->started = 0;
+                buffers[i]->written = 0;
+                registry.buffers.push_back(buffers[i]);
+            }
+            else {
+                registry.spare.push_back(buffers[i]);
+            }
+        }
+        // the dump thread of the parent does not exist in the child
+        registry.dumper = NULL;
+        registry.mutex.Unlock();
+    }
+
+    // live threads are named after their current role, a thread that exited keeps the name it had
+    std::string msdk_trace_thread_name(const msdkTraceBuffer& buffer)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/task/%d/comm", (int)buffer.tid);
+        FILE* file = fopen(path, "r");
+        if (!file) return buffer.name;
+
+        char name[64] = {0};
+        if (!fgets(name, sizeof(name), file)) name[0] = 0;
+        fclose(file);
+        std::string str(name);
+        if (!str.empty() && str[str.size() - 1] == '\n') str.erase(str.size() - 1);
+        return str.empty() ? buffer.name : str;
+    }
+
+    void msdk_trace_write_string(FILE* file, const char* str)
+    {
+        fputc('"', file);
+        for (; *str; ++str) {
+            if (*str == '"' || *str == '\\') {
+                fputc('\\', file);
+                fputc(*str, file);
+            }
+            else if ((unsigned char)*str < 0x20) {
+                fprintf(file, "\\u%04x", (unsigned char)*str);
+            }
+            else {
+                fputc(*str, file);
+            }
+        }
+        fputc('"', file);
+    }
+
+    // The rings are copied while their threads keep appending. An event is kept only if its slot was not
+    // reused before the copy was finished, i.e. no event started since then went to its slot.
+    mfxStatus msdk_trace_write_dump(const std::string& path, const std::vector<msdkTraceBuffer*>& buffers)
+    {
+        // written next to the previous dump and renamed over it, so a reader never sees a partial file
+        std::string partial = path + ".tmp";
+        FILE* file = fopen(partial.c_str(), "w");
+        if (!file) return MFX_ERR_ABORTED;
+
+        const double usPerTick = 1e6 / msdk_time_get_frequency();
+        const int pid = getpid();
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        const char* separator = "\n";
+        std::vector<msdkTraceEvent> events;
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            const msdkTraceBuffer& buffer = *buffers[i];
+            const mfxU64 size = buffer.events.size();
+
+            mfxU64 end = buffer.written.load(std::memory_order_acquire);
+            mfxU64 begin = end > size ? end - size : 0;
+            events.clear();
+            for (mfxU64 n = begin; n < end; ++n) {
+                events.push_back(buffer.events[n % size]);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            mfxU64 started = buffer.started.load(std::memory_order_relaxed);
+            mfxU64 valid = started > size ? started - size : 0;
+            size_t skip = valid > begin ? (size_t)std::min<mfxU64>(valid - begin, events.size()) : 0;
+            if (skip == events.size()) continue;
+
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                separator, pid, (int)buffer.tid);
+            msdk_trace_write_string(file, msdk_trace_thread_name(buffer).c_str());
+            fprintf(file, "}}");
+            separator = ",\n";
+            for (size_t n = skip; n < events.size(); ++n) {
+                fprintf(file, ",\n{\"name\":");
+                msdk_trace_write_string(file, events[n].name);
+                fprintf(file, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    pid, (int)buffer.tid, events[n].start * usPerTick, (events[n].end - events[n].start) * usPerTick);
+            }
+        }
+        fprintf(file, "\n]}\n");
+
+        bool failed = ferror(file) != 0;
+        failed = (fclose(file) != 0) || failed;
+        if (failed || rename(partial.c_str(), path.c_str()) != 0) {
+            unlink(partial.c_str());
+            return MFX_ERR_ABORTED;
+        }
+        return MFX_ERR_NONE;
+    }
+
+    unsigned int MFX_STDCALL msdk_trace_dump_thread(void*)
+    {
+        msdkTraceRegistry& registry = msdk_trace_registry();
+        while (!registry.stop) {
+            if (msdk_trace_dump_requested) {
+                msdk_trace_dump_requested = 0;
+                msdk_trace_dump();
+                if (msdk_trace_exit_code >= 0) _exit(msdk_trace_exit_code);
+            }
+            usleep(100 * 1000);
+        }
+        return 0;
+    }
+}
+
+mfxStatus msdk_trace_start(const char* prefix, mfxU32 eventsPerThread)
+{
+    if (!prefix) return MFX_ERR_NULL_PTR;
+
+    msdkTraceRegistry& registry = msdk_trace_registry();
+    {
+        AutomaticMutex lock(registry.mutex);
+        if (registry.dumper && registry.pid == getpid()) return MFX_ERR_NONE;
+
+        // the buffers created later get the new size
+        mfxU32 capacity = 1024;
+        while (capacity < eventsPerThread && capacity < (1u << 30)) capacity <<= 1;
+        registry.prefix = prefix;
+        registry.capacity = capacity;
+        registry.pid = getpid();
+        registry.stop = false;
+        if (!registry.forkHandled) {
+            pthread_atfork(msdk_trace_prepare_fork, msdk_trace_parent_fork, msdk_trace_child_fork);
+            pthread_key_create(&registry.key, msdk_trace_thread_exit);
+            registry.forkHandled = true;
+        }
+    }
+    msdk_trace_on = true;
+
+    mfxStatus sts = MFX_ERR_NONE;
+    MSDKThread* dumper = new MSDKThread(sts, msdk_trace_dump_thread, NULL, "trace");
+    if (sts != MFX_ERR_NONE) {
+        delete dumper;
+        return sts;
+    }
+    AutomaticMutex lock(registry.mutex);
+    registry.dumper = dumper;
+    return MFX_ERR_NONE;
+}
+
+void msdk_trace_stop()
+{
+    msdkTraceRegistry& registry = msdk_trace_registry();
+    MSDKThread* dumper = NULL;
+    {
+        AutomaticMutex lock(registry.mutex);
+        dumper = registry.dumper;
+        registry.dumper = NULL;
+    }
+    if (!dumper) return;
+
+    registry.stop = true;
+    dumper->Wait();
+    delete dumper;
+    msdk_trace_on = false;
+    msdk_trace_dump();
+}
+
+bool msdk_trace_enabled()
+{
+    return msdk_trace_on;
+}
+
+mfxStatus msdk_trace_dump()
+{
+    msdkTraceRegistry& registry = msdk_trace_registry();
+    std::vector<msdkTraceBuffer*> buffers;
+    std::vector<msdkTraceBuffer*> exited;
+    std::string path;
+    {
+        AutomaticMutex lock(registry.mutex);
+        if (registry.prefix.empty()) return MFX_ERR_NOT_INITIALIZED;
+        buffers = registry.buffers;
+        exited.assign(registry.exited.begin(), registry.exited.end());
+        path = registry.prefix + "." + std::to_string(getpid()) + ".json";
+        registry.dumps++;
+    }
+
+    mfxStatus sts = msdk_trace_write_dump(path, buffers);
+
+    // the threads that had exited before the copy recorded nothing since, their buffers can be reused
+    AutomaticMutex lock(registry.mutex);
+    registry.dumps--;
+    for (size_t i = 0; sts == MFX_ERR_NONE && i < exited.size(); ++i) {
+        msdk_trace_retire(registry, exited[i]);
+    }
+    msdk_trace_limit_exited(registry);
+    return sts;
+}
+
+void msdk_trace_request_dump(mfxI32 exitCode)
+{
+    // nothing to write, an exit is not delayed
+    if (!msdk_trace_on) {
+        if (exitCode >= 0) _exit(exitCode);
+        return;
+    }
+    msdk_trace_exit_code = exitCode;
+    msdk_trace_dump_requested = 1;
+}
+
+const char* msdk_trace_name(const char* name)
+{
+    if (!name) return NULL;
+
+    msdkTraceRegistry& registry = msdk_trace_registry();
+    AutomaticMutex lock(registry.mutex);
+    return registry.names.insert(name).first->c_str();
+}
+
+mfxI64 msdk_trace_begin()
+{
+    return msdk_trace_on.load(std::memory_order_relaxed) ? msdk_time_get_tick() : 0;
+}
+
+void msdk_trace_end(const char* name, mfxI64 start)
+{
+    if (!start) return;
+
+    msdk_tick end = msdk_time_get_tick();
+    msdkTraceBuffer* buffer = msdk_trace_buffer;
+    if (!buffer) {
+        buffer = msdk_trace_buffer = msdk_trace_create_buffer();
+    }
+    mfxU64 n = buffer->written.load(std::memory_order_relaxed);
+    buffer->started.store(n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    msdkTraceEvent& event = buffer->events[n & (buffer->events.size() - 1)];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    buffer->written.store(n + 1, std::memory_order_release);
+}
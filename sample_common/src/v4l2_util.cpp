@@ -34,9 +34,6 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 /* Global Declaration */
 Buffer *buffers, *CurBuffers;
 bool CtrlFlag = false;
-int m_q[5], m_first = 0, m_last = 0, m_numInQ = 0;
-pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t empty = PTHREAD_MUTEX_INITIALIZER;
 
 v4l2Device::v4l2Device( const char *devname,
             uint32_t width,
@@ -51,8 +48,12 @@ v4l2Device::v4l2Device( const char *devname,
             m_MipiPort(0),
             m_MipiMode(MipiMode),
             m_v4l2Format(v4l2Format),
-            m_fd(-1)
+            m_fd(-1),
+            m_pQueued(NULL)
 {
+    mfxStatus sts = MFX_ERR_NONE;
+    m_pQueued = new MSDKSemaphore(sts, 0);
+    BYE_ON(sts != MFX_ERR_NONE, "semaphore creation failed\n");
 }
 
 v4l2Device::~v4l2Device()
@@ -61,6 +62,7 @@ v4l2Device::~v4l2Device()
     {
         BYE_ON(close(m_fd) < 0, "V4L2 device close failed: %s\n", ERRSTR);
     }
+    MSDK_SAFE_DELETE(m_pQueued);
 }
 
 int v4l2Device::blockIOCTL(int handle, int request, void *args)
@@ -234,6 +236,8 @@ void v4l2Device::V4L2Init()
 void v4l2Device::V4L2Alloc()
 {
     buffers = (Buffer *)malloc(sizeof(Buffer) * (int) m_num_buffers);
+    // every buffer can be waiting in the queue at once
+    m_queue.Init(m_num_buffers);
 }
 
 void v4l2Device::V4L2QueueBuffer(Buffer *buffer)
@@ -286,36 +290,27 @@ void v4l2Device::V4L2StopCapture()
     BYE_ON(ret < 0, "STREAMOFF failed: %s\n", ERRSTR);
 }
 
+/* Called by PollingThread only */
 void v4l2Device::PutOnQ(int x)
 {
-    pthread_mutex_lock(&mutex);
-    m_q[m_first] = x;
-    m_first = (m_first+1) % 5;
-    m_numInQ++;
-    pthread_mutex_unlock(&mutex);
-    pthread_mutex_unlock(&empty);
+    BYE_ON(!m_queue.Push(x), "V4L2 buffer queue overflow\n");
+    m_pQueued->Post();
 }
 
+/* Called by the single consumer thread only, waits if the queue is empty */
 int v4l2Device::GetOffQ()
 {
-    int thing;
+    int thing = -1;
 
-    /* wait if the queue is empty. */
-    while (m_numInQ == 0)
-    pthread_mutex_lock(&empty);
-
-    pthread_mutex_lock(&mutex);
-    thing = m_q[m_last];
-    m_last = (m_last+1) % 5;
-    m_numInQ--;
-    pthread_mutex_unlock(&mutex);
+    m_pQueued->Wait();
+    m_queue.Pop(thing);
 
     return thing;
 }
 
 int v4l2Device::GetV4L2TerminationSignal()
 {
-    return (CtrlFlag && m_numInQ == 0)? 1 : 0;
+    return (CtrlFlag && m_queue.GetSize() == 0)? 1 : 0;
 }
 
 static void CtrlCTerminationHandler(int s) { CtrlFlag = true; }
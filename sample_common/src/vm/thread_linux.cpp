@@ -23,8 +23,15 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include <sched.h>
 #include <unistd.h>
 #include <sys/syscall.h>
+#include <linux/futex.h>
+#include <limits.h>
+#include <time.h>
+#include <map>
+#include <string>
 
 #include "vm/thread_defs.h"
+#include "vm/time_defs.h"
+#include "sample_defs.h"
 #include "sample_utils.h"
 
 MSDKMutex::MSDKMutex(void)
@@ -55,49 +62,74 @@ int MSDKMutex::Try(void)
 
 /* ****************************************************************************** */
 
+namespace
+{
+    static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex word must be a plain int");
+
+    int msdk_futex_wait(std::atomic<int>& word, int value, const struct timespec* timeout)
+    {
+        return syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE, value, timeout, NULL, 0);
+    }
+
+    int msdk_futex_wake(std::atomic<int>& word, int count)
+    {
+        return syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+    }
+
+    // Sleeps while the word holds the value, returns 0 once woken up or if the word has changed, an errno code otherwise.
+    // The waiter is registered before the kernel checks the word, so a wake up can not be missed.
+    int msdk_futex_sleep(std::atomic<int>& word, std::atomic<int>& waiters, int value, const struct timespec* timeout)
+    {
+        ++waiters;
+        int res = msdk_futex_wait(word, value, timeout) ? errno : 0;
+        --waiters;
+        return (EAGAIN == res || EINTR == res) ? 0 : res;
+    }
+
+    // Time left to the deadline on the monotonic clock, false once the deadline has passed
+    bool msdk_futex_timeout(const struct timespec& deadline, struct timespec& timeout)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        timeout.tv_sec = deadline.tv_sec - now.tv_sec;
+        timeout.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+        if (timeout.tv_nsec < 0) {
+            timeout.tv_nsec += 1000000000;
+            --timeout.tv_sec;
+        }
+        return (timeout.tv_sec > 0) || (!timeout.tv_sec && timeout.tv_nsec > 0);
+    }
+}
+
+/* ****************************************************************************** */
+
 MSDKSemaphore::MSDKSemaphore(mfxStatus &sts, mfxU32 count):
     msdkSemaphoreHandle(count)
 {
     sts = MFX_ERR_NONE;
-    int res = pthread_cond_init(&m_semaphore, NULL);
-    if (!res) {
-        res = pthread_mutex_init(&m_mutex, NULL);
-        if (res) {
-            pthread_cond_destroy(&m_semaphore);
-        }
-    }
-    if (res) throw std::bad_alloc();
 }
 
 MSDKSemaphore::~MSDKSemaphore(void)
 {
-    pthread_mutex_destroy(&m_mutex);
-    pthread_cond_destroy(&m_semaphore);
 }
 
 mfxStatus MSDKSemaphore::Post(void)
 {
-    int res = pthread_mutex_lock(&m_mutex);
-    if (!res) {
-        if (0 == m_count++) res = pthread_cond_signal(&m_semaphore);
-    }
-    int sts = pthread_mutex_unlock(&m_mutex);
-    if (!res) res = sts;
-    return (res)? MFX_ERR_UNKNOWN: MFX_ERR_NONE;
+    ++m_count;
+    if (m_waiters.load() && msdk_futex_wake(m_count, 1) < 0) return MFX_ERR_UNKNOWN;
+    return MFX_ERR_NONE;
 }
 
 mfxStatus MSDKSemaphore::Wait(void)
 {
-    int res = pthread_mutex_lock(&m_mutex);
-    if (!res) {
-        while(!m_count) {
-            res = pthread_cond_wait(&m_semaphore, &m_mutex);
+    for (;;) {
+        int count = m_count.load();
+        while (count > 0) {
+            if (m_count.compare_exchange_weak(count, count - 1)) return MFX_ERR_NONE;
         }
-        if (!res) --m_count;
-        int sts = pthread_mutex_unlock(&m_mutex);
-        if (!res) res = sts;
+        if (msdk_futex_sleep(m_count, m_waiters, 0, NULL)) return MFX_ERR_UNKNOWN;
     }
-    return (res)? MFX_ERR_UNKNOWN: MFX_ERR_NONE;
 }
 
 /* ****************************************************************************** */
@@ -106,97 +138,56 @@ MSDKEvent::MSDKEvent(mfxStatus &sts, bool manual, bool state):
     msdkEventHandle(manual, state)
 {
     sts = MFX_ERR_NONE;
-
-    int res = pthread_cond_init(&m_event, NULL);
-    if (!res) {
-        res = pthread_mutex_init(&m_mutex, NULL);
-        if (res) {
-            pthread_cond_destroy(&m_event);
-        }
-    }
-    if (res) throw std::bad_alloc();
 }
 
 MSDKEvent::~MSDKEvent(void)
 {
-    pthread_mutex_destroy(&m_mutex);
-    pthread_cond_destroy(&m_event);
 }
 
 mfxStatus MSDKEvent::Signal(void)
 {
-    int res = pthread_mutex_lock(&m_mutex);
-    if (!res) {
-        if (!m_state) {
-            m_state = true;
-            if (m_manual) res = pthread_cond_broadcast(&m_event);
-            else res = pthread_cond_signal(&m_event);
-        }
-        int sts = pthread_mutex_unlock(&m_mutex);
-        if (!res) res = sts;
-    }
-    return (res)? MFX_ERR_UNKNOWN: MFX_ERR_NONE;
+    if (m_state.exchange(1)) return MFX_ERR_NONE;
+
+    // a manual event releases every waiter, an automatic one hands the state over to one of them
+    if (m_waiters.load() && msdk_futex_wake(m_state, m_manual ? INT_MAX : 1) < 0) return MFX_ERR_UNKNOWN;
+    return MFX_ERR_NONE;
 }
 
 mfxStatus MSDKEvent::Reset(void)
 {
-    int res = pthread_mutex_lock(&m_mutex);
-    if (!res)
-    {
-        if (m_state) m_state = false;
-        res = pthread_mutex_unlock(&m_mutex);
-    }
-    return (res)? MFX_ERR_UNKNOWN: MFX_ERR_NONE;
+    m_state.store(0);
+    return MFX_ERR_NONE;
 }
 
 mfxStatus MSDKEvent::Wait(void)
 {
-    int res = pthread_mutex_lock(&m_mutex);
-    if (!res)
-    {
-        while(!m_state) res = pthread_cond_wait(&m_event, &m_mutex);
-        if (!m_manual) m_state = false;
-        int sts = pthread_mutex_unlock(&m_mutex);
-        if (!res) res = sts;
+    for (;;) {
+        if (m_manual ? (m_state.load() != 0) : (m_state.exchange(0) != 0)) return MFX_ERR_NONE;
+        if (msdk_futex_sleep(m_state, m_waiters, 0, NULL)) return MFX_ERR_UNKNOWN;
     }
-    return (res)? MFX_ERR_UNKNOWN: MFX_ERR_NONE;
 }
 
 mfxStatus MSDKEvent::TimedWait(mfxU32 msec)
 {
     if (MFX_INFINITE == msec) return MFX_ERR_UNSUPPORTED;
-    mfxStatus mfx_res = MFX_ERR_NOT_INITIALIZED;
 
-    int res = pthread_mutex_lock(&m_mutex);
-    if (!res)
-    {
-        if (!m_state)
-        {
-            struct timeval tval;
-            struct timespec tspec;
-            mfxI32 res;
-
-            gettimeofday(&tval, NULL);
-            msec = 1000 * msec + tval.tv_usec;
-            tspec.tv_sec = tval.tv_sec + msec / 1000000;
-            tspec.tv_nsec = (msec % 1000000) * 1000;
-            res = pthread_cond_timedwait(&m_event,
-                                         &m_mutex,
-                                         &tspec);
-            if (!res) mfx_res = MFX_ERR_NONE;
-            else if (ETIMEDOUT == res) mfx_res = MFX_TASK_WORKING;
-            else mfx_res = MFX_ERR_UNKNOWN;
-        }
-        else mfx_res = MFX_ERR_NONE;
-        if (!m_manual)
-            m_state = false;
-
-        res = pthread_mutex_unlock(&m_mutex);
-        if (res) mfx_res = MFX_ERR_UNKNOWN;
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += msec / 1000;
+    deadline.tv_nsec += (msec % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_nsec -= 1000000000;
+        ++deadline.tv_sec;
     }
-    else mfx_res = MFX_ERR_UNKNOWN;
 
-    return mfx_res;
+    for (;;) {
+        if (m_manual ? (m_state.load() != 0) : (m_state.exchange(0) != 0)) return MFX_ERR_NONE;
+
+        struct timespec timeout;
+        if (!msdk_futex_timeout(deadline, timeout)) return MFX_TASK_WORKING;
+        int res = msdk_futex_sleep(m_state, m_waiters, 0, &timeout);
+        if (res && (ETIMEDOUT != res)) return MFX_ERR_UNKNOWN;
+    }
 }
 
 /* ****************************************************************************** */
@@ -206,7 +197,9 @@ void* msdk_thread_start(void* arg)
     if (arg) {
         MSDKThread* thread = (MSDKThread*)arg;
 
+        if (thread->m_role) msdk_thread_enter(thread->m_role);
         if (thread->m_func) thread->m_func(thread->m_arg);
+        if (thread->m_role) msdk_thread_leave();
         thread->m_event->Signal();
     }
     return NULL;
@@ -214,8 +207,8 @@ void* msdk_thread_start(void* arg)
 
 /* ****************************************************************************** */
 
-MSDKThread::MSDKThread(mfxStatus &sts, msdk_thread_callback func, void* arg):
-    msdkThreadHandle(func, arg)
+MSDKThread::MSDKThread(mfxStatus &sts, msdk_thread_callback func, void* arg, const char* role):
+    msdkThreadHandle(func, arg, role)
 {
     m_event = new MSDKEvent(sts, false, false);
     if (pthread_create(&(m_thread), NULL, msdk_thread_start, this)) {
@@ -315,3 +308,298 @@ mfxU32 msdk_get_current_pid()
     return syscall(SYS_getpid);
 }
 
+
+/* ****************************************************************************** */
+
+namespace
+{
+    struct msdkThreadRecord
+    {
+        std::string role;
+        pid_t pid;
+        pid_t tid;
+        clockid_t clock;
+        bool active;
+        std::string cpus;   // CPUs the thread was allowed to run on after the placement
+        msdk_tick start;
+        msdk_tick end;
+        double cpuTime;     // seconds, valid once the thread left
+        double wallTime;    // seconds, valid once the thread left
+        long voluntary;     // context switches, valid once the thread left
+        long involuntary;
+        mfxU32 exited;      // number of exited threads summed up in the record, see msdk_thread_leave
+    };
+
+    struct msdkThreadRegistry
+    {
+        MSDKMutex mutex;
+        std::map<std::string, msdkThreadPlacement> placements;
+        std::vector<msdkThreadRecord> records;
+    };
+
+    msdkThreadRegistry& msdk_thread_registry()
+    {
+        static msdkThreadRegistry registry;
+        return registry;
+    }
+
+    // index of the calling thread in the registry records, copied to the child on fork
+    __thread int msdk_thread_record = -1;
+
+    std::string msdk_thread_format_cpus(const cpu_set_t& set)
+    {
+        std::string str;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (!CPU_ISSET(cpu, &set)) continue;
+
+            int last = cpu;
+            while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &set)) ++last;
+
+            if (!str.empty()) str += ",";
+            str += std::to_string(cpu);
+            if (last != cpu) str += "-" + std::to_string(last);
+            cpu = last;
+        }
+        return str;
+    }
+
+    std::string msdk_thread_get_cpus(pid_t tid)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(tid, sizeof(set), &set)) return "?";
+        return msdk_thread_format_cpus(set);
+    }
+
+    // reads the context switch counters of a live thread of this process
+    void msdk_thread_get_switches(pid_t tid, long& voluntary, long& involuntary)
+    {
+        voluntary = involuntary = -1;
+
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/task/%d/status", (int)tid);
+        FILE* file = fopen(path, "r");
+        if (!file) return;
+
+        char line[256];
+        while (fgets(line, sizeof(line), file)) {
+            sscanf(line, "voluntary_ctxt_switches: %ld", &voluntary);
+            sscanf(line, "nonvoluntary_ctxt_switches: %ld", &involuntary);
+        }
+        fclose(file);
+    }
+
+    mfxStatus msdk_thread_apply_placement(const msdkThreadPlacement& placement)
+    {
+        mfxStatus sts = MFX_ERR_NONE;
+
+        if (!placement.cpus.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (size_t i = 0; i < placement.cpus.size(); ++i) {
+                if (placement.cpus[i] < CPU_SETSIZE) CPU_SET(placement.cpus[i], &set);
+            }
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) sts = MFX_ERR_UNSUPPORTED;
+        }
+
+        if (placement.schedType >= 0) {
+            bool realtime = (placement.schedType == SCHED_FIFO) || (placement.schedType == SCHED_RR);
+
+            struct sched_param param;
+            MSDK_ZERO_MEMORY(param);
+            if (realtime) param.sched_priority = placement.priority;
+            if (pthread_setschedparam(pthread_self(), placement.schedType, &param)) sts = MFX_ERR_UNSUPPORTED;
+
+            // Linux keeps the nice value per thread, so it can prioritize threads without root privileges
+            if (!realtime && placement.schedType != SCHED_IDLE &&
+                setpriority(PRIO_PROCESS, syscall(SYS_gettid), placement.priority)) {
+                sts = MFX_ERR_UNSUPPORTED;
+            }
+        }
+        return sts;
+    }
+}
+
+mfxStatus msdk_thread_parse_cpu_list(const msdk_char* str, std::vector<mfxU32>& cpus)
+{
+    if (!str) return MFX_ERR_NULL_PTR;
+
+    cpus.clear();
+    const msdk_char* p = str;
+    while (*p) {
+        msdk_char* end = NULL;
+        unsigned long first = msdk_strtol(p, &end, 10);
+        if (end == p) return MFX_ERR_UNSUPPORTED;
+
+        unsigned long last = first;
+        p = end;
+        if (*p == MSDK_CHAR('-')) {
+            ++p;
+            last = msdk_strtol(p, &end, 10);
+            if (end == p || last < first) return MFX_ERR_UNSUPPORTED;
+            p = end;
+        }
+        if (last >= CPU_SETSIZE) return MFX_ERR_UNSUPPORTED;
+
+        for (unsigned long cpu = first; cpu <= last; ++cpu) cpus.push_back((mfxU32)cpu);
+
+        if (*p == MSDK_CHAR(',')) ++p;
+        else if (*p) return MFX_ERR_UNSUPPORTED;
+    }
+    return cpus.empty() ? MFX_ERR_UNSUPPORTED : MFX_ERR_NONE;
+}
+
+void msdk_thread_set_placement(const char* role, const msdkThreadPlacement& placement)
+{
+    msdkThreadRegistry& registry = msdk_thread_registry();
+    AutomaticMutex lock(registry.mutex);
+
+    registry.placements[role] = placement;
+}
+
+bool msdk_thread_get_placement(const char* role, msdkThreadPlacement& placement)
+{
+    msdkThreadRegistry& registry = msdk_thread_registry();
+    AutomaticMutex lock(registry.mutex);
+
+    std::map<std::string, msdkThreadPlacement>::const_iterator it = registry.placements.find(role);
+    if (it == registry.placements.end()) return false;
+
+    placement = it->second;
+    return true;
+}
+
+mfxStatus msdk_thread_enter(const char* role)
+{
+    if (!role) return MFX_ERR_NULL_PTR;
+
+    msdkThreadPlacement placement;
+    bool placed = msdk_thread_get_placement(role, placement);
+
+    // the name of the main thread is the name of the process shown by ps and matched by pkill,
+    // the kernel limits thread names to 15 characters
+    if (syscall(SYS_gettid) != getpid()) {
+        std::string name(role, 0, 15);
+        pthread_setname_np(pthread_self(), name.c_str());
+    }
+
+    mfxStatus sts = placed ? msdk_thread_apply_placement(placement) : MFX_ERR_NONE;
+    if (sts != MFX_ERR_NONE) {
+        msdk_printf(MSDK_STRING("WARNING: cannot apply the placement of the %s thread, see the scheduling notes\n"), role);
+    }
+
+    msdkThreadRecord record;
+    record.role = role;
+    record.pid = getpid();
+    record.tid = syscall(SYS_gettid);
+    record.active = true;
+    pthread_getcpuclockid(pthread_self(), &record.clock);
+    record.cpus = msdk_thread_get_cpus(0);
+    record.start = msdk_time_get_tick();
+    record.end = 0;
+    record.cpuTime = record.wallTime = 0;
+    record.voluntary = record.involuntary = 0;
+    record.exited = 0;
+
+    msdkThreadRegistry& registry = msdk_thread_registry();
+    AutomaticMutex lock(registry.mutex);
+
+    if (msdk_thread_record < 0 || msdk_thread_record >= (int)registry.records.size()) {
+        // slots freed by msdk_thread_leave are reused
+        msdk_thread_record = (int)registry.records.size();
+        for (size_t i = 0; i < registry.records.size(); ++i) {
+            if (registry.records[i].role.empty()) {
+                msdk_thread_record = (int)i;
+                break;
+            }
+        }
+        if (msdk_thread_record == (int)registry.records.size()) registry.records.push_back(record);
+    }
+    registry.records[msdk_thread_record] = record;
+    return sts;
+}
+
+void msdk_thread_leave()
+{
+    if (msdk_thread_record < 0) return;
+
+    struct rusage usage;
+    MSDK_ZERO_MEMORY(usage);
+    getrusage(RUSAGE_THREAD, &usage);
+
+    msdkThreadRegistry& registry = msdk_thread_registry();
+    AutomaticMutex lock(registry.mutex);
+
+    if (msdk_thread_record < (int)registry.records.size()) {
+        msdkThreadRecord& record = registry.records[msdk_thread_record];
+        record.active = false;
+        record.end = msdk_time_get_tick();
+        record.cpuTime = (double)msdk_time_get_thread_cpu_tick() / msdk_time_get_frequency();
+        record.wallTime = (double)(record.end - record.start) / msdk_time_get_frequency();
+        record.voluntary = usage.ru_nvcsw;
+        record.involuntary = usage.ru_nivcsw;
+        record.exited = 1;
+
+        // the exited threads of a role are summed up in one record and the slot is freed,
+        // so a thread started per ad or per request does not grow the registry
+        for (size_t i = 0; i < registry.records.size(); ++i) {
+            msdkThreadRecord& total = registry.records[i];
+            if ((int)i == msdk_thread_record || !total.exited || total.pid != record.pid || total.role != record.role) continue;
+
+            total.tid = record.tid;
+            total.cpus = record.cpus;
+            total.end = record.end;
+            total.cpuTime += record.cpuTime;
+            total.wallTime += record.wallTime;
+            total.voluntary += record.voluntary;
+            total.involuntary += record.involuntary;
+            total.exited += record.exited;
+            record.role.clear();
+            record.exited = 0;
+            break;
+        }
+    }
+    msdk_thread_record = -1;
+}
+
+void msdk_thread_print_cpu_report()
+{
+    msdkThreadRegistry& registry = msdk_thread_registry();
+    AutomaticMutex lock(registry.mutex);
+
+    pid_t pid = getpid();
+    msdk_tick now = msdk_time_get_tick();
+    double frequency = (double)msdk_time_get_frequency();
+
+    msdk_printf(MSDK_STRING("Thread CPU report of process %d:\n"), (int)pid);
+    msdk_printf(MSDK_STRING("  %-15s %8s %12s %7s %10s %10s  %s\n"),
+        MSDK_STRING("role"), MSDK_STRING("tid"), MSDK_STRING("cpu time, ms"), MSDK_STRING("busy, %"),
+        MSDK_STRING("vol. cs"), MSDK_STRING("invol. cs"), MSDK_STRING("cpus"));
+
+    for (size_t i = 0; i < registry.records.size(); ++i) {
+        msdkThreadRecord record = registry.records[i];
+        // records inherited from the parent process describe its threads
+        if (record.pid != pid || record.role.empty()) continue;
+
+        if (record.active) {
+            struct timespec ts;
+            if (!clock_gettime(record.clock, &ts)) record.cpuTime = ts.tv_sec + ts.tv_nsec / 1e9;
+            msdk_thread_get_switches(record.tid, record.voluntary, record.involuntary);
+            record.wallTime = (now - record.start) / frequency;
+        }
+
+        // the busy time of several exited threads is relative to the time they ran, summed up
+        std::string tid = std::to_string(record.tid), state;
+        if (record.exited > 1) {
+            tid = "-";
+            state = " (" + std::to_string(record.exited) + " exited)";
+        }
+        else if (record.exited) {
+            state = " (exited)";
+        }
+        msdk_printf(MSDK_STRING("  %-15s %8s %12.1f %7.1f %10ld %10ld  %s%s\n"),
+            record.role.c_str(), tid.c_str(), record.cpuTime * 1000.0,
+            (record.wallTime > 0) ? 100.0 * record.cpuTime / record.wallTime : 0.0,
+            record.voluntary, record.involuntary, record.cpus.c_str(), state.c_str());
+    }
+}
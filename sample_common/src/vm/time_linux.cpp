@@ -19,16 +19,45 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 
 
 #include "vm/time_defs.h"
-#include <sys/time.h>
+#include <time.h>
+#include <errno.h>
 
 #define MSDK_TIME_MHZ 1000000
 
+static msdk_tick msdk_time_get_clock_tick(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return (msdk_tick)ts.tv_sec * (msdk_tick)MSDK_TIME_MHZ + (msdk_tick)(ts.tv_nsec / 1000);
+}
+
+// monotonic clock: ticks are used for intervals and deadlines, so they must not jump with wall time
 msdk_tick msdk_time_get_tick(void)
 {
-    struct timeval tv;
+    return msdk_time_get_clock_tick(CLOCK_MONOTONIC);
+}
+
+void msdk_time_sleep_until(msdk_tick deadline)
+{
+    struct timespec ts;
 
-    gettimeofday(&tv, NULL);
-    return (msdk_tick)tv.tv_sec * (msdk_tick)MSDK_TIME_MHZ + (msdk_tick)tv.tv_usec;
+    ts.tv_sec = (time_t)(deadline / MSDK_TIME_MHZ);
+    ts.tv_nsec = (long)(deadline % MSDK_TIME_MHZ) * 1000;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+    }
+}
+
+msdk_tick msdk_time_get_process_cpu_tick(void)
+{
+    return msdk_time_get_clock_tick(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+msdk_tick msdk_time_get_thread_cpu_tick(void)
+{
+    return msdk_time_get_clock_tick(CLOCK_THREAD_CPUTIME_ID);
 }
 
 msdk_tick msdk_time_get_frequency(void)
@@ -0,0 +1,177 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// msdkAtomicList and the surface pools built on it, under several producer threads.
+// Every item has to arrive exactly once and in the order its producer added it.
+
+#include "sample_test.h"
+#include "mfx_buffering.h"
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+const mfxU32 PRODUCERS = 4;
+const mfxU32 ITEMS_PER_PRODUCER = 100000;
+
+struct TestItem
+{
+    mfxU32    producer;
+    mfxU32    index;
+    TestItem* next;
+};
+
+std::vector<TestItem> MakeItems()
+{
+    std::vector<TestItem> items(PRODUCERS * ITEMS_PER_PRODUCER);
+    for (mfxU32 i = 0; i < items.size(); i++)
+    {
+        items[i].producer = i / ITEMS_PER_PRODUCER;
+        items[i].index = i % ITEMS_PER_PRODUCER;
+        items[i].next = NULL;
+    }
+    return items;
+}
+
+} // namespace
+
+SAMPLE_TEST(atomic_list, push_take_all)
+{
+    std::vector<TestItem> items = MakeItems();
+    msdkAtomicList<TestItem> list;
+    std::vector<std::thread> producers;
+
+    for (mfxU32 p = 0; p < PRODUCERS; p++)
+    {
+        producers.push_back(std::thread([&items, &list, p]() {
+            for (mfxU32 i = 0; i < ITEMS_PER_PRODUCER; i++)
+                list.Push(&items[p * ITEMS_PER_PRODUCER + i]);
+        }));
+    }
+
+    // a batch is in LIFO order, so the items of one producer come with decreasing indices
+    std::vector<mfxU32> received(PRODUCERS, 0);
+    mfxU32 total = 0;
+    bool ordered = true;
+    while (total < items.size())
+    {
+        std::vector<TestItem*> batch;
+        for (TestItem* item = list.TakeAll(); item; item = item->next)
+            batch.push_back(item);
+        for (size_t i = batch.size(); i-- > 0;)
+        {
+            ordered = ordered && batch[i]->index == received[batch[i]->producer];
+            received[batch[i]->producer]++;
+        }
+        total += (mfxU32)batch.size();
+    }
+
+    for (size_t p = 0; p < producers.size(); p++)
+        producers[p].join();
+
+    SAMPLE_CHECK(ordered);
+    SAMPLE_CHECK(total == items.size());
+    SAMPLE_CHECK(list.TakeAll() == NULL);
+}
+
+SAMPLE_TEST(atomic_list, output_surfaces_pool)
+{
+    std::vector<msdkOutputSurface> surfaces(PRODUCERS * ITEMS_PER_PRODUCER);
+    msdkOutputSurfacesPool pool;
+    std::vector<std::thread> producers;
+
+    for (mfxU32 p = 0; p < PRODUCERS; p++)
+    {
+        producers.push_back(std::thread([&surfaces, &pool, p]() {
+            for (mfxU32 i = 0; i < ITEMS_PER_PRODUCER; i++)
+            {
+                msdkOutputSurface& surface = surfaces[p * ITEMS_PER_PRODUCER + i];
+                surface.surface = NULL;
+                surface.syncp = NULL;
+                surface.next = NULL;
+                pool.AddSurface(&surface);
+            }
+        }));
+    }
+
+    // FIFO per producer, and the count never drops below the surfaces still to be taken
+    std::vector<mfxU32> received(PRODUCERS, 0);
+    mfxU32 total = 0;
+    bool ordered = true, counted = true;
+    while (total < surfaces.size())
+    {
+        msdkOutputSurface* surface = pool.GetSurface();
+        if (!surface)
+            continue;
+        const mfxU32 index = (mfxU32)(surface - &surfaces[0]);
+        ordered = ordered && index % ITEMS_PER_PRODUCER == received[index / ITEMS_PER_PRODUCER];
+        received[index / ITEMS_PER_PRODUCER]++;
+        total++;
+        counted = counted && pool.GetSurfaceCount() <= surfaces.size() - total;
+    }
+
+    for (size_t p = 0; p < producers.size(); p++)
+        producers[p].join();
+
+    SAMPLE_CHECK(ordered);
+    SAMPLE_CHECK(counted);
+    SAMPLE_CHECK(pool.GetSurfaceCount() == 0);
+    SAMPLE_CHECK(pool.GetSurface() == NULL);
+}
+
+SAMPLE_TEST(atomic_list, free_surfaces_pool)
+{
+    std::vector<msdkFrameSurface> surfaces(PRODUCERS * ITEMS_PER_PRODUCER);
+    std::vector<mfxU32> taken(surfaces.size(), 0);
+    msdkFreeSurfacesPool pool;
+    std::vector<std::thread> producers;
+
+    for (mfxU32 p = 0; p < PRODUCERS; p++)
+    {
+        producers.push_back(std::thread([&surfaces, &pool, p]() {
+            for (mfxU32 i = 0; i < ITEMS_PER_PRODUCER; i++)
+            {
+                msdkFrameSurface& surface = surfaces[p * ITEMS_PER_PRODUCER + i];
+                surface.prev = surface.next = NULL;
+                pool.AddSurface(&surface);
+            }
+        }));
+    }
+
+    mfxU32 total = 0;
+    while (total < surfaces.size())
+    {
+        msdkFrameSurface* surface = pool.GetSurface();
+        if (!surface)
+            continue;
+        taken[surface - &surfaces[0]]++;
+        total++;
+    }
+
+    for (size_t p = 0; p < producers.size(); p++)
+        producers[p].join();
+
+    bool once = true;
+    for (size_t i = 0; i < taken.size(); i++)
+        once = once && taken[i] == 1;
+    SAMPLE_CHECK(once);
+    SAMPLE_CHECK(pool.GetSurface() == NULL);
+}
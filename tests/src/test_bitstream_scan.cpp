@@ -0,0 +1,413 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// The SSE2 and AVX2 implementations of bitstream_scan.h must give the results of the
+// plain C one for every alignment of the data and every length of the tail. The parsers
+// rewritten on top of them must give the results of the byte by byte loops they replaced.
+
+#include "sample_test.h"
+#include "bitstream_scan.h"
+#include "sample_defs.h"
+#include "avc_nal_spl.h"
+#include "sample_utils.h"
+
+#include <random>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+
+// Long enough for several iterations of the 32 byte AVX2 loop plus every tail
+const mfxU32 MAX_SIZE = 160;
+const mfxU32 MAX_ALIGNMENT = 64;
+
+// The vector implementations of the CPU, the plain C one is the reference
+std::vector<BitstreamScanFunctions> GetVectorFunctions()
+{
+    std::vector<BitstreamScanFunctions> result;
+    BitstreamScanFunctions funcs;
+    if (GetBitstreamScanFunctions(MSDK_CPU_ISA_SSE2, funcs))
+        result.push_back(funcs);
+    if (GetBitstreamScanFunctions(MSDK_CPU_ISA_AVX2, funcs))
+        result.push_back(funcs);
+    return result;
+}
+
+BitstreamScanFunctions GetReference()
+{
+    BitstreamScanFunctions funcs;
+    GetBitstreamScanFunctions(MSDK_CPU_ISA_C, funcs);
+    return funcs;
+}
+
+// Bytes from a small alphabet, so partial matches and matches are frequent
+void FillRandom(mfxU8* pData, mfxU32 size, std::mt19937& random, mfxU32 alphabet)
+{
+    for (mfxU32 i = 0; i < size; i++)
+        pData[i] = (mfxU8)(random() % alphabet);
+}
+
+// Start codes, emulation prevention bytes and JPEG markers, possibly cut by the end of the buffer
+struct Pattern
+{
+    mfxU32 size;
+    mfxU8  data[8];
+};
+
+const Pattern PATTERNS[] =
+{
+    { 3, { 0, 0, 1 } },
+    { 4, { 0, 0, 0, 1 } },
+    { 5, { 0, 0, 0, 0, 1 } },
+    { 3, { 0, 0, 3 } },
+    { 4, { 0, 0, 3, 3 } },
+    { 5, { 0, 0, 0, 3, 1 } },
+    { 6, { 0, 0, 3, 0, 0, 3 } },
+    { 6, { 0, 0, 3, 0, 0, 1 } },
+    { 2, { 0xFF, 0xD8 } },
+    { 4, { 0xFF, 0xFF, 0xD9, 0xD8 } },
+};
+
+// Background of bytes which can't be a part of any pattern, with the pattern at pos
+void PlacePattern(mfxU8* pData, mfxU32 size, mfxU32 pos, const Pattern& pattern)
+{
+    memset(pData, 0x55, size);
+    for (mfxU32 i = 0; i < pattern.size && pos + i < size; i++)
+        pData[pos + i] = pattern.data[i];
+}
+
+// The start code search as it was before it skipped to the next pair of zero bytes
+class CTestStartCodeIterator : public ProtectedLibrary::StartCodeIterator
+{
+public:
+    using ProtectedLibrary::StartCodeIterator::FindStartCode;
+
+    mfxI32 ScalarFindStartCode(mfxU8 * (&pb), mfxU32 & size, mfxI32 & startCodeSize)
+    {
+        mfxU32 zeroCount = 0;
+
+        for (mfxU32 i = 0 ; i < (mfxU32)size; i++, pb++)
+        {
+            switch(pb[0])
+            {
+            case 0x00:
+                zeroCount++;
+                break;
+            case 0x01:
+                if (zeroCount >= 2)
+                {
+                    startCodeSize = MSDK_MIN(zeroCount + 1, 4);
+                    size -= i + 1;
+                    pb++; // remove 0x01 symbol
+                    zeroCount = 0;
+                    if (size >= 1)
+                    {
+                        return GetNalUnitCode(pb[0]);
+                    }
+                    else
+                    {
+                        pb -= startCodeSize;
+                        size += startCodeSize;
+                        startCodeSize = 0;
+                        return 0;
+                    }
+                }
+                zeroCount = 0;
+                break;
+            default:
+                zeroCount = 0;
+                break;
+            }
+        }
+
+        zeroCount = MSDK_MIN(zeroCount, 3);
+        pb -= zeroCount;
+        size += zeroCount;
+        zeroCount = 0;
+        startCodeSize = 0;
+        return 0;
+    }
+};
+
+// Both searches must stop at the same NAL units of the buffer and leave the same tail
+bool StartCodesMatch(mfxU8* pData, mfxU32 size)
+{
+    CTestStartCodeIterator iterator;
+    // every NAL unit header gives a non zero code
+    iterator.SetCodec(MFX_CODEC_HEVC);
+
+    mfxU8* pExpected = pData;
+    mfxU32 expectedSize = size;
+    for (;;)
+    {
+        mfxU8* pActual = pExpected;
+        mfxU32 actualSize = expectedSize;
+        mfxI32 expectedStartCodeSize = -1;
+        mfxI32 actualStartCodeSize = -1;
+
+        mfxI32 expectedCode = iterator.ScalarFindStartCode(pExpected, expectedSize, expectedStartCodeSize);
+        mfxI32 actualCode = iterator.FindStartCode(pActual, actualSize, actualStartCodeSize);
+        if (actualCode != expectedCode || pActual != pExpected ||
+            actualSize != expectedSize || actualStartCodeSize != expectedStartCodeSize)
+            return false;
+
+        if (!expectedCode)
+            return true;
+
+        // continue after the NAL unit header
+        pExpected++;
+        expectedSize--;
+    }
+}
+
+// The big endian dword copy which skipped 0x03 after two zero bytes one byte at a time
+void ScalarSwapMemory(mfxU8 *pDestination, mfxU32 &nDstSize, const mfxU8 *pSource, mfxU32 nSrcSize)
+{
+    std::vector<mfxU8> bytes;
+    mfxU32 zeros = 0;
+
+    for (mfxU32 i = 0; i < nSrcSize; i++)
+    {
+        if (3 == pSource[i] && 2 <= zeros)
+        {
+            zeros = 0;
+            continue;
+        }
+        bytes.push_back(pSource[i]);
+        zeros = pSource[i] ? 0 : zeros + 1;
+    }
+
+    // padding bytes
+    while (bytes.size() & 3)
+        bytes.push_back(0);
+
+    for (size_t i = 0; i < bytes.size(); i += 4)
+    {
+        mfxU32 dword = ((mfxU32)bytes[i] << 24) | ((mfxU32)bytes[i + 1] << 16) | ((mfxU32)bytes[i + 2] << 8) | bytes[i + 3];
+        memcpy(pDestination + i, &dword, sizeof(dword));
+    }
+    nDstSize = (mfxU32)bytes.size();
+}
+
+// The bytes behind the written dwords must stay untouched
+bool SwapMemoryMatches(mfxU8* pData, mfxU32 size, std::mt19937& random)
+{
+    const mfxU32 guard = 8;
+    std::vector<mfxU8> expected(size + 3 + guard);
+    FillRandom(&expected[0], (mfxU32)expected.size(), random, 256);
+    std::vector<mfxU8> actual(expected);
+
+    mfxU32 expectedSize = 0;
+    mfxU32 actualSize = 0;
+    ScalarSwapMemory(&expected[0], expectedSize, pData, size);
+    ProtectedLibrary::SwapMemoryAndRemovePreventingBytes(&actual[0], actualSize, pData, size);
+    return actualSize == expectedSize && actual == expected;
+}
+
+class CTestJPEGFrameReader : public CJPEGFrameReader
+{
+public:
+    using CJPEGFrameReader::FindMarker;
+    using CJPEGFrameReader::JPEGMarker;
+    using CJPEGFrameReader::SOI;
+    using CJPEGFrameReader::EOI;
+};
+
+// The marker search which compared every unaligned word with the marker
+mfxU32 ScalarFindMarker(mfxBitstream *pBS, mfxU32 startOffset, mfxU16 marker)
+{
+    for (mfxU32 i = startOffset; i + sizeof(mfxU16) <= pBS->DataLength; i++)
+    {
+        mfxU16 word;
+        memcpy(&word, pBS->Data + i, sizeof(word));
+        if (word == marker)
+            return i;
+    }
+    return 0xFFFFFFFF;
+}
+
+bool MarkersMatch(mfxU8* pData, mfxU32 size)
+{
+    CTestJPEGFrameReader reader;
+    const CTestJPEGFrameReader::JPEGMarker markers[] = { CTestJPEGFrameReader::SOI, CTestJPEGFrameReader::EOI };
+
+    mfxBitstream bs;
+    memset(&bs, 0, sizeof(bs));
+    bs.Data = pData;
+    bs.DataLength = size;
+    for (size_t m = 0; m < sizeof(markers) / sizeof(markers[0]); m++)
+    {
+        for (mfxU32 startOffset = 0; startOffset <= size + 1; startOffset++)
+        {
+            if (reader.FindMarker(&bs, startOffset, markers[m]) != ScalarFindMarker(&bs, startOffset, (mfxU16)markers[m]))
+                return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+SAMPLE_TEST(bitstream_scan, find_random_data)
+{
+    const BitstreamScanFunctions reference = GetReference();
+    const std::vector<BitstreamScanFunctions> vector = GetVectorFunctions();
+    std::vector<mfxU8> buffer(MAX_ALIGNMENT + MAX_SIZE);
+    std::mt19937 random(1);
+
+    for (size_t f = 0; f < vector.size(); f++)
+    {
+        for (mfxU32 alignment = 0; alignment < MAX_ALIGNMENT; alignment++)
+        {
+            for (mfxU32 size = 0; size <= MAX_SIZE; size++)
+            {
+                for (mfxU32 alphabet = 2; alphabet <= 16; alphabet *= 2)
+                {
+                    mfxU8* pData = &buffer[alignment];
+                    FillRandom(pData, size, random, alphabet);
+
+                    SAMPLE_CHECK(vector[f].findBytePair(pData, size, 0, 1) == reference.findBytePair(pData, size, 0, 1));
+                    SAMPLE_CHECK(vector[f].findByteTriple(pData, size, 0, 0, 1) == reference.findByteTriple(pData, size, 0, 0, 1));
+                }
+            }
+        }
+    }
+}
+
+// A single match at every position, preceded by a partial one, and no match at all
+SAMPLE_TEST(bitstream_scan, find_every_position)
+{
+    const BitstreamScanFunctions reference = GetReference();
+    const std::vector<BitstreamScanFunctions> vector = GetVectorFunctions();
+    std::vector<mfxU8> buffer(MAX_ALIGNMENT + MAX_SIZE);
+
+    for (size_t f = 0; f < vector.size(); f++)
+    {
+        for (mfxU32 alignment = 0; alignment < MAX_ALIGNMENT; alignment += 3)
+        {
+            for (mfxU32 size = 0; size <= MAX_SIZE; size++)
+            {
+                mfxU8* pData = &buffer[alignment];
+                for (mfxU32 pos = 0; pos <= size; pos++)
+                {
+                    memset(pData, 0xFF, size);
+                    if (pos > 0)
+                        pData[pos - 1] = 0;
+                    for (mfxU32 i = pos; i < pos + 3 && i < size; i++)
+                        pData[i] = (i == pos + 2) ? 1 : 0;
+
+                    SAMPLE_CHECK(vector[f].findBytePair(pData, size, 0, 0) == reference.findBytePair(pData, size, 0, 0));
+                    SAMPLE_CHECK(vector[f].findByteTriple(pData, size, 0, 0, 1) == reference.findByteTriple(pData, size, 0, 0, 1));
+                }
+            }
+        }
+    }
+}
+
+// The bytes around the destination range must stay untouched
+SAMPLE_TEST(bitstream_scan, copy_swapping_dwords)
+{
+    const BitstreamScanFunctions reference = GetReference();
+    const std::vector<BitstreamScanFunctions> vector = GetVectorFunctions();
+    const mfxU32 guard = 8;
+    std::vector<mfxU8> src(MAX_ALIGNMENT + MAX_SIZE);
+    std::vector<mfxU8> expected(guard + MAX_SIZE + guard);
+    std::vector<mfxU8> actual(expected.size());
+    std::mt19937 random(2);
+
+    for (size_t f = 0; f < vector.size(); f++)
+    {
+        for (mfxU32 alignment = 0; alignment < MAX_ALIGNMENT; alignment++)
+        {
+            for (mfxU32 size = 0; size <= MAX_SIZE - guard; size++)
+            {
+                for (mfxU32 dstPos = 0; dstPos < 8; dstPos++)
+                {
+                    FillRandom(&src[alignment], size, random, 256);
+                    FillRandom(&expected[0], (mfxU32)expected.size(), random, 256);
+                    actual = expected;
+
+                    reference.copyBytesSwappingDwords(&expected[guard], dstPos, &src[alignment], size);
+                    vector[f].copyBytesSwappingDwords(&actual[guard], dstPos, &src[alignment], size);
+                    SAMPLE_CHECK(actual == expected);
+                }
+            }
+        }
+    }
+}
+
+// The plain C version defines the byte order of the dwords
+SAMPLE_TEST(bitstream_scan, copy_swapping_dwords_order)
+{
+    const mfxU8 src[6] = { 1, 2, 3, 4, 5, 6 };
+    mfxU8 dst[8] = { 0 };
+    const mfxU8 expected[8] = { 1, 0, 0, 0, 5, 4, 3, 2 };
+    CopyBytesSwappingDwords(dst, 3, src, 5);
+    SAMPLE_CHECK(memcmp(dst, expected, sizeof(dst)) == 0);
+}
+
+// Every pattern at every position, so it straddles the 16 and 32 byte blocks of the vector
+// searches and gets cut by the end of the buffer
+SAMPLE_TEST(bitstream_scan, parsers_every_position)
+{
+    std::vector<mfxU8> buffer(MAX_ALIGNMENT + MAX_SIZE);
+    std::mt19937 random(3);
+
+    for (mfxU32 alignment = 0; alignment < MAX_ALIGNMENT; alignment += 5)
+    {
+        for (mfxU32 size = 0; size <= MAX_SIZE; size++)
+        {
+            mfxU8* pData = &buffer[alignment];
+            for (mfxU32 pos = 0; pos <= size; pos++)
+            {
+                for (size_t p = 0; p < sizeof(PATTERNS) / sizeof(PATTERNS[0]); p++)
+                {
+                    PlacePattern(pData, size, pos, PATTERNS[p]);
+                    SAMPLE_CHECK(StartCodesMatch(pData, size));
+                    SAMPLE_CHECK(SwapMemoryMatches(pData, size, random));
+                    if (size <= 40)
+                        SAMPLE_CHECK(MarkersMatch(pData, size));
+                }
+            }
+        }
+    }
+}
+
+// Dense runs of zeros, start codes, emulation prevention bytes and markers
+SAMPLE_TEST(bitstream_scan, parsers_random_data)
+{
+    static const mfxU8 symbols[] = { 0, 0, 0, 1, 3, 0x55, 0xFF, 0xD8, 0xD9 };
+    std::vector<mfxU8> buffer(MAX_ALIGNMENT + MAX_SIZE);
+    std::mt19937 random(4);
+
+    for (mfxU32 alignment = 0; alignment < MAX_ALIGNMENT; alignment++)
+    {
+        for (mfxU32 size = 0; size <= MAX_SIZE; size++)
+        {
+            mfxU8* pData = &buffer[alignment];
+            for (mfxU32 i = 0; i < size; i++)
+                pData[i] = symbols[random() % sizeof(symbols)];
+
+            SAMPLE_CHECK(StartCodesMatch(pData, size));
+            SAMPLE_CHECK(SwapMemoryMatches(pData, size, random));
+            SAMPLE_CHECK(MarkersMatch(pData, size));
+        }
+    }
+}
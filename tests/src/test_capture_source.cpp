@@ -0,0 +1,217 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// CFileCaptureSource through the consumer API: frames arrive in file order, the consumer
+// owns a frame until it releases it, the end of file is reported or the file is looped.
+
+#include "sample_test.h"
+#include "capture_source.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace
+{
+
+const mfxU16 WIDTH = 16;
+const mfxU16 HEIGHT = 8;
+const size_t NV12_FRAME_SIZE = WIDTH * HEIGHT * 3 / 2;
+
+// A raw file of frames whose every byte is the number of the frame, removed at the end of the scope
+class CTestFile
+{
+public:
+    CTestFile(mfxU32 frames, size_t frameSize, size_t extraBytes = 0)
+    {
+        char name[] = "capture_source_test_XXXXXX";
+        int fd = mkstemp(name);
+        m_name = name;
+        for (mfxU32 i = 0; fd >= 0 && i <= frames; i++)
+        {
+            std::vector<mfxU8> frame(i < frames ? frameSize : extraBytes, (mfxU8)i);
+            if (!frame.empty() && write(fd, &frame[0], frame.size()) != (ssize_t)frame.size())
+                m_name.clear();
+        }
+        if (fd >= 0)
+            close(fd);
+        else
+            m_name.clear();
+    }
+
+    ~CTestFile()
+    {
+        if (!m_name.empty())
+            unlink(m_name.c_str());
+    }
+
+    const std::string& GetName() const { return m_name; }
+
+private:
+    std::string m_name;
+};
+
+sCaptureParams MakeParams(const CTestFile& file, mfxU32 numBuffers, bool loop)
+{
+    sCaptureParams params;
+    params.device = file.GetName();
+    params.width = WIDTH;
+    params.height = HEIGHT;
+    params.numBuffers = numBuffers;
+    params.loop = loop;
+    return params;
+}
+
+// Every byte of the frame holds value
+bool IsFilledWith(const sCaptureFrame& frame, size_t size, mfxU8 value)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (frame.data[i] != value)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+SAMPLE_TEST(capture_source, frames_then_end_of_stream)
+{
+    CTestFile file(5, NV12_FRAME_SIZE);
+    SAMPLE_CHECK(!file.GetName().empty());
+
+    CFileCaptureSource source;
+    SAMPLE_CHECK(source.Open(MakeParams(file, 2, false)) == MFX_ERR_NONE);
+
+    for (mfxU32 i = 0; i < 5; i++)
+    {
+        sCaptureFrame frame;
+        SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_NONE);
+        SAMPLE_CHECK(frame.fourcc == MFX_FOURCC_NV12);
+        SAMPLE_CHECK(frame.width == WIDTH && frame.height == HEIGHT && frame.pitch == WIDTH);
+        SAMPLE_CHECK(frame.index < 2);
+        SAMPLE_CHECK(frame.dmabufFd == -1);
+        SAMPLE_CHECK(IsFilledWith(frame, NV12_FRAME_SIZE, (mfxU8)i));
+        source.ReleaseFrame(frame);
+    }
+
+    // the end of stream is reported again to a consumer asking again
+    sCaptureFrame frame;
+    SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_MORE_DATA);
+    SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_MORE_DATA);
+    SAMPLE_CHECK(source.GetDroppedFrames() == 0);
+    source.Close();
+}
+
+SAMPLE_TEST(capture_source, partial_frame_is_not_returned)
+{
+    CTestFile file(2, NV12_FRAME_SIZE, NV12_FRAME_SIZE / 2);
+    CFileCaptureSource source;
+    SAMPLE_CHECK(source.Open(MakeParams(file, 4, false)) == MFX_ERR_NONE);
+
+    sCaptureFrame frame;
+    for (mfxU32 i = 0; i < 2; i++)
+    {
+        SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_NONE);
+        SAMPLE_CHECK(IsFilledWith(frame, NV12_FRAME_SIZE, (mfxU8)i));
+        source.ReleaseFrame(frame);
+    }
+    SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_MORE_DATA);
+}
+
+SAMPLE_TEST(capture_source, loop_restarts_the_file)
+{
+    CTestFile file(3, NV12_FRAME_SIZE);
+    CFileCaptureSource source;
+    SAMPLE_CHECK(source.Open(MakeParams(file, 2, true)) == MFX_ERR_NONE);
+
+    for (mfxU32 i = 0; i < 10; i++)
+    {
+        sCaptureFrame frame;
+        SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_NONE);
+        SAMPLE_CHECK(IsFilledWith(frame, NV12_FRAME_SIZE, (mfxU8)(i % 3)));
+        source.ReleaseFrame(frame);
+    }
+
+    // the capture thread waits for a free buffer, Close has to wake and stop it
+    source.Close();
+}
+
+SAMPLE_TEST(capture_source, held_frames_are_not_overwritten)
+{
+    CTestFile file(6, NV12_FRAME_SIZE);
+    CFileCaptureSource source;
+    SAMPLE_CHECK(source.Open(MakeParams(file, 2, false)) == MFX_ERR_NONE);
+
+    sCaptureFrame held;
+    SAMPLE_CHECK(source.GetFrame(held) == MFX_ERR_NONE);
+
+    // only the other buffer circulates while the first frame is held
+    for (mfxU32 i = 1; i < 6; i++)
+    {
+        sCaptureFrame frame;
+        SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_NONE);
+        SAMPLE_CHECK(frame.index != held.index);
+        SAMPLE_CHECK(IsFilledWith(frame, NV12_FRAME_SIZE, (mfxU8)i));
+        source.ReleaseFrame(frame);
+    }
+    SAMPLE_CHECK(IsFilledWith(held, NV12_FRAME_SIZE, 0));
+    source.ReleaseFrame(held);
+
+    sCaptureFrame frame;
+    SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_MORE_DATA);
+}
+
+SAMPLE_TEST(capture_source, yuy2_pitch)
+{
+    CTestFile file(1, WIDTH * 2 * HEIGHT);
+    sCaptureParams params = MakeParams(file, 1, false);
+    params.fourcc = MFX_FOURCC_YUY2;
+
+    CFileCaptureSource source;
+    SAMPLE_CHECK(source.Open(params) == MFX_ERR_NONE);
+
+    sCaptureFrame frame;
+    SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_NONE);
+    SAMPLE_CHECK(frame.fourcc == MFX_FOURCC_YUY2 && frame.pitch == WIDTH * 2);
+    source.ReleaseFrame(frame);
+    SAMPLE_CHECK(source.GetFrame(frame) == MFX_ERR_MORE_DATA);
+}
+
+SAMPLE_TEST(capture_source, open_errors)
+{
+    CTestFile file(1, NV12_FRAME_SIZE);
+    CFileCaptureSource source;
+
+    sCaptureParams params = MakeParams(file, 2, false);
+    params.device = file.GetName() + ".missing";
+    SAMPLE_CHECK(source.Open(params) == MFX_ERR_NOT_FOUND);
+
+    params = MakeParams(file, 2, false);
+    params.width = WIDTH + 1;
+    SAMPLE_CHECK(source.Open(params) == MFX_ERR_INVALID_VIDEO_PARAM);
+
+    params = MakeParams(file, 0, false);
+    SAMPLE_CHECK(source.Open(params) == MFX_ERR_INVALID_VIDEO_PARAM);
+
+    params = MakeParams(file, 2, false);
+    params.fourcc = MFX_FOURCC_RGB4;
+    SAMPLE_CHECK(source.Open(params) == MFX_ERR_UNSUPPORTED);
+}
@@ -0,0 +1,295 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// A recording made on the live path replays to the same demographics and ad decisions: the faces are
+// recorded as the live analysis updates them, and the replay runs the same tracking and attribute cache.
+
+#include "sample_test.h"
+#include "main.hpp"
+#include "audience.hpp"
+#include "detection_record.hpp"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const int FRAMES = 300;
+
+// A temporary file name, the file is removed at the end of the scope
+class CTestFile
+{
+public:
+    CTestFile()
+    {
+        char name[] = "detection_record_test_XXXXXX";
+        int fd = mkstemp(name);
+        if (fd >= 0)
+        {
+            close(fd);
+            m_name = name;
+        }
+    }
+
+    ~CTestFile()
+    {
+        if (!m_name.empty())
+            unlink(m_name.c_str());
+    }
+
+    const std::string& Name() const { return m_name; }
+
+private:
+    std::string m_name;
+};
+
+// A person passing by the screen, the detector finds the face in [enter, leave)
+struct Person
+{
+    int x, y, size;
+    int enter, leave;
+    float intensity;
+    float age;
+    float maleProb;
+};
+
+const Person PEOPLE[] =
+{
+    {  40,  60, 90,   0, 300, 120.f, 34.f, 0.9f },
+    { 300,  50, 80,  20, 170,  90.f, 22.f, 0.1f },
+    { 520,  80, 70,  90, 260, 150.f, 61.f, 0.7f },
+    // lit differently from frame 200 on, the tracking takes it for a new face
+    { 300, 220, 60, 150, 300,  60.f,  9.f, 0.3f },
+};
+
+// The detections of a frame with the results every network would give, as the live loop gets them
+std::vector<RecordedFace> Detect(int f, std::mt19937& random)
+{
+    std::uniform_real_distribution<float> noise(-1.f, 1.f);
+    std::vector<RecordedFace> faces;
+    for (size_t i = 0; i < sizeof(PEOPLE) / sizeof(PEOPLE[0]); i++)
+    {
+        const Person& p = PEOPLE[i];
+        if (f < p.enter || f >= p.leave)
+            continue;
+        RecordedFace face = {};
+        face.x = (int16_t)(p.x + (int)(2 * noise(random)));
+        face.y = (int16_t)(p.y + (int)(2 * noise(random)));
+        face.width = face.height = (int16_t)p.size;
+        face.confidence = 0.9f;
+        face.intensity = p.intensity + noise(random) + (i == 3 && f >= 200 ? 40.f : 0.f);
+        face.age = p.age + 4 * noise(random);
+        face.maleProb = p.maleProb + 0.05f * noise(random);
+        face.yaw = 45.f * sinf(0.05f * f + (float)i);
+        face.pitch = 5 * noise(random);
+        face.roll = 5 * noise(random);
+        for (int e = 0; e < 5; e++)
+            face.emotions[e] = 0.5f + 0.5f * noise(random);
+        faces.push_back(face);
+    }
+    return faces;
+}
+
+struct Decision
+{
+    float pCount[4];
+    char gender;
+    unsigned int ageGroup;
+};
+
+// The ad is selected every 30th frame and when an ad finished, before the frame is analysed
+void Decide(int frameCount, const RecordedFrame& frame, std::vector<Decision>& decisions)
+{
+    if (frameCount % 30 != 0 && !(frame.flags & RECORDED_AD_FINISHED))
+        return;
+    Decision decision = {};
+    getPeopleCount(decision.pCount);
+    playAdForData data = getGenderAgeGroup(decision.pCount);
+    decision.gender = data.gender;
+    decision.ageGroup = data.ageGroup;
+    decisions.push_back(decision);
+}
+
+void Snapshot(std::vector<DemographicsStructure>& history)
+{
+    history.insert(history.end(), demographics, demographics + 5);
+}
+
+bool SameDemographics(const std::vector<DemographicsStructure>& a, const std::vector<DemographicsStructure>& b)
+{
+    return a.size() == b.size() && (a.empty() || !memcmp(&a[0], &b[0], a.size() * sizeof(a[0])));
+}
+
+bool SameDecisions(const std::vector<Decision>& a, const std::vector<Decision>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (memcmp(a[i].pCount, b[i].pCount, sizeof(a[i].pCount)) ||
+            a[i].gender != b[i].gender || a[i].ageGroup != b[i].ageGroup)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+SAMPLE_TEST(detection_record, records_read_back)
+{
+    CTestFile file;
+    SAMPLE_CHECK(!file.Name().empty());
+
+    std::mt19937 random(1);
+    std::vector<RecordedFrame> frames;
+    std::vector<std::vector<RecordedFace> > faces;
+    {
+        DetectionRecorder recorder;
+        SAMPLE_CHECK(recorder.open(file.Name()));
+        for (int f = 0; f < 50; f++)
+        {
+            faces.push_back(Detect(f * 5, random));
+            RecordedFrame frame = { (uint64_t)f * 33333, 640, 480, (uint16_t)faces.back().size(),
+                                    (uint16_t)(f % 7 ? RECORDED_DETECTED : 0) };
+            frames.push_back(frame);
+            recorder.write(frame, faces.back());
+        }
+        recorder.close();
+    }
+
+    DetectionReplay replay;
+    SAMPLE_CHECK(replay.open(file.Name()));
+    RecordedFrame frame;
+    std::vector<RecordedFace> recorded;
+    for (size_t f = 0; f < frames.size(); f++)
+    {
+        SAMPLE_CHECK(replay.next(frame, recorded));
+        SAMPLE_CHECK(!memcmp(&frame, &frames[f], sizeof(frame)));
+        SAMPLE_CHECK(recorded.size() == faces[f].size());
+        SAMPLE_CHECK(recorded.empty() || !memcmp(&recorded[0], &faces[f][0], recorded.size() * sizeof(recorded[0])));
+    }
+    SAMPLE_CHECK(!replay.next(frame, recorded));
+
+    // a recording cut in the middle of the last record ends before it
+    size_t size = sizeof(uint32_t) * 2;
+    for (size_t f = 0; f < frames.size(); f++)
+        size += sizeof(RecordedFrame) + faces[f].size() * sizeof(RecordedFace);
+    SAMPLE_CHECK(truncate(file.Name().c_str(), (off_t)size - 1) == 0);
+    DetectionReplay truncated;
+    SAMPLE_CHECK(truncated.open(file.Name()));
+    size_t count = 0;
+    while (truncated.next(frame, recorded))
+        count++;
+    SAMPLE_CHECK(count == frames.size() - 1);
+}
+
+SAMPLE_TEST(detection_record, replay_matches_live)
+{
+    CTestFile file;
+    SAMPLE_CHECK(!file.Name().empty());
+
+    const AudienceOptions options = { true, { 5, 3.f, 1.f, 30 }, true, true };
+    std::vector<DemographicsStructure> liveDemographics, replayDemographics;
+    std::vector<Decision> liveDecisions, replayDecisions;
+    size_t estimated = 0, cached = 0;
+
+    // The live loop: Age/Gender runs on the stale faces only, Emotions and Landmarks on the faces
+    // looking at the screen, and the faces are recorded as they are updated
+    setAudienceOptions(options);
+    resetAudience();
+    {
+        DetectionRecorder recorder;
+        SAMPLE_CHECK(recorder.open(file.Name()));
+        std::mt19937 random(2);
+        for (int f = 0; f < FRAMES; f++)
+        {
+            std::vector<RecordedFace> detected = Detect(f, random);
+            RecordedFrame frame = { (uint64_t)f * 33333, 640, 480, (uint16_t)detected.size(),
+                                    (uint16_t)(RECORDED_DETECTED | recordedNetworks() | (f % 97 == 96 ? RECORDED_AD_FINISHED : 0)) };
+            Decide(f + 1, frame, liveDecisions);
+
+            beginDemographics();
+            std::vector<cv::Rect> rects;
+            std::vector<float> intensities;
+            for (size_t i = 0; i < detected.size(); i++)
+            {
+                // copies of the packed fields, no reference to them may be taken
+                const RecordedFace& face = detected[i];
+                rects.push_back(cv::Rect(int(face.x), int(face.y), int(face.width), int(face.height)));
+                const float intensity = face.intensity;
+                intensities.push_back(intensity);
+            }
+            std::vector<Face::Ptr> tracked = trackFaces(rects, intensities);
+            for (size_t i = 0; i < detected.size(); i++)
+            {
+                RecordedFace& face = detected[i];
+                if (tracked[i]->isAgeGenderStale(options.ageGender))
+                {
+                    face.flags |= RECORDED_AGE_GENDER;
+                    estimated++;
+                }
+                else
+                {
+                    tracked[i]->skipAgeGender();
+                    face.age = face.maleProb = 0.f;
+                    cached++;
+                }
+                face.flags |= RECORDED_HEAD_POSE;
+                if (isLookingAtScreen({ face.roll, face.pitch, face.yaw }))
+                    face.flags |= RECORDED_EMOTIONS | RECORDED_LANDMARKS;
+                else
+                {
+                    for (int e = 0; e < 5; e++)
+                        face.emotions[e] = 0.f;
+                }
+                updateFace(tracked[i], face);
+                addFace(tracked[i]);
+            }
+            endDemographics(detected.size());
+            recorder.write(frame, detected);
+            Snapshot(liveDemographics);
+        }
+        recorder.close();
+    }
+    // the cache must have been both hit and missed for the comparison to mean anything
+    SAMPLE_CHECK(estimated > 0 && cached > 0);
+
+    // The replay as replayRecording runs it
+    resetAudience();
+    DetectionReplay replay;
+    SAMPLE_CHECK(replay.open(file.Name()));
+    RecordedFrame frame;
+    std::vector<RecordedFace> faces;
+    for (int frameCount = 1; replay.next(frame, faces); frameCount++)
+    {
+        Decide(frameCount, frame, replayDecisions);
+        SAMPLE_CHECK(replayPeople(frame, faces) == 0);
+        Snapshot(replayDemographics);
+    }
+
+    SAMPLE_CHECK(replayDemographics.size() == (size_t)FRAMES * 5);
+    SAMPLE_CHECK(SameDemographics(liveDemographics, replayDemographics));
+    SAMPLE_CHECK(liveDecisions.size() == FRAMES / 30 + FRAMES / 97);
+    SAMPLE_CHECK(SameDecisions(liveDecisions, replayDecisions));
+}
@@ -0,0 +1,327 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// HEVC_Spl on a synthetic stream: every access unit has to come out whole and byte for byte,
+// its NAL units behind three-byte start codes, including one larger than the initial frame buffer.
+
+#include "sample_test.h"
+#include "hevc_spl.h"
+
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace ProtectedLibrary;
+
+namespace
+{
+
+// Writes the RBSP of a NAL unit and adds the emulation prevention bytes
+class CBitWriter
+{
+public:
+    CBitWriter() : m_bits(0) {}
+
+    void Bits(mfxU32 value, mfxU32 count)
+    {
+        while (count--)
+        {
+            if (!(m_bits & 7))
+                m_rbsp.push_back(0);
+            if ((value >> count) & 1)
+                m_rbsp.back() |= (mfxU8)(0x80 >> (m_bits & 7));
+            m_bits++;
+        }
+    }
+
+    void Ue(mfxU32 value)
+    {
+        mfxU32 length = 0;
+        while ((value + 1) >> (length + 1))
+            length++;
+        Bits(0, length);
+        Bits(value + 1, length + 1);
+    }
+
+    void Bytes(const std::vector<mfxU8>& bytes)
+    {
+        for (size_t i = 0; i < bytes.size(); i++)
+            Bits(bytes[i], 8);
+    }
+
+    // rbsp_trailing_bits, then the NAL unit as it is in the stream
+    std::vector<mfxU8> Nal(mfxU32 nalType)
+    {
+        Bits(1, 1);
+        while (m_bits & 7)
+            Bits(0, 1);
+
+        std::vector<mfxU8> nal;
+        nal.push_back((mfxU8)(nalType << 1));
+        nal.push_back(1); // nuh_temporal_id_plus1
+        mfxU32 zeros = 0;
+        for (size_t i = 0; i < m_rbsp.size(); i++)
+        {
+            if (zeros == 2 && m_rbsp[i] <= 3)
+            {
+                nal.push_back(3);
+                zeros = 0;
+            }
+            nal.push_back(m_rbsp[i]);
+            zeros = m_rbsp[i] ? 0 : zeros + 1;
+        }
+        return nal;
+    }
+
+private:
+    std::vector<mfxU8> m_rbsp;
+    mfxU32 m_bits;
+};
+
+// 1920x1088 in 64x64 CTBs, 510 CTBs address with 9 bits
+const mfxU32 WIDTH = 1920;
+const mfxU32 HEIGHT = 1088;
+const mfxU32 ADDRESS_BITS = 9;
+
+std::vector<mfxU8> MakeVps()
+{
+    CBitWriter writer;
+    writer.Bits(0, 4);      // vps_video_parameter_set_id
+    writer.Bits(3, 2);      // vps_base_layer_internal_flag, vps_base_layer_available_flag
+    writer.Bits(0, 6);      // vps_max_layers_minus1
+    writer.Bits(0, 3);      // vps_max_sub_layers_minus1
+    writer.Bits(1, 1);      // vps_temporal_id_nesting_flag
+    writer.Bits(0xffff, 16);
+    return writer.Nal(HEVC_NAL_UT_VPS);
+}
+
+std::vector<mfxU8> MakeSps()
+{
+    CBitWriter writer;
+    writer.Bits(0, 4);      // sps_video_parameter_set_id
+    writer.Bits(0, 3);      // sps_max_sub_layers_minus1
+    writer.Bits(1, 1);      // sps_temporal_id_nesting_flag
+    writer.Bits(0, 8);      // general_profile_space .. general_profile_idc
+    writer.Bits(0, 32);     // general_profile_compatibility_flag[]
+    writer.Bits(0, 16);
+    writer.Bits(0, 32);     // general constraint flags
+    writer.Bits(93, 8);     // general_level_idc
+    writer.Ue(0);           // sps_seq_parameter_set_id
+    writer.Ue(1);           // chroma_format_idc
+    writer.Ue(WIDTH);
+    writer.Ue(HEIGHT);
+    writer.Bits(0, 1);      // conformance_window_flag
+    writer.Ue(0);           // bit_depth_luma_minus8
+    writer.Ue(0);           // bit_depth_chroma_minus8
+    writer.Ue(4);           // log2_max_pic_order_cnt_lsb_minus4
+    writer.Bits(1, 1);      // sps_sub_layer_ordering_info_present_flag
+    writer.Ue(4);
+    writer.Ue(0);
+    writer.Ue(0);
+    writer.Ue(0);           // log2_min_luma_coding_block_size_minus3
+    writer.Ue(3);           // log2_diff_max_min_luma_coding_block_size
+    return writer.Nal(HEVC_NAL_UT_SPS);
+}
+
+std::vector<mfxU8> MakePps()
+{
+    CBitWriter writer;
+    writer.Ue(0);           // pps_pic_parameter_set_id
+    writer.Ue(0);           // pps_seq_parameter_set_id
+    writer.Bits(1, 1);      // dependent_slice_segments_enabled_flag
+    writer.Bits(0, 1);      // output_flag_present_flag
+    writer.Bits(0, 3);      // num_extra_slice_header_bits
+    return writer.Nal(HEVC_NAL_UT_PPS);
+}
+
+std::vector<mfxU8> MakeOther(mfxU32 nalType)
+{
+    CBitWriter writer;
+    writer.Bits(0x05, 8);
+    writer.Bits(0x01, 8);
+    return writer.Nal(nalType);
+}
+
+// A slice segment with payloadSize random bytes, zero runs included
+std::vector<mfxU8> MakeSlice(mfxU32 nalType, mfxU32 address, bool dependent, mfxU32 sliceType, mfxU32 poc,
+    size_t payloadSize, std::mt19937& random)
+{
+    CBitWriter writer;
+    writer.Bits(address == 0, 1);           // first_slice_segment_in_pic_flag
+    if (IsHEVCIRAP(nalType))
+        writer.Bits(0, 1);                  // no_output_of_prior_pics_flag
+    writer.Ue(0);                           // slice_pic_parameter_set_id
+    if (address)
+    {
+        writer.Bits(dependent, 1);          // dependent_slice_segment_flag
+        writer.Bits(address, ADDRESS_BITS); // slice_segment_address
+    }
+    if (!dependent)
+    {
+        writer.Ue(sliceType);
+        if (nalType != HEVC_NAL_UT_IDR_W_RADL && nalType != HEVC_NAL_UT_IDR_N_LP)
+            writer.Bits(poc, 8);            // slice_pic_order_cnt_lsb
+    }
+    std::vector<mfxU8> payload(payloadSize);
+    for (size_t i = 0; i < payload.size(); i++)
+        payload[i] = random() % 4 ? (mfxU8)random() : 0;
+    writer.Bytes(payload);
+    return writer.Nal(nalType);
+}
+
+struct TestFrame
+{
+    std::vector<mfxU8> data;        // what the splitter has to return
+    std::vector<mfxU16> sliceTypes;
+};
+
+class CTestStream
+{
+public:
+    void Add(const std::vector<mfxU8>& nal, bool longStartCode = false)
+    {
+        static const mfxU8 startCode[] = { 0, 0, 0, 1 };
+        m_stream.insert(m_stream.end(), startCode + (longStartCode ? 0 : 1), startCode + 4);
+        m_stream.insert(m_stream.end(), nal.begin(), nal.end());
+        m_frames.back().data.insert(m_frames.back().data.end(), startCode + 1, startCode + 4);
+        m_frames.back().data.insert(m_frames.back().data.end(), nal.begin(), nal.end());
+    }
+
+    void AddSlice(const std::vector<mfxU8>& nal, mfxU16 sliceType)
+    {
+        Add(nal);
+        m_frames.back().sliceTypes.push_back(sliceType);
+    }
+
+    void NextFrame() { m_frames.push_back(TestFrame()); }
+
+    std::vector<mfxU8>& Stream() { return m_stream; }
+    const std::vector<TestFrame>& Frames() const { return m_frames; }
+
+private:
+    std::vector<mfxU8> m_stream;
+    std::vector<TestFrame> m_frames;
+};
+
+// A multi-slice IDR frame with its parameter sets, a P frame framed by an AUD and SEI prefix and
+// suffix, then a frame of largeSliceSize byte slices and a last small one
+CTestStream MakeStream(size_t largeSliceSize)
+{
+    std::mt19937 random(7);
+    CTestStream stream;
+
+    stream.NextFrame();
+    stream.Add(MakeVps(), true);
+    stream.Add(MakeSps());
+    stream.Add(MakePps());
+    stream.AddSlice(MakeSlice(HEVC_NAL_UT_IDR_W_RADL, 0, false, HEVC_SLICE_I, 0, 3000, random), TYPE_I);
+    stream.AddSlice(MakeSlice(HEVC_NAL_UT_IDR_W_RADL, 170, true, HEVC_SLICE_I, 0, 2000, random), TYPE_I);
+    stream.AddSlice(MakeSlice(HEVC_NAL_UT_IDR_W_RADL, 340, false, HEVC_SLICE_I, 0, 1000, random), TYPE_I);
+
+    stream.NextFrame();
+    stream.Add(MakeOther(HEVC_NAL_UT_AUD));
+    stream.Add(MakeOther(HEVC_NAL_UT_SEI_PREFIX));
+    stream.AddSlice(MakeSlice(HEVC_NAL_UT_TRAIL_R, 0, false, HEVC_SLICE_P, 1, 500, random), TYPE_P);
+    stream.AddSlice(MakeSlice(HEVC_NAL_UT_TRAIL_R, 200, false, HEVC_SLICE_B, 1, 700, random), TYPE_B);
+    stream.AddSlice(MakeSlice(HEVC_NAL_UT_TRAIL_R, 400, true, HEVC_SLICE_B, 1, 900, random), TYPE_B);
+    stream.Add(MakeOther(HEVC_NAL_UT_SEI_SUFFIX));
+
+    stream.NextFrame();
+    for (mfxU32 i = 0; i < 3; i++)
+        stream.AddSlice(MakeSlice(HEVC_NAL_UT_TRAIL_R, i * 100, false, HEVC_SLICE_P, 2, largeSliceSize, random), TYPE_P);
+
+    stream.NextFrame();
+    stream.AddSlice(MakeSlice(HEVC_NAL_UT_TRAIL_N, 0, false, HEVC_SLICE_B, 3, 100, random), TYPE_B);
+    return stream;
+}
+
+// Splits the stream fed in chunks of chunkSize bytes like CHEVCFrameReader does, the splitter output is
+// compared with the access units the stream was made of
+bool SplitMatches(CTestStream& stream, size_t chunkSize)
+{
+    std::vector<mfxU8>& data = stream.Stream();
+    const std::vector<TestFrame>& expected = stream.Frames();
+    HEVC_Spl splitter;
+    mfxBitstream bs;
+    memset(&bs, 0, sizeof(bs));
+    std::vector<mfxU8> buffer(2 * chunkSize + 16);
+    bs.Data = &buffer[0];
+    bs.MaxLength = (mfxU32)buffer.size();
+
+    size_t fed = 0;
+    size_t frames = 0;
+    bool endOfStream = false;
+    for (;;)
+    {
+        FrameSplitterInfo* frame = NULL;
+        mfxStatus sts = splitter.GetFrame(endOfStream ? NULL : &bs, &frame);
+        if (sts == MFX_ERR_MORE_DATA)
+        {
+            if (endOfStream)
+                break;
+            if (fed == data.size())
+            {
+                endOfStream = true;
+                continue;
+            }
+            memmove(bs.Data, bs.Data + bs.DataOffset, bs.DataLength);
+            bs.DataOffset = 0;
+            size_t size = std::min(chunkSize, data.size() - fed);
+            memcpy(bs.Data + bs.DataLength, &data[fed], size);
+            bs.DataLength += (mfxU32)size;
+            fed += size;
+            continue;
+        }
+        if (sts != MFX_ERR_NONE || !frame || frames == expected.size())
+            return false;
+
+        const TestFrame& want = expected[frames++];
+        if (frame->DataLength != want.data.size() || memcmp(frame->Data, &want.data[0], want.data.size()))
+            return false;
+        if (frame->SliceNum != want.sliceTypes.size())
+            return false;
+        for (mfxU32 i = 0; i < frame->SliceNum; i++)
+        {
+            if (frame->Slice[i].SliceType != want.sliceTypes[i])
+                return false;
+        }
+        splitter.ResetCurrentState();
+    }
+    return frames == expected.size();
+}
+
+} // namespace
+
+SAMPLE_TEST(hevc_spl, multi_slice_frames)
+{
+    CTestStream stream = MakeStream(20000);
+    SAMPLE_CHECK(SplitMatches(stream, stream.Stream().size()));
+    SAMPLE_CHECK(SplitMatches(stream, 4096));
+    SAMPLE_CHECK(SplitMatches(stream, 1000));
+}
+
+// three slices of 500 KB exceed the initial BUFFER_SIZE of 1 MB, the access unit must not lose any
+SAMPLE_TEST(hevc_spl, oversized_access_unit)
+{
+    CTestStream stream = MakeStream(500 * 1024);
+    SAMPLE_CHECK(stream.Frames()[2].data.size() > 1024 * 1024);
+    SAMPLE_CHECK(SplitMatches(stream, stream.Stream().size()));
+    SAMPLE_CHECK(SplitMatches(stream, 64 * 1024));
+}
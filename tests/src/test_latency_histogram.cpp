@@ -0,0 +1,109 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// CLatencyHistogram as the decoder uses it for the periodic latency reports: every
+// snapshot holds the samples since the previous one and the histogram starts over.
+
+#include "sample_test.h"
+#include "latency_histogram.h"
+
+namespace
+{
+
+// Quantiles are reported with up to ~6% relative error
+bool IsNear(mfxF64 actual, mfxF64 expected)
+{
+    mfxF64 diff = actual > expected ? actual - expected : expected - actual;
+    return diff <= expected * 0.07;
+}
+
+} // namespace
+
+SAMPLE_TEST(latency_histogram, empty)
+{
+    CLatencyHistogram histogram;
+    SAMPLE_CHECK(histogram.GetCount() == 0);
+    SAMPLE_CHECK(histogram.GetAvg() == 0);
+    SAMPLE_CHECK(histogram.GetMin() == 0);
+    SAMPLE_CHECK(histogram.GetMax() == 0);
+    SAMPLE_CHECK(histogram.GetQuantile(0.5) == 0);
+}
+
+SAMPLE_TEST(latency_histogram, quantiles)
+{
+    CLatencyHistogram histogram;
+    for (mfxU32 i = 1; i <= 1000; i++)
+        histogram.AddValue(i * 0.1);
+
+    SAMPLE_CHECK(histogram.GetCount() == 1000);
+    SAMPLE_CHECK(IsNear(histogram.GetAvg(), 50.05));
+    SAMPLE_CHECK(histogram.GetMin() == 0.1);
+    SAMPLE_CHECK(histogram.GetMax() == 100);
+    SAMPLE_CHECK(IsNear(histogram.GetQuantile(0.5), 50));
+    SAMPLE_CHECK(IsNear(histogram.GetQuantile(0.9), 90));
+    SAMPLE_CHECK(IsNear(histogram.GetQuantile(0.99), 99));
+    SAMPLE_CHECK(IsNear(histogram.GetQuantile(0), 0.1));
+    SAMPLE_CHECK(histogram.GetQuantile(1) == 100);
+}
+
+// The snapshot takes over all samples and the histogram is left empty
+SAMPLE_TEST(latency_histogram, snapshot_resets)
+{
+    CLatencyHistogram histogram;
+    for (mfxU32 i = 1; i <= 100; i++)
+        histogram.AddValue(i);
+
+    CLatencyHistogram snapshot;
+    snapshot.AddValue(1000);
+    histogram.TakeSnapshot(snapshot);
+
+    SAMPLE_CHECK(snapshot.GetCount() == 100);
+    SAMPLE_CHECK(snapshot.GetMin() == 1);
+    SAMPLE_CHECK(snapshot.GetMax() == 100);
+    SAMPLE_CHECK(IsNear(snapshot.GetQuantile(0.5), 50));
+
+    SAMPLE_CHECK(histogram.GetCount() == 0);
+    SAMPLE_CHECK(histogram.GetMax() == 0);
+    SAMPLE_CHECK(histogram.GetQuantile(0.99) == 0);
+}
+
+// Every period reports only its own samples, a slow period does not leak into the next one
+SAMPLE_TEST(latency_histogram, snapshot_per_period)
+{
+    CLatencyHistogram histogram;
+    CLatencyHistogram snapshot;
+
+    for (mfxU32 i = 0; i < 50; i++)
+        histogram.AddValue(200);
+    histogram.TakeSnapshot(snapshot);
+    SAMPLE_CHECK(snapshot.GetCount() == 50);
+    SAMPLE_CHECK(snapshot.GetMin() == 200);
+
+    for (mfxU32 i = 0; i < 30; i++)
+        histogram.AddValue(5);
+    histogram.TakeSnapshot(snapshot);
+    SAMPLE_CHECK(snapshot.GetCount() == 30);
+    SAMPLE_CHECK(snapshot.GetMax() == 5);
+    SAMPLE_CHECK(snapshot.GetQuantile(0.99) == 5);
+    SAMPLE_CHECK(snapshot.GetAvg() == 5);
+
+    // a period without frames gives an empty snapshot
+    histogram.TakeSnapshot(snapshot);
+    SAMPLE_CHECK(snapshot.GetCount() == 0);
+}
@@ -0,0 +1,89 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// Runs the cases of the suite given as the argument, or of all the suites.
+// Returns 1 if a case failed, so ctest reports the suite.
+
+#include "sample_test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct SampleTestCase
+{
+    const char*    suite;
+    const char*    name;
+    SampleTestFunc func;
+};
+
+std::vector<SampleTestCase>& GetCases()
+{
+    static std::vector<SampleTestCase> cases;
+    return cases;
+}
+
+bool g_failed = false;
+
+} // namespace
+
+SampleTestRegistrar::SampleTestRegistrar(const char* suite, const char* name, SampleTestFunc func)
+{
+    SampleTestCase testCase = { suite, name, func };
+    GetCases().push_back(testCase);
+}
+
+void sample_test_fail(const char* file, int line, const char* expr)
+{
+    printf("%s:%d: check failed: %s\n", file, line, expr);
+    g_failed = true;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* suite = argc > 1 ? argv[1] : NULL;
+    unsigned int run = 0, failed = 0;
+
+    for (size_t i = 0; i < GetCases().size(); i++)
+    {
+        const SampleTestCase& testCase = GetCases()[i];
+        if (suite && strcmp(suite, testCase.suite))
+            continue;
+
+        printf("[ RUN    ] %s.%s\n", testCase.suite, testCase.name);
+        fflush(stdout);
+        g_failed = false;
+        testCase.func();
+        printf("[ %s ] %s.%s\n", g_failed ? "FAILED" : "    OK", testCase.suite, testCase.name);
+        run++;
+        failed += g_failed ? 1 : 0;
+    }
+
+    if (!run)
+    {
+        printf("error: no test cases in suite %s\n", suite ? suite : "");
+        return 1;
+    }
+    printf("%u cases, %u failed\n", run, failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// The SSE2 and AVX2 row kernels of plane_convert.h must give the results of the plain C
+// ones for every width, with odd widths and tails shorter than a vector, at every alignment.
+
+#include "sample_test.h"
+#include "plane_convert.h"
+
+#include <random>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+
+// Several iterations of the 64 byte AVX2 loop plus every tail
+const mfxU32 MAX_WIDTH = 200;
+const mfxU32 MAX_ALIGNMENT = 32;
+const mfxU32 GUARD = 16;
+
+// The vector implementations of the CPU, the plain C one is the reference
+std::vector<PlaneConvertFunctions> GetVectorFunctions()
+{
+    std::vector<PlaneConvertFunctions> result;
+    PlaneConvertFunctions funcs;
+    if (GetPlaneConvertFunctions(MSDK_CPU_ISA_SSE2, funcs))
+        result.push_back(funcs);
+    if (GetPlaneConvertFunctions(MSDK_CPU_ISA_AVX2, funcs))
+        result.push_back(funcs);
+    return result;
+}
+
+PlaneConvertFunctions GetReference()
+{
+    PlaneConvertFunctions funcs;
+    GetPlaneConvertFunctions(MSDK_CPU_ISA_C, funcs);
+    return funcs;
+}
+
+void FillRandom(mfxU8* pData, size_t size, std::mt19937& random)
+{
+    for (size_t i = 0; i < size; i++)
+        pData[i] = (mfxU8)random();
+}
+
+} // namespace
+
+// The bytes around the destination rows must stay untouched
+SAMPLE_TEST(plane_convert, split_uv_row)
+{
+    const PlaneConvertFunctions reference = GetReference();
+    const std::vector<PlaneConvertFunctions> vector = GetVectorFunctions();
+    std::vector<mfxU8> src(MAX_ALIGNMENT + MAX_WIDTH);
+    std::vector<mfxU8> expected(2 * (GUARD + MAX_ALIGNMENT + MAX_WIDTH / 2 + 1 + GUARD));
+    std::vector<mfxU8> actual(expected.size());
+    std::mt19937 random(1);
+
+    for (size_t f = 0; f < vector.size(); f++)
+    {
+        for (mfxU32 alignment = 0; alignment < MAX_ALIGNMENT; alignment++)
+        {
+            for (mfxU32 width = 0; width <= MAX_WIDTH; width++)
+            {
+                FillRandom(&src[alignment], width, random);
+                FillRandom(&expected[0], expected.size(), random);
+                actual = expected;
+
+                // U and V rows at different alignments
+                const size_t offsetU = GUARD + alignment;
+                const size_t offsetV = expected.size() / 2 + GUARD + (alignment * 7) % MAX_ALIGNMENT;
+                reference.splitUVRow(&expected[offsetU], &expected[offsetV], &src[alignment], width);
+                vector[f].splitUVRow(&actual[offsetU], &actual[offsetV], &src[alignment], width);
+                SAMPLE_CHECK(actual == expected);
+            }
+        }
+    }
+}
+
+SAMPLE_TEST(plane_convert, shift_right_16_row)
+{
+    const PlaneConvertFunctions reference = GetReference();
+    const std::vector<PlaneConvertFunctions> vector = GetVectorFunctions();
+    std::vector<mfxU16> src(MAX_ALIGNMENT + MAX_WIDTH);
+    std::vector<mfxU8> expected(2 * (GUARD + MAX_ALIGNMENT + MAX_WIDTH + GUARD));
+    std::vector<mfxU8> actual(expected.size());
+    std::mt19937 random(2);
+
+    for (size_t f = 0; f < vector.size(); f++)
+    {
+        for (mfxU32 alignment = 0; alignment < MAX_ALIGNMENT; alignment++)
+        {
+            for (mfxU32 width = 0; width <= MAX_WIDTH; width++)
+            {
+                for (mfxU32 shift = 0; shift < 16; shift += 3)
+                {
+                    FillRandom((mfxU8*)&src[alignment], 2 * width, random);
+                    FillRandom(&expected[0], expected.size(), random);
+                    actual = expected;
+
+                    mfxU16* pExpected = (mfxU16*)&expected[2 * (GUARD + alignment)];
+                    mfxU16* pActual = (mfxU16*)&actual[2 * (GUARD + alignment)];
+                    reference.shiftRight16Row(pExpected, &src[alignment], width, shift);
+                    vector[f].shiftRight16Row(pActual, &src[alignment], width, shift);
+                    SAMPLE_CHECK(actual == expected);
+                }
+            }
+        }
+    }
+}
+
+// The dispatched plane functions walk the rows with the source pitch and pack the destination
+SAMPLE_TEST(plane_convert, planes)
+{
+    const mfxU32 height = 3;
+    std::mt19937 random(3);
+
+    for (mfxU32 width = 1; width <= 67; width += 3)
+    {
+        // odd widths, the pitch of the 16-bit rows stays even
+        const mfxU32 pitch = width * 2 + 6;
+        std::vector<mfxU8> src(pitch * height);
+        FillRandom(&src[0], src.size(), random);
+
+        std::vector<mfxU8> u((width + 1) / 2 * height);
+        std::vector<mfxU8> v(width / 2 * height + 1);
+        SplitUVPlane(&u[0], &v[0], &src[0], pitch, width, height);
+        for (mfxU32 y = 0; y < height; y++)
+        {
+            for (mfxU32 x = 0; x < width; x++)
+            {
+                const mfxU8 value = src[y * pitch + x];
+                if (x % 2)
+                    SAMPLE_CHECK(v[y * (width / 2) + x / 2] == value);
+                else
+                    SAMPLE_CHECK(u[y * ((width + 1) / 2) + x / 2] == value);
+            }
+        }
+
+        std::vector<mfxU16> shifted(width * height);
+        CopyPlaneShiftRight16(&shifted[0], &src[0], pitch, width, height, 6);
+        for (mfxU32 y = 0; y < height; y++)
+        {
+            for (mfxU32 x = 0; x < width; x++)
+            {
+                mfxU16 sample;
+                memcpy(&sample, &src[y * pitch + 2 * x], sizeof(sample));
+                SAMPLE_CHECK(shifted[y * width + x] == (mfxU16)(sample >> 6));
+            }
+        }
+    }
+}
@@ -0,0 +1,125 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// The SSE2 row blend of resize_kernel.hpp must round like the scalar loop that finishes
+// the rows, the resize must keep flat images flat whatever the scale and stay within one
+// level of cv::resize, which it replaced.
+
+#include "sample_test.h"
+#include "resize_kernel.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <random>
+#include <stdlib.h>
+#include <vector>
+
+SAMPLE_TEST(resize_kernel, blend_matches_scalar)
+{
+    std::mt19937 random(1);
+    for (int width = 1; width <= 40; width++)
+    {
+        std::vector<float> top(width), bottom(width);
+        for (int x = 0; x < width; x++)
+        {
+            top[x] = (float)(random() % 256);
+            bottom[x] = (float)(random() % 256);
+        }
+        std::vector<uint8_t> expected(width), actual(width);
+        // weights of 1/2 and 1/4 hit the halves between two bytes
+        for (int i = 0; i <= 8; i++)
+        {
+            blendRowScalar(&top[0], &bottom[0], i / 8.f, &expected[0], width);
+            blendRow(&top[0], &bottom[0], i / 8.f, &actual[0], width);
+            SAMPLE_CHECK(expected == actual);
+        }
+    }
+}
+
+SAMPLE_TEST(resize_kernel, halves_round_up)
+{
+    const float top[8] = { 0, 1, 2, 3, 4, 5, 254, 0 };
+    const float bottom[8] = { 1, 2, 3, 4, 5, 6, 255, 255 };
+    const uint8_t expected[8] = { 1, 2, 3, 4, 5, 6, 255, 128 };
+    uint8_t actual[8];
+    blendRow(top, bottom, 0.5f, actual, 8);
+    for (int x = 0; x < 8; x++)
+        SAMPLE_CHECK(actual[x] == expected[x]);
+}
+
+SAMPLE_TEST(resize_kernel, flat_image_stays_flat)
+{
+    const int sizes[][4] = { { 1920, 1080, 672, 384 }, { 200, 200, 62, 62 }, { 31, 17, 64, 64 } };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        const int srcWidth = sizes[s][0], srcHeight = sizes[s][1], width = sizes[s][2], height = sizes[s][3];
+        std::vector<uint8_t> image((size_t)srcWidth * srcHeight * 3);
+        for (size_t i = 0; i < image.size(); i += 3)
+        {
+            image[i] = 10;
+            image[i + 1] = 128;
+            image[i + 2] = 255;
+        }
+        std::vector<uint8_t> planes((size_t)3 * width * height);
+        resizeBgrRows(&image[0], (size_t)srcWidth * 3, ResizeTaps(srcWidth, width, 3), ResizeTaps(srcHeight, height, 1),
+            &planes[0], width, height, 0, height);
+        const size_t planeSize = (size_t)width * height;
+        for (size_t i = 0; i < planeSize; i++)
+        {
+            SAMPLE_CHECK(planes[i] == 10);
+            SAMPLE_CHECK(planes[planeSize + i] == 128);
+            SAMPLE_CHECK(planes[2 * planeSize + i] == 255);
+        }
+    }
+}
+
+// The face detection input and the inputs of age/gender, head pose and emotions, upscaled faces too.
+// cv::resize rounds in fixed point, the kernel in floating point, so they may differ by one level.
+SAMPLE_TEST(resize_kernel, matches_cv_resize)
+{
+    const int sizes[][4] = { { 1920, 1080, 672, 384 }, { 200, 200, 62, 62 }, { 200, 200, 60, 60 },
+        { 200, 200, 64, 64 }, { 37, 53, 64, 64 }, { 123, 77, 62, 62 } };
+    std::mt19937 random(2);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        const int srcWidth = sizes[s][0], srcHeight = sizes[s][1], width = sizes[s][2], height = sizes[s][3];
+        cv::Mat image(srcHeight, srcWidth, CV_8UC3);
+        for (int y = 0; y < srcHeight; y++)
+        {
+            uint8_t* row = image.ptr<uint8_t>(y);
+            for (int x = 0; x < srcWidth * 3; x++)
+                row[x] = (uint8_t)random();
+        }
+        cv::Mat expected;
+        cv::resize(image, expected, cv::Size(width, height), 0, 0, cv::INTER_LINEAR);
+
+        std::vector<uint8_t> planes((size_t)3 * width * height);
+        resizeBgrRows(image.ptr<uint8_t>(), image.step, ResizeTaps(srcWidth, width, 3), ResizeTaps(srcHeight, height, 1),
+            &planes[0], width, height, 0, height);
+        const size_t planeSize = (size_t)width * height;
+        for (int y = 0; y < height; y++)
+        {
+            const uint8_t* row = expected.ptr<uint8_t>(y);
+            for (int x = 0; x < width; x++)
+            {
+                for (int c = 0; c < 3; c++)
+                    SAMPLE_CHECK(abs((int)planes[c * planeSize + (size_t)y * width + x] - (int)row[x * 3 + c]) <= 1);
+            }
+        }
+    }
+}
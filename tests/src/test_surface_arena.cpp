@@ -0,0 +1,187 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// SysMemSurfaceArena and SysMemFrameAllocator on top of it: a pipeline started again with
+// the same surfaces gets the same mapping back, a larger request maps a larger region.
+
+#include "sample_test.h"
+#include "sysmem_allocator.h"
+
+#include <string.h>
+#include <vector>
+
+namespace
+{
+
+const mfxU32 SLOT_SIZE = 64 * 4096;
+const mfxU32 SLOT_COUNT = 6;
+
+mfxFrameAllocRequest MakeRequest(mfxU16 width, mfxU16 height, mfxU16 count)
+{
+    mfxFrameAllocRequest request;
+    memset(&request, 0, sizeof(request));
+    request.Info.FourCC = MFX_FOURCC_NV12;
+    request.Info.ChromaFormat = MFX_CHROMAFORMAT_YUV420;
+    request.Info.Width = width;
+    request.Info.Height = height;
+    request.Type = MFX_MEMTYPE_SYSTEM_MEMORY | MFX_MEMTYPE_EXTERNAL_FRAME | MFX_MEMTYPE_FROM_DECODE;
+    request.NumFrameSuggested = count;
+    request.NumFrameMin = count;
+    return request;
+}
+
+// Every surface can be locked and its planes written in full
+bool SurfacesWritable(SysMemFrameAllocator& allocator, const mfxFrameAllocResponse& response,
+    mfxU16 height, std::vector<mfxU8*>& luma)
+{
+    luma.clear();
+    for (mfxU32 i = 0; i < response.NumFrameActual; i++)
+    {
+        mfxFrameData data;
+        memset(&data, 0, sizeof(data));
+        if (allocator.LockFrame(response.mids[i], &data) != MFX_ERR_NONE || !data.Y || !data.UV)
+            return false;
+        memset(data.Y, (int)i, (size_t)data.Pitch * height);
+        memset(data.UV, (int)i, (size_t)data.Pitch * height / 2);
+        allocator.UnlockFrame(response.mids[i], &data);
+        luma.push_back(data.Y);
+    }
+    return true;
+}
+
+} // namespace
+
+SAMPLE_TEST(surface_arena, release_keeps_mapping)
+{
+    SysMemSurfaceArena arena;
+    mfxHDL region = NULL;
+    mfxU8* pBase = NULL;
+    SAMPLE_CHECK(arena.Acquire(SLOT_SIZE, SLOT_COUNT, &region, &pBase) == MFX_ERR_NONE);
+    const mfxU64 mapped = arena.GetMappedBytes();
+    SAMPLE_CHECK(mapped >= (mfxU64)SLOT_SIZE * SLOT_COUNT);
+    memset(pBase, 1, (size_t)SLOT_SIZE * SLOT_COUNT);
+    arena.Release(region);
+    SAMPLE_CHECK(arena.GetMappedBytes() == mapped);
+
+    // the same request and a smaller one get the cached region back
+    mfxHDL region2 = NULL;
+    mfxU8* pBase2 = NULL;
+    SAMPLE_CHECK(arena.Acquire(SLOT_SIZE, SLOT_COUNT, &region2, &pBase2) == MFX_ERR_NONE);
+    SAMPLE_CHECK(pBase2 == pBase);
+    SAMPLE_CHECK(arena.GetMappedBytes() == mapped);
+    arena.Release(region2);
+    SAMPLE_CHECK(arena.Acquire(SLOT_SIZE, SLOT_COUNT - 1, &region2, &pBase2) == MFX_ERR_NONE);
+    SAMPLE_CHECK(pBase2 == pBase);
+    SAMPLE_CHECK(arena.GetMappedBytes() == mapped);
+    arena.Release(region2);
+
+    arena.Trim();
+    SAMPLE_CHECK(arena.GetMappedBytes() == 0);
+}
+
+SAMPLE_TEST(surface_arena, larger_request_grows)
+{
+    SysMemSurfaceArena arena;
+    mfxHDL region = NULL;
+    mfxU8* pBase = NULL;
+    SAMPLE_CHECK(arena.Acquire(SLOT_SIZE, SLOT_COUNT, &region, &pBase) == MFX_ERR_NONE);
+    const mfxU64 mapped = arena.GetMappedBytes();
+    arena.Release(region);
+
+    // more slots than the cached region holds
+    const mfxU32 largeCount = (mfxU32)(mapped / SLOT_SIZE) + 1;
+    mfxHDL largeRegion = NULL;
+    mfxU8* pLargeBase = NULL;
+    SAMPLE_CHECK(arena.Acquire(SLOT_SIZE, largeCount, &largeRegion, &pLargeBase) == MFX_ERR_NONE);
+    SAMPLE_CHECK(pLargeBase != pBase);
+    SAMPLE_CHECK(arena.GetMappedBytes() >= mapped + (mfxU64)SLOT_SIZE * largeCount);
+    memset(pLargeBase, 1, (size_t)SLOT_SIZE * largeCount);
+
+    // the small region is still cached and preferred for the small request
+    mfxHDL smallRegion = NULL;
+    mfxU8* pSmallBase = NULL;
+    SAMPLE_CHECK(arena.Acquire(SLOT_SIZE, SLOT_COUNT, &smallRegion, &pSmallBase) == MFX_ERR_NONE);
+    SAMPLE_CHECK(pSmallBase == pBase);
+    arena.Release(smallRegion);
+
+    // after the release the large region serves the large request again
+    arena.Release(largeRegion);
+    const mfxU64 grown = arena.GetMappedBytes();
+    SAMPLE_CHECK(arena.Acquire(SLOT_SIZE, largeCount, &largeRegion, &pBase) == MFX_ERR_NONE);
+    SAMPLE_CHECK(pBase == pLargeBase);
+    SAMPLE_CHECK(arena.GetMappedBytes() == grown);
+    arena.Release(largeRegion);
+
+    // a different surface size never gets a region of another one
+    SAMPLE_CHECK(arena.Acquire(SLOT_SIZE * 2, SLOT_COUNT, &region, &pBase) == MFX_ERR_NONE);
+    SAMPLE_CHECK(pBase != pLargeBase && pBase != pSmallBase);
+    arena.Release(region);
+}
+
+// A cache limit of 0 unmaps every released region
+SAMPLE_TEST(surface_arena, cache_limit)
+{
+    SysMemSurfaceArena arena(0);
+    mfxHDL region = NULL;
+    mfxU8* pBase = NULL;
+    SAMPLE_CHECK(arena.Acquire(SLOT_SIZE, SLOT_COUNT, &region, &pBase) == MFX_ERR_NONE);
+    SAMPLE_CHECK(arena.GetMappedBytes() > 0);
+    arena.Release(region);
+    SAMPLE_CHECK(arena.GetMappedBytes() == 0);
+}
+
+// The allocator of the decoder, freed and allocated again as when the next ad starts
+SAMPLE_TEST(surface_arena, allocator_reuses_surfaces)
+{
+    SysMemSurfaceArena arena;
+    SysMemAllocatorParams params;
+    params.pArena = &arena;
+    SysMemFrameAllocator allocator;
+    SAMPLE_CHECK(allocator.Init(&params) == MFX_ERR_NONE);
+
+    mfxFrameAllocRequest request = MakeRequest(1920, 1088, 8);
+    mfxFrameAllocResponse response;
+    memset(&response, 0, sizeof(response));
+    SAMPLE_CHECK(allocator.AllocFrames(&request, &response) == MFX_ERR_NONE);
+    SAMPLE_CHECK(response.NumFrameActual == 8);
+    std::vector<mfxU8*> first;
+    SAMPLE_CHECK(SurfacesWritable(allocator, response, 1088, first));
+    const mfxU64 mapped = arena.GetMappedBytes();
+    SAMPLE_CHECK(allocator.FreeFrames(&response) == MFX_ERR_NONE);
+    SAMPLE_CHECK(arena.GetMappedBytes() == mapped);
+
+    memset(&response, 0, sizeof(response));
+    SAMPLE_CHECK(allocator.AllocFrames(&request, &response) == MFX_ERR_NONE);
+    std::vector<mfxU8*> second;
+    SAMPLE_CHECK(SurfacesWritable(allocator, response, 1088, second));
+    SAMPLE_CHECK(second == first);
+    SAMPLE_CHECK(arena.GetMappedBytes() == mapped);
+    SAMPLE_CHECK(allocator.FreeFrames(&response) == MFX_ERR_NONE);
+
+    // more surfaces than the region holds
+    request = MakeRequest(1920, 1088, (mfxU16)(mapped / (1920 * 1088 * 3 / 2) + 1));
+    memset(&response, 0, sizeof(response));
+    SAMPLE_CHECK(allocator.AllocFrames(&request, &response) == MFX_ERR_NONE);
+    std::vector<mfxU8*> large;
+    SAMPLE_CHECK(SurfacesWritable(allocator, response, 1088, large));
+    SAMPLE_CHECK(arena.GetMappedBytes() > mapped);
+    SAMPLE_CHECK(allocator.FreeFrames(&response) == MFX_ERR_NONE);
+
+    SAMPLE_CHECK(allocator.Close() == MFX_ERR_NONE);
+}
@@ -0,0 +1,375 @@
+/******************************************************************************\
+Copyright (c) 2005-2018, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+// The Chrome trace dumps of trace_events: a dump written while threads keep recording holds only
+// whole spans, exited threads leave a bounded number of buffers, and every dump is valid JSON.
+
+#include "sample_test.h"
+#include "trace_events.h"
+
+#include <atomic>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+const char* const TRACE_PREFIX = "trace_events_test";
+const mfxU32 WRITERS = 2;
+const mfxU32 DUMPS = 100;
+// the writers record until the dumps are done, this only bounds the span numbers
+const mfxU32 SPANS_PER_WRITER = 100000000;
+
+// Span k of a writer is named NAMES[k % 8] and starts at tick 8 * (k + 1) + k % 8, so the name, the
+// start and the number of the span can be checked against each other in the dump
+const char* const NAMES[] = { "span0", "span1", "span2", "span3", "span4", "span5", "span6", "span7" };
+
+// Minimal JSON reader, enough for the dumps: objects, arrays, strings, numbers
+struct JsonValue
+{
+    enum Type { NONE, OBJECT, ARRAY, STRING, NUMBER };
+
+    Type type;
+    std::map<std::string, JsonValue> members;
+    std::vector<JsonValue> items;
+    std::string str;
+    double number;
+
+    JsonValue() : type(NONE), number(0) {}
+
+    const JsonValue& operator[](const char* name) const
+    {
+        static const JsonValue none;
+        std::map<std::string, JsonValue>::const_iterator it = members.find(name);
+        return it != members.end() ? it->second : none;
+    }
+};
+
+class CJsonReader
+{
+public:
+    explicit CJsonReader(const std::string& text) : m_text(text), m_pos(0) {}
+
+    // false if the text is not exactly one JSON value
+    bool Read(JsonValue& value)
+    {
+        if (!ReadValue(value))
+            return false;
+        SkipSpaces();
+        return m_pos == m_text.size();
+    }
+
+private:
+    void SkipSpaces()
+    {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' ||
+                                         m_text[m_pos] == '\r' || m_text[m_pos] == '\t'))
+            m_pos++;
+    }
+
+    bool Expect(char c)
+    {
+        SkipSpaces();
+        if (m_pos >= m_text.size() || m_text[m_pos] != c)
+            return false;
+        m_pos++;
+        return true;
+    }
+
+    bool Peek(char c)
+    {
+        SkipSpaces();
+        return m_pos < m_text.size() && m_text[m_pos] == c;
+    }
+
+    bool ReadString(std::string& str)
+    {
+        if (!Expect('"'))
+            return false;
+        str.clear();
+        while (m_pos < m_text.size() && m_text[m_pos] != '"')
+        {
+            char c = m_text[m_pos++];
+            if ((unsigned char)c < 0x20)
+                return false;
+            if (c == '\\')
+            {
+                if (m_pos >= m_text.size())
+                    return false;
+                c = m_text[m_pos++];
+                if (c == 'u')
+                {
+                    if (m_pos + 4 > m_text.size())
+                        return false;
+                    c = (char)strtol(m_text.substr(m_pos, 4).c_str(), NULL, 16);
+                    m_pos += 4;
+                }
+                else if (c == 'n')
+                    c = '\n';
+                else if (c != '"' && c != '\\' && c != '/')
+                    return false;
+            }
+            str += c;
+        }
+        return Expect('"');
+    }
+
+    bool ReadValue(JsonValue& value)
+    {
+        SkipSpaces();
+        if (m_pos >= m_text.size())
+            return false;
+
+        if (Peek('{'))
+        {
+            value.type = JsonValue::OBJECT;
+            Expect('{');
+            if (Expect('}'))
+                return true;
+            do
+            {
+                std::string name;
+                if (!ReadString(name) || !Expect(':') || !ReadValue(value.members[name]))
+                    return false;
+            } while (Expect(','));
+            return Expect('}');
+        }
+        if (Peek('['))
+        {
+            value.type = JsonValue::ARRAY;
+            Expect('[');
+            if (Expect(']'))
+                return true;
+            do
+            {
+                value.items.push_back(JsonValue());
+                if (!ReadValue(value.items.back()))
+                    return false;
+            } while (Expect(','));
+            return Expect(']');
+        }
+        if (Peek('"'))
+        {
+            value.type = JsonValue::STRING;
+            return ReadString(value.str);
+        }
+
+        const char* begin = m_text.c_str() + m_pos;
+        char* end = NULL;
+        value.type = JsonValue::NUMBER;
+        value.number = strtod(begin, &end);
+        if (end == begin)
+            return false;
+        m_pos += end - begin;
+        return true;
+    }
+
+    const std::string& m_text;
+    size_t m_pos;
+};
+
+std::string DumpPath()
+{
+    return std::string(TRACE_PREFIX) + "." + std::to_string(getpid()) + ".json";
+}
+
+// Reads and parses the last dump, false if it is missing or not valid JSON
+bool ReadDump(JsonValue& dump)
+{
+    FILE* file = fopen(DumpPath().c_str(), "rb");
+    if (!file)
+        return false;
+    std::string text;
+    char buffer[4096];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.append(buffer, size);
+    fclose(file);
+
+    dump = JsonValue();
+    return CJsonReader(text).Read(dump) && dump.type == JsonValue::OBJECT &&
+           dump["traceEvents"].type == JsonValue::ARRAY;
+}
+
+mfxU32 CountThreads(const JsonValue& dump)
+{
+    mfxU32 threads = 0;
+    const std::vector<JsonValue>& events = dump["traceEvents"].items;
+    for (size_t i = 0; i < events.size(); i++)
+        threads += events[i]["name"].str == "thread_name";
+    return threads;
+}
+
+void RecordWriterSpans(mfxU32 count, const std::atomic<bool>& stop)
+{
+    for (mfxU32 k = 0; k < count && !stop; k++)
+        msdk_trace_end(NAMES[k % 8], 8 * (mfxI64)(k + 1) + k % 8);
+}
+
+void RecordWriterSpans(mfxU32 count)
+{
+    std::atomic<bool> stop(false);
+    RecordWriterSpans(count, stop);
+}
+
+// The spans of the writers form an unbroken run of numbers per thread, each with its own name and an
+// end after the test started: a span mixing two slots or a stale slot breaks the run
+bool WriterSpansWhole(const JsonValue& dump, double testStart)
+{
+    std::map<double, double> lastSpan;  // of each writer thread
+    const std::vector<JsonValue>& events = dump["traceEvents"].items;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const JsonValue& event = events[i];
+        if (event["ph"].str != "X" || event["name"].str.compare(0, 4, "span") != 0)
+            continue;
+
+        const double ts = event["ts"].number;
+        const double span = (double)((mfxI64)ts / 8 - 1);
+        if (event["name"].str != NAMES[(mfxI64)ts % 8] || ts != 8 * (span + 1) + (mfxI64)span % 8)
+            return false;
+        if (ts + event["dur"].number < testStart)
+            return false;
+
+        const double tid = event["tid"].number;
+        if (lastSpan.count(tid) && span != lastSpan[tid] + 1)
+            return false;
+        lastSpan[tid] = span;
+    }
+    return true;
+}
+
+// Starts the recording and removes the dump at the end of the scope
+class CTraceSession
+{
+public:
+    CTraceSession() : m_started(msdk_trace_start(TRACE_PREFIX, 1024) == MFX_ERR_NONE) {}
+
+    ~CTraceSession()
+    {
+        msdk_trace_stop();
+        unlink(DumpPath().c_str());
+    }
+
+    bool IsStarted() const { return m_started; }
+
+private:
+    bool m_started;
+};
+
+} // namespace
+
+SAMPLE_TEST(trace_events, dump_while_recording)
+{
+    CTraceSession session;
+    SAMPLE_CHECK(session.IsStarted());
+
+    const double testStart = (double)msdk_trace_begin();
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> writers;
+    for (mfxU32 w = 0; w < WRITERS; w++)
+        writers.push_back(std::thread([&stop]() { RecordWriterSpans(SPANS_PER_WRITER, stop); }));
+
+    // every dump is checked, the rings wrap many times during a dump
+    bool parsed = true, whole = true;
+    for (mfxU32 i = 0; i < DUMPS; i++)
+    {
+        JsonValue dump;
+        parsed = parsed && msdk_trace_dump() == MFX_ERR_NONE && ReadDump(dump);
+        whole = whole && WriterSpansWhole(dump, testStart);
+    }
+    stop = true;
+
+    for (size_t w = 0; w < writers.size(); w++)
+        writers[w].join();
+
+    SAMPLE_CHECK(parsed);
+    SAMPLE_CHECK(whole);
+
+    // the writers have exited, their last spans are still in the next dump
+    JsonValue dump;
+    SAMPLE_CHECK(msdk_trace_dump() == MFX_ERR_NONE);
+    SAMPLE_CHECK(ReadDump(dump));
+    SAMPLE_CHECK(WriterSpansWhole(dump, testStart));
+    SAMPLE_CHECK(CountThreads(dump) >= WRITERS);
+}
+
+SAMPLE_TEST(trace_events, exited_threads_bounded)
+{
+    CTraceSession session;
+    SAMPLE_CHECK(session.IsStarted());
+
+    // the buffers of the threads of other cases go with the first dump
+    SAMPLE_CHECK(msdk_trace_dump() == MFX_ERR_NONE);
+
+    msdk_trace_end("main", msdk_trace_begin());
+    for (mfxU32 i = 0; i < 1000; i++)
+    {
+        std::thread thread([]() { RecordWriterSpans(10); });
+        thread.join();
+    }
+
+    // the calling thread and the last exited ones
+    JsonValue dump;
+    SAMPLE_CHECK(msdk_trace_dump() == MFX_ERR_NONE);
+    SAMPLE_CHECK(ReadDump(dump));
+    SAMPLE_CHECK(CountThreads(dump) <= MSDK_TRACE_EXITED_BUFFERS + 1);
+    SAMPLE_CHECK(CountThreads(dump) > 1);
+
+    // the dumped buffers are reused by the next threads
+    for (mfxU32 i = 0; i < 1000; i++)
+    {
+        std::thread thread([]() { RecordWriterSpans(10); });
+        thread.join();
+    }
+    SAMPLE_CHECK(msdk_trace_dump() == MFX_ERR_NONE);
+    SAMPLE_CHECK(ReadDump(dump));
+    SAMPLE_CHECK(CountThreads(dump) <= MSDK_TRACE_EXITED_BUFFERS + 1);
+}
+
+SAMPLE_TEST(trace_events, json_escapes_names)
+{
+    CTraceSession session;
+    SAMPLE_CHECK(session.IsStarted());
+
+    const char* name = msdk_trace_name("quote \" backslash \\ line\nend");
+    msdk_trace_end(name, msdk_trace_begin());
+
+    JsonValue dump;
+    SAMPLE_CHECK(msdk_trace_dump() == MFX_ERR_NONE);
+    SAMPLE_CHECK(ReadDump(dump));
+    SAMPLE_CHECK(dump["displayTimeUnit"].str == "ms");
+
+    bool found = false;
+    const std::vector<JsonValue>& events = dump["traceEvents"].items;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const JsonValue& event = events[i];
+        SAMPLE_CHECK(event["ph"].type == JsonValue::STRING);
+        SAMPLE_CHECK(event["pid"].number == getpid());
+        found = found || (event["name"].str == name && event["ph"].str == "X" &&
+                          event["ts"].type == JsonValue::NUMBER && event["dur"].number >= 0);
+    }
+    SAMPLE_CHECK(found);
+}